@@ -0,0 +1,95 @@
+/**
+ * @file actuator_meter.h
+ * @brief Runtime accounting for an on/off actuator
+ *
+ * Keeps the actuator's state as last switched (no GPIO read-back), the time
+ * of the last change, the cumulative on time, the number of switches and a
+ * rolling duty cycle. The duty cycle is an exponentially weighted average of
+ * the on/off state with time constant dutyWindowMs, integrated exactly
+ * between updates, so it does not depend on how often it is sampled.
+ *
+ * Counters start at zero on boot. Call update() at least once per millis()
+ * wrap (the control cycle does) so elapsed times stay unambiguous.
+ *
+ * Header-only with no Arduino dependencies: the caller passes the current
+ * time in milliseconds.
+ */
+
+#ifndef ACTUATOR_METER_H
+#define ACTUATOR_METER_H
+
+#include <math.h>
+#include <stdint.h>
+
+class ActuatorMeter {
+public:
+  /**
+   * @param dutyWindowMs Time constant of the rolling duty cycle (ms)
+   */
+  explicit ActuatorMeter(unsigned long dutyWindowMs)
+    : dutyWindowMs_((float)dutyWindowMs), on_(false), last_(0), lastChange_(0),
+      onTimeMs_(0), switches_(0), duty_(0.0f) {}
+
+  /**
+   * Record the actuator state at nowMs
+   * @param on State from now on
+   * @param nowMs Current time (ms)
+   */
+  void update(bool on, unsigned long nowMs) {
+    advance(nowMs);
+    if (on != on_) {
+      on_ = on;
+      lastChange_ = nowMs;
+      switches_++;
+    }
+  }
+
+  bool isOn() const { return on_; }
+
+  // Time of the last switch (ms, 0 = never switched)
+  unsigned long lastChange() const { return lastChange_; }
+
+  uint32_t switches() const { return switches_; }
+
+  /**
+   * Cumulative on time, including the current run
+   * @param nowMs Current time (ms)
+   */
+  uint64_t onTimeMs(unsigned long nowMs) const {
+    return onTimeMs_ + (on_ ? (uint64_t)(nowMs - last_) : 0);
+  }
+
+  /**
+   * Rolling duty cycle (0..1)
+   * @param nowMs Current time (ms)
+   */
+  float duty(unsigned long nowMs) const {
+    return decay(duty_, nowMs - last_);
+  }
+
+private:
+  void advance(unsigned long nowMs) {
+    unsigned long elapsed = nowMs - last_;
+    if (on_) {
+      onTimeMs_ += elapsed;
+    }
+    duty_ = decay(duty_, elapsed);
+    last_ = nowMs;
+  }
+
+  // Average after holding the current state for elapsedMs
+  float decay(float average, unsigned long elapsedMs) const {
+    float target = on_ ? 1.0f : 0.0f;
+    return target + (average - target) * expf(-(float)elapsedMs / dutyWindowMs_);
+  }
+
+  float dutyWindowMs_;
+  bool on_;
+  unsigned long last_;          // Time of the last update (ms)
+  unsigned long lastChange_;
+  uint64_t onTimeMs_;           // On time up to last_
+  uint32_t switches_;
+  float duty_;                  // Duty cycle at last_
+};
+
+#endif // ACTUATOR_METER_H
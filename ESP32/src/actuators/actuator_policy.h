@@ -0,0 +1,123 @@
+/**
+ * @file actuator_policy.h
+ * @brief Anti-short-cycle protection for on/off actuators
+ *
+ * An ActuatorPolicy sits between a control rule and a relay. The rule says
+ * what it wants each cycle; the policy only lets the state change when
+ *   - the actuator has been on for at least minOnMs (turning off), or off
+ *     for at least minOffMs (turning on), and
+ *   - fewer than maxSwitchesPerHour switches happened in the last hour.
+ * Otherwise the current state is held and the request is counted as held.
+ * A forced request (safety off, e.g. tank empty) skips both checks.
+ *
+ * The hysteresis helpers below give rules a release threshold apart from
+ * the switching threshold, so a noisy reading near the setpoint does not
+ * produce a stream of requests in the first place.
+ *
+ * Header-only with no Arduino dependencies: the caller passes the current
+ * time in milliseconds.
+ */
+
+#ifndef ACTUATOR_POLICY_H
+#define ACTUATOR_POLICY_H
+
+#include <stdint.h>
+
+#define ACTUATOR_POLICY_MAX_RATE 32     // Highest maxSwitchesPerHour (switch history entries)
+#define ACTUATOR_POLICY_RATE_WINDOW_MS 3600000UL
+
+/**
+ * ON while value is above threshold; once on, stays on until value drops
+ * to threshold - band
+ */
+inline bool hysteresisAbove(float value, float threshold, float band, bool on) {
+  return on ? value > threshold - band : value > threshold;
+}
+
+/**
+ * ON while value is below threshold; once on, stays on until value rises
+ * to threshold + band
+ */
+inline bool hysteresisBelow(float value, float threshold, float band, bool on) {
+  return on ? value < threshold + band : value < threshold;
+}
+
+class ActuatorPolicy {
+public:
+  /**
+   * @param minOnMs Shortest on time (ms)
+   * @param minOffMs Shortest off time (ms)
+   * @param maxSwitchesPerHour Switch rate limit (0 = unlimited, at most ACTUATOR_POLICY_MAX_RATE)
+   */
+  ActuatorPolicy(unsigned long minOnMs, unsigned long minOffMs, uint8_t maxSwitchesPerHour)
+    : minOnMs_(minOnMs), minOffMs_(minOffMs),
+      maxRate_(maxSwitchesPerHour > ACTUATOR_POLICY_MAX_RATE ? ACTUATOR_POLICY_MAX_RATE
+                                                              : maxSwitchesPerHour),
+      on_(false), started_(false), lastSwitch_(0), historyCount_(0), historyNext_(0),
+      switches_(0), held_(0) {}
+
+  /**
+   * Decide the actuator state for this cycle
+   * @param wanted State the control rule asks for
+   * @param nowMs Current time (ms)
+   * @param force Switch regardless of dwell times and rate (safety)
+   * @return State to apply (wanted, or the current state if the switch is held)
+   */
+  bool request(bool wanted, unsigned long nowMs, bool force = false) {
+    if (!started_) {
+      // The actuator has been off since boot - it may turn on at once
+      started_ = true;
+      lastSwitch_ = nowMs - minOffMs_;
+    }
+    if (wanted == on_) {
+      return on_;
+    }
+    if (!force && (nowMs - lastSwitch_ < (on_ ? minOnMs_ : minOffMs_) || rateLimited(nowMs))) {
+      held_++;
+      return on_;
+    }
+
+    on_ = wanted;
+    lastSwitch_ = nowMs;
+    switches_++;
+    if (maxRate_ > 0) {
+      history_[historyNext_] = nowMs;
+      historyNext_ = (historyNext_ + 1) % maxRate_;
+      if (historyCount_ < maxRate_) {
+        historyCount_++;
+      }
+    }
+    return on_;
+  }
+
+  bool isOn() const { return on_; }
+
+  // Switches let through since construction
+  uint32_t switches() const { return switches_; }
+
+  // Cycles a requested switch was held back
+  uint32_t held() const { return held_; }
+
+private:
+  // The oldest of the last maxRate_ switches is less than an hour old
+  bool rateLimited(unsigned long nowMs) const {
+    if (maxRate_ == 0 || historyCount_ < maxRate_) {
+      return false;
+    }
+    return nowMs - history_[historyNext_] < ACTUATOR_POLICY_RATE_WINDOW_MS;
+  }
+
+  unsigned long minOnMs_;
+  unsigned long minOffMs_;
+  uint8_t maxRate_;
+  bool on_;
+  bool started_;
+  unsigned long lastSwitch_;
+  unsigned long history_[ACTUATOR_POLICY_MAX_RATE];  // Recent switch times (ring)
+  uint8_t historyCount_;
+  uint8_t historyNext_;                               // Oldest entry once the ring is full
+  uint32_t switches_;
+  uint32_t held_;
+};
+
+#endif // ACTUATOR_POLICY_H
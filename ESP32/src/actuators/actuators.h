@@ -6,6 +6,17 @@
 #ifndef ACTUATORS_H
 #define ACTUATORS_H
 
+#include <stdint.h>
+
+// Actuator identifiers
+enum ActuatorId : uint8_t {
+  ACTUATOR_PUMP,
+  ACTUATOR_HEATING,
+  ACTUATOR_LED,
+  ACTUATOR_FAN,
+  ACTUATOR_COUNT
+};
+
 // Pump functions
 void initPump();
 void turnPumpOn();
@@ -30,4 +41,25 @@ void turnFanOn();
 void turnFanOff();
 bool isFanOn();
 
+// Actuator usage since boot (see actuator_meter.h)
+struct ActuatorUsage {
+  bool on;
+  unsigned long lastChangeMs;   // millis() of the last switch
+  uint64_t onTimeMs;            // Cumulative on time
+  uint32_t switches;
+  float duty;                   // Rolling duty cycle (0..1, ACTUATOR_DUTY_WINDOW_MS)
+  double energyWh;              // On time x rated power
+};
+
+// Registry (actuators/registry.cpp). Control logic switches through the
+// anti-short-cycle policy (see actuator_policy.h) instead of calling the
+// turn*On/turn*Off functions, and reads the cached state instead of is*On().
+bool setActuator(ActuatorId actuator, bool on, bool force = false);
+void syncActuator(ActuatorId actuator, bool on, unsigned long atMs);
+bool isActuatorOn(ActuatorId actuator);
+void getActuatorUsage(ActuatorId actuator, ActuatorUsage &usage);
+double getPumpedLitres();
+const char* getActuatorName(ActuatorId actuator);
+void getActuatorPolicyStats(ActuatorId actuator, uint32_t &switches, uint32_t &held);
+
 #endif // ACTUATORS_H
@@ -0,0 +1,137 @@
+/**
+ * @file registry.cpp
+ * @brief Actuator registry: switching policy, cached state and usage
+ *
+ * One channel per actuator with its anti-short-cycle policy
+ * (actuator_policy.h) and runtime meter (actuator_meter.h). The control
+ * rules switch actuators only through setActuator(), so the registry always
+ * knows each actuator's state without reading the GPIO back.
+ */
+
+#include <Arduino.h>
+#include "actuators.h"
+#include "actuator_meter.h"
+#include "actuator_policy.h"
+#include "../config.h"
+#include "../constants.h"
+
+struct ActuatorChannel {
+  const char* name;         // Also the telemetry / JSON key
+  float ratedWatts;
+  ActuatorPolicy policy;
+  ActuatorMeter meter;
+  void (*turnOn)();
+  void (*turnOff)();
+  bool holding;             // A switch is being held (logged once)
+};
+
+static ActuatorChannel channels[ACTUATOR_COUNT] = {
+  { "pump", PUMP_RATED_W,
+    ActuatorPolicy(PUMP_MIN_ON_MS, PUMP_MIN_OFF_MS, PUMP_MAX_SWITCHES_PER_HOUR),
+    ActuatorMeter(ACTUATOR_DUTY_WINDOW_MS), turnPumpOn, turnPumpOff, false },
+  { "heating", HEATING_RATED_W,
+    ActuatorPolicy(HEATING_MIN_ON_MS, HEATING_MIN_OFF_MS, HEATING_MAX_SWITCHES_PER_HOUR),
+    ActuatorMeter(ACTUATOR_DUTY_WINDOW_MS), turnHeatingOn, turnHeatingOff, false },
+  { "led", LED_RATED_W,
+    ActuatorPolicy(LED_MIN_ON_MS, LED_MIN_OFF_MS, LED_MAX_SWITCHES_PER_HOUR),
+    ActuatorMeter(ACTUATOR_DUTY_WINDOW_MS), turnLEDOn, turnLEDOff, false },
+  { "fan", FAN_RATED_W,
+    ActuatorPolicy(FAN_MIN_ON_MS, FAN_MIN_OFF_MS, FAN_MAX_SWITCHES_PER_HOUR),
+    ActuatorMeter(ACTUATOR_DUTY_WINDOW_MS), turnFanOn, turnFanOff, false }
+};
+
+/**
+ * Request an actuator state
+ * The relay only switches if the actuator's policy allows it; otherwise it
+ * keeps its current state and the control rule asks again next cycle.
+ * @param actuator Actuator to switch
+ * @param on Requested state
+ * @param force Skip the dwell times and rate limit (safety stops)
+ * @return State of the actuator after the call
+ */
+bool setActuator(ActuatorId actuator, bool on, bool force) {
+  ActuatorChannel& channel = channels[actuator];
+  unsigned long now = millis();
+  uint32_t held = channel.policy.held();
+  bool state = channel.policy.request(on, now, force);
+  
+  bool holding = channel.policy.held() != held;
+  if (holding && !channel.holding) {
+    Serial.printf("⏳ %s %s held (anti-short-cycle)\n", channel.name, on ? "ON" : "OFF");
+  }
+  channel.holding = holding;
+  
+  if (state != channel.meter.isOn()) {
+    if (state) {
+      channel.turnOn();
+    } else {
+      channel.turnOff();
+    }
+  }
+  channel.meter.update(state, now);
+  return state;
+}
+
+/**
+ * Record a switch made outside setActuator() (e.g. a timer cut the pump)
+ * The relay is not touched; the cached state, policy and meter catch up.
+ * @param actuator Actuator
+ * @param on State the relay was switched to
+ * @param atMs When it switched (millis() clock, not before the last switch)
+ */
+void syncActuator(ActuatorId actuator, bool on, unsigned long atMs) {
+  ActuatorChannel& channel = channels[actuator];
+  channel.policy.request(on, atMs, true);
+  channel.meter.update(on, atMs);
+}
+
+/**
+ * Get an actuator's state as last switched (no GPIO read)
+ * @param actuator Actuator
+ * @return true if ON
+ */
+bool isActuatorOn(ActuatorId actuator) {
+  return channels[actuator].meter.isOn();
+}
+
+/**
+ * Get an actuator's runtime, switch count, duty cycle and energy
+ * @param actuator Actuator
+ * @param usage Destination
+ */
+void getActuatorUsage(ActuatorId actuator, ActuatorUsage &usage) {
+  const ActuatorChannel& channel = channels[actuator];
+  unsigned long now = millis();
+  usage.on = channel.meter.isOn();
+  usage.lastChangeMs = channel.meter.lastChange();
+  usage.onTimeMs = channel.meter.onTimeMs(now);
+  usage.switches = channel.meter.switches();
+  usage.duty = channel.meter.duty(now);
+  usage.energyWh = usage.onTimeMs / 3600000.0 * channel.ratedWatts;
+}
+
+/**
+ * Get the water pumped since boot (pump on time x PUMP_FLOW_L_PER_MIN)
+ * @return Litres
+ */
+double getPumpedLitres() {
+  return channels[ACTUATOR_PUMP].meter.onTimeMs(millis()) / 60000.0 * PUMP_FLOW_L_PER_MIN;
+}
+
+/**
+ * Get an actuator's name (lowercase, used as its JSON key)
+ */
+const char* getActuatorName(ActuatorId actuator) {
+  return channels[actuator].name;
+}
+
+/**
+ * Get an actuator's policy counters
+ * @param actuator Actuator
+ * @param switches Switches let through since boot
+ * @param held Control cycles a requested switch was held back
+ */
+void getActuatorPolicyStats(ActuatorId actuator, uint32_t &switches, uint32_t &held) {
+  switches = channels[actuator].policy.switches();
+  held = channels[actuator].policy.held();
+}
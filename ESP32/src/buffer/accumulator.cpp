@@ -0,0 +1,116 @@
+/**
+ * @file accumulator.cpp
+ * @brief Streaming (Welford) aggregator for telemetry windows
+ */
+
+#include <math.h>
+#include <string.h>
+#include "accumulator.h"
+
+void ChannelAccumulator::reset() {
+  count = 0;
+  mean = 0;
+  m2 = 0;
+  min = 0;
+  max = 0;
+}
+
+void ChannelAccumulator::merge(uint32_t n, float groupMean, float groupStdDev,
+                               float groupMin, float groupMax) {
+  if (n == 0) {
+    return;
+  }
+  
+  if (count == 0) {
+    count = n;
+    mean = groupMean;
+    m2 = groupStdDev * groupStdDev * n;
+    min = groupMin;
+    max = groupMax;
+    return;
+  }
+  
+  uint32_t total = count + n;
+  float delta = groupMean - mean;
+  mean += delta * n / total;
+  m2 += groupStdDev * groupStdDev * n + delta * delta * ((float)count * n / total);
+  count = total;
+  
+  if (groupMin < min) min = groupMin;
+  if (groupMax > max) max = groupMax;
+}
+
+float ChannelAccumulator::stdDev() const {
+  if (count < 2 || m2 <= 0) {
+    return 0;
+  }
+  return sqrtf(m2 / count);
+}
+
+// Fold one channel of a reading; raw readings are single samples
+static void addChannel(ChannelAccumulator& channel, float value, bool validValue,
+                       bool raw, const ChannelStats& stats) {
+  if (!validValue) {
+    return; // Skip SENSOR_ERROR_* sentinels
+  }
+  if (raw) {
+    channel.merge(1, value, 0, value, value);
+  } else {
+    channel.merge(stats.count, value, stats.stdDev, stats.min, stats.max);
+  }
+}
+
+// Export one channel into the aggregate (sentinel if no valid samples)
+static void finalizeChannel(const ChannelAccumulator& channel, float errorValue,
+                            float& value, ChannelStats& stats) {
+  stats.count = (uint16_t)(channel.count > 65535 ? 65535 : channel.count);
+  if (channel.count == 0) {
+    value = errorValue;
+    stats.min = stats.max = errorValue;
+    stats.stdDev = 0;
+    return;
+  }
+  value = channel.mean;
+  stats.min = channel.min;
+  stats.max = channel.max;
+  stats.stdDev = channel.stdDev();
+}
+
+void TelemetryAccumulator::reset() {
+  temperature_.reset();
+  humidity_.reset();
+  light_.reset();
+  samples_ = 0;
+  events_ = 0;
+  entries_ = 0;
+  memset(&latest_, 0, sizeof(latest_));
+}
+
+void TelemetryAccumulator::add(const TelemetryReading& reading) {
+  bool raw = reading.samples <= 1;
+  
+  addChannel(temperature_, reading.temperature, reading.temperature != SENSOR_ERROR_TEMP,
+             raw, reading.temperatureStats);
+  addChannel(humidity_, reading.humidity, reading.humidity != SENSOR_ERROR_HUM,
+             raw, reading.humidityStats);
+  addChannel(light_, reading.light, reading.light >= 0,
+             raw, reading.lightStats);
+  
+  samples_ += raw ? 1 : reading.samples;
+  events_ |= raw ? rawReadingEvents(reading) : reading.events;
+  entries_++;
+  latest_ = reading;
+}
+
+void TelemetryAccumulator::finalize(TelemetryReading& aggregate) const {
+  aggregate = latest_;
+  
+  finalizeChannel(temperature_, SENSOR_ERROR_TEMP, aggregate.temperature, aggregate.temperatureStats);
+  finalizeChannel(humidity_, SENSOR_ERROR_HUM, aggregate.humidity, aggregate.humidityStats);
+  finalizeChannel(light_, SENSOR_ERROR_LIGHT, aggregate.light, aggregate.lightStats);
+  
+  aggregate.samples = (uint16_t)(samples_ > 65535 ? 65535 : samples_);
+  aggregate.events = events_;
+  aggregate.irrigated = (events_ & READING_EVENT_IRRIGATED) != 0;
+  aggregate.valid = true;
+}
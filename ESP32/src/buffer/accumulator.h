@@ -0,0 +1,76 @@
+/**
+ * @file accumulator.h
+ * @brief Streaming (Welford) aggregator for telemetry windows
+ * 
+ * Readings are folded in one at a time, so aggregation is an O(1)
+ * finalize instead of a drain + recompute. Already-aggregated readings
+ * are merged with their statistics (Chan et al. parallel update), so the
+ * same accumulator serves every tier of the cascade.
+ * 
+ * Sensor error sentinels are skipped per channel and event flags
+ * (irrigated, pump ran, ...) are OR'd across the window.
+ */
+
+#ifndef ACCUMULATOR_H
+#define ACCUMULATOR_H
+
+#include <stdint.h>
+#include "buffer.h"
+
+// Running statistics for one sensor channel
+struct ChannelAccumulator {
+  uint32_t count;
+  float mean;
+  float m2;                 // Sum of squared deviations from the mean
+  float min;
+  float max;
+
+  void reset();
+
+  /**
+   * Merge a group of samples
+   * @param n Number of samples in the group
+   * @param groupMean Mean of the group
+   * @param groupStdDev Population standard deviation of the group
+   * @param groupMin Smallest sample of the group
+   * @param groupMax Largest sample of the group
+   */
+  void merge(uint32_t n, float groupMean, float groupStdDev, float groupMin, float groupMax);
+
+  // Population standard deviation (0 for fewer than two samples)
+  float stdDev() const;
+};
+
+class TelemetryAccumulator {
+public:
+  TelemetryAccumulator() { reset(); }
+
+  void reset();
+
+  /**
+   * Fold a raw reading or an aggregate into the window
+   * @param reading Reading to add (raw if samples <= 1)
+   */
+  void add(const TelemetryReading& reading);
+
+  /**
+   * Build the aggregate for the current window
+   * Timestamp and actuator states come from the newest reading added
+   * @param aggregate Output parameter for the aggregated reading
+   */
+  void finalize(TelemetryReading& aggregate) const;
+
+  // Number of readings/aggregates added since reset()
+  int entries() const { return entries_; }
+
+private:
+  ChannelAccumulator temperature_;
+  ChannelAccumulator humidity_;
+  ChannelAccumulator light_;
+  uint32_t samples_;
+  uint8_t events_;
+  int entries_;
+  TelemetryReading latest_;
+};
+
+#endif // ACCUMULATOR_H
@@ -0,0 +1,379 @@
+/**
+ * @file buffer.cpp
+ * @brief Tiered offline telemetry buffer (downsampling cascade)
+ * 
+ * Tier 0 stores the 1-minute telemetry windows as PackedAggregate records
+ * (with their statistics). When a tier is full, the oldest fan-in entries
+ * are aggregated into one entry of the next tier, so the same memory
+ * covers much longer outages at decreasing resolution.
+ * Entries in a higher tier are always older than those in a lower one.
+ */
+
+#include <Arduino.h>
+#include "buffer.h"
+#include "buffer_tier.h"
+#include "accumulator.h"
+#include "journal.h"
+
+// ============================================
+// TIER TABLE (edit here to change the cascade)
+// ============================================
+static RingBufferTier<PackedAggregate, BUFFER_TIER0_SIZE, 1> tier1Min("1-min");
+static RingBufferTier<PackedAggregate, BUFFER_TIER1_SIZE, BUFFER_TIER1_FANIN> tier10Min("10-min");
+static RingBufferTier<PackedAggregate, BUFFER_TIER2_SIZE, BUFFER_TIER2_FANIN> tier1Hour("1-hour");
+static RingBufferTier<PackedAggregate, BUFFER_TIER3_SIZE, BUFFER_TIER3_FANIN> tier6Hour("6-hour");
+static RingBufferTier<PackedAggregate, BUFFER_TIER4_SIZE, BUFFER_TIER4_FANIN> tier24Hour("24-hour");
+
+static_assert(BUFFER_TIER0_SIZE >= BUFFER_TIER1_FANIN, "Tier 0 must hold a full tier 1 window");
+static_assert(BUFFER_TIER1_SIZE >= BUFFER_TIER2_FANIN, "Tier 1 must hold a full tier 2 window");
+static_assert(BUFFER_TIER2_SIZE >= BUFFER_TIER3_FANIN, "Tier 2 must hold a full tier 3 window");
+static_assert(BUFFER_TIER3_SIZE >= BUFFER_TIER4_FANIN, "Tier 3 must hold a full tier 4 window");
+
+BufferTier* const bufferTiers[] = { &tier1Min, &tier10Min, &tier1Hour, &tier6Hour, &tier24Hour };
+const int bufferTierCount = sizeof(bufferTiers) / sizeof(bufferTiers[0]);
+
+// Observability counters, indexed like bufferTiers
+static BufferTierStats tierStats[sizeof(bufferTiers) / sizeof(bufferTiers[0])];
+static BufferFlushStats flushStats;
+
+/**
+ * Update the high-water mark of a tier after a push
+ * @param tier Tier index
+ */
+static void noteTierDepth(int tier) {
+  uint16_t depth = (uint16_t)bufferTiers[tier]->size();
+  if (depth > tierStats[tier].highWater) {
+    tierStats[tier].highWater = depth;
+  }
+}
+
+// Streaming aggregate of the readings currently in tier 0, updated on
+// every addToBuffer() with the entry as stored, so it matches a rebuild
+// from the tier exactly. Valid only while it covers exactly the tier
+// contents (entries() == size()); otherwise roll-up merges stored stats.
+static TelemetryAccumulator tier0Window;
+
+/**
+ * Aggregate the oldest entries of a tier by merging their statistics
+ * @param source Tier to read from
+ * @param count Number of oldest entries to aggregate
+ * @param aggregate Output parameter for aggregated reading
+ */
+static void aggregateOldest(const BufferTier& source, size_t count, TelemetryReading& aggregate) {
+  TelemetryAccumulator accumulator;
+  for (size_t i = 0; i < count; i++) {
+    TelemetryReading reading;
+    source.read(i, reading);
+    accumulator.add(reading);
+  }
+  accumulator.finalize(aggregate);
+}
+
+/**
+ * Rebuild the tier 0 streaming window from the entries left in tier 0
+ */
+static void rebuildTier0Window() {
+  tier0Window.reset();
+  for (size_t i = 0; i < bufferTiers[0]->size(); i++) {
+    TelemetryReading reading;
+    bufferTiers[0]->read(i, reading);
+    tier0Window.add(reading);
+  }
+}
+
+/**
+ * Roll the oldest entries of a full tier up into the next tier
+ * @param tier Index of the full tier
+ */
+static void rollUp(int tier) {
+  BufferTier& source = *bufferTiers[tier];
+  
+  if (tier + 1 >= bufferTierCount) {
+    // Last tier - nothing coarser to roll into
+    Serial.printf("⚠️  %s buffer full - dropping oldest entry\n", source.name());
+    uint16_t samples = source.samples(0);
+    tierStats[tier].dropped++;
+    tierStats[tier].droppedSamples += samples > 1 ? samples : 1;
+    source.pop();
+    journalBufferPop(tier);
+    return;
+  }
+  
+  BufferTier& target = *bufferTiers[tier + 1];
+  if (target.full()) {
+    rollUp(tier + 1);
+  }
+  
+  size_t count = target.fanIn();
+  bool streamed = (tier == 0) && (count == source.size()) &&
+                  (tier0Window.entries() == (int)source.size());
+  
+  TelemetryReading aggregate;
+  if (streamed) {
+    tier0Window.finalize(aggregate); // O(1) - window covers the whole tier
+  } else {
+    aggregateOldest(source, count, aggregate);
+  }
+  
+  target.push(aggregate);
+  journalBufferPush(tier + 1);
+  for (size_t i = 0; i < count; i++) {
+    source.pop();
+    journalBufferPop(tier);
+  }
+  tierStats[tier].aggregated += count;
+  tierStats[tier + 1].enqueued++;
+  noteTierDepth(tier + 1);
+  
+  if (tier == 0) {
+    rebuildTier0Window(); // Just a reset when the whole tier was rolled up
+  }
+  
+  Serial.printf("Aggregated %u %s entries into %s buffer (count: %u)\n",
+                (unsigned)count, source.name(), target.name(), (unsigned)target.size());
+}
+
+/**
+ * Initialize all buffer tiers
+ */
+void initBuffers() {
+  size_t bytes = 0;
+  for (int i = 0; i < bufferTierCount; i++) {
+    bufferTiers[i]->clear();
+    bytes += bufferTiers[i]->capacity() * bufferTiers[i]->recordSize();
+  }
+  tier0Window.reset();
+  memset(tierStats, 0, sizeof(tierStats));
+  memset(&flushStats, 0, sizeof(flushStats));
+  Serial.printf("%d-tier buffer initialized (%u bytes)\n", bufferTierCount, (unsigned)bytes);
+}
+
+/**
+ * Add telemetry reading to tier 0 (rolling up full tiers first)
+ * @param reading Telemetry data to store
+ */
+void addToBuffer(const TelemetryReading& reading) {
+  if (bufferTiers[0]->full()) {
+    rollUp(0);
+  }
+  
+  TelemetryReading entry = reading;
+  entry.valid = true;
+  bufferTiers[0]->push(entry);
+  journalBufferPush(0);
+  bufferTiers[0]->read(bufferTiers[0]->size() - 1, entry); // As packed (fixed-point)
+  tier0Window.add(entry);
+  tierStats[0].enqueued++;
+  noteTierDepth(0);
+  
+  Serial.printf("Added to %s buffer (count: %u)\n",
+                bufferTiers[0]->name(), (unsigned)bufferTiers[0]->size());
+}
+
+/**
+ * Add telemetry reading to tier 0 in timestamp order
+ * @param reading Telemetry data to store
+ */
+void insertIntoBuffer(const TelemetryReading& reading) {
+  BufferTier& tier0 = *bufferTiers[0];
+  uint32_t timestamp = (uint32_t)strtoul(reading.timestamp, NULL, 10);
+  if (tier0.empty() || tier0.timestamp(tier0.size() - 1) <= timestamp) {
+    addToBuffer(reading);
+    return;
+  }
+  
+  if (tier0.full()) {
+    rollUp(0);
+  }
+  
+  size_t index = tier0.size();
+  while (index > 0 && tier0.timestamp(index - 1) > timestamp) {
+    index--;
+  }
+  
+  TelemetryReading entry = reading;
+  entry.valid = true;
+  tier0.insert(index, entry);
+  journalBufferRewrite(); // The journal replays pushes in order - write a fresh snapshot
+  rebuildTier0Window();
+  tierStats[0].enqueued++;
+  noteTierDepth(0);
+  
+  Serial.printf("Inserted into %s buffer at position %u (count: %u)\n",
+                tier0.name(), (unsigned)index, (unsigned)tier0.size());
+}
+
+int getBufferTierCount() {
+  return bufferTierCount;
+}
+
+const char* getBufferTierName(int tier) {
+  return bufferTiers[tier]->name();
+}
+
+int getBufferCapacity(int tier) {
+  return (int)bufferTiers[tier]->capacity();
+}
+
+int getBufferCount(int tier) {
+  return (int)bufferTiers[tier]->size();
+}
+
+/**
+ * Get the tier holding the oldest buffered data
+ * @return Tier index, or -1 if all tiers are empty
+ */
+int getOldestBufferTier() {
+  for (int i = bufferTierCount - 1; i >= 0; i--) {
+    if (!bufferTiers[i]->empty()) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Get oldest reading from a tier
+ * @param tier Tier index
+ * @param reading Output parameter for retrieved data
+ * @return true if reading retrieved, false if tier empty
+ */
+bool getOldestFromBuffer(int tier, TelemetryReading& reading) {
+  if (bufferTiers[tier]->empty()) {
+    return false;
+  }
+  
+  bufferTiers[tier]->read(0, reading);
+  return reading.valid;
+}
+
+/**
+ * Remove oldest reading from a tier (after successful transmission)
+ * @param tier Tier index
+ */
+void removeOldestFromBuffer(int tier) {
+  if (bufferTiers[tier]->pop()) {
+    journalBufferPop(tier);
+    tierStats[tier].flushed++;
+  }
+  if (tier == 0 && bufferTiers[0]->empty()) {
+    tier0Window.reset(); // Flushed - next window starts clean
+  }
+}
+
+/**
+ * Get a buffered reading by chronological position across all tiers
+ * @param index Position (0 = oldest buffered reading)
+ * @param reading Output parameter for retrieved data
+ * @return true if reading retrieved, false if index out of range
+ */
+bool getBufferedReading(int index, TelemetryReading& reading) {
+  for (int tier = bufferTierCount - 1; tier >= 0 && index >= 0; tier--) {
+    int size = (int)bufferTiers[tier]->size();
+    if (index < size) {
+      bufferTiers[tier]->read(index, reading);
+      return true;
+    }
+    index -= size;
+  }
+  return false;
+}
+
+/**
+ * Remove the oldest buffered readings across all tiers
+ * @param count Number of readings to remove
+ */
+void removeOldestBuffered(int count) {
+  int tier;
+  while (count > 0 && (tier = getOldestBufferTier()) >= 0) {
+    removeOldestFromBuffer(tier);
+    count--;
+  }
+}
+
+/**
+ * Get total buffered readings count
+ * @return Total number of readings across all tiers
+ */
+int getTotalBufferedCount() {
+  int total = 0;
+  for (int i = 0; i < bufferTierCount; i++) {
+    total += (int)bufferTiers[i]->size();
+  }
+  return total;
+}
+
+/**
+ * Check if any tier has data
+ * @return true if there is buffered data to send
+ */
+bool hasBufferedData() {
+  return getOldestBufferTier() >= 0;
+}
+
+/**
+ * Rewrite the timestamps of provisional buffered readings in place
+ * @param rewrite Maps a provisional timestamp to its replacement
+ * @param resolved The replacements are Unix time
+ * @return Number of readings rewritten
+ */
+int rewriteProvisionalTimestamps(uint32_t (*rewrite)(uint32_t timestamp), bool resolved) {
+  int changed = 0;
+  for (int tier = 0; tier < bufferTierCount; tier++) {
+    for (size_t i = 0; i < bufferTiers[tier]->size(); i++) {
+      if (!bufferTiers[tier]->provisional(i)) {
+        continue;
+      }
+      uint32_t timestamp = rewrite(bufferTiers[tier]->timestamp(i));
+      bufferTiers[tier]->setTimestamp(i, timestamp, !resolved);
+      changed++;
+    }
+  }
+  
+  if (changed > 0) {
+    rebuildTier0Window(); // Aggregates take the newest timestamp of their window
+    journalBufferRewrite();
+  }
+  return changed;
+}
+
+/**
+ * Get counters for one tier
+ * @param tier Tier index
+ * @param stats Output parameter for counters
+ * @return true if the tier exists
+ */
+bool getBufferTierStats(int tier, BufferTierStats& stats) {
+  if (tier < 0 || tier >= bufferTierCount) {
+    return false;
+  }
+  
+  // Entries replayed from the journal bypass addToBuffer()
+  noteTierDepth(tier);
+  
+  stats = tierStats[tier];
+  stats.depth = (uint16_t)bufferTiers[tier]->size();
+  stats.capacity = (uint16_t)bufferTiers[tier]->capacity();
+  stats.oldestTimestamp = bufferTiers[tier]->empty() ? 0 : bufferTiers[tier]->timestamp(0);
+  return true;
+}
+
+/**
+ * Record the outcome of a buffer flush
+ * @param records Readings sent
+ * @param durationMs Time from flush start to completion (ms)
+ */
+void recordBufferFlush(int records, unsigned long durationMs) {
+  flushStats.flushes++;
+  flushStats.lastRecords = records > 0 ? (uint32_t)records : 0;
+  flushStats.lastDurationMs = durationMs;
+  flushStats.recordsPerSecond = durationMs > 0 ? flushStats.lastRecords * 1000.0f / durationMs : 0.0f;
+}
+
+/**
+ * Get timing of the most recent flush
+ * @return Flush statistics
+ */
+const BufferFlushStats& getBufferFlushStats() {
+  return flushStats;
+}
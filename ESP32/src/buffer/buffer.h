@@ -2,125 +2,325 @@
  * @file buffer.h
  * @brief Circular buffer module for offline telemetry storage
  * 
- * Two-tier buffering system:
- * - Buffer #1: High-resolution 1-minute readings (10 entries)
- * - Buffer #2: Low-resolution 10-minute aggregates (10 entries)
+ * N-tier downsampling cascade (configured in constants.h), by default:
+ * - Tier 0: 1-minute windows
+ * - Tier 1: 10-minute aggregates
+ * - Tier 2: 1-hour aggregates
+ * - Tier 3: 6-hour aggregates
+ * - Tier 4: 24-hour aggregates
  * 
- * When MQTT is offline, data is stored in Buffer #1.
- * When Buffer #1 fills, data is aggregated into Buffer #2.
- * When MQTT reconnects, buffers are flushed automatically.
+ * Every tier stores 44-byte PackedAggregate records (means plus
+ * min/max/stddev/count per channel): tier 0 receives the 1-minute
+ * telemetry windows, which already carry statistics. The 16-byte
+ * PackedReading is the mean part of that record and the live binary
+ * record. The public API keeps using TelemetryReading and converts at the
+ * boundary.
+ * 
+ * When MQTT is offline, data is stored in tier 0.
+ * When a tier fills, its oldest entries are aggregated into the next tier
+ * (fan-in entries per aggregate), so older data is kept at lower resolution.
+ * When MQTT reconnects, tiers are flushed oldest-first automatically.
+ * 
+ * All tiers are mirrored to a flash journal (see journal.h) so buffered
+ * data survives reboots and brownouts.
  */
 
 #ifndef BUFFER_H
 #define BUFFER_H
 
+#include <stdint.h>
+#include "../constants.h"
+
+// Per-channel window statistics (aggregated readings only)
+struct ChannelStats {
+  float min;                // Smallest valid sample
+  float max;                // Largest valid sample
+  float stdDev;             // Population standard deviation
+  uint16_t count;           // Valid samples (sensor errors are skipped)
+};
+
+// Event flags OR'd across an aggregation window
+#define READING_EVENT_IRRIGATED   0x01  // Irrigation completed
+#define READING_EVENT_PUMP_RAN    0x02  // Pump was on in at least one sample
+#define READING_EVENT_LIGHTS_RAN  0x04  // LEDs were on in at least one sample
+#define READING_EVENT_TANK_EMPTY  0x08  // Tank reported empty in at least one sample
+
 // Telemetry data structure
 struct TelemetryReading {
   char timestamp[30];       // ISO 8601 timestamp string
-  float temperature;        // Celsius
-  float humidity;           // Percentage
-  float light;              // Lux
+  float temperature;        // Celsius (mean for aggregates)
+  float humidity;           // Percentage (mean for aggregates)
+  float light;              // Lux (mean for aggregates)
   bool tankLevel;           // Water tank status
   bool pumpOn;              // Pump state
   bool lightsOn;            // LED state
   bool irrigated;           // Irrigation occurred flag
   bool valid;               // Data validity flag
+  bool provisional;         // Timestamp taken before the first clock sync (not Unix time)
+  uint16_t samples;         // Readings represented (0 or 1 = raw reading)
+  uint8_t events;           // READING_EVENT_* bitmap (aggregates only)
+  ChannelStats temperatureStats;
+  ChannelStats humidityStats;
+  ChannelStats lightStats;
 };
 
+/**
+ * Event flags implied by a single raw reading
+ * @param reading Raw reading (samples <= 1)
+ * @return READING_EVENT_* bitmap
+ */
+uint8_t rawReadingEvents(const TelemetryReading& reading);
+
+// Packed buffer record flags
+#define PACKED_FLAG_PROVISIONAL  0x01  // Timestamp is provisional (taken before the clock synced)
+#define PACKED_FLAG_TANK_LEVEL   0x02  // Water tank OK
+#define PACKED_FLAG_PUMP_ON      0x04  // Pump state
+#define PACKED_FLAG_LIGHTS_ON    0x08  // LED state
+#define PACKED_FLAG_IRRIGATED    0x10  // Irrigation occurred
+#define PACKED_FLAG_TEMP_OK      0x20  // Temperature is a real reading (not SENSOR_ERROR_TEMP)
+#define PACKED_FLAG_HUM_OK       0x40  // Humidity is a real reading (not SENSOR_ERROR_HUM)
+#define PACKED_FLAG_LIGHT_OK     0x80  // Light is a real reading (not SENSOR_ERROR_LIGHT)
+
+// Compact raw record (16 bytes vs ~100 for TelemetryReading)
+// Sensor values are fixed-point with 2 decimals, which is exact for the
+// DHT11 and VCNL4010 resolutions.
+struct PackedReading {
+  uint32_t epoch;               // Unix timestamp (seconds)
+  int16_t temperature;          // Celsius x100
+  uint16_t humidity;            // Percentage x100
+  uint32_t light;               // Lux x100
+  uint8_t flags;                // PACKED_FLAG_* bitmap
+  uint8_t reserved[3];          // Spare (keeps 4-byte alignment)
+};
+
+// Compact aggregate buffer record (44 bytes, all tiers)
+// Light statistics use whole lux (VCNL4010 ambient is a 16-bit integer
+// count).
+struct PackedAggregate {
+  PackedReading mean;           // Window means; timestamp and states of the newest reading
+  uint16_t samples;             // Readings represented
+  uint8_t events;               // READING_EVENT_* bitmap
+  uint8_t reserved;             // Spare
+  int16_t temperatureMin;       // Celsius x100
+  int16_t temperatureMax;       // Celsius x100
+  uint16_t temperatureStdDev;   // Celsius x100
+  uint16_t humidityMin;         // Percentage x100
+  uint16_t humidityMax;         // Percentage x100
+  uint16_t humidityStdDev;      // Percentage x100
+  uint16_t lightMin;            // Lux (saturates at 65535)
+  uint16_t lightMax;            // Lux (saturates at 65535)
+  uint16_t lightStdDev;         // Lux (saturates at 65535)
+  uint16_t temperatureCount;    // Valid temperature samples
+  uint16_t humidityCount;       // Valid humidity samples
+  uint16_t lightCount;          // Valid light samples
+};
+
+/**
+ * Convert a raw telemetry reading to its packed buffer form
+ * Sentinel or out-of-range sensor values clear the matching *_OK flag.
+ * Aggregate statistics, if any, are not kept (see packAggregate()).
+ * @param reading Source reading
+ * @param packed Output parameter for packed record
+ */
+void packReading(const TelemetryReading& reading, PackedReading& packed);
+
+/**
+ * Convert a packed raw record back to a telemetry reading
+ * Invalid sensor channels are restored as their SENSOR_ERROR_* sentinel;
+ * statistics are filled in as for a single sample
+ * @param packed Source record
+ * @param reading Output parameter for unpacked reading
+ */
+void unpackReading(const PackedReading& packed, TelemetryReading& reading);
+
+/**
+ * Convert an aggregated telemetry reading to its packed buffer form
+ * Raw readings (samples <= 1) get single-sample statistics.
+ * @param reading Source reading
+ * @param packed Output parameter for packed record
+ */
+void packAggregate(const TelemetryReading& reading, PackedAggregate& packed);
+
+/**
+ * Convert a packed aggregate record back to a telemetry reading
+ * @param packed Source record
+ * @param reading Output parameter for unpacked reading
+ */
+void unpackAggregate(const PackedAggregate& packed, TelemetryReading& reading);
+
 // ============================================
-// BUFFER #1: 1-Minute High Resolution Buffer
+// TIERED BUFFER
 // ============================================
 
 /**
- * Initialize 1-minute buffer
+ * Initialize all buffer tiers (see BUFFER_TIER_* in constants.h)
  */
-void initBuffer1Min();
+void initBuffers();
 
 /**
- * Add telemetry reading to 1-minute buffer
+ * Add telemetry reading to the first (highest resolution) tier
+ * Full tiers are rolled up into the next tier first; the last tier
+ * drops its oldest entry when full
  * @param reading Telemetry data to store
  */
-void addToBuffer1Min(const TelemetryReading& reading);
+void addToBuffer(const TelemetryReading& reading);
 
 /**
- * Get oldest reading from 1-minute buffer
- * @param reading Output parameter for retrieved data
- * @return true if reading retrieved, false if buffer empty
+ * Add telemetry reading to tier 0 in timestamp order
+ * For a reading older than some already buffered (a live publish that
+ * failed after newer readings were buffered). Appends like addToBuffer()
+ * when the reading is the newest; otherwise the journal is rewritten.
+ * @param reading Telemetry data to store
  */
-bool getOldestFrom1MinBuffer(TelemetryReading& reading);
+void insertIntoBuffer(const TelemetryReading& reading);
 
 /**
- * Remove oldest reading from 1-minute buffer (after successful transmission)
+ * Get number of configured tiers
+ * @return Tier count (tier 0 = highest resolution, newest data)
  */
-void removeOldestFrom1MinBuffer();
+int getBufferTierCount();
 
 /**
- * Get 1-minute buffer count
- * @return Number of readings currently stored
+ * Get tier label for logs ("1-min", "10-min", ...)
+ * @param tier Tier index
+ * @return Label string
  */
-int get1MinBufferCount();
+const char* getBufferTierName(int tier);
 
 /**
- * Check if 1-minute buffer is full
- * @return true if buffer is full
+ * Get tier capacity
+ * @param tier Tier index
+ * @return Maximum number of entries
  */
-bool is1MinBufferFull();
-
-// ============================================
-// BUFFER #2: 10-Minute Aggregated Buffer
-// ============================================
+int getBufferCapacity(int tier);
 
 /**
- * Initialize 10-minute buffer
+ * Get tier count
+ * @param tier Tier index
+ * @return Number of readings currently stored
  */
-void initBuffer10Min();
+int getBufferCount(int tier);
 
 /**
- * Aggregate readings from 1-minute buffer and store in 10-minute buffer
- * Called automatically when Buffer #1 is full
- * @param readings Array of TelemetryReading structs
- * @param count Number of readings to aggregate
+ * Get the tier holding the oldest buffered data
+ * Higher tiers always hold older data, so flushing this tier first keeps
+ * the overall send order chronological
+ * @return Tier index, or -1 if all tiers are empty
  */
-void aggregateAndStore(TelemetryReading readings[], int count);
+int getOldestBufferTier();
 
 /**
- * Get oldest reading from 10-minute buffer
+ * Get oldest reading from a tier
+ * @param tier Tier index
  * @param reading Output parameter for retrieved data
- * @return true if reading retrieved, false if buffer empty
+ * @return true if reading retrieved, false if tier empty
  */
-bool getOldestFrom10MinBuffer(TelemetryReading& reading);
+bool getOldestFromBuffer(int tier, TelemetryReading& reading);
 
 /**
- * Remove oldest reading from 10-minute buffer (after successful transmission)
+ * Remove oldest reading from a tier (after successful transmission)
+ * @param tier Tier index
  */
-void removeOldestFrom10MinBuffer();
+void removeOldestFromBuffer(int tier);
 
 /**
- * Get 10-minute buffer count
- * @return Number of readings currently stored
+ * Get a buffered reading by chronological position across all tiers
+ * (coarsest tier first), without removing it
+ * @param index Position (0 = oldest buffered reading)
+ * @param reading Output parameter for retrieved data
+ * @return true if reading retrieved, false if index out of range
  */
-int get10MinBufferCount();
+bool getBufferedReading(int index, TelemetryReading& reading);
 
 /**
- * Check if 10-minute buffer is full
- * @return true if buffer is full
+ * Remove the oldest buffered readings across all tiers (after a
+ * successful batch transmission)
+ * @param count Number of readings to remove
  */
-bool is10MinBufferFull();
-
-// ============================================
-// BUFFER MANAGEMENT
-// ============================================
+void removeOldestBuffered(int count);
 
 /**
- * Get total buffered readings count (across both buffers)
+ * Get total buffered readings count (across all tiers)
  * @return Total number of buffered readings
  */
 int getTotalBufferedCount();
 
 /**
- * Check if any buffer has data
+ * Check if any tier has data
  * @return true if there is buffered data to send
  */
 bool hasBufferedData();
 
+/**
+ * Rewrite the timestamps of buffered readings flagged provisional, in
+ * place (all tiers)
+ * The journal is rewritten too, so the new timestamps survive a reboot
+ * @param rewrite Maps a provisional timestamp to its replacement
+ * @param resolved The replacements are Unix time (clears the provisional flag)
+ * @return Number of readings rewritten
+ */
+int rewriteProvisionalTimestamps(uint32_t (*rewrite)(uint32_t timestamp), bool resolved);
+
+// ============================================
+// OBSERVABILITY
+// ============================================
+
+// Per-tier counters (since boot; depth and oldest record are live values)
+struct BufferTierStats {
+  uint16_t depth;             // Entries currently stored
+  uint16_t capacity;          // Maximum entries
+  uint16_t highWater;         // Largest depth seen
+  uint32_t enqueued;          // Entries added (readings for tier 0, aggregates above)
+  uint32_t aggregated;        // Entries rolled up into the next tier
+  uint32_t dropped;           // Entries discarded because the last tier was full
+  uint32_t droppedSamples;    // Raw readings represented by dropped entries
+  uint32_t flushed;           // Entries removed after transmission
+  uint32_t oldestTimestamp;   // Unix time of the oldest entry (0 if empty)
+};
+
+// Buffer flush timing (most recent flush)
+struct BufferFlushStats {
+  uint32_t flushes;           // Completed or interrupted flushes
+  uint32_t lastRecords;       // Readings sent by the last flush
+  uint32_t lastDurationMs;    // Duration of the last flush (ms)
+  float recordsPerSecond;     // Throughput of the last flush
+};
+
+/**
+ * Get counters for one tier
+ * @param tier Tier index
+ * @param stats Output parameter for counters
+ * @return true if the tier exists
+ */
+bool getBufferTierStats(int tier, BufferTierStats& stats);
+
+/**
+ * Record the outcome of a buffer flush (called by the MQTT flush)
+ * @param records Readings sent
+ * @param durationMs Time from flush start to completion (ms)
+ */
+void recordBufferFlush(int records, unsigned long durationMs);
+
+/**
+ * Get timing of the most recent flush
+ * @return Flush statistics
+ */
+const BufferFlushStats& getBufferFlushStats();
+
+// ============================================
+// PERSISTENCE
+// ============================================
+
+/**
+ * Mount flash storage and replay the journal into all tiers
+ * Call once after initBuffers()
+ */
+void initBufferJournal();
+
+/**
+ * Write batched journal records to flash when the sync interval is due
+ * Call regularly from the main loop
+ */
+void syncBufferJournal();
+
 #endif // BUFFER_H
@@ -0,0 +1,130 @@
+/**
+ * @file buffer_tier.h
+ * @brief Uniform interface over fixed-capacity buffer tiers
+ * 
+ * Each tier is a RingBuffer with its own compile-time capacity and record
+ * type (PackedReading for raw readings, PackedAggregate for windows); this
+ * interface lets the cascade, flush and journal code walk all tiers
+ * without knowing their sizes or record layouts.
+ */
+
+#ifndef BUFFER_TIER_H
+#define BUFFER_TIER_H
+
+#include <stddef.h>
+#include <string.h>
+#include "buffer.h"
+#include "ring_buffer.h"
+
+class BufferTier {
+public:
+  BufferTier(const char* name, size_t fanIn) : name_(name), fanIn_(fanIn) {}
+  virtual ~BufferTier() {}
+
+  virtual size_t size() const = 0;
+  virtual size_t capacity() const = 0;
+  virtual bool pop() = 0;
+  virtual void clear() = 0;
+
+  // Pack and append a reading
+  virtual bool push(const TelemetryReading& reading) = 0;
+
+  // Pack and insert a reading before the entry at index (false if full)
+  virtual bool insert(size_t index, const TelemetryReading& reading) = 0;
+
+  // Entry access by age (0 = oldest). Caller must ensure index < size().
+  virtual void read(size_t index, TelemetryReading& reading) const = 0;
+  virtual uint32_t timestamp(size_t index) const = 0;
+  virtual bool provisional(size_t index) const = 0;
+  virtual void setTimestamp(size_t index, uint32_t timestamp, bool provisional) = 0;
+  virtual uint16_t samples(size_t index) const = 0;
+
+  // Stored records as bytes (journal). recordSize() bytes each.
+  virtual size_t recordSize() const = 0;
+  virtual const void* record(size_t index) const = 0;
+  virtual bool pushRecord(const void* record) = 0;
+
+  bool empty() const { return size() == 0; }
+  bool full() const { return size() == capacity(); }
+
+  const char* name() const { return name_; }
+
+  // Number of entries from the previous tier folded into one entry here
+  size_t fanIn() const { return fanIn_; }
+
+private:
+  const char* name_;
+  size_t fanIn_;
+};
+
+// Record type dispatch for RingBufferTier
+inline void packRecord(const TelemetryReading& reading, PackedReading& record) { packReading(reading, record); }
+inline void packRecord(const TelemetryReading& reading, PackedAggregate& record) { packAggregate(reading, record); }
+inline void unpackRecord(const PackedReading& record, TelemetryReading& reading) { unpackReading(record, reading); }
+inline void unpackRecord(const PackedAggregate& record, TelemetryReading& reading) { unpackAggregate(record, reading); }
+inline PackedReading& recordMean(PackedReading& record) { return record; }
+inline PackedReading& recordMean(PackedAggregate& record) { return record.mean; }
+inline const PackedReading& recordMean(const PackedReading& record) { return record; }
+inline const PackedReading& recordMean(const PackedAggregate& record) { return record.mean; }
+inline uint16_t recordSamples(const PackedReading&) { return 1; }
+inline uint16_t recordSamples(const PackedAggregate& record) { return record.samples; }
+
+template <typename Record, size_t Capacity, size_t FanIn>
+class RingBufferTier : public BufferTier {
+  static_assert(FanIn > 0, "Tier fan-in must be at least 1");
+
+public:
+  explicit RingBufferTier(const char* name) : BufferTier(name, FanIn) {}
+
+  size_t size() const override { return ring_.size(); }
+  size_t capacity() const override { return Capacity; }
+  bool pop() override { return ring_.pop(); }
+  void clear() override { ring_.clear(); }
+
+  bool push(const TelemetryReading& reading) override {
+    Record record;
+    packRecord(reading, record);
+    return ring_.push(record);
+  }
+
+  bool insert(size_t index, const TelemetryReading& reading) override {
+    Record record;
+    packRecord(reading, record);
+    return ring_.insert(index, record);
+  }
+
+  void read(size_t index, TelemetryReading& reading) const override { unpackRecord(ring_[index], reading); }
+  uint32_t timestamp(size_t index) const override { return recordMean(ring_[index]).epoch; }
+  bool provisional(size_t index) const override {
+    return (recordMean(ring_[index]).flags & PACKED_FLAG_PROVISIONAL) != 0;
+  }
+
+  void setTimestamp(size_t index, uint32_t timestamp, bool provisional) override {
+    PackedReading& mean = recordMean(ring_[index]);
+    mean.epoch = timestamp;
+    if (provisional) {
+      mean.flags |= PACKED_FLAG_PROVISIONAL;
+    } else {
+      mean.flags &= (uint8_t)~PACKED_FLAG_PROVISIONAL;
+    }
+  }
+  uint16_t samples(size_t index) const override { return recordSamples(ring_[index]); }
+
+  size_t recordSize() const override { return sizeof(Record); }
+  const void* record(size_t index) const override { return &ring_[index]; }
+
+  bool pushRecord(const void* record) override {
+    Record copy;
+    memcpy(&copy, record, sizeof(Record));
+    return ring_.push(copy);
+  }
+
+private:
+  RingBuffer<Record, Capacity> ring_;
+};
+
+// Tier table, newest tier first (defined in buffer.cpp)
+extern BufferTier* const bufferTiers[];
+extern const int bufferTierCount;
+
+#endif // BUFFER_TIER_H
@@ -0,0 +1,271 @@
+/**
+ * @file journal.cpp
+ * @brief Telemetry journal record encoding, replay and slot rotation
+ * 
+ * Platform independent: all I/O goes through JournalStorage.
+ */
+
+#include <string.h>
+#include "../crc32.h"
+#include "journal.h"
+
+static_assert(sizeof(JournalRecord) == 56, "JournalRecord layout changed");
+
+static const size_t JOURNAL_RECORD_SIZE = sizeof(JournalRecord);
+static const size_t JOURNAL_CRC_OFFSET = offsetof(JournalRecord, crc);
+
+static JournalRecord makeRecord(uint8_t type, uint8_t tier, uint32_t value) {
+  JournalRecord record;
+  memset(&record, 0, sizeof(record));
+  record.type = type;
+  record.tier = tier;
+  record.value = value;
+  return record;
+}
+
+static void sealRecord(JournalRecord& record) {
+  record.crc = crc32((const uint8_t*)&record, JOURNAL_CRC_OFFSET);
+}
+
+static bool isRecordIntact(const JournalRecord& record) {
+  return record.crc == crc32((const uint8_t*)&record, JOURNAL_CRC_OFFSET);
+}
+
+TelemetryJournal::TelemetryJournal(JournalStorage& storage, BufferTier* const* tiers, int tierCount)
+  : storage_(storage), tiers_(tiers), tierCount_(tierCount),
+    pendingCount_(0), generation_(0), activeBytes_(0), needsCompact_(false) {}
+
+/**
+ * Build the PUSH record for one entry of a tier
+ */
+JournalRecord TelemetryJournal::makePush(uint8_t tier, size_t index) const {
+  JournalRecord record = makeRecord(JOURNAL_REC_PUSH, tier, 0);
+  size_t size = tiers_[tier]->recordSize();
+  if (size <= sizeof(record.payload)) {
+    memcpy(&record.payload, tiers_[tier]->record(index), size);
+  }
+  return record;
+}
+
+/**
+ * Apply one incremental record to the tiers
+ * @return false if the record is not a known mutation
+ */
+bool TelemetryJournal::applyRecord(const JournalRecord& record) {
+  if (record.tier >= tierCount_) {
+    return false;
+  }
+  BufferTier& tier = *tiers_[record.tier];
+  
+  switch (record.type) {
+    case JOURNAL_REC_PUSH:
+      if (tier.recordSize() > sizeof(record.payload)) {
+        return false;
+      }
+      tier.pushRecord(&record.payload);
+      return true;
+    case JOURNAL_REC_POP:
+      for (uint32_t i = 0; i < record.value; i++) {
+        tier.pop();
+      }
+      return true;
+    case JOURNAL_REC_CLEAR:
+      tier.clear();
+      return true;
+    default:
+      return false;
+  }
+}
+
+void TelemetryJournal::clearTiers() {
+  for (int i = 0; i < tierCount_; i++) {
+    tiers_[i]->clear();
+  }
+}
+
+/**
+ * Replay one slot into the (cleared) tiers
+ * @return true if the slot held a committed snapshot
+ */
+bool TelemetryJournal::replaySlot(uint8_t slot) {
+  clearTiers();
+  
+  JournalRecord record;
+  size_t offset = 0;
+  bool committed = false;
+  
+  while (storage_.read(slot, offset, &record, JOURNAL_RECORD_SIZE) == JOURNAL_RECORD_SIZE) {
+    // Stop at the first torn or corrupt record (e.g. power cut mid-write)
+    if (!isRecordIntact(record)) {
+      break;
+    }
+    if (offset == 0 && record.type != JOURNAL_REC_HEADER) {
+      break;
+    }
+    
+    if (record.type == JOURNAL_REC_COMMIT) {
+      committed = true;
+    } else if (record.type != JOURNAL_REC_HEADER && !applyRecord(record)) {
+      break;
+    }
+    offset += JOURNAL_RECORD_SIZE;
+  }
+  
+  if (!committed) {
+    clearTiers();
+  }
+  return committed;
+}
+
+int TelemetryJournal::replay() {
+  pendingCount_ = 0;
+  
+  // Read slot generations and try the newest first
+  uint32_t generations[2] = {0, 0};
+  bool present[2] = {false, false};
+  for (uint8_t slot = 0; slot < 2; slot++) {
+    JournalRecord header;
+    if (storage_.read(slot, 0, &header, JOURNAL_RECORD_SIZE) == JOURNAL_RECORD_SIZE &&
+        isRecordIntact(header) && header.type == JOURNAL_REC_HEADER) {
+      generations[slot] = header.value;
+      present[slot] = true;
+    }
+  }
+  
+  uint8_t newest = (present[1] && (!present[0] || generations[1] > generations[0])) ? 1 : 0;
+  uint8_t order[2] = {newest, (uint8_t)(1 - newest)};
+  
+  generation_ = 0;
+  for (int i = 0; i < 2; i++) {
+    uint8_t slot = order[i];
+    if (present[slot] && replaySlot(slot)) {
+      generation_ = generations[slot];
+      break;
+    }
+  }
+  if (generations[0] > generation_) generation_ = generations[0];
+  if (generations[1] > generation_) generation_ = generations[1];
+  
+  // Start from a clean slot so new records never follow a torn tail
+  compact();
+  
+  int restored = 0;
+  for (int i = 0; i < tierCount_; i++) {
+    restored += (int)tiers_[i]->size();
+  }
+  return restored;
+}
+
+void TelemetryJournal::queue(const JournalRecord& record) {
+  if (pendingCount_ >= JOURNAL_BATCH_RECORDS) {
+    sync();
+  }
+  if (pendingCount_ >= JOURNAL_BATCH_RECORDS) {
+    // Storage is failing - the next compaction captures the current state
+    pendingCount_ = 0;
+    needsCompact_ = true;
+  }
+  pending_[pendingCount_] = record;
+  sealRecord(pending_[pendingCount_]);
+  pendingCount_++;
+}
+
+void TelemetryJournal::recordPush(uint8_t tier) {
+  if (tier >= tierCount_ || tiers_[tier]->empty()) {
+    return;
+  }
+  queue(makePush(tier, tiers_[tier]->size() - 1));
+}
+
+void TelemetryJournal::recordPop(uint8_t tier) {
+  // Coalesce consecutive pops (a flush removes records one by one)
+  if (pendingCount_ > 0) {
+    JournalRecord& last = pending_[pendingCount_ - 1];
+    if (last.type == JOURNAL_REC_POP && last.tier == tier) {
+      last.value++;
+      sealRecord(last);
+      return;
+    }
+  }
+  queue(makeRecord(JOURNAL_REC_POP, tier, 1));
+}
+
+void TelemetryJournal::recordClear(uint8_t tier) {
+  queue(makeRecord(JOURNAL_REC_CLEAR, tier, 0));
+}
+
+bool TelemetryJournal::sync() {
+  size_t bytes = pendingCount_ * JOURNAL_RECORD_SIZE;
+  
+  if (needsCompact_ || activeBytes_ + bytes > JOURNAL_SEGMENT_MAX_BYTES) {
+    // The snapshot already reflects every pending mutation
+    return compact();
+  }
+  if (pendingCount_ == 0) {
+    return true;
+  }
+  
+  uint8_t slot = (uint8_t)(generation_ % 2);
+  if (!storage_.append(slot, pending_, bytes)) {
+    needsCompact_ = true;
+    return false;
+  }
+  
+  activeBytes_ += bytes;
+  pendingCount_ = 0;
+  return true;
+}
+
+bool TelemetryJournal::compact() {
+  uint32_t newGeneration = generation_ + 1;
+  uint8_t slot = (uint8_t)(newGeneration % 2);
+  
+  // Reuse the pending batch as write buffer - the snapshot supersedes it
+  pendingCount_ = 0;
+  storage_.erase(slot);
+  
+  size_t written = 0;
+  int tier = 0;
+  size_t index = 0;
+  bool ok = true;
+  bool done = false;
+  
+  pending_[pendingCount_++] = makeRecord(JOURNAL_REC_HEADER, 0, newGeneration);
+  while (ok && !done) {
+    // Advance to the next tier entry, if any
+    while (tier < tierCount_ && index >= tiers_[tier]->size()) {
+      tier++;
+      index = 0;
+    }
+    
+    if (tier < tierCount_) {
+      pending_[pendingCount_++] = makePush((uint8_t)tier, index++);
+    } else {
+      pending_[pendingCount_++] = makeRecord(JOURNAL_REC_COMMIT, 0, 0);
+      done = true;
+    }
+    
+    if (pendingCount_ == JOURNAL_BATCH_RECORDS || done) {
+      for (size_t i = 0; i < pendingCount_; i++) {
+        sealRecord(pending_[i]);
+      }
+      ok = storage_.append(slot, pending_, pendingCount_ * JOURNAL_RECORD_SIZE);
+      written += pendingCount_ * JOURNAL_RECORD_SIZE;
+      pendingCount_ = 0;
+    }
+  }
+  
+  if (!ok) {
+    // Keep the previous slot; retry on the next sync
+    storage_.erase(slot);
+    needsCompact_ = true;
+    return false;
+  }
+  
+  // New slot is committed - the old one can go
+  storage_.erase((uint8_t)(1 - slot));
+  generation_ = newGeneration;
+  activeBytes_ = written;
+  needsCompact_ = false;
+  return true;
+}
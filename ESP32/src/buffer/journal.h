@@ -0,0 +1,109 @@
+/**
+ * @file journal.h
+ * @brief Append-only, CRC-protected journal that persists the buffer tiers
+ * 
+ * Every buffer mutation (push / pop / clear) is logged as a fixed-size
+ * record. Records are batched in RAM and appended to flash together.
+ * 
+ * Storage uses two rotating slots. Each slot starts with a HEADER record
+ * (generation number), followed by a snapshot of all tiers and a COMMIT
+ * record, followed by incremental records. When the active slot grows past
+ * JOURNAL_SEGMENT_MAX_BYTES a fresh snapshot is written to the other slot
+ * and the old one is erased only after that snapshot is committed.
+ * 
+ * On boot the newest committed slot is replayed up to the first torn or
+ * corrupt record, so a power cut at any write offset loses at most the
+ * records that were still pending in RAM.
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "buffer.h"
+#include "buffer_tier.h"
+#include "journal_storage.h"
+
+// Journal record types
+#define JOURNAL_REC_HEADER 1   // value = slot generation
+#define JOURNAL_REC_PUSH 2     // reading pushed to tier
+#define JOURNAL_REC_POP 3      // value = number of oldest entries removed from tier
+#define JOURNAL_REC_CLEAR 4    // tier emptied
+#define JOURNAL_REC_COMMIT 5   // snapshot complete, slot is valid
+
+// Pushed entry, in the record type of its tier (unused bytes are 0)
+union JournalPayload {
+  PackedReading reading;        // Raw-record tiers
+  PackedAggregate aggregate;    // Aggregate tiers (all firmware tiers)
+};
+
+// Fixed-size journal record (56 bytes)
+struct JournalRecord {
+  uint8_t type;             // JOURNAL_REC_*
+  uint8_t tier;             // Buffer tier index
+  uint16_t reserved;        // Always 0
+  uint32_t value;           // Type-specific argument
+  JournalPayload payload;   // Payload for JOURNAL_REC_PUSH
+  uint32_t crc;             // CRC-32 of all preceding bytes
+};
+
+class TelemetryJournal {
+public:
+  TelemetryJournal(JournalStorage& storage, BufferTier* const* tiers, int tierCount);
+
+  /**
+   * Restore all tiers from the newest committed slot, then compact
+   * @return Number of readings restored
+   */
+  int replay();
+
+  // Log a buffer mutation (call after the tier has been modified;
+  // a push logs the newest entry of the tier)
+  void recordPush(uint8_t tier);
+  void recordPop(uint8_t tier);
+  void recordClear(uint8_t tier);
+
+  /**
+   * Append all pending records to flash (rotates slots when needed)
+   * @return true if nothing is left pending
+   */
+  bool sync();
+
+  /**
+   * Write a snapshot of all tiers into a fresh slot and drop the old one
+   * @return true if the new slot was committed
+   */
+  bool compact();
+
+  int pendingCount() const { return (int)pendingCount_; }
+
+private:
+  void queue(const JournalRecord& record);
+  JournalRecord makePush(uint8_t tier, size_t index) const;
+  bool replaySlot(uint8_t slot);
+  bool applyRecord(const JournalRecord& record);
+  void clearTiers();
+
+  JournalStorage& storage_;
+  BufferTier* const* tiers_;
+  int tierCount_;
+
+  JournalRecord pending_[JOURNAL_BATCH_RECORDS];
+  size_t pendingCount_;
+
+  uint32_t generation_;     // Generation of the active slot
+  size_t activeBytes_;      // Bytes written to the active slot
+  bool needsCompact_;       // Last append failed, rewrite before continuing
+};
+
+// ============================================
+// BUFFER HOOKS (implemented in persistence.cpp)
+// ============================================
+// No-ops until initBufferJournal() has replayed the journal.
+
+void journalBufferPush(int tier);  // Newest entry of the tier was pushed
+void journalBufferPop(int tier);
+void journalBufferRewrite();  // Entries were modified in place - write a fresh snapshot
+
+#endif // JOURNAL_H
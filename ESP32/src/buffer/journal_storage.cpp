@@ -0,0 +1,60 @@
+/**
+ * @file journal_storage.cpp
+ * @brief File-backed journal storage (LittleFS on ESP32, any directory on host)
+ */
+
+#include <stdio.h>
+#include <sys/stat.h>
+#include "journal_storage.h"
+
+void FileJournalStorage::slotPath(uint8_t slot, char* path, size_t pathSize) const {
+  snprintf(path, pathSize, "%s%u.bin", basePath_, (unsigned)slot);
+}
+
+size_t FileJournalStorage::read(uint8_t slot, size_t offset, void* data, size_t length) {
+  char path[64];
+  slotPath(slot, path, sizeof(path));
+  
+  FILE* file = fopen(path, "rb");
+  if (file == NULL) {
+    return 0;
+  }
+  
+  size_t bytesRead = 0;
+  if (fseek(file, (long)offset, SEEK_SET) == 0) {
+    bytesRead = fread(data, 1, length, file);
+  }
+  fclose(file);
+  return bytesRead;
+}
+
+bool FileJournalStorage::append(uint8_t slot, const void* data, size_t length) {
+  char path[64];
+  slotPath(slot, path, sizeof(path));
+  
+  FILE* file = fopen(path, "ab");
+  if (file == NULL) {
+    return false;
+  }
+  
+  size_t written = fwrite(data, 1, length, file);
+  bool ok = (written == length) && (fflush(file) == 0);
+  return (fclose(file) == 0) && ok;
+}
+
+void FileJournalStorage::erase(uint8_t slot) {
+  char path[64];
+  slotPath(slot, path, sizeof(path));
+  remove(path);
+}
+
+size_t FileJournalStorage::size(uint8_t slot) {
+  char path[64];
+  slotPath(slot, path, sizeof(path));
+  
+  struct stat info;
+  if (stat(path, &info) != 0) {
+    return 0;
+  }
+  return (size_t)info.st_size;
+}
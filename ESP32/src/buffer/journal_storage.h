@@ -0,0 +1,63 @@
+/**
+ * @file journal_storage.h
+ * @brief Pluggable storage backend for the telemetry journal
+ * 
+ * The journal only needs a handful of append-only slot operations, so the
+ * backend can be LittleFS on the ESP32 or a plain directory on a Linux
+ * host. FileJournalStorage covers both: ESP-IDF exposes a mounted LittleFS
+ * partition through the standard C file API.
+ */
+
+#ifndef JOURNAL_STORAGE_H
+#define JOURNAL_STORAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class JournalStorage {
+public:
+  virtual ~JournalStorage() {}
+
+  /**
+   * Read bytes from a slot
+   * @return Number of bytes actually read (short at end of slot)
+   */
+  virtual size_t read(uint8_t slot, size_t offset, void* data, size_t length) = 0;
+
+  /**
+   * Append bytes to the end of a slot (creates the slot if missing)
+   * @return true if all bytes were written
+   */
+  virtual bool append(uint8_t slot, const void* data, size_t length) = 0;
+
+  /**
+   * Delete all data in a slot
+   */
+  virtual void erase(uint8_t slot) = 0;
+
+  /**
+   * Current slot size in bytes (0 if missing)
+   */
+  virtual size_t size(uint8_t slot) = 0;
+};
+
+/**
+ * File-per-slot backend using the C file API
+ * Slot N is stored as "<basePath>N.bin"
+ */
+class FileJournalStorage : public JournalStorage {
+public:
+  explicit FileJournalStorage(const char* basePath) : basePath_(basePath) {}
+
+  size_t read(uint8_t slot, size_t offset, void* data, size_t length) override;
+  bool append(uint8_t slot, const void* data, size_t length) override;
+  void erase(uint8_t slot) override;
+  size_t size(uint8_t slot) override;
+
+private:
+  void slotPath(uint8_t slot, char* path, size_t pathSize) const;
+
+  const char* basePath_;
+};
+
+#endif // JOURNAL_STORAGE_H
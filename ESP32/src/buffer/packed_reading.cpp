@@ -0,0 +1,187 @@
+/**
+ * @file packed_reading.cpp
+ * @brief Conversion between TelemetryReading and the packed buffer records
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "buffer.h"
+
+// Fixed-point scale for temperature, humidity and mean light (2 decimals)
+static const float PACKED_SCALE = 100.0f;
+
+static_assert(sizeof(PackedReading) == 16, "PackedReading layout changed");
+static_assert(sizeof(PackedAggregate) == 44, "PackedAggregate layout changed");
+
+// Clamp and round a value into a fixed-point integer range
+static long toFixed(float value, float scale, long minValue, long maxValue) {
+  float scaled = roundf(value * scale);
+  if (scaled < minValue) return minValue;
+  if (scaled > maxValue) return maxValue;
+  return (long)scaled;
+}
+
+/**
+ * Event flags implied by a single raw reading
+ */
+uint8_t rawReadingEvents(const TelemetryReading& reading) {
+  uint8_t events = 0;
+  if (reading.irrigated) events |= READING_EVENT_IRRIGATED;
+  if (reading.pumpOn) events |= READING_EVENT_PUMP_RAN;
+  if (reading.lightsOn) events |= READING_EVENT_LIGHTS_RAN;
+  if (!reading.tankLevel) events |= READING_EVENT_TANK_EMPTY;
+  return events;
+}
+
+/**
+ * Convert telemetry reading to packed raw record
+ */
+void packReading(const TelemetryReading& reading, PackedReading& packed) {
+  memset(&packed, 0, sizeof(PackedReading));
+  packed.epoch = (uint32_t)strtoul(reading.timestamp, NULL, 10);
+  
+  if (reading.provisional) packed.flags |= PACKED_FLAG_PROVISIONAL;
+  if (reading.tankLevel) packed.flags |= PACKED_FLAG_TANK_LEVEL;
+  if (reading.pumpOn) packed.flags |= PACKED_FLAG_PUMP_ON;
+  if (reading.lightsOn) packed.flags |= PACKED_FLAG_LIGHTS_ON;
+  if (reading.irrigated) packed.flags |= PACKED_FLAG_IRRIGATED;
+  
+  // Temperature: int16 centi-degrees (-327.67 .. 327.67 °C)
+  float temp = roundf(reading.temperature * PACKED_SCALE);
+  if (reading.temperature != SENSOR_ERROR_TEMP && temp >= -32767.0f && temp <= 32767.0f) {
+    packed.temperature = (int16_t)temp;
+    packed.flags |= PACKED_FLAG_TEMP_OK;
+  }
+  
+  // Humidity: uint16 centi-percent (0 .. 655.35 %)
+  float hum = roundf(reading.humidity * PACKED_SCALE);
+  if (reading.humidity != SENSOR_ERROR_HUM && hum >= 0.0f && hum <= 65535.0f) {
+    packed.humidity = (uint16_t)hum;
+    packed.flags |= PACKED_FLAG_HUM_OK;
+  }
+  
+  // Light: uint32 centi-lux
+  float light = roundf(reading.light * PACKED_SCALE);
+  if (reading.light >= 0 && light <= 4294967040.0f) {
+    packed.light = (uint32_t)light;
+    packed.flags |= PACKED_FLAG_LIGHT_OK;
+  }
+}
+
+/**
+ * Convert packed raw record to telemetry reading
+ */
+void unpackReading(const PackedReading& packed, TelemetryReading& reading) {
+  snprintf(reading.timestamp, sizeof(reading.timestamp), "%lu", (unsigned long)packed.epoch);
+  
+  reading.temperature = (packed.flags & PACKED_FLAG_TEMP_OK)
+                        ? packed.temperature / PACKED_SCALE : SENSOR_ERROR_TEMP;
+  reading.humidity = (packed.flags & PACKED_FLAG_HUM_OK)
+                     ? packed.humidity / PACKED_SCALE : SENSOR_ERROR_HUM;
+  reading.light = (packed.flags & PACKED_FLAG_LIGHT_OK)
+                  ? packed.light / PACKED_SCALE : SENSOR_ERROR_LIGHT;
+  
+  reading.tankLevel = (packed.flags & PACKED_FLAG_TANK_LEVEL) != 0;
+  reading.pumpOn = (packed.flags & PACKED_FLAG_PUMP_ON) != 0;
+  reading.lightsOn = (packed.flags & PACKED_FLAG_LIGHTS_ON) != 0;
+  reading.irrigated = (packed.flags & PACKED_FLAG_IRRIGATED) != 0;
+  reading.provisional = (packed.flags & PACKED_FLAG_PROVISIONAL) != 0;
+  reading.valid = true;  // Only readings are stored
+  
+  reading.samples = 1;
+  reading.events = rawReadingEvents(reading);
+  
+  // Single-sample statistics (stored values, so they match the mean exactly)
+  bool tempOk = (packed.flags & PACKED_FLAG_TEMP_OK) != 0;
+  reading.temperatureStats.min = tempOk ? reading.temperature : 0.0f;
+  reading.temperatureStats.max = reading.temperatureStats.min;
+  reading.temperatureStats.stdDev = 0.0f;
+  reading.temperatureStats.count = tempOk ? 1 : 0;
+  
+  bool humOk = (packed.flags & PACKED_FLAG_HUM_OK) != 0;
+  reading.humidityStats.min = humOk ? reading.humidity : 0.0f;
+  reading.humidityStats.max = reading.humidityStats.min;
+  reading.humidityStats.stdDev = 0.0f;
+  reading.humidityStats.count = humOk ? 1 : 0;
+  
+  bool lightOk = (packed.flags & PACKED_FLAG_LIGHT_OK) != 0;
+  reading.lightStats.min = lightOk ? (float)toFixed(reading.light, 1.0f, 0, 65535) : 0.0f;
+  reading.lightStats.max = reading.lightStats.min;
+  reading.lightStats.stdDev = 0.0f;
+  reading.lightStats.count = lightOk ? 1 : 0;
+}
+
+/**
+ * Convert telemetry reading to packed aggregate record
+ */
+void packAggregate(const TelemetryReading& reading, PackedAggregate& packed) {
+  memset(&packed, 0, sizeof(PackedAggregate));
+  packReading(reading, packed.mean);
+  
+  bool raw = reading.samples <= 1;
+  packed.samples = raw ? 1 : reading.samples;
+  packed.events = raw ? rawReadingEvents(reading) : reading.events;
+  
+  if (packed.mean.flags & PACKED_FLAG_TEMP_OK) {
+    if (raw) {
+      packed.temperatureMin = packed.temperatureMax = packed.mean.temperature;
+      packed.temperatureCount = 1;
+    } else {
+      packed.temperatureMin = (int16_t)toFixed(reading.temperatureStats.min, PACKED_SCALE, -32767, 32767);
+      packed.temperatureMax = (int16_t)toFixed(reading.temperatureStats.max, PACKED_SCALE, -32767, 32767);
+      packed.temperatureStdDev = (uint16_t)toFixed(reading.temperatureStats.stdDev, PACKED_SCALE, 0, 65535);
+      packed.temperatureCount = reading.temperatureStats.count;
+    }
+  }
+  
+  if (packed.mean.flags & PACKED_FLAG_HUM_OK) {
+    if (raw) {
+      packed.humidityMin = packed.humidityMax = packed.mean.humidity;
+      packed.humidityCount = 1;
+    } else {
+      packed.humidityMin = (uint16_t)toFixed(reading.humidityStats.min, PACKED_SCALE, 0, 65535);
+      packed.humidityMax = (uint16_t)toFixed(reading.humidityStats.max, PACKED_SCALE, 0, 65535);
+      packed.humidityStdDev = (uint16_t)toFixed(reading.humidityStats.stdDev, PACKED_SCALE, 0, 65535);
+      packed.humidityCount = reading.humidityStats.count;
+    }
+  }
+  
+  if (packed.mean.flags & PACKED_FLAG_LIGHT_OK) {
+    if (raw) {
+      packed.lightMin = packed.lightMax = (uint16_t)toFixed(reading.light, 1.0f, 0, 65535);
+      packed.lightCount = 1;
+    } else {
+      packed.lightMin = (uint16_t)toFixed(reading.lightStats.min, 1.0f, 0, 65535);
+      packed.lightMax = (uint16_t)toFixed(reading.lightStats.max, 1.0f, 0, 65535);
+      packed.lightStdDev = (uint16_t)toFixed(reading.lightStats.stdDev, 1.0f, 0, 65535);
+      packed.lightCount = reading.lightStats.count;
+    }
+  }
+}
+
+/**
+ * Convert packed aggregate record to telemetry reading
+ */
+void unpackAggregate(const PackedAggregate& packed, TelemetryReading& reading) {
+  unpackReading(packed.mean, reading);
+  
+  reading.samples = packed.samples;
+  reading.events = packed.events;
+  
+  reading.temperatureStats.min = packed.temperatureMin / PACKED_SCALE;
+  reading.temperatureStats.max = packed.temperatureMax / PACKED_SCALE;
+  reading.temperatureStats.stdDev = packed.temperatureStdDev / PACKED_SCALE;
+  reading.temperatureStats.count = packed.temperatureCount;
+  
+  reading.humidityStats.min = packed.humidityMin / PACKED_SCALE;
+  reading.humidityStats.max = packed.humidityMax / PACKED_SCALE;
+  reading.humidityStats.stdDev = packed.humidityStdDev / PACKED_SCALE;
+  reading.humidityStats.count = packed.humidityCount;
+  
+  reading.lightStats.min = packed.lightMin;
+  reading.lightStats.max = packed.lightMax;
+  reading.lightStats.stdDev = packed.lightStdDev;
+  reading.lightStats.count = packed.lightCount;
+}
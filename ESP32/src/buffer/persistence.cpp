@@ -0,0 +1,76 @@
+/**
+ * @file persistence.cpp
+ * @brief Flash persistence for the buffer tiers (LittleFS-backed journal)
+ * 
+ * Mounts LittleFS, replays the journal into the buffer tiers on boot
+ * and persists buffer mutations in batches so flash is not written every
+ * cycle. Replayed readings are sent by the normal reconnect flush.
+ */
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "../constants.h"
+#include "buffer.h"
+#include "journal.h"
+
+static FileJournalStorage journalStorage(JOURNAL_BASE_PATH);
+static TelemetryJournal journal(journalStorage, bufferTiers, bufferTierCount);
+static bool journalReady = false;
+static unsigned long lastJournalSync = 0;
+
+/**
+ * Mount flash storage and restore buffered telemetry from the journal
+ * Must be called after initBuffers()
+ */
+void initBufferJournal() {
+  if (!LittleFS.begin(true)) {
+    Serial.println("⚠️  LittleFS mount failed - buffers will not survive reboots");
+    return;
+  }
+  
+  int restored = journal.replay();
+  journalReady = true;
+  lastJournalSync = millis();
+  
+  Serial.printf("Buffer journal ready (restored %d readings)\n", restored);
+}
+
+/**
+ * Persist pending journal records once the batch interval has elapsed
+ */
+void syncBufferJournal() {
+  if (!journalReady || journal.pendingCount() == 0) {
+    return;
+  }
+  
+  unsigned long now = millis();
+  if (now - lastJournalSync < JOURNAL_SYNC_INTERVAL_MS) {
+    return;
+  }
+  lastJournalSync = now;
+  
+  int pending = journal.pendingCount();
+  if (journal.sync()) {
+    Serial.printf("💾 Buffer journal synced (%d records)\n", pending);
+  } else {
+    Serial.println("⚠️  Buffer journal write failed - will retry");
+  }
+}
+
+void journalBufferPush(int tier) {
+  if (journalReady) {
+    journal.recordPush((uint8_t)tier);
+  }
+}
+
+void journalBufferPop(int tier) {
+  if (journalReady) {
+    journal.recordPop((uint8_t)tier);
+  }
+}
+
+void journalBufferRewrite() {
+  if (journalReady && !journal.compact()) {
+    Serial.println("⚠️  Buffer journal rewrite failed - will retry");
+  }
+}
@@ -0,0 +1,176 @@
+/**
+ * @file ring_buffer.h
+ * @brief Fixed-capacity circular buffer template shared by all buffer tiers
+ *
+ * Header-only, no heap allocation and no Arduino dependencies, so the
+ * capacity of a tier is a single template argument and the container can
+ * be compiled on the host as well as on the ESP32.
+ *
+ * Elements are ordered oldest -> newest. Pushing into a full buffer
+ * overwrites the oldest element (same behaviour as the original
+ * hand-written 1-min/10-min buffers).
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stddef.h>
+
+template <typename T, size_t N>
+class RingBuffer {
+  static_assert(N > 0, "RingBuffer capacity must be greater than zero");
+
+public:
+  /**
+   * Forward iterator (oldest -> newest)
+   */
+  template <typename Owner, typename Ref>
+  class Iterator {
+  public:
+    Iterator(Owner* owner, size_t pos) : owner_(owner), pos_(pos) {}
+    Ref operator*() const { return (*owner_)[pos_]; }
+    Iterator& operator++() { ++pos_; return *this; }
+    bool operator==(const Iterator& other) const { return pos_ == other.pos_; }
+    bool operator!=(const Iterator& other) const { return pos_ != other.pos_; }
+
+  private:
+    Owner* owner_;
+    size_t pos_;
+  };
+
+  typedef Iterator<RingBuffer, T&> iterator;
+  typedef Iterator<const RingBuffer, const T&> const_iterator;
+
+  RingBuffer() : head_(0), count_(0) {}
+
+  /**
+   * Maximum number of elements (compile-time constant)
+   */
+  static constexpr size_t capacity() { return N; }
+
+  size_t size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+  bool full() const { return count_ == N; }
+
+  /**
+   * Remove all elements (storage is not touched)
+   */
+  void clear() {
+    head_ = 0;
+    count_ = 0;
+  }
+
+  /**
+   * Append an element as the newest entry
+   * @param item Element to store
+   * @return false if the buffer was full and the oldest element was overwritten
+   */
+  bool push(const T& item) {
+    items_[physical(count_ == N ? 0 : count_)] = item;
+    if (count_ == N) {
+      head_ = physical(1);
+      return false;
+    }
+    count_++;
+    return true;
+  }
+
+  /**
+   * Insert an element before the one at a given age (size() = append)
+   * Later elements move up by one; O(n)
+   * @param index Position by age (0 = oldest), at most size()
+   * @param item Element to store
+   * @return false if the buffer is full or index is out of range
+   */
+  bool insert(size_t index, const T& item) {
+    if (count_ == N || index > count_) {
+      return false;
+    }
+    for (size_t i = count_; i > index; i--) {
+      items_[physical(i)] = items_[physical(i - 1)];
+    }
+    items_[physical(index)] = item;
+    count_++;
+    return true;
+  }
+
+  /**
+   * Copy the oldest element without removing it
+   * @param out Output parameter for the element
+   * @return true if an element was copied, false if buffer empty
+   */
+  bool peek(T& out) const {
+    if (count_ == 0) {
+      return false;
+    }
+    out = items_[head_];
+    return true;
+  }
+
+  /**
+   * Remove the oldest element
+   * @return true if an element was removed, false if buffer empty
+   */
+  bool pop() {
+    if (count_ == 0) {
+      return false;
+    }
+    head_ = physical(1);
+    count_--;
+    return true;
+  }
+
+  /**
+   * Copy and remove the oldest element
+   * @param out Output parameter for the element
+   * @return true if an element was removed, false if buffer empty
+   */
+  bool pop(T& out) {
+    return peek(out) && pop();
+  }
+
+  /**
+   * Move up to maxCount of the oldest elements into a caller-provided array
+   * @param out Destination array
+   * @param maxCount Capacity of the destination array
+   * @return Number of elements moved
+   */
+  size_t drain(T* out, size_t maxCount) {
+    size_t n = count_ < maxCount ? count_ : maxCount;
+    for (size_t i = 0; i < n; i++) {
+      out[i] = items_[physical(i)];
+    }
+    head_ = physical(n);
+    count_ -= n;
+    return n;
+  }
+
+  /**
+   * Element access by age (0 = oldest). Caller must ensure index < size().
+   */
+  T& operator[](size_t index) { return items_[physical(index)]; }
+  const T& operator[](size_t index) const { return items_[physical(index)]; }
+
+  T& front() { return items_[head_]; }
+  const T& front() const { return items_[head_]; }
+  T& back() { return items_[physical(count_ - 1)]; }
+  const T& back() const { return items_[physical(count_ - 1)]; }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, count_); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, count_); }
+
+private:
+  // Map a logical offset from the oldest element to a storage index
+  size_t physical(size_t offset) const {
+    size_t index = head_ + offset;
+    return index >= N ? index - N : index;
+  }
+
+  T items_[N];
+  size_t head_;   // Storage index of the oldest element
+  size_t count_;  // Number of stored elements
+};
+
+#endif // RING_BUFFER_H
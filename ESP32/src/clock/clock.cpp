@@ -0,0 +1,166 @@
+/**
+ * @file clock.cpp
+ * @brief Clock service on esp_timer and SNTP
+ *
+ * The SNTP client resyncs every CLOCK_RESYNC_INTERVAL_MS and reports each
+ * sync through a callback on the lwIP task; the sync is handed to the
+ * control loop, which applies it to the EpochClock. On the first sync of
+ * a boot, buffered readings with provisional timestamps are rewritten to
+ * Unix time (buffer and journal).
+ */
+
+#include <Arduino.h>
+#include <esp_sntp.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <sys/time.h>
+#include <time.h>
+#include "../config.h"
+#include "../constants.h"
+#include "../buffer/buffer.h"
+#include "clock.h"
+#include "epoch_clock.h"
+
+static int64_t monotonicClock() {
+  return esp_timer_get_time();
+}
+
+static EpochClock epochClock(monotonicClock, CLOCK_STEP_THRESHOLD_MS,
+                             CLOCK_DRIFT_MIN_INTERVAL_MS, CLOCK_MAX_DRIFT_PPM);
+
+// Latest sync reported by SNTP (written on the lwIP task)
+static portMUX_TYPE syncMux = portMUX_INITIALIZER_UNLOCKED;
+static bool syncPending = false;
+static int64_t pendingEpochUs = 0;
+static int64_t pendingMonotonicUs = 0;
+
+// Distance replayed provisional timestamps are moved back (see initClock)
+static uint32_t replayedShift = 0;
+
+/**
+ * SNTP sync notification (lwIP task)
+ * @param tv Time just set by SNTP
+ */
+static void onTimeSync(struct timeval* tv) {
+  int64_t monotonic = esp_timer_get_time();
+  portENTER_CRITICAL(&syncMux);
+  pendingEpochUs = (int64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+  pendingMonotonicUs = monotonic;
+  syncPending = true;
+  portEXIT_CRITICAL(&syncMux);
+}
+
+/**
+ * Move a provisional timestamp of an earlier boot below this boot's range
+ */
+static uint32_t rebaseReplayed(uint32_t timestamp) {
+  return timestamp > replayedShift ? timestamp - replayedShift : 1;
+}
+
+/**
+ * Convert a provisional timestamp to Unix time
+ */
+static uint32_t resolveProvisional(uint32_t timestamp) {
+  return epochClock.resolve(timestamp);
+}
+
+/**
+ * Initialize the clock
+ * Provisional timestamps replayed from the journal belong to an earlier
+ * boot and would read as times of this one, so they are moved to end just
+ * below CLOCK_PROVISIONAL_BASE (spacing kept). At sync they then resolve
+ * to just before this boot - the time the device was off is unknown.
+ */
+void initClock() {
+  uint32_t newest = 0;
+  TelemetryReading reading;
+  for (int i = 0; getBufferedReading(i, reading); i++) {
+    uint32_t timestamp = (uint32_t)strtoul(reading.timestamp, NULL, 10);
+    if (reading.provisional && timestamp > newest) {
+      newest = timestamp;
+    }
+  }
+  
+  if (newest >= CLOCK_PROVISIONAL_BASE) {
+    replayedShift = newest - (CLOCK_PROVISIONAL_BASE - 1);
+    int moved = rewriteProvisionalTimestamps(rebaseReplayed, false);
+    Serial.printf("⏰ %d buffered readings from an earlier boot are waiting for a time sync\n", moved);
+  }
+}
+
+/**
+ * Start SNTP (keeps retrying in the background until the network is up)
+ */
+void startClockSync() {
+  sntp_set_time_sync_notification_cb(onTimeSync);
+  sntp_set_sync_interval(CLOCK_RESYNC_INTERVAL_MS);
+  configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, NTP_SERVER);
+}
+
+/**
+ * Apply the latest sync reported by SNTP
+ */
+void updateClock() {
+  portENTER_CRITICAL(&syncMux);
+  bool pending = syncPending;
+  int64_t epochUs = pendingEpochUs;
+  int64_t monotonicUs = pendingMonotonicUs;
+  syncPending = false;
+  portEXIT_CRITICAL(&syncMux);
+  
+  if (!pending) {
+    return;
+  }
+  
+  bool firstSync = !epochClock.synced();
+  epochClock.onSync(epochUs, monotonicUs);
+  
+  if (!firstSync) {
+    Serial.printf("⏰ Time resync: offset %ld ms, drift %.1f ppm\n",
+                  (long)epochClock.lastOffsetMs(), epochClock.driftPpm());
+    return;
+  }
+  
+  char now[TIMESTAMP_BUFFER_SIZE];
+  formatClockTime(now, sizeof(now));
+  Serial.printf("✅ Time synchronized: %s\n", now);
+  
+  int restamped = rewriteProvisionalTimestamps(resolveProvisional, true);
+  if (restamped > 0) {
+    Serial.printf("⏰ %d buffered readings re-stamped with Unix time\n", restamped);
+  }
+}
+
+bool isClockSynced() {
+  return epochClock.synced();
+}
+
+uint64_t uptimeMs() {
+  return epochClock.uptimeMs();
+}
+
+uint32_t clockTimestamp() {
+  return epochClock.timestamp();
+}
+
+/**
+ * Format the current time for logs
+ * @param out Destination buffer
+ * @param size Buffer size (TIMESTAMP_BUFFER_SIZE)
+ */
+void formatClockTime(char* out, size_t size) {
+  if (epochClock.synced()) {
+    time_t now = (time_t)(epochClock.nowEpochUs() / 1000000);
+    struct tm timeinfo;
+    gmtime_r(&now, &timeinfo);
+    strftime(out, size, "%Y-%m-%d %H:%M:%S+00", &timeinfo);
+    return;
+  }
+  
+  // Not synced yet - uptime instead
+  uint64_t totalSeconds = uptimeMs() / 1000;
+  unsigned long hours = (unsigned long)((totalSeconds / 3600) % 24);
+  unsigned long minutes = (unsigned long)((totalSeconds / 60) % 60);
+  unsigned long seconds = (unsigned long)(totalSeconds % 60);
+  snprintf(out, size, "UPTIME %02lu:%02lu:%02lu", hours, minutes, seconds);
+}
@@ -0,0 +1,37 @@
+/**
+ * @file clock.h
+ * @brief Clock service: monotonic uptime and NTP-synced Unix time
+ *
+ * Readings taken before the first NTP sync carry provisional timestamps
+ * and stay in the offline buffer; when the sync arrives they are rewritten
+ * to Unix time in place (see epoch_clock.h).
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Initialize the clock (after initBufferJournal(), so replayed readings can be fixed up)
+void initClock();
+
+// Start SNTP with periodic resync (call once WiFi has been started)
+void startClockSync();
+
+// Apply a pending time sync (call regularly from the main loop)
+void updateClock();
+
+// Check if the clock has been synced since boot
+bool isClockSynced();
+
+// Monotonic time since boot (ms, 64-bit - never wraps)
+uint64_t uptimeMs();
+
+// Timestamp for a reading taken now (Unix seconds, or provisional before the first sync)
+uint32_t clockTimestamp();
+
+// Format the current time for logs ("YYYY-MM-DD HH:MM:SS+00", or uptime before the first sync)
+void formatClockTime(char* out, size_t size);
+
+#endif // CLOCK_H
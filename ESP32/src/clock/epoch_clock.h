@@ -0,0 +1,179 @@
+/**
+ * @file epoch_clock.h
+ * @brief Monotonic 64-bit time base with an NTP-anchored Unix epoch
+ *
+ * All time is derived from one 64-bit monotonic microsecond counter
+ * (esp_timer on the ESP32), which does not wrap in the lifetime of the
+ * device. Each time sync anchors the counter to Unix time; the offset
+ * found at the next sync gives the oscillator drift, which is corrected
+ * between syncs. Epoch time handed out never goes backward for small
+ * corrections; a large offset is a clock step and is taken as is.
+ *
+ * Before the first sync, readings get provisional timestamps
+ * (CLOCK_PROVISIONAL_BASE + uptime seconds). resolve() turns them into
+ * Unix time once the clock is anchored.
+ *
+ * Header-only with no Arduino dependencies. The counter is injected as a
+ * function pointer, so the clock can be driven by a virtual clock on the
+ * host.
+ */
+
+#ifndef EPOCH_CLOCK_H
+#define EPOCH_CLOCK_H
+
+#include <stdint.h>
+#include "../constants.h"
+
+typedef int64_t (*MonotonicClock)();  // Microseconds since boot
+
+class EpochClock {
+public:
+  /**
+   * @param clock Monotonic microsecond counter
+   * @param stepThresholdMs Sync offset treated as a clock step (ms)
+   * @param driftIntervalMs Shortest sync interval used to estimate drift (ms)
+   * @param maxDriftPpm Largest accepted drift (ppm)
+   */
+  EpochClock(MonotonicClock clock, uint32_t stepThresholdMs, uint32_t driftIntervalMs,
+             int32_t maxDriftPpm)
+    : clock_(clock), stepThresholdUs_((int64_t)stepThresholdMs * 1000),
+      driftIntervalUs_((int64_t)driftIntervalMs * 1000), maxDriftPpb_((int64_t)maxDriftPpm * 1000),
+      synced_(false), syncs_(0), anchorMonotonicUs_(0), anchorEpochUs_(0),
+      driftPpb_(0), driftKnown_(false), lastOffsetUs_(0), lastIssuedUs_(0) {}
+
+  /**
+   * Monotonic time since boot (µs)
+   */
+  int64_t monotonicUs() const { return clock_(); }
+
+  /**
+   * Monotonic time since boot (ms, never wraps)
+   */
+  uint64_t uptimeMs() const { return (uint64_t)(clock_() / 1000); }
+
+  /**
+   * Record a time sync
+   * @param epochUs Unix time received from the time server (µs)
+   * @param monotonicUs Monotonic time at which it was received (µs)
+   */
+  void onSync(int64_t epochUs, int64_t monotonicUs) {
+    if (synced_) {
+      int64_t offset = epochUs - epochAt(monotonicUs);
+      int64_t interval = monotonicUs - anchorMonotonicUs_;
+      lastOffsetUs_ = offset;
+
+      if (offset > stepThresholdUs_ || offset < -stepThresholdUs_) {
+        // Clock was stepped (or a different server answered) - learn drift again
+        driftPpb_ = 0;
+        driftKnown_ = false;
+        lastIssuedUs_ = 0;
+      } else if (interval >= driftIntervalUs_) {
+        // The model already included the old estimate; the offset is the residual
+        int64_t measured = driftPpb_ + offset * 1000000000LL / interval;
+        driftPpb_ = driftKnown_ ? driftPpb_ + (measured - driftPpb_) / 4 : measured;
+        driftPpb_ = clampDrift(driftPpb_);
+        driftKnown_ = true;
+      } else {
+        // Too close to the last anchor to tell drift from jitter - keep the anchor
+        return;
+      }
+    }
+
+    anchorMonotonicUs_ = monotonicUs;
+    anchorEpochUs_ = epochUs;
+    synced_ = true;
+    syncs_++;
+  }
+
+  bool synced() const { return synced_; }
+
+  /**
+   * Number of syncs applied (anchor updates)
+   */
+  uint32_t syncs() const { return syncs_; }
+
+  /**
+   * Estimated oscillator drift (ppm, positive = counter runs slow)
+   */
+  float driftPpm() const { return driftPpb_ / 1000.0f; }
+
+  /**
+   * Offset between the server and the model at the last sync (ms)
+   */
+  int32_t lastOffsetMs() const { return (int32_t)(lastOffsetUs_ / 1000); }
+
+  /**
+   * Current Unix time (µs, 0 before the first sync)
+   * Never goes backward except across a clock step
+   */
+  int64_t nowEpochUs() {
+    if (!synced_) {
+      return 0;
+    }
+    int64_t now = epochAt(clock_());
+    if (now < lastIssuedUs_) {
+      return lastIssuedUs_;
+    }
+    lastIssuedUs_ = now;
+    return now;
+  }
+
+  /**
+   * Timestamp for a reading taken now
+   * @return Unix seconds once synced, a provisional timestamp before
+   */
+  uint32_t timestamp() {
+    if (!synced_) {
+      return (uint32_t)(CLOCK_PROVISIONAL_BASE + clock_() / 1000000);
+    }
+    return (uint32_t)(nowEpochUs() / 1000000);
+  }
+
+  /**
+   * Convert a provisional timestamp of this boot to Unix time
+   * Values below CLOCK_PROVISIONAL_BASE (earlier boots) land before this boot.
+   * Readings carry their own provisional flag (PACKED_FLAG_PROVISIONAL);
+   * only timestamps flagged provisional may be passed in.
+   * @return Unix seconds, or the timestamp unchanged if the clock is not
+   *         synced yet
+   */
+  uint32_t resolve(uint32_t timestamp) const {
+    if (!synced_) {
+      return timestamp;
+    }
+    int64_t monotonic = ((int64_t)timestamp - (int64_t)CLOCK_PROVISIONAL_BASE) * 1000000;
+    return (uint32_t)(epochAt(monotonic) / 1000000);
+  }
+
+private:
+  /**
+   * Unix time at a monotonic instant, from the anchor and drift estimate
+   */
+  int64_t epochAt(int64_t monotonicUs) const {
+    int64_t elapsed = monotonicUs - anchorMonotonicUs_;
+    // ms resolution for the correction keeps the product in range for years
+    return anchorEpochUs_ + elapsed + (elapsed / 1000) * driftPpb_ / 1000000;
+  }
+
+  int64_t clampDrift(int64_t ppb) const {
+    if (ppb > maxDriftPpb_) return maxDriftPpb_;
+    if (ppb < -maxDriftPpb_) return -maxDriftPpb_;
+    return ppb;
+  }
+
+  MonotonicClock clock_;
+  int64_t stepThresholdUs_;
+  int64_t driftIntervalUs_;
+  int64_t maxDriftPpb_;
+
+  bool synced_;
+  uint32_t syncs_;
+  int64_t anchorMonotonicUs_;  // Counter value at the last anchor
+  int64_t anchorEpochUs_;      // Unix time at the last anchor
+  int64_t driftPpb_;           // Counter rate error (parts per billion)
+  bool driftKnown_;
+  int64_t lastOffsetUs_;
+  int64_t lastIssuedUs_;       // Latest time handed out by nowEpochUs()
+};
+
+#endif // EPOCH_CLOCK_H
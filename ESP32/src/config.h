@@ -50,6 +50,28 @@
 #define MQTT_USER ""  // Leave empty if no authentication
 #define MQTT_PASSWORD ""  // Leave empty if no authentication
 
+// Buffered telemetry is flushed as JSON arrays on greenhouse/{id}/telemetry/batch,
+// as many readings per message as fit MQTT_MESSAGE_BUFFER_SIZE.
+// Comment out to flush one message per reading on the telemetry topic.
+#define TELEMETRY_BATCH_FLUSH
+
+// Encoding used at boot. Uncomment to publish telemetry in the compact binary
+// format (mqtt/telemetry_codec.h) on greenhouse/{id}/telemetry/bin instead of JSON.
+// Can be switched at runtime with "telemetry_encoding": "json" | "binary"
+// in a setpoints message.
+//#define TELEMETRY_BINARY
+
+// Report by exception: a live reading is only published when a sensor moves
+// beyond its deadband from the last published value, an actuator or the tank
+// level changes, irrigation ran, or TELEMETRY_HEARTBEAT_MS passed without a
+// publish. Sensors are still read every cycle, and offline readings are all
+// buffered. Comment out to publish every cycle.
+#define TELEMETRY_REPORT_BY_EXCEPTION
+#define TELEMETRY_DEADBAND_TEMP 0.3f     // °C (0 = publish any change)
+#define TELEMETRY_DEADBAND_HUM 2.0f      // % RH
+#define TELEMETRY_DEADBAND_LIGHT 50.0f   // lux
+#define TELEMETRY_HEARTBEAT_MS 900000    // Longest silence (ms, 15 minutes)
+
 // ============================================
 // NTP TIME CONFIGURATION
 // ============================================
@@ -77,10 +99,86 @@
 #define DEFAULT_IRRIGATION_INTERVAL_MINUTES 1  // 
 #define DEFAULT_IRRIGATION_DURATION_SECONDS 20 //
 
+// ============================================
+// HEATING CONTROL
+// ============================================
+// PID on temperature (target = middle of the temp_min..temp_max band) driving
+// the heating relay with time-proportional (slow PWM) output: on for
+// duty x window at the start of each window, at most two switches per window.
+// Comment out to use the on/off rule (on below temp_min, off at the band middle).
+// Gains can be changed at runtime over MQTT ("heating_kp", "heating_ki",
+// "heating_kd" in a setpoints message) or on the web UI.
+#define HEATING_PID
+#define DEFAULT_HEATING_KP 0.3f            // Duty per °C of error
+#define DEFAULT_HEATING_KI 0.0001f         // Duty per °C of error per second
+#define DEFAULT_HEATING_KD 0.0f            // Duty per °C/s (off: it reacts to the PWM ripple)
+#define HEATING_DERIVATIVE_FILTER_S 60.0f  // Derivative low-pass time constant (s)
+#define HEATING_PWM_WINDOW_MS 900000       // Relay PWM period (ms, 15 minutes)
+#define HEATING_MIN_ON_MS 60000            // Shortest heating pulse (ms)
+#define HEATING_MIN_OFF_MS 60000           // Shortest pause between pulses (ms)
+
+// ============================================
+// ACTUATOR PROTECTION
+// ============================================
+// Every relay switch goes through an anti-short-cycle policy
+// (actuators/actuator_policy.h): a switch is held until the actuator has been
+// on/off for the minimum time, and no actuator switches more often than its
+// hourly limit (0 = no limit). Forced safety stops are never held.
+#define FAN_MIN_ON_MS 60000                // Shortest fan run (ms)
+#define FAN_MIN_OFF_MS 60000               // Shortest fan pause (ms)
+#define FAN_MAX_SWITCHES_PER_HOUR 12
+#define FAN_HUMIDITY_HYSTERESIS 3.0f       // Fan stays on until humidity < max - this (%)
+#define FAN_TEMP_HYSTERESIS 0.5f           // Fan stays on until temperature < max - this (°C)
+
+#define LED_MIN_ON_MS 300000               // Shortest LED on time (ms)
+#define LED_MIN_OFF_MS 300000              // Shortest LED off time (ms)
+#define LED_MAX_SWITCHES_PER_HOUR 6
+#define LED_LIGHT_HYSTERESIS 200.0f        // LED stays on until light >= target + this (lux)
+
+#define HEATING_MAX_SWITCHES_PER_HOUR 10   // Dwell times are HEATING_MIN_ON_MS / HEATING_MIN_OFF_MS
+
+// The irrigation schedule times the pump itself
+#define PUMP_MIN_ON_MS 0
+#define PUMP_MIN_OFF_MS 0
+#define PUMP_MAX_SWITCHES_PER_HOUR 0
+
+// ============================================
+// DHT11 FILTERING
+// ============================================
+// A background task reads the DHT11 every 2 s (its fastest safe rate) into a
+// window of the last DHT_FILTER_WINDOW reads. The control loop and telemetry
+// get the median of the valid ones, with samples further than the outlier
+// band from it dropped and the rest averaged (sensors/median_filter.h).
+#define DHT_FILTER_WINDOW 5                // Reads in the window (10 s at 2 s)
+#define DHT_TEMP_OUTLIER_BAND 2.0f         // Temperature kept within this of the median (°C)
+#define DHT_HUM_OUTLIER_BAND 5.0f          // Humidity kept within this of the median (%)
+#define DHT_MAX_SAMPLE_AGE_MS 10000        // Newest valid read older than this = sensor error (ms)
+
+// ============================================
+// TANK LEVEL
+// ============================================
+// The float switch is serviced by a GPIO interrupt: once the tank reads empty
+// for TANK_LEVEL_DEBOUNCE_MS the pump is cut at once and a tank_empty alert
+// is published, without waiting for the control cycle. Raise the debounce
+// if ripples make the switch report empty while pumping.
+#define TANK_LEVEL_DEBOUNCE_MS 500         // Float switch must hold a new level this long (ms)
+
+// ============================================
+// ACTUATOR RATINGS
+// ============================================
+// Runtime x rating gives the energy and water reported in telemetry and on
+// /data. Set these to the installed hardware.
+#define PUMP_RATED_W 4.0f                  // Pump power (W)
+#define PUMP_FLOW_L_PER_MIN 1.5f           // Pump flow (litres per minute)
+#define HEATING_RATED_W 100.0f             // Heater power (W)
+#define LED_RATED_W 2.5f                   // LED strip power (W, 5 V at the 500 mA FastLED limit)
+#define FAN_RATED_W 3.0f                   // Fan power (W)
+
 // ============================================
 // TIMING CONFIGURATION
 // ============================================
-#define TELEMETRY_INTERVAL_MS 1000  // 60 seconds = 1 minute
+#define CONTROL_INTERVAL_MS 2000     // Sensor read + control rules (ms)
+#define TELEMETRY_INTERVAL_MS 60000  // Telemetry publish window (ms, 1 minute)
 #define DISPLAY_INTERVAL_MS 100     // 2 seconds
 
 #endif // CONFIG_H
@@ -34,9 +34,20 @@
 /**
  * MQTT and network buffer sizes
  */
-#define MQTT_JSON_BUFFER_SIZE 512      // JSON payload buffer size (bytes)
+#define MQTT_JSON_BUFFER_SIZE 1536     // JSON payload buffer size (bytes, live readings carry actuator counters)
 #define MQTT_TOPIC_BUFFER_SIZE 100     // MQTT topic string buffer size (bytes)
-#define MQTT_MESSAGE_BUFFER_SIZE 512   // MQTT message buffer size (bytes)
+#define BUFFER_STATS_JSON_SIZE 1536    // Buffer statistics payload size (bytes, MQTT and HTTP)
+#define MQTT_MESSAGE_BUFFER_SIZE 4096  // MQTT message buffer size (bytes, bounds batch payloads)
+#define MQTT_PACKET_OVERHEAD 9         // PUBLISH fixed header (5) + topic length (2) + packet id (2)
+#define MQTT_INBOUND_PAYLOAD_SIZE 512  // Largest accepted setpoint message (bytes)
+
+/**
+ * Queues between the control loop and the network task (SPSC, power of two)
+ */
+#define MQTT_OUTBOUND_QUEUE_DEPTH 4    // Serialized messages awaiting publish (~4 KB each)
+#define MQTT_RESULT_QUEUE_DEPTH 8      // Publish outcomes returned to the control loop
+#define MQTT_INBOUND_QUEUE_DEPTH 4     // Received setpoint messages
+#define MQTT_DEFERRED_READINGS 4       // Readings held back while a flush message is in flight
 
 /**
  * String buffer sizes
@@ -44,10 +55,29 @@
 #define TIMESTAMP_BUFFER_SIZE 30       // ISO 8601 timestamp string buffer (bytes)
 
 /**
- * Circular buffer sizes
+ * Offline buffer tiers (capacity in entries, fan-in = entries of the
+ * previous tier per aggregate). Tier table lives in buffer/buffer.cpp.
+ * Default cascade covers ~5.3 days in 1320 bytes (44-byte aggregates;
+ * tier 0 holds the 1-minute telemetry windows with their statistics):
+ *   10 x 1 min + 6 x 10 min + 6 x 1 h + 4 x 6 h + 4 x 24 h
  */
-#define BUFFER_1MIN_SIZE 10            // 1-minute high-resolution buffer (readings)
-#define BUFFER_10MIN_SIZE 10           // 10-minute aggregated buffer (readings)
+#define BUFFER_TIER0_SIZE 10           // 1-minute windows
+#define BUFFER_TIER1_SIZE 6            // 10-minute aggregates
+#define BUFFER_TIER1_FANIN 10
+#define BUFFER_TIER2_SIZE 6            // 1-hour aggregates
+#define BUFFER_TIER2_FANIN 6
+#define BUFFER_TIER3_SIZE 4            // 6-hour aggregates
+#define BUFFER_TIER3_FANIN 6
+#define BUFFER_TIER4_SIZE 4            // 24-hour aggregates
+#define BUFFER_TIER4_FANIN 4
+
+/**
+ * Persistent buffer journal (LittleFS)
+ */
+#define JOURNAL_BASE_PATH "/littlefs/journal"   // Slot N stored as <base>N.bin
+#define JOURNAL_BATCH_RECORDS 16                // Records batched in RAM per flash write
+#define JOURNAL_SEGMENT_MAX_BYTES 8192          // Slot size that triggers rotation (bytes)
+#define JOURNAL_SYNC_INTERVAL_MS 300000         // Max time pending records stay in RAM (ms)
 
 // ============================================
 // TIMING & DELAYS (Communication)
@@ -56,8 +86,34 @@
 /**
  * MQTT timing
  */
-#define MQTT_PUBLISH_DELAY_MS 100      // Delay between MQTT publishes during flush (ms)
-#define MQTT_RECONNECT_INTERVAL_MS 5000 // Delay between MQTT reconnection attempts (ms)
+#define MQTT_FLUSH_RATE_PER_SEC 10     // Flush messages per second (token bucket refill)
+#define MQTT_FLUSH_BURST 3             // Flush messages allowed back-to-back (token bucket size)
+#define MQTT_FLUSH_MAX_RECORDS_PER_STEP 32 // Readings per flush message
+#define BUFFER_STATS_INTERVAL_MS 900000 // Buffer statistics publish interval (ms, 15 minutes)
+#define MQTT_BACKOFF_BASE_MS 1000     // First reconnect backoff window (ms, doubles per failure)
+#define MQTT_BACKOFF_CAP_MS 120000    // Largest reconnect backoff window (ms)
+#define MQTT_STABLE_CONNECTION_MS 60000 // Connection uptime that resets the backoff (ms)
+#define MQTT_INFLIGHT_WINDOW 4         // Telemetry publishes awaiting PUBACK (<= MQTT_OUTBOUND_QUEUE_DEPTH)
+#define MQTT_ACK_TIMEOUT_MS 15000      // Oldest PUBACK overdue - link assumed dead, reconnect (ms)
+#define MQTT_FLUSH_RETRY_MS 5000      // Shortest gap between flush starts on one connection (ms)
+
+/**
+ * Network task (all broker I/O runs here, off the control loop)
+ */
+#define NETWORK_TASK_CORE 0            // Core shared with the WiFi stack (loop() runs on core 1)
+#define NETWORK_TASK_PRIORITY 1        // Same as the Arduino loop task
+#define NETWORK_TASK_STACK_SIZE 6144   // Stack for connect/publish (bytes)
+#define NETWORK_TASK_PERIOD_MS 10      // Queue polling period (ms)
+
+/**
+ * Tank level task (float switch interrupt -> debounce -> pump cut-off)
+ */
+#define TANK_TASK_CORE 1               // Same core as loop(), at a higher priority
+#define TANK_TASK_PRIORITY 2           // Preempts the loop task to cut the pump
+#define TANK_TASK_STACK_SIZE 3072      // Stack for debounce and the cut-off handler (bytes)
+#define TANK_LEVEL_RECHECK_MS 1000     // Pin re-read when no interrupt arrives (ms, missed edges)
+#define TANK_EVENT_QUEUE_DEPTH 8       // Level changes awaiting the loop task (SPSC, power of two)
+#define ALERT_PENDING_DEPTH 4          // Alerts kept until the broker acknowledges them
 
 /**
  * Network initialization delays
@@ -66,9 +122,41 @@
 #define NTP_SYNC_RETRY_DELAY_MS 500         // Delay between NTP sync attempts (ms)
 
 /**
- * System timing
+ * loop() task periods (see scheduler/task_scheduler.h)
+ */
+#define SCHEDULER_MAX_TASKS 12           // Task slots
+#define SCHEDULER_MAX_IDLE_MS 1000       // Longest single idle block (ms)
+#define WEB_POLL_INTERVAL_MS 10          // HTTP request polling (ms)
+#define WEB_TASK_BUDGET_MS 250           // Longest expected HTTP response (ms)
+#define MQTT_POLL_INTERVAL_MS 10         // Setpoints, publish results and flush steps (ms)
+#define MQTT_TASK_BUDGET_MS 50           // Longest expected MQTT task run (ms)
+#define RECONNECT_CHECK_INTERVAL_MS 100  // MQTT state-change check (ms)
+#define CLOCK_UPDATE_INTERVAL_MS 100     // Pending NTP sync check (ms)
+#define TANK_POLL_INTERVAL_MS 10         // Tank level events -> alerts (ms)
+
+/**
+ * Epoch clock (see clock/epoch_clock.h)
  */
-#define LOOP_DELAY_MS 100              // Main loop delay to prevent CPU hogging (ms)
+#define CLOCK_RESYNC_INTERVAL_MS 3600000UL   // SNTP resync period (ms, 1 hour)
+#define CLOCK_STEP_THRESHOLD_MS 2000         // Sync offset treated as a clock step, not drift (ms)
+#define CLOCK_DRIFT_MIN_INTERVAL_MS 600000UL // Shortest sync interval used to estimate drift (ms)
+#define CLOCK_MAX_DRIFT_PPM 500              // Largest accepted oscillator drift (ppm)
+#define CLOCK_PROVISIONAL_BASE 100000000UL   // Provisional timestamp at boot (uptime seconds are added)
+
+/**
+ * Rule tables received on greenhouse/{id}/config/rules (see control/rule_engine.h)
+ */
+#define RULES_MAX_COUNT 32                   // Rules per table (12 bytes each on the wire)
+
+/**
+ * Actuator registry
+ */
+#define ACTUATOR_DUTY_WINDOW_MS 3600000UL    // Rolling duty cycle time constant (ms, 1 hour)
+
+/**
+ * Heating controller
+ */
+#define HEATING_SENSOR_TIMEOUT_MS 30000      // No valid temperature for this long - heating off (ms)
 
 // ============================================
 // RETRY LIMITS
@@ -80,13 +168,44 @@
 #define WIFI_MAX_CONNECTION_ATTEMPTS 20  // Maximum WiFi connection attempts before giving up
 #define NTP_MAX_SYNC_ATTEMPTS 10         // Maximum NTP synchronization attempts before giving up
 
+// ============================================
+// SETPOINT LIMITS
+// ============================================
+
+/**
+ * Accepted ranges for setpoints received over MQTT (inclusive).
+ * Out-of-range fields are rejected and the current value is kept.
+ */
+#define SETPOINT_TEMP_LIMIT_MIN 0.0f           // Celsius
+#define SETPOINT_TEMP_LIMIT_MAX 60.0f          // Celsius
+#define SETPOINT_HUM_LIMIT_MIN 0.0f            // Percentage
+#define SETPOINT_HUM_LIMIT_MAX 100.0f          // Percentage
+#define SETPOINT_LIGHT_LIMIT_MIN 0.0f          // Lux
+#define SETPOINT_LIGHT_LIMIT_MAX 100000.0f     // Lux
+#define SETPOINT_IRRIGATION_INTERVAL_LIMIT_MIN 1UL      // Minutes
+#define SETPOINT_IRRIGATION_INTERVAL_LIMIT_MAX 10080UL  // Minutes (one week)
+#define SETPOINT_IRRIGATION_DURATION_LIMIT_MIN 1UL      // Seconds
+#define SETPOINT_IRRIGATION_DURATION_LIMIT_MAX 3600UL   // Seconds
+#define SETPOINT_HEATING_KP_LIMIT_MAX 10.0f      // Duty per °C (minimum 0)
+#define SETPOINT_HEATING_KI_LIMIT_MAX 0.1f       // Duty per °C per second (minimum 0)
+#define SETPOINT_HEATING_KD_LIMIT_MAX 3600.0f    // Duty per °C/s (minimum 0)
+#define SETPOINT_MAX_NESTING 8                 // Nested objects/arrays skipped in a setpoint message
+
 // ============================================
 // DHT SENSOR SPECIFIC
 // ============================================
 
 /**
- * DHT sensor stabilization delay (production mode only)
+ * DHT sensor timing (stabilization delay applies to production mode only)
  */
 #define DHT_STABILIZATION_DELAY_MS 2000  // DHT sensor warm-up time after init (ms)
+#define DHT_MIN_SAMPLE_INTERVAL_MS 2000  // Shortest DHT11 read period (library returns cached values below it)
+
+/**
+ * DHT sampler task (reads at DHT_MIN_SAMPLE_INTERVAL_MS, off the control loop)
+ */
+#define DHT_TASK_CORE 1                  // Same core as loop(); the read masks interrupts, keep it off the WiFi core
+#define DHT_TASK_PRIORITY 1              // Same as the Arduino loop task
+#define DHT_TASK_STACK_SIZE 2048         // Stack for the driver and filters (bytes)
 
 #endif // CONSTANTS_H
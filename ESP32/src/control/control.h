@@ -6,12 +6,21 @@
 #ifndef CONTROL_H
 #define CONTROL_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 // Initialize control logic
 void initControlLogic();
 
 // Execute all control logic
 void executeControlLogic(float temperature, float humidity, float light, bool tankLevel);
 
+// Load a compiled rule table (see control/rule_engine.h)
+bool loadControlRules(const uint8_t* data, size_t length);
+
+// Get the version of the rule table in force (0 = built-in rules only)
+uint32_t getControlRulesVersion();
+
 // Get irrigation timing information
 unsigned long getIrrigationInfo(bool &isCurrentlyIrrigating);
 
@@ -25,6 +34,15 @@ void getCurrentSetpoints(float &temp_min, float &temp_max, float &hum_air_max,
                         float &light_intensity, unsigned long &irrigation_interval_minutes,
                         unsigned long &irrigation_duration_seconds);
 
+// Update heating PID gains (see control/pid_controller.h)
+void setHeatingGains(float kp, float ki, float kd);
+
+// Get current heating PID gains
+void getHeatingGains(float &kp, float &ki, float &kd);
+
+// Get heating duty cycle applied to the relay (0..1)
+float getHeatingDuty();
+
 // Check and reset irrigation flag for telemetry
 bool checkAndResetIrrigationFlag();
 
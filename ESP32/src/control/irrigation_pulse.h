@@ -0,0 +1,164 @@
+/**
+ * @file irrigation_pulse.h
+ * @brief Timed irrigation pulse that ends on a one-shot timer
+ *
+ * start() arms a OneShotTimer for the pulse duration; when it expires the
+ * pump is cut from the timer's context, whatever the control loop is doing.
+ * abort() cuts it early (e.g. the tank ran empty). Exactly one of the two
+ * ends the pulse: the state moves RUNNING -> ENDED with a compare-exchange,
+ * and only the winner calls cutOff. The control loop picks up the outcome
+ * with takeEnded() to update its own bookkeeping.
+ *
+ * An expiry only ends a pulse that is at its deadline, so a late callback
+ * from an earlier, aborted pulse cannot cut a newer one short. poll() is a
+ * backstop: it ends a pulse that is past its deadline in case the timer
+ * could not be armed.
+ *
+ * Header-only with no Arduino dependencies: time comes from the timer
+ * interface, so a host test can drive it with a simulated clock.
+ */
+
+#ifndef IRRIGATION_PULSE_H
+#define IRRIGATION_PULSE_H
+
+#include <atomic>
+#include <stdint.h>
+#include "one_shot_timer.h"
+
+#define PULSE_TIMER_SLACK_US 1000   // An expiry this close to the deadline counts
+
+enum PulseEnd : uint8_t {
+  PULSE_COMPLETED,          // Full duration (timer or backstop)
+  PULSE_TANK_EMPTY,         // Cut early - no water
+  PULSE_CANCELLED           // Cut early - other reason
+};
+
+class IrrigationPulse {
+public:
+  /**
+   * @param timer One-shot timer
+   * @param cutOff Turns the pump off; runs in the timer's context on expiry
+   */
+  IrrigationPulse(OneShotTimer& timer, void (*cutOff)())
+    : timer_(timer), cutOff_(cutOff), state_(IDLE), reason_(PULSE_COMPLETED),
+      startUs_(0), deadlineUs_(0), endUs_(0), armed_(false) {}
+
+  /**
+   * Attach to the timer (call once at startup, before start())
+   * @return false if the timer could not be set up (poll() still ends pulses)
+   */
+  bool begin() {
+    return timer_.setCallback(onTimer, this);
+  }
+
+  /**
+   * Begin a pulse (turn the pump on first)
+   * @param durationUs Pulse length (µs)
+   * @return false if a pulse is already running or its end was not taken yet
+   */
+  bool start(uint64_t durationUs) {
+    if (state_.load() != IDLE) {
+      return false;
+    }
+    timer_.disarm();
+    startUs_ = timer_.nowUs();
+    deadlineUs_ = startUs_ + durationUs;
+    state_.store(RUNNING);
+    armed_ = timer_.arm(durationUs);
+    return true;
+  }
+
+  /**
+   * End a running pulse now (cuts the pump)
+   * The timer is left to expire on its own; its callback finds the pulse over
+   * @param reason Why the pulse was cut
+   * @return true if this call ended the pulse
+   */
+  bool abort(PulseEnd reason) {
+    return finish(reason);
+  }
+
+  /**
+   * End the pulse if it is past its deadline (in case the timer missed it)
+   * @return true if this call ended the pulse
+   */
+  bool poll() {
+    if (state_.load() == RUNNING && timer_.nowUs() >= deadlineUs_) {
+      return finish(PULSE_COMPLETED);
+    }
+    return false;
+  }
+
+  bool running() const { return state_.load() == RUNNING; }
+
+  // The timer was armed for the current pulse (false = backstop only)
+  bool timerArmed() const { return armed_; }
+
+  /**
+   * Take the outcome of an ended pulse (then a new one may start)
+   * @param reason How it ended
+   * @param endUs When the pump was cut (timer clock, µs)
+   * @param ranUs How long the pump ran (µs)
+   * @return false if no ended pulse is waiting
+   */
+  bool takeEnded(PulseEnd& reason, uint64_t& endUs, uint64_t& ranUs) {
+    if (state_.load() != ENDED) {
+      return false;
+    }
+    reason = reason_;
+    endUs = endUs_;
+    ranUs = endUs_ - startUs_;
+    state_.store(IDLE);
+    return true;
+  }
+
+  /**
+   * Time left in the running pulse (µs, 0 if none)
+   */
+  uint64_t remainingUs() {
+    if (state_.load() != RUNNING) {
+      return 0;
+    }
+    uint64_t now = timer_.nowUs();
+    return now >= deadlineUs_ ? 0 : deadlineUs_ - now;
+  }
+
+private:
+  enum State : uint8_t {
+    IDLE,
+    RUNNING,
+    ENDING,                 // A finisher won and is cutting the pump
+    ENDED                   // Waiting for takeEnded()
+  };
+
+  static void onTimer(void* context) {
+    IrrigationPulse* pulse = static_cast<IrrigationPulse*>(context);
+    if (pulse->state_.load() == RUNNING &&
+        pulse->timer_.nowUs() + PULSE_TIMER_SLACK_US >= pulse->deadlineUs_) {
+      pulse->finish(PULSE_COMPLETED);
+    }
+  }
+
+  bool finish(PulseEnd reason) {
+    uint8_t expected = RUNNING;
+    if (!state_.compare_exchange_strong(expected, ENDING)) {
+      return false;
+    }
+    cutOff_();
+    endUs_ = timer_.nowUs();
+    reason_ = reason;
+    state_.store(ENDED);
+    return true;
+  }
+
+  OneShotTimer& timer_;
+  void (*cutOff_)();
+  std::atomic<uint8_t> state_;
+  PulseEnd reason_;         // Written before ENDED is published
+  uint64_t startUs_;
+  uint64_t deadlineUs_;
+  uint64_t endUs_;
+  bool armed_;
+};
+
+#endif // IRRIGATION_PULSE_H
@@ -0,0 +1,46 @@
+/**
+ * @file one_shot_timer.cpp
+ * @brief esp_timer implementation of OneShotTimer
+ */
+
+#include <esp_timer.h>
+#include "one_shot_timer.h"
+
+bool EspOneShotTimer::setCallback(Callback callback, void* context) {
+  if (handle_ != nullptr) {
+    esp_timer_delete((esp_timer_handle_t)handle_);
+    handle_ = nullptr;
+  }
+  
+  esp_timer_create_args_t args = {};
+  args.callback = callback;
+  args.arg = context;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = name_;
+  
+  esp_timer_handle_t handle;
+  if (esp_timer_create(&args, &handle) != ESP_OK) {
+    return false;
+  }
+  handle_ = handle;
+  return true;
+}
+
+bool EspOneShotTimer::arm(uint64_t delayUs) {
+  if (handle_ == nullptr) {
+    return false;
+  }
+  // esp_timer_start_once() fails on a running timer
+  esp_timer_stop((esp_timer_handle_t)handle_);
+  return esp_timer_start_once((esp_timer_handle_t)handle_, delayUs) == ESP_OK;
+}
+
+void EspOneShotTimer::disarm() {
+  if (handle_ != nullptr) {
+    esp_timer_stop((esp_timer_handle_t)handle_);
+  }
+}
+
+uint64_t EspOneShotTimer::nowUs() {
+  return (uint64_t)esp_timer_get_time();
+}
@@ -0,0 +1,64 @@
+/**
+ * @file one_shot_timer.h
+ * @brief One-shot timer interface for control actions that must not wait
+ *        for the next control cycle
+ *
+ * The expiry callback runs outside the control loop (the esp_timer task on
+ * the ESP32), so it must only touch state that is safe to share. A host
+ * test can implement the interface with a simulated clock and fire the
+ * callback itself.
+ */
+
+#ifndef ONE_SHOT_TIMER_H
+#define ONE_SHOT_TIMER_H
+
+#include <stdint.h>
+
+class OneShotTimer {
+public:
+  typedef void (*Callback)(void* context);
+
+  virtual ~OneShotTimer() {}
+
+  /**
+   * Set the function called when the timer expires (before the first arm())
+   */
+  virtual bool setCallback(Callback callback, void* context) = 0;
+
+  /**
+   * Start the timer, replacing a pending expiry
+   * @param delayUs Time until the callback runs (µs)
+   * @return true if armed
+   */
+  virtual bool arm(uint64_t delayUs) = 0;
+
+  /**
+   * Cancel a pending expiry (no effect if none)
+   */
+  virtual void disarm() = 0;
+
+  /**
+   * Current time on the timer's clock (µs, monotonic)
+   */
+  virtual uint64_t nowUs() = 0;
+};
+
+/**
+ * esp_timer backend (one_shot_timer.cpp). The callback runs in the
+ * esp_timer task, not in an interrupt.
+ */
+class EspOneShotTimer : public OneShotTimer {
+public:
+  explicit EspOneShotTimer(const char* name) : name_(name), handle_(nullptr) {}
+
+  bool setCallback(Callback callback, void* context) override;
+  bool arm(uint64_t delayUs) override;
+  void disarm() override;
+  uint64_t nowUs() override;
+
+private:
+  const char* name_;
+  void* handle_;            // esp_timer_handle_t
+};
+
+#endif // ONE_SHOT_TIMER_H
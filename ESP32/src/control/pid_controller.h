@@ -0,0 +1,124 @@
+/**
+ * @file pid_controller.h
+ * @brief Discrete PID controller for the heating output
+ *
+ * Parallel form, output clamped to [outputMin, outputMax]:
+ *   u = Kp*e + I + D
+ *   I += Ki*e*dt        (conditional integration - see below)
+ *   D = -Kd * d(filtered measurement)/dt
+ *
+ * - The integral is kept in output units, so changing Ki does not bump the
+ *   output.
+ * - Anti-windup: the integral only grows while the output is not saturated
+ *   in the same direction, and is itself limited to the output range.
+ * - Derivative on the measurement (no kick when the setpoint changes),
+ *   through a first-order low-pass filter with time constant
+ *   derivativeFilterS - the DHT11 reports in 0.1-1 °C steps, and an
+ *   unfiltered difference of those steps is mostly noise.
+ *
+ * Header-only with no Arduino dependencies: the caller passes the time
+ * step, so the controller can be driven by millis() on the ESP32 or by a
+ * simulated plant on the host.
+ */
+
+#ifndef PID_CONTROLLER_H
+#define PID_CONTROLLER_H
+
+struct PidGains {
+  float kp;                 // Output per unit of error
+  float ki;                 // Output per unit of error and second
+  float kd;                 // Output per unit of error change per second
+};
+
+class PidController {
+public:
+  /**
+   * @param gains Initial gains
+   * @param outputMin Lowest output
+   * @param outputMax Highest output
+   * @param derivativeFilterS Derivative low-pass time constant (s, 0 = unfiltered)
+   */
+  PidController(const PidGains& gains, float outputMin, float outputMax, float derivativeFilterS)
+    : gains_(gains), outputMin_(outputMin), outputMax_(outputMax),
+      derivativeFilterS_(derivativeFilterS) {
+    reset();
+  }
+
+  /**
+   * Forget the integral and derivative history (next update starts fresh)
+   */
+  void reset() {
+    integral_ = 0.0f;
+    derivative_ = 0.0f;
+    filtered_ = 0.0f;
+    output_ = outputMin_;
+    primed_ = false;
+  }
+
+  /**
+   * Compute the next output
+   * @param setpoint Target value
+   * @param measurement Current value
+   * @param dtS Time since the previous update (s, > 0)
+   * @return Output in [outputMin, outputMax]
+   */
+  float update(float setpoint, float measurement, float dtS) {
+    if (!primed_) {
+      filtered_ = measurement;
+      derivative_ = 0.0f;
+      primed_ = true;
+    } else if (dtS > 0.0f) {
+      float previous = filtered_;
+      filtered_ += (measurement - filtered_) * (dtS / (derivativeFilterS_ + dtS));
+      derivative_ = (filtered_ - previous) / dtS;
+    }
+
+    float error = setpoint - measurement;
+    float proportional = gains_.kp * error;
+    float derivative = -gains_.kd * derivative_;
+
+    // Conditional integration: hold the integral while the output is pinned
+    // at a limit and the error would push it further
+    float unclamped = proportional + integral_ + derivative;
+    bool pinnedHigh = unclamped >= outputMax_ && error > 0.0f;
+    bool pinnedLow = unclamped <= outputMin_ && error < 0.0f;
+    if (!pinnedHigh && !pinnedLow && dtS > 0.0f) {
+      integral_ = clamp(integral_ + gains_.ki * error * dtS);
+    }
+
+    output_ = clamp(proportional + integral_ + derivative);
+    return output_;
+  }
+
+  /**
+   * Change the gains (the integral is kept, so the output does not jump)
+   */
+  void setGains(const PidGains& gains) { gains_ = gains; }
+
+  const PidGains& gains() const { return gains_; }
+
+  // Last output
+  float output() const { return output_; }
+
+  // Integral term (output units)
+  float integral() const { return integral_; }
+
+private:
+  float clamp(float value) const {
+    if (value > outputMax_) return outputMax_;
+    if (value < outputMin_) return outputMin_;
+    return value;
+  }
+
+  PidGains gains_;
+  float outputMin_;
+  float outputMax_;
+  float derivativeFilterS_;
+  float integral_;
+  float derivative_;          // Filtered measurement slope (units/s)
+  float filtered_;            // Filtered measurement
+  float output_;
+  bool primed_;               // false until the first measurement
+};
+
+#endif // PID_CONTROLLER_H
@@ -0,0 +1,268 @@
+/**
+ * @file rule_engine.h
+ * @brief Interpreter for compiled control rule tables
+ *
+ * Rule tables are compiled on the server (api/services/ruleCompiler.js)
+ * and received on greenhouse/{id}/config/rules. Each rule switches one
+ * actuator when an input crosses a threshold:
+ *
+ *   <actuator> ON while <input> <below|above> <setpoint or constant> + offset
+ *
+ * with a hysteresis band and a minimum dwell time. A rule marked "inhibit"
+ * forces its actuator OFF while it is active (e.g. pump off while the tank
+ * is empty). An actuator is ON if any of its rules is active and none of
+ * its inhibit rules is.
+ *
+ * Table format (little-endian):
+ *   header  8 bytes   'G' 'R', format (RULES_FORMAT_VERSION), rule count,
+ *                     rule set version (uint32, must increase)
+ *   rule   12 bytes   input, comparator, reference, target
+ *                     (actuator | RULE_TARGET_INHIBIT),
+ *                     threshold (int32, x100), hysteresis (uint16, x100),
+ *                     minimum dwell (uint16, seconds)
+ *   CRC-32  4 bytes   of everything before it (crc32.h)
+ *
+ * The table is validated completely before it replaces the current one, and
+ * is evaluated from fixed storage (RULES_MAX_COUNT rules, no heap).
+ *
+ * Header-only with no Arduino dependencies: the caller passes the inputs,
+ * the setpoints and the current time in milliseconds.
+ */
+
+#ifndef RULE_ENGINE_H
+#define RULE_ENGINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "../constants.h"
+#include "../crc32.h"
+#include "../actuators/actuator_policy.h"
+
+#define RULES_MAGIC_0 'G'
+#define RULES_MAGIC_1 'R'
+#define RULES_FORMAT_VERSION 1
+#define RULES_HEADER_SIZE 8
+#define RULES_RECORD_SIZE 12
+#define RULES_CRC_SIZE 4
+#define RULE_TARGET_INHIBIT 0x80
+
+#define RULE_ACTUATOR_BIT(actuator) ((uint8_t)(1u << (actuator)))
+
+static_assert(RULES_HEADER_SIZE + RULES_MAX_COUNT * RULES_RECORD_SIZE + RULES_CRC_SIZE
+              < MQTT_INBOUND_PAYLOAD_SIZE, "A full rule table must fit one inbound message");
+
+// Sensor channel a rule reads
+enum RuleInput : uint8_t {
+  RULE_INPUT_TEMPERATURE,     // °C
+  RULE_INPUT_HUMIDITY,        // %
+  RULE_INPUT_LIGHT,           // lux
+  RULE_INPUT_TANK_LEVEL,      // 1 = water OK, 0 = empty
+  RULE_INPUT_COUNT
+};
+
+enum RuleComparator : uint8_t {
+  RULE_BELOW,                 // Active below the threshold, released at threshold + hysteresis
+  RULE_ABOVE,                 // Active above the threshold, released at threshold - hysteresis
+  RULE_COMPARATOR_COUNT
+};
+
+// Base of the threshold (the rule's offset is added to it)
+enum RuleReference : uint8_t {
+  RULE_REF_CONSTANT,          // 0
+  RULE_REF_TEMP_MIN,
+  RULE_REF_TEMP_MAX,
+  RULE_REF_HUM_AIR_MAX,
+  RULE_REF_LIGHT_INTENSITY,
+  RULE_REF_COUNT
+};
+
+enum RuleActuator : uint8_t {
+  RULE_ACTUATOR_PUMP,
+  RULE_ACTUATOR_HEATING,
+  RULE_ACTUATOR_LED,
+  RULE_ACTUATOR_FAN,
+  RULE_ACTUATOR_COUNT
+};
+
+enum RuleLoadResult {
+  RULES_LOADED,
+  RULES_UNCHANGED,            // Same version and CRC as the current table (retained message again)
+  RULES_BAD_LENGTH,
+  RULES_BAD_MAGIC,
+  RULES_BAD_FORMAT,           // Unknown format version
+  RULES_TOO_MANY,             // More than RULES_MAX_COUNT rules
+  RULES_BAD_CRC,
+  RULES_BAD_RULE,             // Unknown input, comparator, reference or actuator
+  RULES_STALE_VERSION         // Not newer than the current table
+};
+
+class RuleEngine {
+public:
+  RuleEngine() : count_(0), version_(0), crc_(0), actuators_(0), inhibited_(0) {}
+
+  /**
+   * Replace the rule table (the current one is kept unless the result is RULES_LOADED)
+   * @param data Compiled table
+   * @param length Table bytes
+   * @return Load result
+   */
+  RuleLoadResult load(const uint8_t* data, size_t length) {
+    if (length < RULES_HEADER_SIZE + RULES_CRC_SIZE) {
+      return RULES_BAD_LENGTH;
+    }
+    if (data[0] != RULES_MAGIC_0 || data[1] != RULES_MAGIC_1) {
+      return RULES_BAD_MAGIC;
+    }
+    if (data[2] != RULES_FORMAT_VERSION) {
+      return RULES_BAD_FORMAT;
+    }
+    size_t count = data[3];
+    if (count > RULES_MAX_COUNT) {
+      return RULES_TOO_MANY;
+    }
+    if (length != RULES_HEADER_SIZE + count * RULES_RECORD_SIZE + RULES_CRC_SIZE) {
+      return RULES_BAD_LENGTH;
+    }
+    size_t crcOffset = length - RULES_CRC_SIZE;
+    uint32_t crc = readU32(data + crcOffset);
+    if (crc != crc32(data, crcOffset)) {
+      return RULES_BAD_CRC;
+    }
+
+    uint32_t version = readU32(data + 4);
+    if (version == version_ && crc == crc_) {
+      return RULES_UNCHANGED;
+    }
+    if (version <= version_) {
+      return RULES_STALE_VERSION;
+    }
+
+    const uint8_t* record = data + RULES_HEADER_SIZE;
+    for (size_t i = 0; i < count; i++, record += RULES_RECORD_SIZE) {
+      if (record[0] >= RULE_INPUT_COUNT || record[1] >= RULE_COMPARATOR_COUNT ||
+          record[2] >= RULE_REF_COUNT ||
+          (record[3] & (uint8_t)~RULE_TARGET_INHIBIT) >= RULE_ACTUATOR_COUNT) {
+        return RULES_BAD_RULE;
+      }
+    }
+
+    // Valid - decode in place of the current table
+    actuators_ = 0;
+    inhibited_ = 0;
+    record = data + RULES_HEADER_SIZE;
+    for (size_t i = 0; i < count; i++, record += RULES_RECORD_SIZE) {
+      Rule& rule = rules_[i];
+      rule.input = record[0];
+      rule.comparator = record[1];
+      rule.reference = record[2];
+      rule.actuator = record[3] & (uint8_t)~RULE_TARGET_INHIBIT;
+      rule.inhibit = (record[3] & RULE_TARGET_INHIBIT) != 0;
+      rule.threshold = (int32_t)readU32(record + 4) / 100.0f;
+      rule.hysteresis = readU16(record + 8) / 100.0f;
+      rule.dwellMs = readU16(record + 10) * 1000UL;
+      rule.active = false;
+      rule.settled = false;
+      rule.since = 0;
+      actuators_ |= RULE_ACTUATOR_BIT(rule.actuator);
+    }
+    count_ = count;
+    version_ = version;
+    crc_ = crc;
+    return RULES_LOADED;
+  }
+
+  /**
+   * Evaluate every rule (call once per control tick)
+   * An input missing from validInputs keeps its rules in their current state.
+   * @param inputs Sensor values (RULE_INPUT_COUNT entries)
+   * @param validInputs Bitmask of valid inputs (bit = RuleInput)
+   * @param references Setpoint values (RULE_REF_COUNT entries, [RULE_REF_CONSTANT] ignored)
+   * @param nowMs Current time (ms)
+   * @return Bitmask of actuators to switch ON (RULE_ACTUATOR_BIT), within actuators()
+   */
+  uint8_t evaluate(const float* inputs, uint8_t validInputs, const float* references,
+                   unsigned long nowMs) {
+    uint8_t on = 0;
+    uint8_t inhibited = 0;
+    for (size_t i = 0; i < count_; i++) {
+      Rule& rule = rules_[i];
+      if (validInputs & (1u << rule.input)) {
+        float value = inputs[rule.input];
+        float threshold = rule.threshold;
+        if (rule.reference != RULE_REF_CONSTANT) {
+          threshold += references[rule.reference];
+        }
+
+        bool wanted = rule.comparator == RULE_BELOW
+            ? hysteresisBelow(value, threshold, rule.hysteresis, rule.active)
+            : hysteresisAbove(value, threshold, rule.hysteresis, rule.active);
+
+        if (!rule.settled) {
+          // First evaluation after a load starts the dwell time
+          rule.active = wanted;
+          rule.since = nowMs;
+          rule.settled = true;
+        } else if (wanted != rule.active && nowMs - rule.since >= rule.dwellMs) {
+          rule.active = wanted;
+          rule.since = nowMs;
+        }
+      }
+
+      if (rule.active) {
+        if (rule.inhibit) {
+          inhibited |= RULE_ACTUATOR_BIT(rule.actuator);
+        } else {
+          on |= RULE_ACTUATOR_BIT(rule.actuator);
+        }
+      }
+    }
+    inhibited_ = inhibited;
+    return on & (uint8_t)~inhibited;
+  }
+
+  // Actuators the current table drives (RULE_ACTUATOR_BIT mask)
+  uint8_t actuators() const { return actuators_; }
+
+  // Actuators held OFF by an inhibit rule at the last evaluate()
+  uint8_t inhibited() const { return inhibited_; }
+
+  // Version of the current table (0 = none loaded)
+  uint32_t version() const { return version_; }
+
+  size_t ruleCount() const { return count_; }
+
+  // Rule state (for diagnostics)
+  bool isRuleActive(size_t index) const { return index < count_ && rules_[index].active; }
+
+private:
+  struct Rule {
+    uint8_t input;            // RuleInput
+    uint8_t comparator;       // RuleComparator
+    uint8_t reference;        // RuleReference
+    uint8_t actuator;         // RuleActuator
+    bool inhibit;
+    bool active;
+    bool settled;             // Evaluated at least once since the load
+    float threshold;          // Offset from the reference
+    float hysteresis;
+    unsigned long dwellMs;    // Shortest time between two changes
+    unsigned long since;      // Last change (ms)
+  };
+
+  static uint16_t readU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+  }
+
+  static uint32_t readU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+  }
+
+  Rule rules_[RULES_MAX_COUNT];
+  size_t count_;
+  uint32_t version_;
+  uint32_t crc_;
+  uint8_t actuators_;
+  uint8_t inhibited_;
+};
+
+#endif // RULE_ENGINE_H
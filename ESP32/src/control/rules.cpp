@@ -10,6 +10,13 @@
 #include "../constants.h"
 #include "../control/control.h"
 #include "../actuators/actuators.h"
+#include "../actuators/actuator_policy.h"
+#include "../sensors/sensors.h"
+#include "irrigation_pulse.h"
+#include "one_shot_timer.h"
+#include "pid_controller.h"
+#include "rule_engine.h"
+#include "time_proportional.h"
 
 // ============================================
 // DYNAMIC SETPOINTS (can be updated via MQTT)
@@ -28,6 +35,26 @@ float setpoint_light_intensity = DEFAULT_LIGHT_INTENSITY;
 unsigned long setpoint_irrigation_interval_minutes = DEFAULT_IRRIGATION_INTERVAL_MINUTES;
 unsigned long setpoint_irrigation_duration_seconds = DEFAULT_IRRIGATION_DURATION_SECONDS;
 
+// ============================================
+// HEATING CONTROLLER
+// ============================================
+static_assert(HEATING_MIN_ON_MS + HEATING_MIN_OFF_MS <= HEATING_PWM_WINDOW_MS,
+              "Heating PWM window must fit a minimum pulse and pause");
+
+// Duty cycle 0..1 (gains can be updated via MQTT or the web UI)
+PidController heatingPid({ DEFAULT_HEATING_KP, DEFAULT_HEATING_KI, DEFAULT_HEATING_KD },
+                         0.0f, 1.0f, HEATING_DERIVATIVE_FILTER_S);
+TimeProportionalOutput heatingOutput(HEATING_PWM_WINDOW_MS, HEATING_MIN_ON_MS, HEATING_MIN_OFF_MS);
+float heatingDuty = 0.0f;                   // Duty applied to the relay
+unsigned long lastHeatingReading = 0;       // Time of the last valid temperature
+bool heatingFailSafe = false;               // Heating held off - no valid temperature
+
+// ============================================
+// RULE TABLE (received via MQTT)
+// ============================================
+// Actuators driven by the table skip their built-in rule below
+RuleEngine ruleEngine;
+
 // ============================================
 // IRRIGATION STATE TRACKING
 // ============================================
@@ -35,6 +62,29 @@ unsigned long lastIrrigationStartTime = 0;  // When last irrigation started
 bool isIrrigating = false;                  // Currently irrigating?
 bool irrigatedSinceLastTransmission = false; // For telemetry reporting
 
+// The pump is cut by a one-shot esp_timer at the end of the pulse, not by
+// the next control cycle
+EspOneShotTimer irrigationTimer("irrigation");
+IrrigationPulse irrigationPulse(irrigationTimer, turnPumpOff);
+
+/**
+ * Stop the pump because the tank ran empty (runs on the tank level task)
+ * A scheduled pulse ends through irrigationPulse, so the control cycle
+ * records it; a rule-driven run is cut directly and the next control cycle,
+ * seeing the empty tank, brings the registry in line.
+ * @return true if the pump was running
+ */
+static bool cutPumpTankEmpty() {
+  if (irrigationPulse.abort(PULSE_TANK_EMPTY)) {
+    return true;
+  }
+  bool wasOn = isPumpOn();
+  if (wasOn) {
+    turnPumpOff();
+  }
+  return wasOn;
+}
+
 /**
  * Initialize control logic
  */
@@ -42,6 +92,12 @@ void initControlLogic() {
   lastIrrigationStartTime = millis();
   isIrrigating = false;
   irrigatedSinceLastTransmission = false;
+  lastHeatingReading = millis();
+  
+  if (!irrigationPulse.begin()) {
+    Serial.println("⚠️  Irrigation timer unavailable - pulses end on the control cycle");
+  }
+  setTankEmptyHandler(cutPumpTankEmpty);
   
   Serial.println("\n📋 Control Rules (Default Setpoints):");
   Serial.print("   �️  Temperature: ");
@@ -75,7 +131,13 @@ void initControlLogic() {
   Serial.println(" sec");
   
   Serial.println("   🌬️  Fan:        Automatic (Temp/Humidity based)");
-  Serial.println("   🔥 Heating:     Automatic (Temperature based)");
+  #ifdef HEATING_PID
+    Serial.printf("   🔥 Heating:     PID to %.1f°C (Kp %.3f, Ki %.5f, Kd %.1f), %lu s PWM window\n",
+                  (setpoint_temp_min + setpoint_temp_max) / 2, DEFAULT_HEATING_KP,
+                  DEFAULT_HEATING_KI, DEFAULT_HEATING_KD, (unsigned long)(HEATING_PWM_WINDOW_MS / 1000));
+  #else
+    Serial.println("   🔥 Heating:     Automatic (Temperature based)");
+  #endif
   Serial.println("   💡 LED Strip:   Automatic (Light based)\n");
 }
 
@@ -86,70 +148,124 @@ void initControlLogic() {
  * - Temperature exceeds maximum setpoint (for cooling)
  */
 void controlFan(float humidity, float temperature) {
+  bool fanOn = isActuatorOn(ACTUATOR_FAN);
   bool shouldFanBeOn = false;
   
-  // Check humidity condition
-  if (humidity != SENSOR_ERROR_TEMP && humidity > setpoint_hum_air_max) {
+  // Check humidity condition (once on, runs until FAN_HUMIDITY_HYSTERESIS below max)
+  if (humidity != SENSOR_ERROR_HUM &&
+      hysteresisAbove(humidity, setpoint_hum_air_max, FAN_HUMIDITY_HYSTERESIS, fanOn)) {
     shouldFanBeOn = true;
   }
   
   // Check temperature condition (fan helps cool down)
-  if (temperature != SENSOR_ERROR_TEMP && temperature > setpoint_temp_max) {
+  if (temperature != SENSOR_ERROR_TEMP &&
+      hysteresisAbove(temperature, setpoint_temp_max, FAN_TEMP_HYSTERESIS, fanOn)) {
     shouldFanBeOn = true;
   }
   
-  // Apply fan state
-  if (shouldFanBeOn) {
-    if (!isFanOn()) {
-      turnFanOn();
+  setActuator(ACTUATOR_FAN, shouldFanBeOn);
+}
+
+static void applyHeating(bool on) {
+  setActuator(ACTUATOR_HEATING, on);
+}
+
+#ifdef HEATING_PID
+/**
+ * Execute heating control logic (PID + time-proportional relay)
+ * The PID holds the middle of the temperature band; its duty cycle drives
+ * the relay through a slow PWM window with minimum on/off times. A failed
+ * read keeps the last duty; after HEATING_SENSOR_TIMEOUT_MS without a valid
+ * temperature the heating is switched off and the PID restarts fresh.
+ */
+void controlHeating(float temperature) {
+  unsigned long now = millis();
+  
+  if (temperature == SENSOR_ERROR_TEMP) {
+    if (now - lastHeatingReading < HEATING_SENSOR_TIMEOUT_MS) {
+      applyHeating(heatingOutput.update(heatingDuty, now));
+      return;
     }
-  } else {
-    if (isFanOn()) {
-      turnFanOff();
+    if (!heatingFailSafe) {
+      heatingFailSafe = true;
+      heatingDuty = 0.0f;
+      heatingPid.reset();
+      Serial.println("⚠️  Heating held OFF - no valid temperature reading");
     }
+    applyHeating(heatingOutput.forceOff(now));
+    return;
+  }
+  
+  // Time step, bounded so a long sensor outage does not dump into the integral
+  unsigned long elapsed = now - lastHeatingReading;
+  if (elapsed > HEATING_SENSOR_TIMEOUT_MS) {
+    elapsed = HEATING_SENSOR_TIMEOUT_MS;
   }
+  lastHeatingReading = now;
+  heatingFailSafe = false;
+  
+  float target = (setpoint_temp_min + setpoint_temp_max) / 2;
+  heatingDuty = heatingPid.update(target, temperature, elapsed / 1000.0f);
+  applyHeating(heatingOutput.update(heatingDuty, now));
 }
-
+#else
 /**
  * Execute heating control logic (Temperature-based)
  * Heating turns ON if temperature is below minimum setpoint
- * Heating turns OFF if temperature reaches maximum setpoint
+ * Heating turns OFF if temperature reaches the middle of the band
  */
 void controlHeating(float temperature) {
   if (temperature != SENSOR_ERROR_TEMP) {
     if (temperature < setpoint_temp_min) {
-      if (!isHeatingOn()) {
-        turnHeatingOn();
-      }
+      applyHeating(true);
     } else if (temperature >= (setpoint_temp_max + setpoint_temp_min) / 2) {
-      if (isHeatingOn()) {
-        turnHeatingOff();
-      }
+      applyHeating(false);
     }
     // Keep current state if temperature is between min and max
   }
+  heatingDuty = isActuatorOn(ACTUATOR_HEATING) ? 1.0f : 0.0f;
+}
+#endif
+
+/**
+ * Record the end of an irrigation pulse (the pump is already off)
+ */
+static void finishIrrigationPulse() {
+  PulseEnd reason;
+  uint64_t endUs, ranUs;
+  if (!irrigationPulse.takeEnded(reason, endUs, ranUs)) {
+    return;
+  }
+  
+  syncActuator(ACTUATOR_PUMP, false, (unsigned long)(endUs / 1000));
+  isIrrigating = false;
+  irrigatedSinceLastTransmission = true;
+  
+  if (reason == PULSE_COMPLETED) {
+    Serial.printf("✅ Irrigation cycle completed (%lu ms)\n", (unsigned long)(ranUs / 1000));
+  } else if (reason == PULSE_TANK_EMPTY) {
+    Serial.printf("⚠️  Irrigation cut after %lu ms - Tank empty!\n", (unsigned long)(ranUs / 1000));
+  } else {
+    Serial.printf("ℹ️  Irrigation cancelled after %lu ms\n", (unsigned long)(ranUs / 1000));
+  }
 }
 
 /**
  * Execute pump control logic (Irrigation interval/duration based)
- * Irrigates for a set duration at specified intervals
+ * Irrigates for a set duration at specified intervals. The pulse ends on
+ * its timer (see control/irrigation_pulse.h); this only starts pulses, cuts
+ * them if the tank runs empty and records how they ended.
  */
 void controlPump(bool tankLevel) {
   unsigned long currentTime = millis();
   unsigned long irrigation_interval_ms = setpoint_irrigation_interval_minutes * 60UL * 1000UL;
-  unsigned long irrigation_duration_ms = setpoint_irrigation_duration_seconds * 1000UL;
   
   if (isIrrigating) {
-    // Currently irrigating - check if duration has elapsed
-    unsigned long timeSinceStart = currentTime - lastIrrigationStartTime;
-    
-    if (timeSinceStart >= irrigation_duration_ms) {
-      // Irrigation complete
-      turnPumpOff();
-      isIrrigating = false;
-      irrigatedSinceLastTransmission = true;
-      Serial.println("✅ Irrigation cycle completed");
+    if (!tankLevel) {
+      irrigationPulse.abort(PULSE_TANK_EMPTY);
     }
+    irrigationPulse.poll();  // Backstop if the timer could not be armed
+    finishIrrigationPulse();
   } else {
     // Not irrigating - check if it's time to start
     unsigned long timeSinceLastIrrigation = currentTime - lastIrrigationStartTime;
@@ -157,7 +273,15 @@ void controlPump(bool tankLevel) {
     if (timeSinceLastIrrigation >= irrigation_interval_ms) {
       // Time to irrigate
       if (tankLevel) {
-        turnPumpOn();
+        if (!setActuator(ACTUATOR_PUMP, true)) {
+          return;  // Held by the switch policy - retry on the next cycle
+        }
+        irrigationPulse.start(setpoint_irrigation_duration_seconds * 1000000ULL);
+        // The tank may have run empty since tankLevel was read; the cut-off
+        // handler could have fired before the pulse existed
+        if (!readTankLevel()) {
+          irrigationPulse.abort(PULSE_TANK_EMPTY);
+        }
         isIrrigating = true;
         lastIrrigationStartTime = currentTime;
         Serial.print("🚰 Starting irrigation (");
@@ -175,34 +299,159 @@ void controlPump(bool tankLevel) {
 /**
  * Execute LED control logic (Light-based)
  * LED turns ON if light is below the setpoint threshold
- * LED turns OFF if light reaches or exceeds the setpoint threshold
+ * LED turns OFF once light reaches the setpoint + LED_LIGHT_HYSTERESIS
+ * (the strip itself adds to the reading)
  */
 void controlLED(float light) {
   if (light >= 0) { // Valid light reading (not SENSOR_ERROR_LIGHT)
-    if (light < setpoint_light_intensity) {
-      // Light is below threshold - turn LED ON
-      if (!isLEDOn()) {
-        turnLEDOn();
-      }
-    } else {
-      // Light is at or above threshold - turn LED OFF
-      if (isLEDOn()) {
-        turnLEDOff();
-      }
-    }
+    bool ledOn = isActuatorOn(ACTUATOR_LED);
+    setActuator(ACTUATOR_LED, hysteresisBelow(light, setpoint_light_intensity,
+                                              LED_LIGHT_HYSTERESIS, ledOn));
   }
   // If sensor error, keep current state
 }
 
+/**
+ * Evaluate the rule table on the current readings and setpoints
+ * @return Actuators to switch ON (RULE_ACTUATOR_BIT)
+ */
+static uint8_t evaluateRuleTable(float temperature, float humidity, float light, bool tankLevel) {
+  float inputs[RULE_INPUT_COUNT];
+  inputs[RULE_INPUT_TEMPERATURE] = temperature;
+  inputs[RULE_INPUT_HUMIDITY] = humidity;
+  inputs[RULE_INPUT_LIGHT] = light;
+  inputs[RULE_INPUT_TANK_LEVEL] = tankLevel ? 1.0f : 0.0f;
+  
+  uint8_t valid = 1u << RULE_INPUT_TANK_LEVEL;
+  if (temperature != SENSOR_ERROR_TEMP) valid |= 1u << RULE_INPUT_TEMPERATURE;
+  if (humidity != SENSOR_ERROR_HUM) valid |= 1u << RULE_INPUT_HUMIDITY;
+  if (light >= 0) valid |= 1u << RULE_INPUT_LIGHT;
+  
+  float references[RULE_REF_COUNT];
+  references[RULE_REF_CONSTANT] = 0.0f;
+  references[RULE_REF_TEMP_MIN] = setpoint_temp_min;
+  references[RULE_REF_TEMP_MAX] = setpoint_temp_max;
+  references[RULE_REF_HUM_AIR_MAX] = setpoint_hum_air_max;
+  references[RULE_REF_LIGHT_INTENSITY] = setpoint_light_intensity;
+  
+  return ruleEngine.evaluate(inputs, valid, references, millis());
+}
+
+static_assert((int)RULE_ACTUATOR_PUMP == ACTUATOR_PUMP && (int)RULE_ACTUATOR_HEATING == ACTUATOR_HEATING &&
+              (int)RULE_ACTUATOR_LED == ACTUATOR_LED && (int)RULE_ACTUATOR_FAN == ACTUATOR_FAN,
+              "Rule table actuators must match ActuatorId");
+
+/**
+ * Drive an actuator from the rule table (an inhibit rule stops it at once)
+ * @return State of the actuator
+ */
+static bool applyRule(ActuatorId actuator, uint8_t ruledOn, uint8_t inhibited) {
+  return setActuator(actuator, ruledOn & RULE_ACTUATOR_BIT(actuator),
+                     inhibited & RULE_ACTUATOR_BIT(actuator));
+}
+
+/**
+ * Drive the pump from the rule table (replaces the irrigation schedule)
+ * An inhibit rule stops the pump at once. An empty tank always does,
+ * whatever the table says.
+ */
+static void applyRulePump(bool on, bool force, bool tankLevel) {
+  // A scheduled pulse still running when the table took over
+  irrigationPulse.abort(PULSE_CANCELLED);
+  finishIrrigationPulse();
+  
+  bool wasOn = isActuatorOn(ACTUATOR_PUMP);
+  if (setActuator(ACTUATOR_PUMP, on && tankLevel, force || !tankLevel) && !wasOn) {
+    irrigatedSinceLastTransmission = true;
+    if (!readTankLevel()) {
+      setActuator(ACTUATOR_PUMP, false, true);  // Ran empty since tankLevel was read
+    }
+  }
+  isIrrigating = false;
+}
+
 /**
  * Execute all control logic
- * Should be called regularly with current sensor readings
+ * Should be called regularly with current sensor readings. Actuators the
+ * rule table drives follow it; the others keep their built-in rule.
  */
 void executeControlLogic(float temperature, float humidity, float light, bool tankLevel) {
-  controlFan(humidity, temperature);  // Fan uses both humidity and temperature
-  controlHeating(temperature);
-  controlPump(tankLevel);
-  controlLED(light);  // LED uses light sensor reading
+  uint8_t ruled = ruleEngine.actuators();
+  uint8_t ruledOn = ruled != 0 ? evaluateRuleTable(temperature, humidity, light, tankLevel) : 0;
+  
+  uint8_t inhibited = ruleEngine.inhibited();
+  
+  if (ruled & RULE_ACTUATOR_BIT(RULE_ACTUATOR_FAN)) {
+    applyRule(ACTUATOR_FAN, ruledOn, inhibited);
+  } else {
+    controlFan(humidity, temperature);  // Fan uses both humidity and temperature
+  }
+  
+  if (ruled & RULE_ACTUATOR_BIT(RULE_ACTUATOR_HEATING)) {
+    heatingDuty = applyRule(ACTUATOR_HEATING, ruledOn, inhibited) ? 1.0f : 0.0f;
+  } else {
+    controlHeating(temperature);
+  }
+  
+  if (ruled & RULE_ACTUATOR_BIT(RULE_ACTUATOR_PUMP)) {
+    applyRulePump(ruledOn & RULE_ACTUATOR_BIT(RULE_ACTUATOR_PUMP),
+                  inhibited & RULE_ACTUATOR_BIT(RULE_ACTUATOR_PUMP), tankLevel);
+  } else {
+    controlPump(tankLevel);
+  }
+  
+  if (ruled & RULE_ACTUATOR_BIT(RULE_ACTUATOR_LED)) {
+    applyRule(ACTUATOR_LED, ruledOn, inhibited);
+  } else {
+    controlLED(light);  // LED uses light sensor reading
+  }
+}
+
+/**
+ * Load a compiled rule table received via MQTT
+ * The current table stays in force unless the new one is valid and newer.
+ * @param data Table bytes (see control/rule_engine.h)
+ * @param length Table length
+ * @return true if the table was loaded
+ */
+bool loadControlRules(const uint8_t* data, size_t length) {
+  static const char* const RESULT_NAMES[] = {
+    "loaded", "unchanged", "bad length", "bad magic", "unknown format",
+    "too many rules", "CRC mismatch", "invalid rule", "version not newer"
+  };
+  static_assert(sizeof(RESULT_NAMES) / sizeof(RESULT_NAMES[0]) == RULES_STALE_VERSION + 1,
+                "One name per RuleLoadResult");
+  
+  RuleLoadResult result = ruleEngine.load(data, length);
+  if (result == RULES_UNCHANGED) {
+    Serial.printf("ℹ️  Rule table v%lu unchanged\n", (unsigned long)ruleEngine.version());
+    return false;
+  }
+  if (result != RULES_LOADED) {
+    Serial.printf("❌ Rule table rejected (%s) - keeping v%lu\n", RESULT_NAMES[result],
+                  (unsigned long)ruleEngine.version());
+    return false;
+  }
+  
+  static const char* const ACTUATOR_NAMES[RULE_ACTUATOR_COUNT] = { "pump", "heating", "LED", "fan" };
+  Serial.printf("✅ Rule table v%lu loaded (%u rules), drives:", (unsigned long)ruleEngine.version(),
+                (unsigned)ruleEngine.ruleCount());
+  for (uint8_t actuator = 0; actuator < RULE_ACTUATOR_COUNT; actuator++) {
+    if (ruleEngine.actuators() & RULE_ACTUATOR_BIT(actuator)) {
+      Serial.print(" ");
+      Serial.print(ACTUATOR_NAMES[actuator]);
+    }
+  }
+  Serial.println(ruleEngine.actuators() == 0 ? " nothing (built-in rules)" : "");
+  return true;
+}
+
+/**
+ * Get the version of the rule table in force
+ * @return Version, or 0 if only the built-in rules run
+ */
+uint32_t getControlRulesVersion() {
+  return ruleEngine.version();
 }
 
 /**
@@ -213,17 +462,12 @@ void executeControlLogic(float temperature, float humidity, float light, bool ta
 unsigned long getIrrigationInfo(bool &isCurrentlyIrrigating) {
   unsigned long currentTime = millis();
   unsigned long irrigation_interval_ms = setpoint_irrigation_interval_minutes * 60UL * 1000UL;
-  unsigned long irrigation_duration_ms = setpoint_irrigation_duration_seconds * 1000UL;
   
   isCurrentlyIrrigating = isIrrigating;
   
   if (isIrrigating) {
     // Return time remaining in current irrigation
-    unsigned long timeSinceStart = currentTime - lastIrrigationStartTime;
-    if (timeSinceStart >= irrigation_duration_ms) {
-      return 0;
-    }
-    return irrigation_duration_ms - timeSinceStart;
+    return (unsigned long)(irrigationPulse.remainingUs() / 1000);
   } else {
     // Return time until next irrigation
     unsigned long timeSinceLastIrrigation = currentTime - lastIrrigationStartTime;
@@ -293,6 +537,35 @@ void getCurrentSetpoints(float &temp_min, float &temp_max, float &hum_air_max,
   irrigation_duration_seconds = setpoint_irrigation_duration_seconds;
 }
 
+/**
+ * Update the heating PID gains (MQTT or web UI)
+ * The integral is kept, so the heating output does not jump
+ */
+void setHeatingGains(float kp, float ki, float kd) {
+  PidGains gains = { kp, ki, kd };
+  heatingPid.setGains(gains);
+  
+  Serial.printf("🔄 Heating gains updated: Kp %.3f, Ki %.5f, Kd %.1f\n", kp, ki, kd);
+}
+
+/**
+ * Get the heating PID gains (for webserver display/editing)
+ */
+void getHeatingGains(float &kp, float &ki, float &kd) {
+  const PidGains& gains = heatingPid.gains();
+  kp = gains.kp;
+  ki = gains.ki;
+  kd = gains.kd;
+}
+
+/**
+ * Get the heating duty cycle currently applied to the relay
+ * @return Duty cycle (0..1)
+ */
+float getHeatingDuty() {
+  return heatingDuty;
+}
+
 /**
  * Check if irrigation occurred since last call and reset flag
  * @return true if irrigation happened since last check
@@ -0,0 +1,127 @@
+/**
+ * @file time_proportional.h
+ * @brief Time-proportional (slow PWM) drive for an on/off relay
+ *
+ * Turns a duty cycle (0..1) into relay on/off times over a fixed window:
+ * the relay is on for duty * window at the start of each window. Until the
+ * window's pulse ends, its length follows the latest duty (so the output
+ * still reacts within a window); after that the relay stays off until the
+ * next window. One pulse per window means at most two switches per window,
+ * whatever the controller does in between.
+ *
+ * Pulses shorter than the minimum on time are dropped (duty 0) and gaps
+ * shorter than the minimum off time are filled (duty 1). The minimum times
+ * are also enforced on every switch, so a duty change or forceOff() cannot
+ * chatter the relay.
+ *
+ * Header-only with no Arduino dependencies: the caller passes the current
+ * time in milliseconds.
+ */
+
+#ifndef TIME_PROPORTIONAL_H
+#define TIME_PROPORTIONAL_H
+
+#include <stdint.h>
+
+class TimeProportionalOutput {
+public:
+  /**
+   * @param windowMs PWM period (ms)
+   * @param minOnMs Shortest on time (ms)
+   * @param minOffMs Shortest off time (ms)
+   */
+  TimeProportionalOutput(unsigned long windowMs, unsigned long minOnMs, unsigned long minOffMs)
+    : windowMs_(windowMs), minOnMs_(minOnMs), minOffMs_(minOffMs),
+      started_(false), on_(false), pulseDone_(false), windowStart_(0), onMs_(0),
+      lastSwitch_(0), switches_(0) {}
+
+  /**
+   * Compute the relay state for now
+   * @param duty Requested duty cycle (clamped to 0..1)
+   * @param nowMs Current time (ms)
+   * @return true if the relay should be on
+   */
+  bool update(float duty, unsigned long nowMs) {
+    if (!started_) {
+      started_ = true;
+      startWindow(duty, nowMs);
+      lastSwitch_ = nowMs - minOffMs_; // Off long enough - may turn on at once
+    } else if (nowMs - windowStart_ >= windowMs_) {
+      startWindow(duty, windowStart_ + (nowMs - windowStart_) / windowMs_ * windowMs_);
+    } else if (!pulseDone_) {
+      onMs_ = onTimeFor(duty);
+    }
+
+    bool wanted = !pulseDone_ && nowMs - windowStart_ < onMs_;
+    if (wanted != on_) {
+      unsigned long held = nowMs - lastSwitch_;
+      if (held >= (on_ ? minOnMs_ : minOffMs_)) {
+        on_ = wanted;
+        lastSwitch_ = nowMs;
+        switches_++;
+        pulseDone_ = !on_;
+      }
+    }
+    return on_;
+  }
+
+  /**
+   * End the current window's pulse (e.g. the sensor failed)
+   * The relay turns off as soon as its minimum on time allows; call again
+   * until it returns false
+   * @param nowMs Current time (ms)
+   * @return true if the relay is still on
+   */
+  bool forceOff(unsigned long nowMs) {
+    onMs_ = 0;
+    if (on_ && nowMs - lastSwitch_ >= minOnMs_) {
+      on_ = false;
+      lastSwitch_ = nowMs;
+      switches_++;
+      pulseDone_ = true;
+    }
+    return on_;
+  }
+
+  bool isOn() const { return on_; }
+
+  // On time of the current window (ms)
+  unsigned long onTimeMs() const { return onMs_; }
+
+  // Relay switches since construction
+  uint32_t switches() const { return switches_; }
+
+private:
+  void startWindow(float duty, unsigned long startMs) {
+    windowStart_ = startMs;
+    pulseDone_ = false;
+    onMs_ = onTimeFor(duty);
+  }
+
+  unsigned long onTimeFor(float duty) const {
+    if (duty <= 0.0f) {
+      return 0;
+    }
+    unsigned long onMs = duty >= 1.0f ? windowMs_ : (unsigned long)(duty * (float)windowMs_ + 0.5f);
+    if (onMs < minOnMs_) {
+      return 0;
+    }
+    if (windowMs_ - onMs < minOffMs_) {
+      return windowMs_;
+    }
+    return onMs;
+  }
+
+  unsigned long windowMs_;
+  unsigned long minOnMs_;
+  unsigned long minOffMs_;
+  bool started_;
+  bool on_;
+  bool pulseDone_;              // The window's on pulse has ended
+  unsigned long windowStart_;
+  unsigned long onMs_;          // On time of the current window
+  unsigned long lastSwitch_;
+  uint32_t switches_;
+};
+
+#endif // TIME_PROPORTIONAL_H
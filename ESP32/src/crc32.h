@@ -0,0 +1,27 @@
+/**
+ * @file crc32.h
+ * @brief CRC-32 (IEEE 802.3, reflected) shared by the journal and rule tables
+ */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * CRC-32 (bitwise - the inputs are small)
+ * Same polynomial and check value as zlib.crc32 / Node zlib.crc32
+ */
+inline uint32_t crc32(const uint8_t* data, size_t length) {
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+    }
+  }
+  return ~crc;
+}
+
+#endif // CRC32_H
@@ -4,7 +4,8 @@
  */
 
 #include <Arduino.h>
-#include <time.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 #include "config.h"
 #include "constants.h"
 
@@ -14,6 +15,9 @@
 #include "control/control.h"
 #include "mqtt/mqtt.h"
 #include "buffer/buffer.h"
+#include "buffer/accumulator.h"
+#include "clock/clock.h"
+#include "scheduler/task_scheduler.h"
 #include "webserver/html_content.h"
 
 // Forward declarations for webserver functions
@@ -27,9 +31,116 @@ void processWebServer();
   #include <Wire.h>
 #endif
 
-// Timing intervals
-unsigned long lastCycleTime = 0;
-const unsigned long CYCLE_INTERVAL = 60000; // Master cycle interval - change this to 60000 for production (1 minute)
+static unsigned long schedulerClock() {
+  return millis();
+}
+
+// Everything loop() does runs as a scheduler task (registered in setup())
+static TaskScheduler<SCHEDULER_MAX_TASKS> scheduler(schedulerClock);
+
+static_assert(CONTROL_INTERVAL_MS <= TELEMETRY_INTERVAL_MS, "Each telemetry window needs a control sample");
+
+// Latest sensor values (sensors task -> control task)
+static float sensedTemperature = SENSOR_ERROR_TEMP;
+static float sensedHumidity = SENSOR_ERROR_HUM;
+static float sensedLight = SENSOR_ERROR_LIGHT;
+static bool sensedTankLevel = true;        // Follows float switch events (tank task -> loop)
+static bool tankEmptiedSinceSample = false; // Ran empty since the last control sample
+
+// Control-cycle samples since the last telemetry publish
+static TelemetryAccumulator telemetryWindow;
+
+void runSensorCycle();
+void runControlCycle();
+void runTelemetryCycle();
+
+/**
+ * Block the loop task until the next task is due
+ * Lets the FreeRTOS idle task run (and light-sleep, when power management
+ * is enabled) instead of spinning; with a task already due it only yields
+ * @param idleMs Time until the next deadline (ms)
+ */
+static void idleUntilNextTask(unsigned long idleMs) {
+  if (idleMs > SCHEDULER_MAX_IDLE_MS) {
+    idleMs = SCHEDULER_MAX_IDLE_MS;
+  }
+  TickType_t ticks = pdMS_TO_TICKS(idleMs);
+  if (ticks == 0) {
+    taskYIELD();
+    return;
+  }
+  vTaskDelay(ticks);
+}
+
+/**
+ * Report a task that ran longer than its budget
+ */
+static void reportTaskOverrun(const char* name, unsigned long runMs, unsigned long budgetMs) {
+  Serial.printf("⏱️  Task '%s' overran: %lu ms (budget %lu ms)\n", name, runMs, budgetMs);
+}
+
+/**
+ * Send the next slice of buffered telemetry (the count queued is not needed here)
+ */
+static void runFlushStep() {
+  serviceBufferFlush();
+}
+
+/**
+ * Take float switch changes (the tank level is an event source, not sampled)
+ * The tank level task has already cut the pump; this updates the level the
+ * control rules see and publishes the alert without waiting for telemetry
+ */
+static void processTankEvents() {
+  TankLevelEvent event;
+  while (takeTankLevelEvent(event)) {
+    sensedTankLevel = event.hasWater;
+    if (!event.hasWater) {
+      tankEmptiedSinceSample = true;
+    }
+    
+    unsigned long ageMs = millis() - event.atMs;
+    Serial.printf("%s Tank %s %lu ms ago%s\n", event.hasWater ? "🚰" : "🚨",
+                  event.hasWater ? "refilled" : "EMPTY", ageMs,
+                  event.pumpCut ? " - pump stopped" : "");
+    publishTankAlert(!event.hasWater, event.pumpCut, clockTimestamp() - ageMs / 1000);
+  }
+}
+
+/**
+ * Register every periodic job of loop() with the scheduler
+ * Sensors and control share a period; control is registered second, so it
+ * always runs right after the sensor read it uses
+ */
+static void registerTasks() {
+  #ifndef TEST_MODE
+    unsigned long firstSensorRead = DHT_STABILIZATION_DELAY_MS; // DHT stabilization (only in production)
+  #else
+    unsigned long firstSensorRead = 0;
+  #endif
+  
+  scheduler.setIdleHook(idleUntilNextTask);
+  scheduler.setOverrunHook(reportTaskOverrun);
+  
+  // Apply NTP syncs (re-stamps buffered readings on the first one)
+  scheduler.every("clock", updateClock, CLOCK_UPDATE_INTERVAL_MS);
+  // HTTP requests
+  scheduler.every("web", processWebServer, WEB_POLL_INTERVAL_MS, 0, WEB_TASK_BUDGET_MS);
+  // Float switch changes -> tank alerts (the pump cut-off does not wait for this)
+  scheduler.every("tank", processTankEvents, TANK_POLL_INTERVAL_MS);
+  // Setpoints and publish results from the network task
+  scheduler.every("mqtt", processMQTT, MQTT_POLL_INTERVAL_MS, 0, MQTT_TASK_BUDGET_MS);
+  // MQTT state changes (starts the buffer flush after a reconnect)
+  scheduler.every("reconnect", handleMQTTReconnection, RECONNECT_CHECK_INTERVAL_MS);
+  // Next slice of buffered telemetry (bounded, non-blocking)
+  scheduler.every("flush", runFlushStep, MQTT_POLL_INTERVAL_MS, 0, MQTT_TASK_BUDGET_MS);
+  // Sensors and control run fast so actuators (pump duration, heating, fan)
+  // react within CONTROL_INTERVAL_MS
+  scheduler.every("sensors", runSensorCycle, CONTROL_INTERVAL_MS, firstSensorRead);
+  scheduler.every("control", runControlCycle, CONTROL_INTERVAL_MS, firstSensorRead);
+  // Telemetry keeps its own slower cadence
+  scheduler.every("telemetry", runTelemetryCycle, TELEMETRY_INTERVAL_MS, TELEMETRY_INTERVAL_MS);
+}
 
 void setup() {
   Serial.begin(115200);
@@ -56,6 +167,7 @@ void setup() {
   initHumiditySensor();
   initLightSensor();
   initTankLevelSensor();
+  sensedTankLevel = readTankLevel();
   
   // Initialize all actuators (relays)
   Serial.println("\nInitializing actuators...");
@@ -69,8 +181,9 @@ void setup() {
   
   // Initialize circular buffers
   Serial.println("\nInitializing buffers...");
-  initBuffer1Min();
-  initBuffer10Min();
+  initBuffers();
+  initBufferJournal();
+  initClock();
   
   // Initialize WiFi and MQTT
   initWiFi();
@@ -80,181 +193,202 @@ void setup() {
   Serial.println("\nInitializing web server...");
   initWebServer();
   
-  // Attempt initial MQTT connection
-  if (connectMQTT()) {
-    Serial.println("\n✅ System ready with MQTT!");
-  } else {
-    Serial.println("\n✅ System ready (MQTT offline)!");
-  }
+  // Broker I/O runs on its own task (connects in the background)
+  startNetworkTask();
   
-  #ifndef TEST_MODE
-    delay(DHT_STABILIZATION_DELAY_MS); // DHT stabilization (only in production)
-  #endif
+  registerTasks();
+  Serial.printf("\n✅ System ready (%u tasks, MQTT connecting in background)!\n",
+                (unsigned)scheduler.taskCount());
 }
 
 // Helper function to format timestamp
 String getFormattedTimestamp() {
-  char timestamp[30];
-  struct tm timeinfo;
+  char timestamp[TIMESTAMP_BUFFER_SIZE];
+  formatClockTime(timestamp, sizeof(timestamp)); // UTC, or uptime before NTP sync
+  return String(timestamp);
+}
+
+/**
+ * Fast cycle, part 1: read all sensors
+ * Temperature and humidity are the DHT sampler's latest filtered values
+ * (no bus access here)
+ */
+void runSensorCycle() {
+  sensedTemperature = readTemperature();
+  sensedHumidity = readHumidity();
+  sensedLight = readLight();
+  // Tank level arrives as events (processTankEvents)
+}
+
+/**
+ * Fast cycle, part 2: run the control rules on the latest readings and
+ * fold them into the telemetry window
+ */
+void runControlCycle() {
+  executeControlLogic(sensedTemperature, sensedHumidity, sensedLight, sensedTankLevel);
   
-  // Try to get real time from NTP (UTC)
-  if (getLocalTime(&timeinfo)) {
-    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S+00", &timeinfo);
-  } else {
-    // Fallback to uptime-based timestamp
-    unsigned long totalSeconds = millis() / 1000;
-    unsigned long hours = (totalSeconds / 3600) % 24;
-    unsigned long minutes = (totalSeconds / 60) % 60;
-    unsigned long seconds = totalSeconds % 60;
-    sprintf(timestamp, "UPTIME %02lu:%02lu:%02lu", hours, minutes, seconds);
-  }
+  // Update web server with current readings
+  updateCurrentReadings(sensedTemperature, sensedHumidity, sensedLight, sensedTankLevel,
+                       isActuatorOn(ACTUATOR_PUMP), isActuatorOn(ACTUATOR_HEATING),
+                       isActuatorOn(ACTUATOR_LED), isActuatorOn(ACTUATOR_FAN));
   
-  return String(timestamp);
+  TelemetryReading sample = {};
+  sample.temperature = sensedTemperature;
+  sample.humidity = sensedHumidity;
+  sample.light = sensedLight;
+  sample.tankLevel = sensedTankLevel && !tankEmptiedSinceSample;  // Keeps a short empty spell
+  tankEmptiedSinceSample = false;
+  sample.pumpOn = isActuatorOn(ACTUATOR_PUMP);
+  sample.lightsOn = isActuatorOn(ACTUATOR_LED);
+  sample.valid = true;
+  telemetryWindow.add(sample);
 }
 
-void loop() {
-  unsigned long currentTime = millis();
+/**
+ * Slow cycle: publish the telemetry window (means, min/max and events over
+ * TELEMETRY_INTERVAL_MS) and report status
+ */
+void runTelemetryCycle() {
+  Serial.println("\n╔════════════════════════════════════════════════════════╗");
+  Serial.print("║ CYCLE START @ ");
+  Serial.print(getFormattedTimestamp());
+  Serial.println("              ║");
+  Serial.println("╚════════════════════════════════════════════════════════╝");
   
-  // Process web server (handles HTTP requests)
-  processWebServer();
+  TelemetryReading window;
+  telemetryWindow.finalize(window);
+  telemetryWindow.reset();
   
-  // Process MQTT (handles incoming messages) - always process
-  processMQTT();
+  // 1. Window averages
+  Serial.printf("\n[1/4] SENSOR READINGS (mean of %u samples):\n", (unsigned)window.samples);
   
-  // Handle MQTT reconnection - ALWAYS check to detect state changes
-  handleMQTTReconnection();
+  Serial.print("  Temperature ... ");
+  if (window.temperature != SENSOR_ERROR_TEMP) {
+    Serial.print(window.temperature, 1);
+    Serial.println(" °C");
+  } else {
+    Serial.println("ERROR");
+  }
   
-  // Execute one complete cycle every CYCLE_INTERVAL
-  if (currentTime - lastCycleTime >= CYCLE_INTERVAL) {
-    lastCycleTime = currentTime;
-    
-    Serial.println("\n╔════════════════════════════════════════════════════════╗");
-    Serial.print("║ CYCLE START @ ");
-    Serial.print(getFormattedTimestamp());
-    Serial.println("              ║");
-    Serial.println("╚════════════════════════════════════════════════════════╝");
-    
-    // 1. Read all sensors
-    Serial.println("\n[1/4] SENSOR READINGS:");
-    float temperature = readTemperature();
-    float humidity = readHumidity();
-    float light = readLight();
-    bool tankLevel = readTankLevel();
-    
-    Serial.print("  Temperature ... ");
-    if (temperature != SENSOR_ERROR_TEMP) {
-      Serial.print(temperature, 1);
-      Serial.println(" °C");
-    } else {
-      Serial.println("ERROR");
-    }
-    
-    Serial.print("  Humidity ...... ");
-    if (humidity != SENSOR_ERROR_HUM) {
-      Serial.print(humidity, 1);
-      Serial.println(" %");
-    } else {
-      Serial.println("ERROR");
-    }
-    
-    Serial.print("  Light ......... ");
-    if (light >= 0) {
-      Serial.print(light, 0);
-      Serial.println(" lux");
-    } else {
-      Serial.println("N/A");
-    }
-    
-    Serial.print("  Water Tank .... ");
-    Serial.println(tankLevel ? "OK" : "EMPTY");
-    
-    // 2. Execute automatic control logic
-    Serial.println("\n[2/4] CONTROL LOGIC:");
-    executeControlLogic(temperature, humidity, light, tankLevel);
-    
-    // Get irrigation info for display
-    bool isCurrentlyIrrigating;
-    unsigned long timeRemaining = getIrrigationInfo(isCurrentlyIrrigating);
-    
-    Serial.print("  Fan ........... ");
-    Serial.println(isFanOn() ? "ON" : "OFF");
-    
-    Serial.print("  Heating ....... ");
-    Serial.println(isHeatingOn() ? "ON" : "OFF");
-    
-    Serial.print("  LED ........... ");
-    Serial.println(isLEDOn() ? "ON" : "OFF");
-    
-    Serial.print("  Pump .......... ");
-    if (isPumpOn()) {
-      Serial.print("ON (");
-      Serial.print(timeRemaining / 1000);
-      Serial.println("s left)");
-    } else {
-      Serial.print("OFF (next: ");
-      unsigned long minutes = timeRemaining / 60000;
-      unsigned long seconds = (timeRemaining % 60000) / 1000;
-      if (minutes > 0) {
-        Serial.print(minutes);
-        Serial.print("m ");
-      }
-      Serial.print(seconds);
-      Serial.println("s)");
-    }
-    
-    // Update web server with current readings
-    updateCurrentReadings(temperature, humidity, light, tankLevel,
-                         isPumpOn(), isHeatingOn(), isLEDOn(), isFanOn());
-    
-    // 3. Publish telemetry
-    Serial.println("\n[3/4] MQTT TELEMETRY:");
-    bool pumpStatus = isPumpOn();
-    bool ledStatus = isLEDOn();
-    
-    Serial.print("  Connection .... ");
-    Serial.println(isMQTTConnected() ? "CONNECTED" : "OFFLINE");
-    
-    Serial.print("  Publishing .... ");
-    if (publishTelemetry(temperature, humidity, light, tankLevel, pumpStatus, ledStatus)) {
-      Serial.println(isMQTTConnected() ? "SUCCESS" : "BUFFERED");
-    } else {
-      Serial.println("FAILED");
-    }
-    
-    // Show buffer status
-    int buffer1Count = get1MinBufferCount();
-    int buffer2Count = get10MinBufferCount();
-    if (buffer1Count > 0 || buffer2Count > 0) {
-      Serial.print("  Buffer Status . B1:");
-      Serial.print(buffer1Count);
-      Serial.print("/10  B2:");
-      Serial.print(buffer2Count);
-      Serial.println("/10");
+  Serial.print("  Humidity ...... ");
+  if (window.humidity != SENSOR_ERROR_HUM) {
+    Serial.print(window.humidity, 1);
+    Serial.println(" %");
+  } else {
+    Serial.println("ERROR");
+  }
+  
+  Serial.print("  Light ......... ");
+  if (window.light >= 0) {
+    Serial.print(window.light, 0);
+    Serial.println(" lux");
+  } else {
+    Serial.println("N/A");
+  }
+  
+  Serial.print("  Water Tank .... ");
+  Serial.println(window.tankLevel ? "OK" : "EMPTY");
+  
+  // 2. Actuator states (control runs every CONTROL_INTERVAL_MS)
+  Serial.println("\n[2/4] CONTROL LOGIC:");
+  
+  // Get irrigation info for display
+  bool isCurrentlyIrrigating;
+  unsigned long timeRemaining = getIrrigationInfo(isCurrentlyIrrigating);
+  
+  Serial.print("  Fan ........... ");
+  Serial.println(isActuatorOn(ACTUATOR_FAN) ? "ON" : "OFF");
+  
+  Serial.print("  Heating ....... ");
+  Serial.println(isActuatorOn(ACTUATOR_HEATING) ? "ON" : "OFF");
+  
+  Serial.print("  LED ........... ");
+  Serial.println(isActuatorOn(ACTUATOR_LED) ? "ON" : "OFF");
+  
+  Serial.print("  Pump .......... ");
+  if (isActuatorOn(ACTUATOR_PUMP)) {
+    Serial.print("ON (");
+    Serial.print(timeRemaining / 1000);
+    Serial.println("s left)");
+  } else {
+    Serial.print("OFF (next: ");
+    unsigned long minutes = timeRemaining / 60000;
+    unsigned long seconds = (timeRemaining % 60000) / 1000;
+    if (minutes > 0) {
+      Serial.print(minutes);
+      Serial.print("m ");
     }
-    
-    // 4. Cycle summary
-    Serial.println("\n[4/4] CYCLE SUMMARY:");
-    Serial.print("  Next cycle .... ");
-    Serial.print(CYCLE_INTERVAL / 1000);
-    Serial.println("s");
-    Serial.print("  Uptime ........ ");
-    unsigned long uptimeSeconds = currentTime / 1000;
-    unsigned long uptimeMinutes = uptimeSeconds / 60;
-    unsigned long uptimeHours = uptimeMinutes / 60;
-    if (uptimeHours > 0) {
-      Serial.print(uptimeHours);
-      Serial.print("h ");
+    Serial.print(seconds);
+    Serial.println("s)");
+  }
+  
+  // 3. Publish telemetry
+  Serial.println("\n[3/4] MQTT TELEMETRY:");
+  
+  Serial.print("  Connection .... ");
+  Serial.println(isMQTTConnected() ? "CONNECTED" : "OFFLINE");
+  
+  Serial.print("  Publishing .... ");
+  if (publishTelemetry(window)) {
+    Serial.println(isMQTTConnected() ? "QUEUED" : "BUFFERED");
+  } else {
+    Serial.println("FAILED");
+  }
+  
+  // Persist buffer changes (batched)
+  syncBufferJournal();
+  
+  // Periodic buffer health report
+  publishBufferStats();
+  
+  // Show buffer status
+  if (hasBufferedData()) {
+    Serial.print("  Buffer Status .");
+    for (int tier = 0; tier < getBufferTierCount(); tier++) {
+      Serial.print(" ");
+      Serial.print(getBufferTierName(tier));
+      Serial.print(":");
+      Serial.print(getBufferCount(tier));
+      Serial.print("/");
+      Serial.print(getBufferCapacity(tier));
     }
-    if (uptimeMinutes % 60 > 0) {
-      Serial.print(uptimeMinutes % 60);
-      Serial.print("m ");
+    Serial.println();
+  }
+  
+  // 4. Cycle summary
+  Serial.println("\n[4/4] CYCLE SUMMARY:");
+  Serial.print("  Next cycle .... ");
+  Serial.print(TELEMETRY_INTERVAL_MS / 1000);
+  Serial.println("s");
+  Serial.print("  Uptime ........ ");
+  unsigned long uptimeSeconds = (unsigned long)(uptimeMs() / 1000); // millis() wraps after 49 days
+  unsigned long uptimeMinutes = uptimeSeconds / 60;
+  unsigned long uptimeHours = uptimeMinutes / 60;
+  if (uptimeHours > 0) {
+    Serial.print(uptimeHours);
+    Serial.print("h ");
+  }
+  if (uptimeMinutes % 60 > 0) {
+    Serial.print(uptimeMinutes % 60);
+    Serial.print("m ");
+  }
+  Serial.print(uptimeSeconds % 60);
+  Serial.println("s");
+  
+  uint32_t overruns = 0;
+  TaskStats stats;
+  for (int id = 0; id < SCHEDULER_MAX_TASKS; id++) {
+    if (scheduler.stats(id, stats)) {
+      overruns += stats.overruns;
     }
-    Serial.print(uptimeSeconds % 60);
-    Serial.println("s");
-    
-    Serial.println("\n────────────────────────────────────────────────────────");
   }
+  Serial.print("  Task overruns . ");
+  Serial.println(overruns);
   
-  // Small delay to prevent CPU hogging
-  delay(LOOP_DELAY_MS);
+  Serial.println("\n────────────────────────────────────────────────────────");
+}
+
+void loop() {
+  // Runs due tasks, then blocks until the next one (no fixed delay)
+  scheduler.tick();
 }
@@ -0,0 +1,82 @@
+/**
+ * @file ack_client.cpp
+ * @brief Network client that reports PUBACKs to the delivery window
+ */
+
+#include "ack_client.h"
+
+/**
+ * A new connection starts at a packet boundary
+ */
+void AckTrackingClient::beginSession() {
+  scanner_.reset();
+  sessions_++;
+}
+
+int AckTrackingClient::connect(IPAddress ip, uint16_t port) {
+  beginSession();
+  return inner_.connect(ip, port);
+}
+
+int AckTrackingClient::connect(const char* host, uint16_t port) {
+  beginSession();
+  return inner_.connect(host, port);
+}
+
+int AckTrackingClient::connect(IPAddress ip, uint16_t port, int32_t timeout) {
+  beginSession();
+  return inner_.connect(ip, port, timeout);
+}
+
+int AckTrackingClient::connect(const char* host, uint16_t port, int32_t timeout) {
+  beginSession();
+  return inner_.connect(host, port, timeout);
+}
+
+size_t AckTrackingClient::write(uint8_t byte) {
+  return inner_.write(byte);
+}
+
+size_t AckTrackingClient::write(const uint8_t* buffer, size_t size) {
+  return inner_.write(buffer, size);
+}
+
+int AckTrackingClient::available() {
+  return inner_.available();
+}
+
+int AckTrackingClient::read() {
+  int byte = inner_.read();
+  if (byte >= 0) {
+    scanner_.feed((uint8_t)byte);
+  }
+  return byte;
+}
+
+int AckTrackingClient::read(uint8_t* buffer, size_t size) {
+  int count = inner_.read(buffer, size);
+  if (count > 0) {
+    scanner_.feed(buffer, (size_t)count);
+  }
+  return count;
+}
+
+int AckTrackingClient::peek() {
+  return inner_.peek();
+}
+
+void AckTrackingClient::flush() {
+  inner_.flush();
+}
+
+void AckTrackingClient::stop() {
+  inner_.stop();
+}
+
+uint8_t AckTrackingClient::connected() {
+  return inner_.connected();
+}
+
+AckTrackingClient::operator bool() {
+  return (bool)inner_;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file ack_client.h
+ * @brief Network client that reports PUBACKs to the delivery window
+ *
+ * Sits between PubSubClient and the WiFiClient socket. Every call is
+ * passed through unchanged; bytes read from the broker are also fed to a
+ * PubAckScanner, so PUBACKs that PubSubClient ignores reach the network
+ * task's in-flight window (see network_task.cpp).
+ */
+
+#ifndef ACK_CLIENT_H
+#define ACK_CLIENT_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include <WiFi.h>
+#include "mqtt_packet.h"
+
+class AckTrackingClient : public Client {
+public:
+  /**
+   * @param inner Socket to wrap
+   * @param handler Called with the packet id of each PUBACK read
+   */
+  AckTrackingClient(WiFiClient& inner, PubAckScanner::AckHandler handler)
+    : inner_(inner), scanner_(handler), sessions_(0) {}
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char* host, uint16_t port) override;
+  int connect(IPAddress ip, uint16_t port, int32_t timeout);
+  int connect(const char* host, uint16_t port, int32_t timeout);
+  size_t write(uint8_t byte) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buffer, size_t size) override;
+  int peek() override;
+  void flush() override;
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override;
+
+  /**
+   * Number of connections opened so far
+   * Packets sent before the current one started must be sent again
+   */
+  uint32_t sessions() const { return sessions_; }
+
+private:
+  void beginSession();
+
+  WiFiClient& inner_;
+  PubAckScanner scanner_;
+  uint32_t sessions_;
+};
+
+#endif // ACK_CLIENT_H
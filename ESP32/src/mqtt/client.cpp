@@ -1,69 +1,209 @@
 /**
  * @file client.cpp
  * @brief MQTT client implementation with WiFi and JSON support
+ * 
+ * Runs on the control loop: builds payloads, queues them for the network
+ * task (network_task.cpp) and applies the results it reports back. Only
+ * connectMQTT() touches the broker, and it is called from the network task.
  */
 
 #include <Arduino.h>
 #include <WiFi.h>
 #include <PubSubClient.h>
-#include <ArduinoJson.h>
-#include <time.h>
 #include "../config.h"
 #include "../constants.h"
+#include "../actuators/actuators.h"
+#include "../clock/clock.h"
 #include "../control/control.h"
+#include "../sensors/sensors.h"
 #include "../buffer/buffer.h"
+#include "../buffer/ring_buffer.h"
+#include "ack_client.h"
+#include "json_writer.h"
 #include "mqtt.h"
+#include "network.h"
+#include "reconnect_policy.h"
+#include "report_filter.h"
+#include "setpoint_parser.h"
+#include "telemetry_codec.h"
+#include "token_bucket.h"
 
 WiFiClient wifiClient;
-PubSubClient mqttClient(wifiClient);
-bool ntpSynced = false;
+AckTrackingClient ackClient(wifiClient, handlePubAck);
+PubSubClient mqttClient(ackClient);
 
 // Sequence counter for message ordering (must be positive, incrementing)
 static unsigned long sequenceCounter = 0;
 
 // Topic buffers
 char telemetryTopic[MQTT_TOPIC_BUFFER_SIZE];
+char telemetryBatchTopic[MQTT_TOPIC_BUFFER_SIZE];
+char telemetryBinaryTopic[MQTT_TOPIC_BUFFER_SIZE];
 char setpointTopic[MQTT_TOPIC_BUFFER_SIZE];
+char ruleTopic[MQTT_TOPIC_BUFFER_SIZE];
+char bufferStatsTopic[MQTT_TOPIC_BUFFER_SIZE];
+char alertTopic[MQTT_TOPIC_BUFFER_SIZE];
+
+// Telemetry encoding (binary needs DEVICE_ID as a 16-byte UUID)
+#ifdef TELEMETRY_BINARY
+static TelemetryEncoding telemetryEncoding = TELEMETRY_ENCODING_BINARY;
+#else
+static TelemetryEncoding telemetryEncoding = TELEMETRY_ENCODING_JSON;
+#endif
+static uint8_t deviceUuid[16];
+static bool deviceUuidValid = false;
+
+static_assert(MQTT_FLUSH_MAX_RECORDS_PER_STEP <= 255, "Binary messages hold at most 255 records");
+
+// Last buffer statistics publish (ms)
+static unsigned long lastBufferStatsPublish = 0;
+
+// Live reading queued for publish (re-buffered if the publish fails)
+static bool liveInFlight = false;
+static TelemetryReading liveInFlightReading;
+
+#ifdef TELEMETRY_REPORT_BY_EXCEPTION
+// Holds back live readings that add nothing to the last published one
+static ReportFilter reportFilter(TELEMETRY_DEADBAND_TEMP, TELEMETRY_DEADBAND_HUM,
+                                 TELEMETRY_DEADBAND_LIGHT, TELEMETRY_HEARTBEAT_MS);
+#endif
+
+// Incremental buffer flush state
+enum FlushState {
+  FLUSH_IDLE,
+  FLUSH_ACTIVE
+};
+static FlushState flushState = FLUSH_IDLE;
+static int flushSentCount = 0;
+static unsigned long flushStartTime = 0;
+static TokenBucket flushBucket(MQTT_FLUSH_BURST, MQTT_FLUSH_RATE_PER_SEC);
+static int flushInFlight = 0; // Readings covered by flush messages awaiting PUBACK
+
+// Readings that arrive while flush messages are in flight. The buffer is
+// left untouched until their results are back, so the oldest `flushInFlight`
+// entries are still the ones that were sent.
+static RingBuffer<TelemetryReading, MQTT_DEFERRED_READINGS> deferredReadings;
+
+// Alert waiting for its PUBACK
+struct TankAlert {
+  bool empty;               // Raised (true) or cleared
+  bool pumpStopped;         // The cut-off stopped a running pump
+  uint32_t timestamp;       // When the level changed
+};
+
+// Alerts not yet acknowledged, oldest first. The first `alertsInFlight`
+// are queued for publish; one that fails moves to the back and is sent
+// again, so every alert carries its own timestamp.
+static RingBuffer<TankAlert, ALERT_PENDING_DEPTH> pendingAlerts;
+static size_t alertsInFlight = 0;
 
 /**
- * Callback for incoming MQTT messages
+ * Take a received setpoint if it is present and differs from the current one
+ * @param command Parsed message
+ * @param field Field to check
+ * @param received Value from the message
+ * @param current Current value (updated)
+ * @param changed Mask of changed fields (updated)
  */
-void mqttCallback(char* topic, byte* payload, unsigned int length) {
-  Serial.print("📥 Message received on topic: ");
-  Serial.println(topic);
-  
-  // Convert payload to string
-  char message[length + 1];
-  memcpy(message, payload, length);
-  message[length] = '\0';
-  
+template <typename T>
+static void overlaySetpoint(const SetpointCommand& command, uint8_t field, T received,
+                            T& current, uint16_t& changed) {
+  if ((command.present & SETPOINT_FIELD_BIT(field)) && received != current) {
+    current = received;
+    changed |= SETPOINT_FIELD_BIT(field);
+  }
+}
+
+/**
+ * Apply a message received on the setpoints topic
+ * Only the fields present in the message are updated; missing, malformed
+ * or out-of-range fields keep their current value
+ * @param message JSON payload (copied by the network task)
+ * @param length Payload length
+ * @return Mask of changed fields (SETPOINT_FIELD_BIT)
+ */
+static uint16_t applySetpointMessage(const char* message, size_t length) {
   Serial.print("Payload: ");
   Serial.println(message);
   
-  // Parse JSON
-  JsonDocument doc;
-  DeserializationError error = deserializeJson(doc, message);
+  SetpointCommand command;
+  SetpointParseResult result = parseSetpointCommand(message, length, command);
+  if (result != SETPOINT_PARSE_OK) {
+    Serial.println(result == SETPOINT_PARSE_TOO_LARGE ? "❌ Setpoint message too large"
+                                                      : "❌ Setpoint message is not a JSON object");
+    return 0;
+  }
   
-  if (error) {
-    Serial.print("❌ JSON parsing failed: ");
-    Serial.println(error.c_str());
-    return;
+  float temp_min, temp_max, hum_air_max, light_intensity;
+  unsigned long irrigation_interval, irrigation_duration;
+  getCurrentSetpoints(temp_min, temp_max, hum_air_max, light_intensity,
+                      irrigation_interval, irrigation_duration);
+  
+  // The temperature band must stay ordered once merged with the current values
+  const uint16_t tempBits = SETPOINT_FIELD_BIT(SETPOINT_TEMP_MIN) | SETPOINT_FIELD_BIT(SETPOINT_TEMP_MAX);
+  float merged_min = (command.present & SETPOINT_FIELD_BIT(SETPOINT_TEMP_MIN)) ? command.tempMin : temp_min;
+  float merged_max = (command.present & SETPOINT_FIELD_BIT(SETPOINT_TEMP_MAX)) ? command.tempMax : temp_max;
+  if ((command.present & tempBits) && merged_min >= merged_max) {
+    command.rejected |= command.present & tempBits;
+    command.present &= (uint16_t)~tempBits;
   }
   
-  // Extract setpoints from JSON
-  // Database schema: target_temp_min, target_temp_max, target_hum_air_max,
-  // irrigation_interval_minutes, irrigation_duration_seconds, target_light_intensity
+  uint16_t changed = 0;
+  overlaySetpoint(command, SETPOINT_TEMP_MIN, command.tempMin, temp_min, changed);
+  overlaySetpoint(command, SETPOINT_TEMP_MAX, command.tempMax, temp_max, changed);
+  overlaySetpoint(command, SETPOINT_HUM_AIR_MAX, command.humAirMax, hum_air_max, changed);
+  overlaySetpoint(command, SETPOINT_LIGHT_INTENSITY, command.lightIntensity, light_intensity, changed);
+  overlaySetpoint(command, SETPOINT_IRRIGATION_INTERVAL, command.irrigationIntervalMinutes,
+                  irrigation_interval, changed);
+  overlaySetpoint(command, SETPOINT_IRRIGATION_DURATION, command.irrigationDurationSeconds,
+                  irrigation_duration, changed);
+  
+  if (changed != 0) {
+    updateSetpoints(temp_min, temp_max, hum_air_max, light_intensity,
+                    irrigation_interval, irrigation_duration);
+  }
+  
+  // Heating PID gains (missing ones keep their current value)
+  float heating_kp, heating_ki, heating_kd;
+  getHeatingGains(heating_kp, heating_ki, heating_kd);
+  uint16_t gainsChanged = 0;
+  overlaySetpoint(command, SETPOINT_HEATING_KP, command.heatingKp, heating_kp, gainsChanged);
+  overlaySetpoint(command, SETPOINT_HEATING_KI, command.heatingKi, heating_ki, gainsChanged);
+  overlaySetpoint(command, SETPOINT_HEATING_KD, command.heatingKd, heating_kd, gainsChanged);
+  if (gainsChanged != 0) {
+    setHeatingGains(heating_kp, heating_ki, heating_kd);
+    changed |= gainsChanged;
+  }
   
-  float temp_min = doc["target_temp_min"] | DEFAULT_TEMP_MIN;
-  float temp_max = doc["target_temp_max"] | DEFAULT_TEMP_MAX;
-  float hum_air_max = doc["target_hum_air_max"] | DEFAULT_HUM_AIR_MAX;
-  float light_intensity = doc["target_light_intensity"] | DEFAULT_LIGHT_INTENSITY;
-  unsigned long irrigation_interval = doc["irrigation_interval_minutes"] | DEFAULT_IRRIGATION_INTERVAL_MINUTES;
-  unsigned long irrigation_duration = doc["irrigation_duration_seconds"] | DEFAULT_IRRIGATION_DURATION_SECONDS;
+  // Optional telemetry encoding switch
+  if (command.present & SETPOINT_FIELD_BIT(SETPOINT_TELEMETRY_ENCODING)) {
+    TelemetryEncoding previous = getTelemetryEncoding();
+    setTelemetryEncoding(command.telemetryEncoding);
+    if (getTelemetryEncoding() != previous) {
+      changed |= SETPOINT_FIELD_BIT(SETPOINT_TELEMETRY_ENCODING);
+    }
+  }
+  
+  // Report what the message did
+  for (uint8_t field = 0; field < SETPOINT_FIELD_COUNT; field++) {
+    if (command.rejected & SETPOINT_FIELD_BIT(field)) {
+      Serial.printf("⚠️  Setpoint %s rejected (invalid or out of range)\n", getSetpointFieldName(field));
+    }
+  }
+  if (changed == 0) {
+    Serial.println("ℹ️  Setpoints unchanged");
+  } else {
+    Serial.print("✅ Changed:");
+    for (uint8_t field = 0; field < SETPOINT_FIELD_COUNT; field++) {
+      if (changed & SETPOINT_FIELD_BIT(field)) {
+        Serial.print(" ");
+        Serial.print(getSetpointFieldName(field));
+      }
+    }
+    Serial.println();
+  }
   
-  // Update control logic setpoints
-  updateSetpoints(temp_min, temp_max, hum_air_max, light_intensity, 
-                  irrigation_interval, irrigation_duration);
+  return changed;
 }
 
 /**
@@ -98,32 +238,26 @@ void initWiFi() {
     attempts++;
   }
   
+  // SNTP keeps retrying in the background until the network is up
+  startClockSync();
+  
   if (WiFi.status() == WL_CONNECTED) {
     Serial.println("\n✅ WiFi connected!");
     Serial.print("Station IP address: ");
     Serial.println(WiFi.localIP());
     
-    // Initialize NTP time synchronization
+    // Give the first NTP sync a moment so early readings get Unix time
     Serial.println("\n⏰ Synchronizing time with NTP...");
-    configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, NTP_SERVER);
-    
-    // Wait for time to be set
-    struct tm timeinfo;
     int ntpAttempts = 0;
-    while (!getLocalTime(&timeinfo) && ntpAttempts < NTP_MAX_SYNC_ATTEMPTS) {
+    while (!isClockSynced() && ntpAttempts < NTP_MAX_SYNC_ATTEMPTS) {
       Serial.print(".");
       delay(NTP_SYNC_RETRY_DELAY_MS);
+      updateClock();
       ntpAttempts++;
     }
     
-    if (getLocalTime(&timeinfo)) {
-      ntpSynced = true;
-      Serial.println("\n✅ Time synchronized!");
-      Serial.print("Current time: ");
-      Serial.println(&timeinfo, "%Y-%m-%d %H:%M:%S");
-    } else {
-      Serial.println("\n⚠️  Time sync failed, will use uptime-based timestamps");
-      ntpSynced = false;
+    if (!isClockSynced()) {
+      Serial.println("\n⚠️  Time sync pending - readings are buffered until it arrives");
     }
   } else {
     Serial.println("\n⚠️  WiFi connection failed!");
@@ -135,6 +269,13 @@ void initWiFi() {
  * Initialize MQTT client
  */
 void initMQTT() {
+  // Binary telemetry carries the device ID as 16 raw bytes
+  deviceUuidValid = parseUuid(DEVICE_ID, deviceUuid);
+  if (!deviceUuidValid && telemetryEncoding == TELEMETRY_ENCODING_BINARY) {
+    Serial.println("⚠️  DEVICE_ID is not a UUID - using JSON telemetry");
+    telemetryEncoding = TELEMETRY_ENCODING_JSON;
+  }
+  
   if (WiFi.status() != WL_CONNECTED) {
     Serial.println("⚠️  WiFi not connected, skipping MQTT initialization");
     return;
@@ -146,17 +287,57 @@ void initMQTT() {
   
   // Build topic strings
   snprintf(telemetryTopic, sizeof(telemetryTopic), "greenhouse/%s/telemetry", GREENHOUSE_ID);
+  snprintf(telemetryBatchTopic, sizeof(telemetryBatchTopic), "greenhouse/%s/telemetry/batch", GREENHOUSE_ID);
+  snprintf(telemetryBinaryTopic, sizeof(telemetryBinaryTopic), "greenhouse/%s/telemetry/bin", GREENHOUSE_ID);
+  snprintf(bufferStatsTopic, sizeof(bufferStatsTopic), "greenhouse/%s/buffer_stats", GREENHOUSE_ID);
+  snprintf(alertTopic, sizeof(alertTopic), "greenhouse/%s/alerts", GREENHOUSE_ID);
   snprintf(setpointTopic, sizeof(setpointTopic), "greenhouse/%s/setpoints", GREENHOUSE_ID);
+  snprintf(ruleTopic, sizeof(ruleTopic), "greenhouse/%s/config/rules", GREENHOUSE_ID);
   
   Serial.println("📡 MQTT client initialized");
   Serial.print("Telemetry topic: ");
   Serial.println(telemetryTopic);
+#ifdef TELEMETRY_BATCH_FLUSH
+  Serial.print("Telemetry batch topic: ");
+  Serial.println(telemetryBatchTopic);
+#endif
   Serial.print("Setpoint topic: ");
   Serial.println(setpointTopic);
+  Serial.print("Rule topic: ");
+  Serial.println(ruleTopic);
+  Serial.print("Alert topic: ");
+  Serial.println(alertTopic);
+  Serial.printf("Telemetry encoding: %s\n",
+                telemetryEncoding == TELEMETRY_ENCODING_BINARY ? "binary" : "JSON");
+}
+
+/**
+ * Select the encoding for subsequent telemetry messages
+ * Binary is refused if DEVICE_ID is not a UUID
+ * @param encoding New encoding
+ */
+void setTelemetryEncoding(TelemetryEncoding encoding) {
+  if (encoding == telemetryEncoding) {
+    return;
+  }
+  if (encoding == TELEMETRY_ENCODING_BINARY && !deviceUuidValid) {
+    Serial.println("⚠️  Binary telemetry needs DEVICE_ID to be a UUID");
+    return;
+  }
+  telemetryEncoding = encoding;
+  Serial.printf("📡 Telemetry encoding: %s\n",
+                encoding == TELEMETRY_ENCODING_BINARY ? "binary" : "JSON");
 }
 
 /**
- * Connect to MQTT broker
+ * Get the current telemetry encoding
+ */
+TelemetryEncoding getTelemetryEncoding() {
+  return telemetryEncoding;
+}
+
+/**
+ * Connect to MQTT broker (network task only - may block for seconds)
  * @return true if connected, false otherwise
  */
 bool connectMQTT() {
@@ -190,6 +371,14 @@ bool connectMQTT() {
       Serial.println("❌ Failed to subscribe to setpoints topic");
     }
     
+    // Rule tables are published retained, so the current one arrives on every connect
+    if (mqttClient.subscribe(ruleTopic)) {
+      Serial.print("✅ Subscribed to: ");
+      Serial.println(ruleTopic);
+    } else {
+      Serial.println("❌ Failed to subscribe to rules topic");
+    }
+    
     return true;
   } else {
     Serial.print(" ❌ Failed, rc=");
@@ -199,278 +388,697 @@ bool connectMQTT() {
 }
 
 /**
- * Check if MQTT is connected
- * @return true if connected, false otherwise
+ * Add a reading to the offline buffer, in timestamp order
+ * Held back while flush messages are in flight (see deferredReadings)
+ * @param reading Reading to store
  */
-bool isMQTTConnected() {
-  return mqttClient.connected();
+static void bufferReading(const TelemetryReading& reading) {
+#ifdef TELEMETRY_REPORT_BY_EXCEPTION
+  reportFilter.reset(); // Next live reading is published in full
+#endif
+  
+  if (flushInFlight > 0) {
+    if (!deferredReadings.push(reading)) {
+      Serial.println("⚠️  Deferred readings full - dropped oldest");
+    }
+    if (deferredReadings.full() && !isMQTTConnected()) {
+      // Stop waiting for PUBACKs - the in-flight readings stay buffered
+      // and are sent again by the next flush
+      abandonUnackedMessages();
+    }
+    return;
+  }
+  
+  // Add reading to the tiered buffer in timestamp order (rolls up full tiers)
+  insertIntoBuffer(reading);
+  Serial.printf("📦 Buffered (total: %d)\n", getTotalBufferedCount());
+}
+
+/**
+ * Move readings deferred during a flush message into the buffer
+ */
+static void releaseDeferredReadings() {
+  TelemetryReading reading;
+  while (deferredReadings.pop(reading)) {
+    bufferReading(reading);
+  }
+}
+
+/**
+ * Write the actuator counters since boot: per actuator on time, switches,
+ * rolling duty cycle and energy, then the totals
+ * @param json Destination writer (inside the telemetry object)
+ */
+static void writeActuatorUsageJson(JsonWriter& json) {
+  double energyWh = 0;
+  json.key("actuators");
+  json.beginObject();
+  for (uint8_t actuator = 0; actuator < ACTUATOR_COUNT; actuator++) {
+    ActuatorUsage usage;
+    getActuatorUsage((ActuatorId)actuator, usage);
+    energyWh += usage.energyWh;
+    
+    json.key(getActuatorName((ActuatorId)actuator));
+    json.beginObject();
+    json.member("on", usage.on);
+    json.member("on_time_s", (unsigned long long)(usage.onTimeMs / 1000));
+    json.member("switches", (unsigned long)usage.switches);
+    json.member("duty", usage.duty);
+    json.member("energy_wh", (float)usage.energyWh);
+    json.endObject();
+  }
+  json.endObject();
+  json.member("energy_wh", (float)energyWh);
+  json.member("water_l", (float)getPumpedLitres());
+}
+
+/**
+ * Write the DHT11 filter quality: valid and rejected reads in the window,
+ * failed reads since boot and age of the newest valid read
+ * @param json Destination writer (inside the telemetry object)
+ */
+static void writeSensorQualityJson(JsonWriter& json) {
+  SensorQuality quality[2];
+  getTemperatureQuality(quality[0]);
+  getHumidityQuality(quality[1]);
+  static const char* const NAMES[2] = { "temperature", "humidity" };
+  
+  json.key("sensor_quality");
+  json.beginObject();
+  for (int i = 0; i < 2; i++) {
+    json.key(NAMES[i]);
+    json.beginObject();
+    json.member("valid", (unsigned)quality[i].validSamples);
+    json.member("window", (unsigned)quality[i].windowSize);
+    json.member("rejected", (unsigned)quality[i].rejected);
+    json.member("failures", (unsigned long)quality[i].failures);
+    json.member("age_ms", quality[i].ageMs);
+    json.endObject();
+  }
+  json.endObject();
+}
+
+/**
+ * Write one reading as a telemetry JSON object
+ * Sensor fields are omitted when they hold an error sentinel; aggregated
+ * readings carry their window statistics
+ * @param json Destination writer
+ * @param reading Reading to serialize
+ * @param sequence Sequence number assigned to the reading
+ * @param suppressed Live readings held back since the previous message
+ * @param withUsage Add the actuator counters and sensor quality (live
+ *                  readings only - the counters are cumulative and the
+ *                  quality describes the current filter window)
+ */
+static void writeTelemetryJson(JsonWriter& json, const TelemetryReading& reading, unsigned long sequence,
+                               uint32_t suppressed = 0, bool withUsage = false) {
+  json.beginObject();
+  json.member("device_id", DEVICE_ID);
+  json.member("timestamp", (long long)atol(reading.timestamp));  // Unix timestamp as i64
+  json.member("sequence", (long long)sequence);                  // Sequence number as i64
+  
+  // Only include valid sensor readings
+  if (reading.temperature != SENSOR_ERROR_TEMP) {
+    json.member("temperature", reading.temperature);
+  }
+  if (reading.humidity != SENSOR_ERROR_HUM) {
+    json.member("humidity", reading.humidity);
+  }
+  if (reading.light >= 0) {
+    json.member("light", (double)reading.light);
+  }
+  
+  json.member("tank_level", reading.tankLevel);
+  json.member("irrigated_since_last_transmission", reading.irrigated);
+  json.member("lights_are_on", reading.lightsOn);
+  json.member("pump_on", reading.pumpOn);
+  if (suppressed > 0) {
+    json.member("suppressed", (unsigned long)suppressed);
+  }
+  
+  // Window statistics for aggregated readings
+  if (reading.samples > 1) {
+    json.member("samples", reading.samples);
+    if (reading.temperatureStats.count > 0) {
+      json.member("temperature_min", reading.temperatureStats.min);
+      json.member("temperature_max", reading.temperatureStats.max);
+      json.member("temperature_stddev", reading.temperatureStats.stdDev);
+    }
+    if (reading.humidityStats.count > 0) {
+      json.member("humidity_min", reading.humidityStats.min);
+      json.member("humidity_max", reading.humidityStats.max);
+      json.member("humidity_stddev", reading.humidityStats.stdDev);
+    }
+    if (reading.lightStats.count > 0) {
+      json.member("light_min", reading.lightStats.min);
+      json.member("light_max", reading.lightStats.max);
+      json.member("light_stddev", reading.lightStats.stdDev);
+    }
+    json.member("pump_ran", (reading.events & READING_EVENT_PUMP_RAN) != 0);
+    json.member("lights_ran", (reading.events & READING_EVENT_LIGHTS_RAN) != 0);
+    json.member("tank_was_empty", (reading.events & READING_EVENT_TANK_EMPTY) != 0);
+  }
+  
+  if (withUsage) {
+    writeActuatorUsageJson(json);
+    writeSensorQualityJson(json);
+  }
+  
+  json.endObject();
 }
 
 /**
  * Publish telemetry data to MQTT
- * If MQTT is offline, stores data in circular buffers
- * @param temperature Temperature in Celsius
- * @param humidity Humidity percentage
- * @param light Light intensity
- * @param tankLevel Tank water level status
- * @param pumpOn Pump status
- * @param lightsOn LED status
- * @return true if published successfully or buffered, false on error
+ * The message is queued for the network task; this never blocks on the
+ * broker. If MQTT is offline the reading is stored in the circular
+ * buffers instead. While a buffer flush is in progress the reading is
+ * buffered too, so it is sent after the older readings ahead of it.
+ * Until the clock has synced, readings are buffered with provisional
+ * timestamps, which are rewritten to Unix time when the sync arrives.
+ * With TELEMETRY_REPORT_BY_EXCEPTION a live reading that changes nothing
+ * beyond the deadbands is held back (see report_filter.h)
+ * @param window Control-cycle samples aggregated over the telemetry
+ *               interval (a single sample is sent as a raw reading)
+ * @return true if queued for publish, buffered or held back
  */
-bool publishTelemetry(float temperature, float humidity, float light, 
-                      bool tankLevel, bool pumpOn, bool lightsOn) {
+bool publishTelemetry(const TelemetryReading& window) {
+  // Copy kept for buffering if the publish fails
+  TelemetryReading reading = window;
+  // Store Unix timestamp as string for buffer compatibility (provisional before NTP sync)
+  reading.provisional = !isClockSynced();
+  snprintf(reading.timestamp, sizeof(reading.timestamp), "%lu", (unsigned long)clockTimestamp());
+  reading.valid = true;
+  
   // Check if irrigation occurred since last transmission
-  bool irrigated = checkAndResetIrrigationFlag();
-  
-  // Get Unix timestamp (seconds since epoch)
-  time_t unixTimestamp = 0;
-  if (ntpSynced) {
-    struct tm timeinfo;
-    if (getLocalTime(&timeinfo)) {
-      unixTimestamp = mktime(&timeinfo);
-    } else {
-      // Fallback: use approximate time based on uptime
-      unixTimestamp = 1733100000 + (millis() / 1000); // Base: ~Dec 2025
-      ntpSynced = false;
-    }
-  } else {
-    // Fallback: use approximate time based on uptime
-    unixTimestamp = 1733100000 + (millis() / 1000); // Base: ~Dec 2025
+  reading.irrigated = checkAndResetIrrigationFlag();
+  if (reading.irrigated) {
+    reading.events |= READING_EVENT_IRRIGATED;
+  }
+  
+  // If MQTT is offline or older readings are still being flushed, buffer the data
+  if (!isMQTTConnected() || isBufferFlushActive()) {
+    Serial.println(isMQTTConnected() ? "⏳ Flush in progress - buffering telemetry"
+                                     : "⚠️  MQTT offline - buffering telemetry");
+    bufferReading(reading);
+    return true; // Successfully buffered
+  }
+  
+  // No Unix time yet - keep it buffered until the timestamp can be rewritten
+  if (!isClockSynced()) {
+    Serial.println("⏰ Clock not synced - buffering telemetry");
+    bufferReading(reading);
+    return true;
+  }
+  
+  uint32_t suppressed = 0;
+#ifdef TELEMETRY_REPORT_BY_EXCEPTION
+  // Nothing changed beyond the deadbands - skip the publish, keep the count
+  uint8_t actuators = (reading.pumpOn ? 0x01 : 0) | (reading.lightsOn ? 0x02 : 0) |
+                      (isActuatorOn(ACTUATOR_HEATING) ? 0x04 : 0) |
+                      (isActuatorOn(ACTUATOR_FAN) ? 0x08 : 0);
+  if (!reportFilter.shouldReport(reading, actuators, millis())) {
+    reportFilter.onSuppressed();
+    Serial.printf("🔇 No change beyond deadbands - not published (%lu held back)\n",
+                  (unsigned long)reportFilter.suppressed());
+    return true;
+  }
+  suppressed = reportFilter.suppressed();
+#endif
+  
+  // Previous reading still waiting for the network task
+  OutboundMessage* message = liveInFlight ? nullptr : outboundQueue.beginPush();
+  if (message == nullptr) {
+    Serial.println("⚠️  Publish queue busy - buffering telemetry");
+    bufferReading(reading);
+    return true;
   }
   
+  message->kind = OUTBOUND_LIVE;
+  message->records = 1;
+  
   // Increment sequence counter (must be positive)
   sequenceCounter++;
   
-  // If MQTT is offline, buffer the data
-  if (!mqttClient.connected()) {
-    Serial.println("⚠️  MQTT offline - buffering telemetry");
-    
-    // Create telemetry reading struct
-    TelemetryReading reading;
-    // Store Unix timestamp as string for buffer compatibility
-    snprintf(reading.timestamp, sizeof(reading.timestamp), "%ld", (long)unixTimestamp);
-    reading.temperature = temperature;
-    reading.humidity = humidity;
-    reading.light = light;
-    reading.tankLevel = tankLevel;
-    reading.pumpOn = pumpOn;
-    reading.lightsOn = lightsOn;
-    reading.irrigated = irrigated;
-    reading.valid = true;
-    
-    // Check Buffer #1 status
-    if (is1MinBufferFull()) {
-      Serial.println("⚠️  Buffer #1 full - aggregating to Buffer #2");
-      
-      // Get all readings from Buffer #1
-      TelemetryReading buffer1Data[10];
-      int count = 0;
-      while (get1MinBufferCount() > 0 && count < 10) {
-        if (getOldestFrom1MinBuffer(buffer1Data[count])) {
-          removeOldestFrom1MinBuffer();
-          count++;
-        }
-      }
-      
-      // Aggregate and store in Buffer #2
-      if (count > 0) {
-        // Check if Buffer #2 is also full
-        if (is10MinBufferFull()) {
-          Serial.println("⚠️  Buffer #2 also full - dropping oldest aggregate");
-          removeOldestFrom10MinBuffer();
-        }
-        aggregateAndStore(buffer1Data, count);
-      }
+  if (telemetryEncoding == TELEMETRY_ENCODING_BINARY) {
+    PackedAggregate packed;     // Window statistics, as for a buffered minute
+    packAggregate(reading, packed);
+    BinaryTelemetryWriter writer((uint8_t*)message->payload, sizeof(message->payload), deviceUuid);
+    if (suppressed > 0) {
+      writer.setSuppressed(suppressed);
     }
+    writer.add(packed, (uint32_t)sequenceCounter);
     
-    // Add current reading to Buffer #1
-    addToBuffer1Min(reading);
-    Serial.printf("📦 Buffered (B1: %d, B2: %d)\n", get1MinBufferCount(), get10MinBufferCount());
+    message->topic = MQTT_TOPIC_TELEMETRY_BINARY;
+    message->length = (uint16_t)writer.size();
+  } else {
+    // MQTT is connected - serialize straight into the queue slot
+    JsonWriter json(message->payload, MQTT_JSON_BUFFER_SIZE);
+    writeTelemetryJson(json, reading, sequenceCounter, suppressed, true);
+    if (json.overflowed()) {
+      Serial.println("❌ Telemetry exceeds JSON buffer - buffering");
+      bufferReading(reading);
+      return true;
+    }
     
-    return true; // Successfully buffered
+    message->topic = MQTT_TOPIC_TELEMETRY;
+    message->length = (uint16_t)json.length();
   }
+  outboundQueue.commitPush();
   
-  // MQTT is connected - publish directly
-  // Build JSON payload
-  JsonDocument doc;
+  liveInFlight = true;
+  liveInFlightReading = reading;
+#ifdef TELEMETRY_REPORT_BY_EXCEPTION
+  reportFilter.onReported(reading, actuators, millis());
+#endif
   
-  doc["device_id"] = DEVICE_ID;
-  doc["timestamp"] = (long long)unixTimestamp;  // Unix timestamp as i64
-  doc["sequence"] = (long long)sequenceCounter;  // Sequence number as i64
+  if (telemetryEncoding == TELEMETRY_ENCODING_BINARY) {
+    Serial.printf("📤 Telemetry queued (binary, %u bytes)\n", (unsigned)message->length);
+    return true;
+  }
   
-  // Only include valid sensor readings
-  if (temperature != SENSOR_ERROR_TEMP) {
-    doc["temperature"] = temperature;
+  Serial.println("📤 Telemetry queued:");
+  Serial.println(message->payload);
+  
+  return true;
+}
+
+/**
+ * Queue the oldest unsent buffered readings as one binary message on the
+ * telemetry/bin topic
+ * @param message Outbound queue slot to fill
+ * @param first Buffer index of the first reading (readings before it are in flight)
+ * @param maxRecords Maximum number of readings to include
+ * @return Number of readings in the message, -1 if none fit
+ */
+static int buildBinaryBufferedMessage(OutboundMessage& message, int first, int maxRecords) {
+  size_t budget = MQTT_MESSAGE_BUFFER_SIZE - MQTT_PACKET_OVERHEAD - strlen(telemetryBinaryTopic);
+  BinaryTelemetryWriter writer((uint8_t*)message.payload, budget, deviceUuid);
+  
+  TelemetryReading reading;
+  PackedAggregate packed;
+  while (writer.count() < maxRecords && getBufferedReading(first + writer.count(), reading)) {
+    packAggregate(reading, packed);
+    if (!writer.add(packed, (uint32_t)(sequenceCounter + 1))) {
+      break; // Does not fit - leave it for the next message
+    }
+    sequenceCounter++;
   }
-  if (humidity != SENSOR_ERROR_HUM) {
-    doc["humidity"] = humidity;
+  
+  if (writer.count() == 0) {
+    Serial.println("  ✗ Reading exceeds binary message budget");
+    return -1;
   }
-  if (light >= 0) {
-    doc["light"] = (double)light;  // Ensure it's a float/double
+  
+  message.topic = MQTT_TOPIC_TELEMETRY_BINARY;
+  message.length = (uint16_t)writer.size();
+  return writer.count();
+}
+
+#ifdef TELEMETRY_BATCH_FLUSH
+/**
+ * Queue the oldest unsent buffered readings as one JSON array on the batch topic
+ * Readings stay in the buffer until the network task reports the result
+ * @param message Outbound queue slot to fill
+ * @param first Buffer index of the first reading (readings before it are in flight)
+ * @param maxRecords Maximum number of readings to include
+ * @return Number of readings in the message, -1 if none fit
+ */
+static int buildBufferedMessage(OutboundMessage& message, int first, int maxRecords) {
+  size_t budget = MQTT_MESSAGE_BUFFER_SIZE - MQTT_PACKET_OVERHEAD - strlen(telemetryBatchTopic);
+  
+  // Capacity includes the NUL terminator; one more byte is kept for ']'
+  JsonWriter json(message.payload, budget + 1);
+  json.beginArray();
+  int count = 0;
+  
+  TelemetryReading reading;
+  while (count < maxRecords && getBufferedReading(first + count, reading)) {
+    size_t mark = json.length();
+    writeTelemetryJson(json, reading, sequenceCounter + 1);
+    if (json.overflowed() || json.length() >= budget) {
+      // Does not fit - leave it for the next batch
+      json.rewind(mark);
+      break;
+    }
+    sequenceCounter++;
+    count++;
   }
+  json.endArray();
   
-  doc["tank_level"] = tankLevel;
-  doc["irrigated_since_last_transmission"] = irrigated;
-  doc["lights_are_on"] = lightsOn;
-  doc["pump_on"] = pumpOn;
+  if (count == 0) {
+    Serial.println("  ✗ Reading exceeds batch size budget");
+    return -1;
+  }
   
-  // Serialize to string
-  char jsonBuffer[MQTT_JSON_BUFFER_SIZE];
-  size_t len = serializeJson(doc, jsonBuffer);
+  message.topic = MQTT_TOPIC_TELEMETRY_BATCH;
+  message.length = (uint16_t)json.length();
+  return count;
+}
+#else
+/**
+ * Queue the oldest unsent buffered reading on the telemetry topic
+ * @param message Outbound queue slot to fill
+ * @param first Buffer index of the reading (readings before it are in flight)
+ * @param maxRecords Unused (always one reading per message)
+ * @return Number of readings in the message (1), -1 on error
+ */
+static int buildBufferedMessage(OutboundMessage& message, int first, int maxRecords) {
+  (void)maxRecords;
   
-  // Publish
-  bool success = mqttClient.publish(telemetryTopic, jsonBuffer, len);
+  // Coarsest tier first - it always holds the oldest data
+  TelemetryReading reading;
+  if (!getBufferedReading(first, reading)) {
+    return -1;
+  }
   
-  if (success) {
-    Serial.println("📤 Telemetry published:");
-    Serial.println(jsonBuffer);
-  } else {
-    Serial.println("❌ Failed to publish telemetry");
+  // Build JSON for buffered reading
+  JsonWriter json(message.payload, MQTT_JSON_BUFFER_SIZE);
+  writeTelemetryJson(json, reading, sequenceCounter + 1);
+  if (json.overflowed()) {
+    Serial.println("  ✗ Reading exceeds JSON buffer");
+    return -1;
   }
+  sequenceCounter++;
   
-  return success;
+  message.topic = MQTT_TOPIC_TELEMETRY;
+  message.length = (uint16_t)json.length();
+  return 1;
 }
+#endif
 
 /**
- * Flush buffered telemetry data to MQTT
- * Called automatically after reconnection
- * @return Number of readings successfully sent
+ * Stop the flush and record its statistics
+ * @param reason Log message
  */
-int flushBufferedTelemetry() {
-  if (!mqttClient.connected()) {
+static void endBufferFlush(const char* reason) {
+  flushState = FLUSH_IDLE;
+  recordBufferFlush(flushSentCount, millis() - flushStartTime);
+  Serial.printf("⚠️  %s (%d readings sent)\n", reason, flushSentCount);
+}
+
+/**
+ * Start flushing buffered telemetry
+ * The flush itself runs incrementally from serviceBufferFlush()
+ * @return true if a flush was started
+ */
+bool startBufferFlush() {
+  if (!isMQTTConnected()) {
     Serial.println("⚠️  Cannot flush - MQTT offline");
-    return 0;
+    return false;
+  }
+  if (!hasBufferedData()) {
+    return false;
   }
-  
-  int sentCount = 0;
-  int buffer1Count = get1MinBufferCount();
-  int buffer2Count = get10MinBufferCount();
   
   Serial.println("\n📤 Starting buffer flush (chronological order)...");
-  Serial.printf("   Buffer #2: %d aggregated readings (OLDEST)\n", buffer2Count);
-  Serial.printf("   Buffer #1: %d high-res readings (NEWER)\n", buffer1Count);
+  for (int tier = getBufferTierCount() - 1; tier >= 0; tier--) {
+    Serial.printf("   Tier %d (%s): %d readings%s\n", tier, getBufferTierName(tier),
+                  getBufferCount(tier), tier == getBufferTierCount() - 1 ? " (OLDEST)" : "");
+  }
   Serial.println();
   
-  // FIRST: Flush Buffer #2 (oldest aggregated data)
-  if (buffer2Count > 0) {
-    Serial.println("📤 Flushing Buffer #2 (aggregated - oldest data)...");
-    while (get10MinBufferCount() > 0) {
-      TelemetryReading reading;
-      if (getOldestFrom10MinBuffer(reading)) {
-        // Build JSON for aggregated reading
-        JsonDocument doc;
-        doc["device_id"] = DEVICE_ID;
-        
-        // Parse stored Unix timestamp string back to i64
-        long storedTimestamp = atol(reading.timestamp);
-        doc["timestamp"] = (long long)storedTimestamp;
-        
-        // Increment sequence for each buffered message
-        sequenceCounter++;
-        doc["sequence"] = (long long)sequenceCounter;
-        
-        if (reading.temperature != -999.0) {
-          doc["temperature"] = reading.temperature;
-        }
-        if (reading.humidity != -999.0) {
-          doc["humidity"] = reading.humidity;
-        }
-        if (reading.light >= 0) {
-          doc["light"] = (double)reading.light;
-        }
-        
-        doc["tank_level"] = reading.tankLevel;
-        doc["irrigated_since_last_transmission"] = reading.irrigated;
-        doc["lights_are_on"] = reading.lightsOn;
-        doc["pump_on"] = reading.pumpOn;
-        
-        // Serialize and publish
-        char jsonBuffer[MQTT_JSON_BUFFER_SIZE];
-        size_t len = serializeJson(doc, jsonBuffer);
-        
-        if (mqttClient.publish(telemetryTopic, jsonBuffer, len)) {
-          Serial.printf("  ✓ Sent aggregated reading (B2: %s)\n", reading.timestamp);
-          removeOldestFrom10MinBuffer();
-          sentCount++;
-          delay(MQTT_PUBLISH_DELAY_MS);
-        } else {
-          Serial.println("  ✗ Failed to send - stopping flush");
-          return sentCount;
-        }
-      }
-    }
+  flushState = FLUSH_ACTIVE;
+  flushSentCount = 0;
+  flushStartTime = millis();
+  flushBucket.reset(flushStartTime);
+  return true;
+}
+
+/**
+ * Check whether a buffer flush is in progress
+ * While it is, live telemetry is appended to the buffer to keep order
+ */
+bool isBufferFlushActive() {
+  return flushState == FLUSH_ACTIVE;
+}
+
+/**
+ * Advance the buffer flush by one step (call every loop iteration)
+ * Queues one message of up to MQTT_FLUSH_MAX_RECORDS_PER_STEP readings
+ * while the outbound queue has room, so up to MQTT_INFLIGHT_WINDOW
+ * messages await their PUBACK at once; messages are paced by a token
+ * bucket instead of blocking delays
+ * @return Number of readings queued in this step
+ */
+int serviceBufferFlush() {
+  if (flushState != FLUSH_ACTIVE) {
+    return 0;
   }
   
-  // SECOND: Flush Buffer #1 (newer high-resolution data)
-  if (buffer1Count > 0) {
-    Serial.println("\n📤 Flushing Buffer #1 (high-resolution - newer data)...");
-  }
-  while (get1MinBufferCount() > 0) {
-    TelemetryReading reading;
-    if (getOldestFrom1MinBuffer(reading)) {
-      // Build JSON for buffered reading
-      JsonDocument doc;
-      doc["device_id"] = DEVICE_ID;
-      
-      // Parse stored Unix timestamp string back to i64
-      long storedTimestamp = atol(reading.timestamp);
-      doc["timestamp"] = (long long)storedTimestamp;
-      
-      // Increment sequence for each buffered message
-      sequenceCounter++;
-      doc["sequence"] = (long long)sequenceCounter;
-      
-      if (reading.temperature != SENSOR_ERROR_TEMP) {
-        doc["temperature"] = reading.temperature;
-      }
-      if (reading.humidity != SENSOR_ERROR_HUM) {
-        doc["humidity"] = reading.humidity;
-      }
-      if (reading.light >= 0) {
-        doc["light"] = (double)reading.light;
-      }
-      
-      doc["tank_level"] = reading.tankLevel;
-      doc["irrigated_since_last_transmission"] = reading.irrigated;
-      doc["lights_are_on"] = reading.lightsOn;
-      doc["pump_on"] = reading.pumpOn;
-      
-      // Serialize and publish
-      char jsonBuffer[MQTT_JSON_BUFFER_SIZE];
-      size_t len = serializeJson(doc, jsonBuffer);
-      
-      if (mqttClient.publish(telemetryTopic, jsonBuffer, len)) {
-        Serial.printf("  ✓ Sent buffered reading (B1: %s)\n", reading.timestamp);
-        removeOldestFrom1MinBuffer();
-        sentCount++;
-        delay(MQTT_PUBLISH_DELAY_MS); // Small delay to avoid overwhelming broker
-      } else {
-        Serial.println("  ✗ Failed to send - stopping flush");
-        return sentCount;
-      }
-    }
+  if (!isMQTTConnected()) {
+    endBufferFlush("Flush interrupted - MQTT offline");
+    return 0;
+  }
+  
+  // Everything buffered is in flight - wait for the PUBACKs
+  if (flushInFlight > 0 && getTotalBufferedCount() <= flushInFlight) {
+    return 0;
+  }
+  
+  // Let the window drain so deferred readings join the buffer in order
+  if (!deferredReadings.empty()) {
+    return 0;
   }
   
   // Flush complete
-  if (sentCount > 0) {
+  if (!hasBufferedData()) {
+    flushState = FLUSH_IDLE;
+    recordBufferFlush(flushSentCount, millis() - flushStartTime);
     Serial.println("\n╔════════════════════════════════════╗");
-    Serial.printf("║  ✅ FLUSH COMPLETE: %d readings   ║\n", sentCount);
+    Serial.printf("║  ✅ FLUSH COMPLETE: %d readings   ║\n", flushSentCount);
     Serial.println("╚════════════════════════════════════╝");
-  } else {
-    Serial.println("⚠️  No data was flushed");
+    Serial.printf("   Duration: %lu ms\n", millis() - flushStartTime);
+    return 0;
+  }
+  
+  if (outboundQueue.full() || !flushBucket.tryConsume(millis())) {
+    return 0; // Rate limited - resume on a later iteration
+  }
+  
+  OutboundMessage* message = outboundQueue.beginPush();
+  int count = telemetryEncoding == TELEMETRY_ENCODING_BINARY
+                ? buildBinaryBufferedMessage(*message, flushInFlight, MQTT_FLUSH_MAX_RECORDS_PER_STEP)
+                : buildBufferedMessage(*message, flushInFlight, MQTT_FLUSH_MAX_RECORDS_PER_STEP);
+  if (count < 0) {
+    endBufferFlush("Flush stopped");
+    return 0;
   }
   
-  return sentCount;
+  message->kind = OUTBOUND_FLUSH;
+  message->records = (uint16_t)count;
+  outboundQueue.commitPush();
+  flushInFlight += count;
+  return count;
 }
 
 /**
- * Process MQTT client (must be called regularly in loop)
+ * Publish buffer statistics when BUFFER_STATS_INTERVAL_MS has elapsed
+ * Per-tier depth, high-water mark and loss counters, last flush timing
+ * and MQTT connection quality
+ * @return true if statistics were queued for publish
+ */
+bool publishBufferStats() {
+  unsigned long now = millis();
+  if (!isMQTTConnected() || outboundQueue.full() ||
+      (lastBufferStatsPublish != 0 && now - lastBufferStatsPublish < BUFFER_STATS_INTERVAL_MS)) {
+    return false;
+  }
+  lastBufferStatsPublish = now;
+  
+  OutboundMessage* message = outboundQueue.beginPush();
+  JsonWriter json(message->payload, BUFFER_STATS_JSON_SIZE);
+  json.beginObject();
+  json.member("device_id", DEVICE_ID);
+  json.member("uptime_ms", (unsigned long long)uptimeMs());
+  
+  json.key("tiers");
+  json.beginArray();
+  for (int tier = 0; tier < getBufferTierCount(); tier++) {
+    BufferTierStats stats;
+    getBufferTierStats(tier, stats);
+    
+    json.beginObject();
+    json.member("name", getBufferTierName(tier));
+    json.member("depth", (unsigned)stats.depth);
+    json.member("capacity", (unsigned)stats.capacity);
+    json.member("high_water", (unsigned)stats.highWater);
+    json.member("enqueued", (unsigned long)stats.enqueued);
+    json.member("aggregated", (unsigned long)stats.aggregated);
+    json.member("dropped", (unsigned long)stats.dropped);
+    json.member("dropped_samples", (unsigned long)stats.droppedSamples);
+    json.member("flushed", (unsigned long)stats.flushed);
+    json.member("oldest_timestamp", (unsigned long)stats.oldestTimestamp);
+    json.endObject();
+  }
+  json.endArray();
+  
+  const BufferFlushStats& flush = getBufferFlushStats();
+  json.key("flush");
+  json.beginObject();
+  json.member("count", (unsigned long)flush.flushes);
+  json.member("last_records", (unsigned long)flush.lastRecords);
+  json.member("last_duration_ms", (unsigned long)flush.lastDurationMs);
+  json.member("records_per_sec", flush.recordsPerSecond);
+  json.endObject();
+  
+  ConnectionStats connection;
+  unsigned long nextAttemptMs;
+  getMQTTConnectionStats(connection, nextAttemptMs);
+  json.key("connection");
+  json.beginObject();
+  json.member("attempts", (unsigned long)connection.attempts);
+  json.member("successes", (unsigned long)connection.successes);
+  json.member("disconnects", (unsigned long)connection.disconnects);
+  json.member("success_rate", connection.successRate);
+  json.member("mean_connect_ms", (unsigned long)connection.meanConnectMs);
+  json.member("offline_ms", (unsigned long)connection.offlineMs);
+  json.endObject();
+  json.endObject();
+  
+  if (json.overflowed()) {
+    Serial.println("❌ Buffer stats exceed JSON buffer - not sent");
+    return false;
+  }
+  message->topic = MQTT_TOPIC_BUFFER_STATS;
+  message->kind = OUTBOUND_STATUS;
+  message->records = 0;
+  message->length = (uint16_t)json.length();
+  outboundQueue.commitPush();
+  
+  Serial.printf("📊 Buffer stats queued (%u bytes)\n", (unsigned)message->length);
+  return true;
+}
+
+/**
+ * Queue pending alerts that are not in flight yet (while connected)
+ */
+static void sendPendingAlerts() {
+  while (alertsInFlight < pendingAlerts.size() && isMQTTConnected()) {
+    OutboundMessage* message = outboundQueue.beginPush();
+    if (message == nullptr) {
+      return;  // Queue busy - retried from processMQTT()
+    }
+    
+    const TankAlert& alert = pendingAlerts[alertsInFlight];
+    JsonWriter json(message->payload, MQTT_JSON_BUFFER_SIZE);
+    json.beginObject();
+    json.member("device_id", DEVICE_ID);
+    json.member("timestamp", (long long)alert.timestamp);
+    json.member("alert", "tank_empty");
+    json.member("active", alert.empty);
+    json.member("pump_stopped", alert.pumpStopped);
+    json.endObject();
+    
+    message->topic = MQTT_TOPIC_ALERT;
+    message->kind = OUTBOUND_ALERT;
+    message->records = 0;
+    message->length = (uint16_t)json.length();
+    outboundQueue.commitPush();
+    alertsInFlight++;
+  }
+}
+
+/**
+ * Queue a tank level alert for publish on the alert topic
+ * Sent right away rather than with the next telemetry window. Offline, up to
+ * ALERT_PENDING_DEPTH alerts wait for the connection.
+ * @param empty true when the tank ran empty, false when it was refilled
+ * @param pumpStopped The cut-off stopped a running pump
+ * @param timestamp When the level changed (clock timestamp)
+ */
+void publishTankAlert(bool empty, bool pumpStopped, uint32_t timestamp) {
+  if (pendingAlerts.full()) {
+    // The oldest can only make room while nothing is in flight
+    if (alertsInFlight > 0) {
+      Serial.println("⚠️  Alert queue full - alert dropped");
+      return;
+    }
+    Serial.println("⚠️  Alert queue full - dropped oldest");
+  }
+  pendingAlerts.push({ empty, pumpStopped, timestamp });
+  Serial.printf("🚨 Tank %s alert %s\n", empty ? "empty" : "refilled",
+                isMQTTConnected() ? "queued" : "held until connected");
+  sendPendingAlerts();
+}
+
+/**
+ * Apply the outcome of a queued message
+ * @param result Result reported by the network task
+ */
+static void handlePublishResult(const PublishResult& result) {
+  switch (result.kind) {
+    case OUTBOUND_LIVE:
+      liveInFlight = false;
+      if (result.ok) {
+        Serial.println("📤 Telemetry acknowledged");
+      } else {
+        // Newer readings may have been buffered meanwhile - it goes in
+        // ahead of them (see insertIntoBuffer)
+        Serial.println("❌ Telemetry not acknowledged - buffering");
+        bufferReading(liveInFlightReading);
+      }
+      break;
+    
+    case OUTBOUND_FLUSH:
+      // Results arrive in queue order, so the oldest readings are the acknowledged ones
+      flushInFlight -= result.records;
+      if (result.ok) {
+        Serial.printf("  ✓ Sent %d buffered readings\n", result.records);
+        removeOldestBuffered(result.records);
+        flushSentCount += result.records;
+      } else {
+        Serial.printf("  ✗ %d buffered readings not acknowledged - kept in buffer\n", result.records);
+        if (flushState == FLUSH_ACTIVE) {
+          endBufferFlush("Flush stopped - publish failed");
+        }
+      }
+      if (flushInFlight == 0) {
+        releaseDeferredReadings();
+      }
+      break;
+    
+    case OUTBOUND_ALERT:
+      // Results arrive in queue order, so the oldest alert is the one reported
+      alertsInFlight--;
+      if (result.ok) {
+        pendingAlerts.pop();
+        Serial.println("🚨 Alert acknowledged");
+      } else {
+        TankAlert alert;
+        pendingAlerts.pop(alert);
+        pendingAlerts.push(alert);
+        Serial.println("⚠️  Alert not acknowledged - will be sent again");
+      }
+      break;
+    
+    default:
+      if (!result.ok) {
+        Serial.println("⚠️  Failed to publish buffer stats");
+      }
+      break;
+  }
+}
+
+/**
+ * Process MQTT traffic (must be called regularly in loop)
+ * Applies setpoints, rule tables and publish results reported by the network
+ * task, then queues alerts still waiting to be sent
  */
 void processMQTT() {
-  if (!mqttClient.connected()) {
-    // Reconnection handled by reconnect.cpp
-    return;
+  InboundMessage* message;
+  while ((message = inboundQueue.front()) != nullptr) {
+    if (message->topic == INBOUND_RULES) {
+      loadControlRules((const uint8_t*)message->payload, message->length);
+    } else {
+      applySetpointMessage(message->payload, message->length);
+    }
+    inboundQueue.pop();
+  }
+  
+  PublishResult result;
+  while (publishResultQueue.pop(result)) {
+    handlePublishResult(result);
   }
   
-  mqttClient.loop();
+  sendPendingAlerts();
 }
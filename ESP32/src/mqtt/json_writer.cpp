@@ -0,0 +1,202 @@
+/**
+ * @file json_writer.cpp
+ * @brief Allocation-free JSON writer for telemetry payloads
+ */
+
+#include <math.h>
+#include <string.h>
+#include "json_writer.h"
+
+JsonWriter::JsonWriter(char* buffer, size_t capacity)
+  : buffer_(buffer), capacity_(capacity), length_(0), overflowed_(capacity == 0) {
+  if (capacity_ > 0) {
+    buffer_[0] = '\0';
+  }
+}
+
+/**
+ * Emit the comma between array elements / object members
+ * (needed unless the previous character opened a container or ended a key)
+ */
+void JsonWriter::separator() {
+  if (length_ == 0) {
+    return;
+  }
+  char last = buffer_[length_ - 1];
+  if (last != '{' && last != '[' && last != ':') {
+    put(',');
+  }
+}
+
+void JsonWriter::put(char c) {
+  if (overflowed_ || length_ + 1 >= capacity_) {
+    overflowed_ = true;
+    return;
+  }
+  buffer_[length_++] = c;
+  buffer_[length_] = '\0';
+}
+
+void JsonWriter::putRaw(const char* text) {
+  while (*text != '\0') {
+    put(*text++);
+  }
+}
+
+void JsonWriter::putUnsigned(unsigned long long number) {
+  char digits[20];
+  int count = 0;
+  do {
+    digits[count++] = (char)('0' + number % 10);
+    number /= 10;
+  } while (number > 0);
+  while (count > 0) {
+    put(digits[--count]);
+  }
+}
+
+void JsonWriter::rewind(size_t mark) {
+  if (mark > length_ || capacity_ == 0) {
+    return;
+  }
+  length_ = mark;
+  buffer_[length_] = '\0';
+  overflowed_ = false;
+}
+
+void JsonWriter::key(const char* name) {
+  value(name);
+  put(':');
+}
+
+/**
+ * Write a string, escaping quotes, backslashes and control characters
+ */
+void JsonWriter::value(const char* text) {
+  separator();
+  put('"');
+  for (const char* p = text; *p != '\0'; p++) {
+    unsigned char c = (unsigned char)*p;
+    switch (c) {
+      case '"': putRaw("\\\""); break;
+      case '\\': putRaw("\\\\"); break;
+      case '\b': putRaw("\\b"); break;
+      case '\f': putRaw("\\f"); break;
+      case '\n': putRaw("\\n"); break;
+      case '\r': putRaw("\\r"); break;
+      case '\t': putRaw("\\t"); break;
+      default:
+        if (c < 0x20) {
+          static const char hex[] = "0123456789abcdef";
+          putRaw("\\u00");
+          put(hex[c >> 4]);
+          put(hex[c & 0x0F]);
+        } else {
+          put((char)c);
+        }
+        break;
+    }
+  }
+  put('"');
+}
+
+void JsonWriter::value(bool flag) {
+  separator();
+  putRaw(flag ? "true" : "false");
+}
+
+void JsonWriter::value(long long number) {
+  separator();
+  if (number < 0) {
+    put('-');
+    putUnsigned(0ULL - (unsigned long long)number);
+  } else {
+    putUnsigned((unsigned long long)number);
+  }
+}
+
+void JsonWriter::value(unsigned long long number) {
+  separator();
+  putUnsigned(number);
+}
+
+/**
+ * Write a floating-point number the way ArduinoJson does: the integral
+ * part, then up to `decimalPlaces` significant digits in total with
+ * trailing zeros removed; exponent form outside [1e-5, 1e7)
+ */
+void JsonWriter::writeFloat(double number, int8_t decimalPlaces) {
+  separator();
+  if (isnan(number) || isinf(number)) {
+    putRaw("null");
+    return;
+  }
+  if (number < 0.0) {
+    put('-');
+    number = -number;
+  }
+  
+  // Normalize large and tiny values into [1, 10) with a decimal exponent
+  int exponent = 0;
+  if (number >= 1e7) {
+    while (number >= 10.0) {
+      number /= 10.0;
+      exponent++;
+    }
+  } else if (number > 0.0 && number <= 1e-5) {
+    while (number < 1.0) {
+      number *= 10.0;
+      exponent--;
+    }
+  }
+  
+  // Digits of the integral part count against the decimal places
+  uint32_t maxDecimalPart = 1;
+  for (int8_t i = 0; i < decimalPlaces; i++) {
+    maxDecimalPart *= 10;
+  }
+  uint32_t integral = (uint32_t)number;
+  for (uint32_t tmp = integral; tmp >= 10; tmp /= 10) {
+    maxDecimalPart /= 10;
+    decimalPlaces--;
+  }
+  
+  double remainder = (number - (double)integral) * (double)maxDecimalPart;
+  uint32_t decimal = (uint32_t)remainder;
+  remainder -= (double)decimal;
+  decimal += (uint32_t)(remainder * 2); // Round half up
+  if (decimal >= maxDecimalPart) {
+    decimal = 0;
+    integral++;
+    if (exponent != 0 && integral >= 10) {
+      exponent++;
+      integral = 1;
+    }
+  }
+  
+  while (decimalPlaces > 0 && decimal % 10 == 0) {
+    decimal /= 10;
+    decimalPlaces--;
+  }
+  
+  putUnsigned(integral);
+  if (decimalPlaces > 0) {
+    put('.');
+    char digits[10];
+    for (int8_t i = decimalPlaces - 1; i >= 0; i--) {
+      digits[i] = (char)('0' + decimal % 10);
+      decimal /= 10;
+    }
+    for (int8_t i = 0; i < decimalPlaces; i++) {
+      put(digits[i]);
+    }
+  }
+  if (exponent != 0) {
+    put('e');
+    if (exponent < 0) {
+      put('-');
+      exponent = -exponent;
+    }
+    putUnsigned((unsigned long long)exponent);
+  }
+}
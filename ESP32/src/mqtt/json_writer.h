@@ -0,0 +1,80 @@
+/**
+ * @file json_writer.h
+ * @brief Allocation-free JSON writer for telemetry payloads
+ *
+ * Writes JSON straight into a caller-provided buffer (an outbound queue
+ * slot) without touching the heap. Output matches ArduinoJson's
+ * serializeJson(): insertion order, no whitespace, floats with 6 decimal
+ * places and doubles with 9, trailing zeros trimmed, NaN/Inf as null.
+ *
+ * Every write is bounds-checked. A write that does not fit sets
+ * overflowed() and leaves the buffer NUL-terminated; rewind() drops a
+ * partly written value, e.g. the last record of a batch.
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class JsonWriter {
+public:
+  /**
+   * @param buffer Destination
+   * @param capacity Size of the destination, including the NUL terminator
+   */
+  JsonWriter(char* buffer, size_t capacity);
+
+  void beginObject() { separator(); put('{'); }
+  void endObject() { put('}'); }
+  void beginArray() { separator(); put('['); }
+  void endArray() { put(']'); }
+
+  /**
+   * Write an object key (followed by its value)
+   */
+  void key(const char* name);
+
+  void value(const char* text);
+  void value(bool flag);
+  void value(long long number);
+  void value(unsigned long long number);
+  void value(int number) { value((long long)number); }
+  void value(unsigned int number) { value((unsigned long long)number); }
+  void value(long number) { value((long long)number); }
+  void value(unsigned long number) { value((unsigned long long)number); }
+  void value(float number) { writeFloat(number, 6); }
+  void value(double number) { writeFloat(number, 9); }
+
+  /**
+   * Write a key/value member
+   */
+  template <typename T>
+  void member(const char* name, T v) {
+    key(name);
+    value(v);
+  }
+
+  size_t length() const { return length_; }
+  bool overflowed() const { return overflowed_; }
+
+  /**
+   * Truncate the output back to an earlier length() and clear overflow
+   */
+  void rewind(size_t mark);
+
+private:
+  void separator();
+  void put(char c);
+  void putRaw(const char* text);
+  void putUnsigned(unsigned long long number);
+  void writeFloat(double number, int8_t decimalPlaces);
+
+  char* buffer_;
+  size_t capacity_;
+  size_t length_;
+  bool overflowed_;
+};
+
+#endif // JSON_WRITER_H
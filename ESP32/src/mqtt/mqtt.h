@@ -6,28 +6,63 @@
 #ifndef MQTT_H
 #define MQTT_H
 
+#include <stdint.h>
+
+struct ConnectionStats;
+struct TelemetryReading;
+
+// Telemetry payload encoding
+enum TelemetryEncoding {
+  TELEMETRY_ENCODING_JSON,    // JSON on the telemetry (and batch) topic
+  TELEMETRY_ENCODING_BINARY   // Compact binary on the telemetry/bin topic
+};
+
 // Initialize WiFi connection
 void initWiFi();
 
 // Initialize MQTT client
 void initMQTT();
 
-// Connect to MQTT broker
+// Connect to MQTT broker (network task only)
 bool connectMQTT();
 
+// Start the network task that owns all broker I/O
+void startNetworkTask();
+
 // Check if MQTT is connected
 bool isMQTTConnected();
 
-// Process MQTT client (call regularly in loop)
+// Process setpoints and publish results from the network task (call regularly in loop)
 void processMQTT();
 
 // Handle MQTT reconnection
 void handleMQTTReconnection();
 
-// Publish telemetry data to MQTT (or buffer if offline)
-bool publishTelemetry(float temperature, float humidity, float light, bool tankLevel, bool pumpOn, bool lightsOn);
+// Get connection-quality statistics (attempts, success rate, offline time)
+void getMQTTConnectionStats(ConnectionStats& stats, unsigned long& nextAttemptMs);
+
+// Queue a telemetry window for publish (buffered if offline, held back if unchanged)
+bool publishTelemetry(const TelemetryReading& window);
+
+// Select the encoding for subsequent telemetry messages
+void setTelemetryEncoding(TelemetryEncoding encoding);
+
+// Get the current telemetry encoding
+TelemetryEncoding getTelemetryEncoding();
+
+// Start flushing buffered telemetry after reconnection
+bool startBufferFlush();
+
+// Check if a buffer flush is in progress
+bool isBufferFlushActive();
+
+// Advance the buffer flush by one bounded step (call every loop iteration)
+int serviceBufferFlush();
+
+// Publish buffer statistics when the publish interval has elapsed
+bool publishBufferStats();
 
-// Flush buffered telemetry after reconnection
-int flushBufferedTelemetry();
+// Queue a tank level alert (kept until the broker acknowledges it)
+void publishTankAlert(bool empty, bool pumpStopped, uint32_t timestamp);
 
 #endif // MQTT_H
@@ -0,0 +1,143 @@
+/**
+ * @file mqtt_packet.h
+ * @brief MQTT 3.1.1 framing for QoS 1 telemetry delivery
+ *
+ * PubSubClient publishes at QoS 0 only and discards the PUBACKs it reads,
+ * so the QoS 1 PUBLISH header is built here and PUBACKs are picked out of
+ * the inbound byte stream by PubAckScanner (fed by AckTrackingClient).
+ *
+ * Header-only with no Arduino dependencies, so it can be exercised on the
+ * host against a local broker.
+ */
+
+#ifndef MQTT_PACKET_H
+#define MQTT_PACKET_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define MQTT_PACKET_PUBLISH_QOS1 0x32  // PUBLISH, QoS 1, not retained
+#define MQTT_PACKET_FLAG_DUP 0x08      // Re-delivery of an unacknowledged PUBLISH
+#define MQTT_PACKET_PUBACK 0x40
+
+// Largest PUBLISH header: fixed header (1 + 4) + topic length (2) + packet id (2)
+#define MQTT_PUBLISH_HEADER_SIZE(topicLength) (9 + (topicLength))
+
+/**
+ * Build the header of a QoS 1 PUBLISH (the payload follows it on the wire)
+ * @param out Destination, at least MQTT_PUBLISH_HEADER_SIZE(strlen(topic)) bytes
+ * @param topic Topic name
+ * @param packetId Packet identifier (non-zero)
+ * @param payloadLength Payload bytes
+ * @param dup true when re-sending a PUBLISH that was not acknowledged
+ * @return Header bytes written
+ */
+inline size_t encodeQos1PublishHeader(uint8_t* out, const char* topic, uint16_t packetId,
+                                      size_t payloadLength, bool dup) {
+  size_t topicLength = strlen(topic);
+  size_t remaining = 2 + topicLength + 2 + payloadLength;
+  size_t n = 0;
+
+  out[n++] = (uint8_t)(MQTT_PACKET_PUBLISH_QOS1 | (dup ? MQTT_PACKET_FLAG_DUP : 0));
+  do {
+    uint8_t digit = (uint8_t)(remaining & 0x7F);
+    remaining >>= 7;
+    out[n++] = remaining > 0 ? (uint8_t)(digit | 0x80) : digit;
+  } while (remaining > 0);
+
+  out[n++] = (uint8_t)(topicLength >> 8);
+  out[n++] = (uint8_t)topicLength;
+  memcpy(out + n, topic, topicLength);
+  n += topicLength;
+  out[n++] = (uint8_t)(packetId >> 8);
+  out[n++] = (uint8_t)packetId;
+  return n;
+}
+
+/**
+ * Incremental packet framer for the inbound stream
+ * Sees every byte the MQTT client reads and reports each PUBACK's packet
+ * identifier; all other packets are skipped by their remaining length.
+ */
+class PubAckScanner {
+public:
+  typedef void (*AckHandler)(uint16_t packetId);
+
+  explicit PubAckScanner(AckHandler handler) : handler_(handler) { reset(); }
+
+  /**
+   * Start over at a packet boundary (call when a new connection opens)
+   */
+  void reset() {
+    state_ = STATE_HEADER;
+    type_ = 0;
+    remaining_ = 0;
+    bodyRead_ = 0;
+    shift_ = 0;
+    packetId_ = 0;
+  }
+
+  void feed(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+      feed(data[i]);
+    }
+  }
+
+  void feed(uint8_t byte) {
+    switch (state_) {
+      case STATE_HEADER:
+        type_ = byte & 0xF0;
+        remaining_ = 0;
+        bodyRead_ = 0;
+        shift_ = 0;
+        packetId_ = 0;
+        state_ = STATE_LENGTH;
+        break;
+
+      case STATE_LENGTH:
+        remaining_ |= (uint32_t)(byte & 0x7F) << shift_;
+        shift_ += 7;
+        if (byte & 0x80) {
+          if (shift_ >= 28) {
+            reset(); // Malformed length - the connection will not survive it anyway
+          }
+        } else if (remaining_ == 0) {
+          state_ = STATE_HEADER;
+        } else {
+          state_ = STATE_BODY;
+        }
+        break;
+
+      case STATE_BODY:
+        if (type_ == MQTT_PACKET_PUBACK && bodyRead_ < 2) {
+          packetId_ = (uint16_t)((packetId_ << 8) | byte);
+        }
+        bodyRead_++;
+        if (bodyRead_ == remaining_) {
+          if (type_ == MQTT_PACKET_PUBACK && bodyRead_ >= 2 && handler_ != nullptr) {
+            handler_(packetId_);
+          }
+          state_ = STATE_HEADER;
+        }
+        break;
+    }
+  }
+
+private:
+  enum State : uint8_t {
+    STATE_HEADER,
+    STATE_LENGTH,
+    STATE_BODY
+  };
+
+  AckHandler handler_;
+  State state_;
+  uint8_t type_;
+  uint32_t remaining_;   // Body length of the current packet
+  uint32_t bodyRead_;    // Body bytes seen so far
+  uint8_t shift_;        // Next remaining-length digit position
+  uint16_t packetId_;
+};
+
+#endif // MQTT_PACKET_H
@@ -0,0 +1,115 @@
+/**
+ * @file network.h
+ * @brief Queues between the control loop and the MQTT network task
+ *
+ * The network task (core 0) owns every PubSubClient call. The control loop
+ * (core 1) never touches the socket: it serializes messages into the
+ * outbound queue and reads publish outcomes and received setpoints/rules back
+ * from the result and inbound queues. Each queue has exactly one producer
+ * and one consumer.
+ *
+ *   control loop --outboundQueue-------> network task
+ *   control loop <--publishResultQueue-- network task
+ *   control loop <--inboundQueue-------- network task
+ *
+ * Telemetry is delivered at QoS 1: the first MQTT_INFLIGHT_WINDOW entries
+ * of the outbound queue are the in-flight window. They are published
+ * back-to-back and stay queued until their PUBACK arrives, so their
+ * readings stay in the offline buffer until then. After a reconnect the
+ * unacknowledged ones are sent again with the DUP flag.
+ */
+
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <stdint.h>
+#include <PubSubClient.h>
+#include "../constants.h"
+#include "ack_client.h"
+#include "spsc_queue.h"
+
+// Broker connection (used by the network task only)
+extern AckTrackingClient ackClient;
+extern PubSubClient mqttClient;
+
+// Topic strings (built once by initMQTT, read-only afterwards)
+extern char telemetryTopic[];
+extern char telemetryBatchTopic[];
+extern char telemetryBinaryTopic[];
+extern char bufferStatsTopic[];
+extern char alertTopic[];
+extern char setpointTopic[];
+extern char ruleTopic[];
+
+// Topics the network task publishes to
+enum MqttTopicId : uint8_t {
+  MQTT_TOPIC_TELEMETRY,
+  MQTT_TOPIC_TELEMETRY_BATCH,
+  MQTT_TOPIC_TELEMETRY_BINARY,
+  MQTT_TOPIC_BUFFER_STATS,
+  MQTT_TOPIC_ALERT
+};
+
+// Message origin (decides how the control loop handles its result)
+enum OutboundKind : uint8_t {
+  OUTBOUND_LIVE,      // Current reading (QoS 1, re-buffered on failure)
+  OUTBOUND_FLUSH,     // Buffered readings (QoS 1, removed from the buffer on success)
+  OUTBOUND_STATUS,    // Diagnostics (QoS 0, dropped on failure)
+  OUTBOUND_ALERT      // Alerts (QoS 1, sent again on failure)
+};
+
+// Serialized message waiting to be published
+struct OutboundMessage {
+  uint8_t topic;            // MqttTopicId
+  uint8_t kind;             // OutboundKind
+  uint16_t records;         // Buffered readings covered (OUTBOUND_FLUSH)
+  uint16_t length;          // Payload bytes
+
+  // Delivery state (set and used by the network task only)
+  uint16_t packetId;        // QoS 1 packet identifier
+  uint8_t attempts;         // Times sent (DUP is set from the second one)
+  bool acked;               // PUBACK received (QoS 0: written to the socket)
+  uint32_t session;         // Connection it was last sent on
+  unsigned long sentAt;     // Last send (ms)
+
+  char payload[MQTT_MESSAGE_BUFFER_SIZE];
+};
+
+// Outcome of one outbound message (same order as the outbound queue)
+struct PublishResult {
+  uint8_t kind;             // OutboundKind
+  uint16_t records;         // Copied from the message
+  bool ok;                  // Acknowledged by the broker (QoS 0: sent)
+};
+
+// Subscribed topics
+enum InboundTopic : uint8_t {
+  INBOUND_SETPOINTS,        // JSON setpoints
+  INBOUND_RULES             // Compiled rule table (binary)
+};
+
+// Message received on a subscribed topic
+struct InboundMessage {
+  uint8_t topic;            // InboundTopic
+  uint16_t length;          // Payload bytes (payload is NUL-terminated)
+  char payload[MQTT_INBOUND_PAYLOAD_SIZE];
+};
+
+extern SpscQueue<OutboundMessage, MQTT_OUTBOUND_QUEUE_DEPTH> outboundQueue;
+extern SpscQueue<PublishResult, MQTT_RESULT_QUEUE_DEPTH> publishResultQueue;
+extern SpscQueue<InboundMessage, MQTT_INBOUND_QUEUE_DEPTH> inboundQueue;
+
+// PubSubClient callback - runs on the network task, only enqueues
+void mqttCallback(char* topic, uint8_t* payload, unsigned int length);
+
+// Reconnect to the broker when due (network task only)
+void maintainMQTTConnection();
+
+// Mark an in-flight message acknowledged (network task, from AckTrackingClient)
+void handlePubAck(uint16_t packetId);
+
+// Ask the network task to fail every queued message while the broker is
+// unreachable, so their readings can be buffered again (control loop)
+void abandonUnackedMessages();
+
+#endif // NETWORK_H
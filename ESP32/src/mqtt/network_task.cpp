@@ -0,0 +1,281 @@
+/**
+ * @file network_task.cpp
+ * @brief FreeRTOS task that owns all MQTT broker I/O
+ *
+ * Connect, subscribe, publish and mqttClient.loop() run only here, pinned
+ * to core 0. A broker that is slow or unreachable blocks this task, never
+ * the control loop on core 1 (sensors, pump shut-off, web server).
+ *
+ * Telemetry goes out at QoS 1 through a bounded in-flight window (see
+ * network.h); PUBACKs are reported by AckTrackingClient.
+ */
+
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "../constants.h"
+#include "ack_client.h"
+#include "mqtt.h"
+#include "mqtt_packet.h"
+#include "network.h"
+
+static_assert(MQTT_INFLIGHT_WINDOW > 0 && MQTT_INFLIGHT_WINDOW <= MQTT_OUTBOUND_QUEUE_DEPTH,
+              "The in-flight window is the front of the outbound queue");
+
+SpscQueue<OutboundMessage, MQTT_OUTBOUND_QUEUE_DEPTH> outboundQueue;
+SpscQueue<PublishResult, MQTT_RESULT_QUEUE_DEPTH> publishResultQueue;
+SpscQueue<InboundMessage, MQTT_INBOUND_QUEUE_DEPTH> inboundQueue;
+
+// Connection state as last seen by the network task
+static std::atomic<bool> mqttOnline(false);
+static TaskHandle_t networkTaskHandle = nullptr;
+
+// In-flight window: the first `windowAdopted` outbound entries have delivery state
+static size_t windowAdopted = 0;
+static uint16_t lastPacketId = 0;
+static std::atomic<bool> abandonRequested(false);
+
+/**
+ * Callback for incoming MQTT messages (network task)
+ * Copies the payload for the control loop, which parses and applies it
+ */
+void mqttCallback(char* topic, uint8_t* payload, unsigned int length) {
+  Serial.print("📥 Message received on topic: ");
+  Serial.println(topic);
+  
+  if (length >= MQTT_INBOUND_PAYLOAD_SIZE) {
+    Serial.printf("❌ Message too large (%u bytes) - ignored\n", length);
+    return;
+  }
+  
+  InboundMessage* message = inboundQueue.beginPush();
+  if (message == nullptr) {
+    Serial.println("❌ Inbound queue full - message dropped");
+    return;
+  }
+  
+  message->topic = strcmp(topic, ruleTopic) == 0 ? INBOUND_RULES : INBOUND_SETPOINTS;
+  memcpy(message->payload, payload, length);
+  message->payload[length] = '\0';
+  message->length = (uint16_t)length;
+  inboundQueue.commitPush();
+}
+
+/**
+ * Resolve a topic id to its topic string
+ */
+static const char* topicName(uint8_t topic) {
+  switch (topic) {
+    case MQTT_TOPIC_TELEMETRY_BATCH: return telemetryBatchTopic;
+    case MQTT_TOPIC_TELEMETRY_BINARY: return telemetryBinaryTopic;
+    case MQTT_TOPIC_BUFFER_STATS: return bufferStatsTopic;
+    case MQTT_TOPIC_ALERT: return alertTopic;
+    default: return telemetryTopic;
+  }
+}
+
+/**
+ * Allocate a packet identifier
+ * Kept in the upper half so it never matches PubSubClient's own SUBSCRIBE
+ * identifiers, which count up from 1
+ */
+static uint16_t allocatePacketId() {
+  lastPacketId = (uint16_t)(lastPacketId + 1);
+  if (lastPacketId < 0x8000) {
+    lastPacketId = 0x8000;
+  }
+  return lastPacketId;
+}
+
+/**
+ * Mark an in-flight message acknowledged (called while mqttClient reads)
+ * @param packetId Identifier from the PUBACK
+ */
+void handlePubAck(uint16_t packetId) {
+  for (size_t i = 0; i < windowAdopted; i++) {
+    OutboundMessage* message = outboundQueue.peek(i);
+    if (message->attempts > 0 && message->packetId == packetId) {
+      message->acked = true;
+      return;
+    }
+  }
+}
+
+/**
+ * Ask for every queued message to be failed while offline (control loop)
+ * Cleared without effect if the broker comes back first
+ */
+void abandonUnackedMessages() {
+  abandonRequested.store(true, std::memory_order_release);
+}
+
+/**
+ * Write one message to the broker connection
+ * Telemetry is a QoS 1 PUBLISH built here (PubSubClient only does QoS 0);
+ * diagnostics stay best-effort QoS 0 and count as acknowledged once written
+ * @return false if the connection failed
+ */
+static bool sendMessage(OutboundMessage& message) {
+  const char* topic = topicName(message.topic);
+  if (message.kind == OUTBOUND_STATUS) {
+    message.acked = mqttClient.publish(topic, (const uint8_t*)message.payload, message.length);
+    return message.acked;
+  }
+  
+  uint8_t header[MQTT_PUBLISH_HEADER_SIZE(MQTT_TOPIC_BUFFER_SIZE)];
+  size_t headerLength = encodeQos1PublishHeader(header, topic, message.packetId,
+                                                message.length, message.attempts > 0);
+  return mqttClient.write(header, headerLength) == headerLength &&
+         mqttClient.write((const uint8_t*)message.payload, message.length) == message.length;
+}
+
+/**
+ * Send every window entry not yet sent on the current connection
+ * New entries get a packet id; later sends carry the DUP flag
+ */
+static void transmitWindow() {
+  uint32_t session = ackClient.sessions();
+  for (size_t i = 0; i < MQTT_INFLIGHT_WINDOW; i++) {
+    OutboundMessage* message = outboundQueue.peek(i);
+    if (message == nullptr) {
+      break;
+    }
+    
+    if (i == windowAdopted) {
+      message->packetId = message->kind == OUTBOUND_STATUS ? 0 : allocatePacketId();
+      message->attempts = 0;
+      message->acked = false;
+      windowAdopted++;
+    }
+    if (message->acked || (message->attempts > 0 && message->session == session)) {
+      continue;
+    }
+    
+    if (!sendMessage(*message)) {
+      Serial.println("❌ Publish failed - reconnecting");
+      mqttClient.disconnect();
+      return;
+    }
+    if (message->attempts > 0) {
+      Serial.printf("🔁 Re-sent packet %u (DUP)\n", message->packetId);
+    }
+    if (message->attempts < 255) {
+      message->attempts++;
+    }
+    message->session = session;
+    message->sentAt = millis();
+  }
+}
+
+/**
+ * Drop a connection whose oldest PUBACK is overdue (half-open link);
+ * the unacknowledged messages are sent again after the reconnect
+ */
+static void checkAckTimeout() {
+  uint32_t session = ackClient.sessions();
+  for (size_t i = 0; i < windowAdopted; i++) {
+    OutboundMessage* message = outboundQueue.peek(i);
+    if (!message->acked && message->attempts > 0 && message->session == session &&
+        millis() - message->sentAt > MQTT_ACK_TIMEOUT_MS) {
+      Serial.printf("⚠️  No PUBACK for packet %u - reconnecting\n", message->packetId);
+      mqttClient.disconnect();
+      return;
+    }
+  }
+}
+
+/**
+ * Report the outcome of the front message and remove it
+ * @param ok true if the broker acknowledged it
+ */
+static void retireFront(bool ok) {
+  OutboundMessage* message = outboundQueue.front();
+  PublishResult result;
+  result.kind = message->kind;
+  result.records = message->records;
+  result.ok = ok;
+  outboundQueue.pop();
+  publishResultQueue.push(result);
+  if (windowAdopted > 0) {
+    windowAdopted--;
+  }
+}
+
+/**
+ * Deliver queued messages and report each outcome in queue order
+ * A message is only retired when its result is guaranteed to fit
+ */
+static void serviceOutboundQueue() {
+  // Acknowledged messages leave the window in order
+  OutboundMessage* message;
+  while (windowAdopted > 0 && !publishResultQueue.full() &&
+         (message = outboundQueue.front())->acked) {
+    retireFront(true);
+  }
+  
+  if (mqttClient.connected()) {
+    abandonRequested.store(false, std::memory_order_relaxed);
+    transmitWindow();
+    checkAckTimeout();
+    return;
+  }
+  
+  // Offline for too long: fail everything left, acknowledged or not, so
+  // the control loop never removes readings out of order
+  if (abandonRequested.load(std::memory_order_acquire)) {
+    while (!publishResultQueue.full() && outboundQueue.front() != nullptr) {
+      retireFront(false);
+    }
+    if (outboundQueue.empty()) {
+      abandonRequested.store(false, std::memory_order_relaxed);
+    }
+  }
+}
+
+/**
+ * Network task body: connection upkeep, inbound traffic, outbound queue
+ */
+static void networkTask(void* param) {
+  for (;;) {
+    maintainMQTTConnection();
+    
+    if (mqttClient.connected()) {
+      mqttClient.loop(); // Keep-alive and inbound messages (mqttCallback)
+    }
+    
+    serviceOutboundQueue();
+    mqttOnline.store(mqttClient.connected(), std::memory_order_release);
+    
+    vTaskDelay(pdMS_TO_TICKS(NETWORK_TASK_PERIOD_MS));
+  }
+}
+
+/**
+ * Start the network task (call once after initMQTT)
+ */
+void startNetworkTask() {
+  if (networkTaskHandle != nullptr) {
+    return;
+  }
+  
+  BaseType_t created = xTaskCreatePinnedToCore(networkTask, "mqtt_net", NETWORK_TASK_STACK_SIZE,
+                                               nullptr, NETWORK_TASK_PRIORITY,
+                                               &networkTaskHandle, NETWORK_TASK_CORE);
+  if (created != pdPASS) {
+    networkTaskHandle = nullptr;
+    Serial.println("❌ Failed to start network task - MQTT disabled");
+    return;
+  }
+  
+  Serial.printf("📡 Network task started on core %d\n", NETWORK_TASK_CORE);
+}
+
+/**
+ * Check if MQTT is connected (as last seen by the network task)
+ * @return true if connected, false otherwise
+ */
+bool isMQTTConnected() {
+  return mqttOnline.load(std::memory_order_acquire);
+}
@@ -1,21 +1,51 @@
 /**
  * @file reconnect.cpp
  * @brief MQTT reconnection logic with exponential backoff and buffer flushing
+ *
+ * Connection attempts run on the network task (maintainMQTTConnection),
+ * spaced by capped exponential backoff with full jitter; the control loop
+ * only watches for state changes and starts a flush
+ * (handleMQTTReconnection) whenever readings are buffered while connected
+ * and the clock has synced.
  */
 
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
 #include "../constants.h"
 #include "../buffer/buffer.h"
+#include "../clock/clock.h"
 #include "mqtt.h"
+#include "network.h"
+#include "reconnect_policy.h"
 
-// Reconnection state
-unsigned long lastReconnectAttempt = 0;
-bool wasConnectedBefore = false;
-bool buffersFlushed = false;
+static unsigned long policyClock() {
+  return millis();
+}
+
+static uint32_t policyRandom() {
+  return esp_random();
+}
+
+// Reconnection state (network task)
+static ReconnectBackoff backoff(policyClock, policyRandom, MQTT_BACKOFF_BASE_MS,
+                                MQTT_BACKOFF_CAP_MS, MQTT_STABLE_CONNECTION_MS);
+static ConnectionQuality quality(policyClock);
+static bool linkUp = false;
+
+// Guards quality/backoff reads from the control loop
+static portMUX_TYPE connectionStatsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Connection state as seen by the control loop
+static bool wasConnectedBefore = false;
+static bool flushStarted = false;           // A flush was started on this connection
+static unsigned long lastFlushStart = 0;    // When it was started (ms)
 
 /**
- * Handle MQTT reconnection with backoff
- * Automatically flushes buffered data after successful reconnection
+ * Handle MQTT connection state changes (control loop)
+ * Starts flushing buffered data after a successful reconnection, and again
+ * whenever readings were buffered while connected (publish queue busy, a
+ * flush stopped after a failed publish). A new flush waits at least
+ * MQTT_FLUSH_RETRY_MS after the previous one started.
  * Should be called regularly in main loop
  */
 void handleMQTTReconnection() {
@@ -23,32 +53,37 @@ void handleMQTTReconnection() {
   
   if (currentlyConnected) {
     // We are connected
-    if (wasConnectedBefore) {
-      // Was connected, still connected - do nothing
-      return;
-    } else {
-      // Just reconnected! Flush buffers if we have data and haven't flushed yet
+    if (!wasConnectedBefore) {
       Serial.println("\n🔄 STATE CHANGE: MQTT just connected!");
       wasConnectedBefore = true;
-      
-      if (hasBufferedData() && !buffersFlushed) {
-        Serial.println("\n╔══════════════════════════════════════════╗");
-        Serial.println("║  MQTT RECONNECTED - FLUSHING BUFFERS    ║");
-        Serial.println("╚══════════════════════════════════════════╝");
-        
-        int totalBuffered = getTotalBufferedCount();
-        Serial.printf("📦 Total buffered readings: %d\n", totalBuffered);
-        
-        int flushed = flushBufferedTelemetry();
-        
-        if (flushed > 0) {
-          Serial.println("╔══════════════════════════════════════════╗");
-          Serial.printf("║  ✅ FLUSHED %d READINGS SUCCESSFULLY    ║\n", flushed);
-          Serial.println("╚══════════════════════════════════════════╝\n");
-        }
-        
-        buffersFlushed = true;
-      }
+    }
+    
+    // Flush only after the clock has synced (buffered readings may still
+    // carry provisional timestamps until then)
+    if (!hasBufferedData() || isBufferFlushActive() || !isClockSynced()) {
+      return;
+    }
+    
+    unsigned long now = millis();
+    if (flushStarted && now - lastFlushStart < MQTT_FLUSH_RETRY_MS) {
+      return;
+    }
+    
+    if (!flushStarted) {
+      Serial.println("\n╔══════════════════════════════════════════╗");
+      Serial.println("║  MQTT RECONNECTED - FLUSHING BUFFERS    ║");
+      Serial.println("╚══════════════════════════════════════════╝");
+    } else {
+      Serial.println("\n📦 Readings buffered while connected - flushing");
+    }
+    
+    int totalBuffered = getTotalBufferedCount();
+    Serial.printf("📦 Total buffered readings: %d\n", totalBuffered);
+    
+    // Drained incrementally by serviceBufferFlush() from loop()
+    if (startBufferFlush()) {
+      flushStarted = true;
+      lastFlushStart = now;
     }
     return;
   }
@@ -58,19 +93,65 @@ void handleMQTTReconnection() {
     // Just disconnected
     Serial.println("\n⚠️  MQTT connection lost - buffering telemetry");
     wasConnectedBefore = false;
-    buffersFlushed = false; // Reset flush flag for next reconnection
+    flushStarted = false; // Next connection flushes at once
+  }
+}
+
+/**
+ * Reconnect to the broker when the backoff delay has elapsed
+ * Runs on the network task - a slow connect blocks only that task
+ */
+void maintainMQTTConnection() {
+  if (mqttClient.connected()) {
+    portENTER_CRITICAL(&connectionStatsMux);
+    backoff.update(); // Resets the backoff once the link is stable
+    portEXIT_CRITICAL(&connectionStatsMux);
+    return;
   }
   
-  // Try to reconnect
-  unsigned long now = millis();
+  if (linkUp) {
+    // Just dropped - first retry is jittered too
+    linkUp = false;
+    portENTER_CRITICAL(&connectionStatsMux);
+    quality.onDisconnected();
+    backoff.onDisconnected();
+    portEXIT_CRITICAL(&connectionStatsMux);
+  }
   
-  if (now - lastReconnectAttempt > MQTT_RECONNECT_INTERVAL_MS) {
-    lastReconnectAttempt = now;
-    
-    Serial.println("🔄 Attempting MQTT reconnection...");
-    if (connectMQTT()) {
-      lastReconnectAttempt = 0; // Reset on successful connection
-      // Don't set wasConnectedBefore here - let the next loop iteration handle it
-    }
+  if (!backoff.shouldAttempt()) {
+    return;
   }
+  
+  Serial.println("🔄 Attempting MQTT reconnection...");
+  unsigned long attemptStart = millis();
+  bool connected = connectMQTT();
+  unsigned long attemptDuration = millis() - attemptStart;
+  
+  portENTER_CRITICAL(&connectionStatsMux);
+  quality.onAttempt(connected, attemptDuration);
+  if (connected) {
+    backoff.onConnected();
+  } else {
+    backoff.onAttemptFailed();
+  }
+  portEXIT_CRITICAL(&connectionStatsMux);
+  
+  if (connected) {
+    linkUp = true;
+  } else {
+    Serial.printf("⏳ Next MQTT attempt in %lu ms (failures: %u)\n",
+                  backoff.msUntilNextAttempt(), backoff.failures());
+  }
+}
+
+/**
+ * Get connection-quality statistics (safe to call from the control loop)
+ * @param stats Output parameter
+ * @param nextAttemptMs Output parameter for time until the next attempt (ms)
+ */
+void getMQTTConnectionStats(ConnectionStats& stats, unsigned long& nextAttemptMs) {
+  portENTER_CRITICAL(&connectionStatsMux);
+  quality.snapshot(stats);
+  nextAttemptMs = backoff.msUntilNextAttempt();
+  portEXIT_CRITICAL(&connectionStatsMux);
 }
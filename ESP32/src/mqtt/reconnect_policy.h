@@ -0,0 +1,192 @@
+/**
+ * @file reconnect_policy.h
+ * @brief Reconnect backoff and connection-quality tracking
+ *
+ * Header-only with no Arduino dependencies. The clock and random source
+ * are injected as function pointers (millis()/esp_random() on the ESP32,
+ * fakes on the host), so both classes can be driven deterministically.
+ */
+
+#ifndef RECONNECT_POLICY_H
+#define RECONNECT_POLICY_H
+
+#include <stdint.h>
+
+typedef unsigned long (*PolicyClock)();
+typedef uint32_t (*PolicyRandom)();
+
+/**
+ * Capped exponential backoff with full jitter
+ *
+ * After n consecutive failures the next attempt is delayed by a uniform
+ * random time in [0, min(cap, base * 2^n)], so a fleet that loses the broker
+ * at the same moment spreads its reconnects instead of retrying in
+ * lockstep. The failure count resets only once a connection has stayed up
+ * for stableMs; a connection that drops sooner keeps escalating.
+ */
+class ReconnectBackoff {
+public:
+  ReconnectBackoff(PolicyClock clock, PolicyRandom random,
+                   unsigned long baseMs, unsigned long capMs, unsigned long stableMs)
+    : clock_(clock), random_(random), baseMs_(baseMs), capMs_(capMs), stableMs_(stableMs),
+      failures_(0), nextAttemptAt_(0), connectedAt_(0), connected_(false) {}
+
+  /**
+   * Check whether the next connection attempt is due
+   */
+  bool shouldAttempt() const {
+    return !connected_ && (long)(clock_() - nextAttemptAt_) >= 0;
+  }
+
+  /**
+   * Milliseconds until the next attempt (0 if due or connected)
+   */
+  unsigned long msUntilNextAttempt() const {
+    long remaining = (long)(nextAttemptAt_ - clock_());
+    return (connected_ || remaining < 0) ? 0 : (unsigned long)remaining;
+  }
+
+  /**
+   * Record a failed attempt and schedule the next one
+   */
+  void onAttemptFailed() {
+    if (failures_ < 31) {
+      failures_++;
+    }
+    schedule();
+  }
+
+  /**
+   * Record a successful connection
+   */
+  void onConnected() {
+    connected_ = true;
+    connectedAt_ = clock_();
+  }
+
+  /**
+   * Record a lost connection and schedule the first reconnect attempt
+   * (jittered too, so a broker restart is not hit by every device at once)
+   */
+  void onDisconnected() {
+    if (!connected_) {
+      return;
+    }
+    connected_ = false;
+    if (clock_() - connectedAt_ >= stableMs_) {
+      failures_ = 0;
+    } else if (failures_ < 31) {
+      failures_++; // Flapping connection - keep backing off
+    }
+    schedule();
+  }
+
+  /**
+   * Reset the failure count once the connection has proven stable
+   * (call periodically while connected)
+   */
+  void update() {
+    if (connected_ && failures_ > 0 && clock_() - connectedAt_ >= stableMs_) {
+      failures_ = 0;
+    }
+  }
+
+  uint8_t failures() const { return failures_; }
+
+private:
+  void schedule() {
+    unsigned long window = capMs_;
+    if (failures_ < 31 && baseMs_ <= (capMs_ >> failures_)) {
+      window = baseMs_ << failures_;
+    }
+    nextAttemptAt_ = clock_() + (unsigned long)(random_() % (window + 1));
+  }
+
+  PolicyClock clock_;
+  PolicyRandom random_;
+  unsigned long baseMs_;
+  unsigned long capMs_;
+  unsigned long stableMs_;
+  uint8_t failures_;           // Consecutive failed or short-lived connections
+  unsigned long nextAttemptAt_;
+  unsigned long connectedAt_;
+  bool connected_;
+};
+
+// Connection-quality snapshot
+struct ConnectionStats {
+  uint32_t attempts;           // Connection attempts since boot
+  uint32_t successes;          // Successful attempts
+  uint32_t disconnects;        // Connections lost
+  float successRate;           // successes / attempts (0..1)
+  uint32_t meanConnectMs;      // Mean duration of a successful connect (ms)
+  uint32_t offlineMs;          // Total time offline since boot, incl. current outage (ms)
+  bool connected;              // Current state
+};
+
+/**
+ * Running connection-quality model (attempts, success rate, connect
+ * latency and time spent offline)
+ */
+class ConnectionQuality {
+public:
+  explicit ConnectionQuality(PolicyClock clock)
+    : clock_(clock), attempts_(0), successes_(0), disconnects_(0),
+      connectMsTotal_(0), offlineMsTotal_(0), offlineSince_(0), connected_(false) {}
+
+  /**
+   * Record one connection attempt
+   * @param ok true if the attempt connected
+   * @param durationMs Time the attempt took (ms)
+   */
+  void onAttempt(bool ok, unsigned long durationMs) {
+    attempts_++;
+    if (!ok) {
+      return;
+    }
+    successes_++;
+    connectMsTotal_ += durationMs;
+    if (!connected_) {
+      offlineMsTotal_ += clock_() - offlineSince_;
+      connected_ = true;
+    }
+  }
+
+  /**
+   * Record a lost connection (starts the offline timer)
+   */
+  void onDisconnected() {
+    if (!connected_) {
+      return;
+    }
+    disconnects_++;
+    connected_ = false;
+    offlineSince_ = clock_();
+  }
+
+  /**
+   * Copy the current statistics
+   * @param stats Output parameter
+   */
+  void snapshot(ConnectionStats& stats) const {
+    stats.attempts = attempts_;
+    stats.successes = successes_;
+    stats.disconnects = disconnects_;
+    stats.successRate = attempts_ > 0 ? (float)successes_ / attempts_ : 0.0f;
+    stats.meanConnectMs = successes_ > 0 ? (uint32_t)(connectMsTotal_ / successes_) : 0;
+    stats.offlineMs = (uint32_t)(offlineMsTotal_ + (connected_ ? 0 : clock_() - offlineSince_));
+    stats.connected = connected_;
+  }
+
+private:
+  PolicyClock clock_;
+  uint32_t attempts_;
+  uint32_t successes_;
+  uint32_t disconnects_;
+  uint64_t connectMsTotal_;
+  uint64_t offlineMsTotal_;
+  unsigned long offlineSince_;  // Boot counts as offline
+  bool connected_;
+};
+
+#endif // RECONNECT_POLICY_H
@@ -0,0 +1,114 @@
+/**
+ * @file report_filter.h
+ * @brief Report-by-exception filter for live telemetry
+ *
+ * A reading is published only if something worth reporting happened since
+ * the last published one:
+ *   - a sensor moved beyond its deadband, or started/stopped failing
+ *   - an actuator or the tank level changed state, or irrigation ran
+ *   - the heartbeat interval passed without a publish
+ * Readings in between are counted, and the count goes out with the next
+ * published frame.
+ *
+ * Header-only with no Arduino dependencies: the caller passes the current
+ * time in milliseconds.
+ */
+
+#ifndef REPORT_FILTER_H
+#define REPORT_FILTER_H
+
+#include <math.h>
+#include <stdint.h>
+#include "../buffer/buffer.h"
+#include "../constants.h"
+
+class ReportFilter {
+public:
+  /**
+   * @param temperatureDeadband Largest unreported temperature change (°C, 0 = any change)
+   * @param humidityDeadband Largest unreported humidity change (%, 0 = any change)
+   * @param lightDeadband Largest unreported light change (lux, 0 = any change)
+   * @param heartbeatMs Longest time without a publish (ms)
+   */
+  ReportFilter(float temperatureDeadband, float humidityDeadband, float lightDeadband,
+               unsigned long heartbeatMs)
+    : temperatureDeadband_(temperatureDeadband), humidityDeadband_(humidityDeadband),
+      lightDeadband_(lightDeadband), heartbeatMs_(heartbeatMs),
+      hasLast_(false), lastActuators_(0), lastMs_(0), suppressed_(0) {}
+
+  /**
+   * Decide whether a reading has to be published
+   * @param reading Current raw reading
+   * @param actuators Bitmap of actuator states (any bit change forces a publish)
+   * @param nowMs Current time (ms)
+   */
+  bool shouldReport(const TelemetryReading& reading, uint8_t actuators, unsigned long nowMs) const {
+    if (!hasLast_ || nowMs - lastMs_ >= heartbeatMs_) {
+      return true;
+    }
+    if (actuators != lastActuators_ || reading.tankLevel != last_.tankLevel || reading.irrigated) {
+      return true;
+    }
+    return moved(reading.temperature, last_.temperature, temperatureDeadband_, SENSOR_ERROR_TEMP) ||
+           moved(reading.humidity, last_.humidity, humidityDeadband_, SENSOR_ERROR_HUM) ||
+           moved(reading.light < 0 ? SENSOR_ERROR_LIGHT : reading.light,
+                 last_.light < 0 ? SENSOR_ERROR_LIGHT : last_.light, lightDeadband_, SENSOR_ERROR_LIGHT);
+  }
+
+  /**
+   * Make the reading the new reference and clear the suppressed count
+   */
+  void onReported(const TelemetryReading& reading, uint8_t actuators, unsigned long nowMs) {
+    last_ = reading;
+    lastActuators_ = actuators;
+    lastMs_ = nowMs;
+    hasLast_ = true;
+    suppressed_ = 0;
+  }
+
+  /**
+   * Count a reading that was not published
+   */
+  void onSuppressed() {
+    if (suppressed_ < UINT32_MAX) {
+      suppressed_++;
+    }
+  }
+
+  /**
+   * Forget the reference so the next reading is published (e.g. after
+   * readings went to the offline buffer instead); the count is kept
+   */
+  void reset() { hasLast_ = false; }
+
+  /**
+   * Readings not published since the last published one
+   */
+  uint32_t suppressed() const { return suppressed_; }
+
+private:
+  /**
+   * Check one sensor channel against its deadband
+   * A sensor that starts or stops failing always counts as a change
+   */
+  static bool moved(float value, float last, float deadband, float errorValue) {
+    bool failed = value == errorValue;
+    if (failed != (last == errorValue)) {
+      return true;
+    }
+    return !failed && fabsf(value - last) > deadband;
+  }
+
+  float temperatureDeadband_;
+  float humidityDeadband_;
+  float lightDeadband_;
+  unsigned long heartbeatMs_;
+
+  bool hasLast_;
+  TelemetryReading last_;
+  uint8_t lastActuators_;
+  unsigned long lastMs_;
+  uint32_t suppressed_;
+};
+
+#endif // REPORT_FILTER_H
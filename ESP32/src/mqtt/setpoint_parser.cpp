@@ -0,0 +1,337 @@
+/**
+ * @file setpoint_parser.cpp
+ * @brief Bounded, allocation-free parser for setpoint messages
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../constants.h"
+#include "setpoint_parser.h"
+
+// Longest number token converted (longer numbers are rejected as values)
+#define SETPOINT_NUMBER_MAX_LENGTH 31
+
+static const char* const FIELD_NAMES[SETPOINT_FIELD_COUNT] = {
+  "target_temp_min",
+  "target_temp_max",
+  "target_hum_air_max",
+  "target_light_intensity",
+  "irrigation_interval_minutes",
+  "irrigation_duration_seconds",
+  "telemetry_encoding",
+  "heating_kp",
+  "heating_ki",
+  "heating_kd"
+};
+
+// Read position within the payload
+struct Cursor {
+  const char* p;
+  const char* end;
+};
+
+static void skipWhitespace(Cursor& c) {
+  while (c.p < c.end && (*c.p == ' ' || *c.p == '\t' || *c.p == '\n' || *c.p == '\r')) {
+    c.p++;
+  }
+}
+
+static bool consume(Cursor& c, char expected) {
+  if (c.p < c.end && *c.p == expected) {
+    c.p++;
+    return true;
+  }
+  return false;
+}
+
+static bool consumeLiteral(Cursor& c, const char* literal) {
+  size_t length = strlen(literal);
+  if ((size_t)(c.end - c.p) < length || memcmp(c.p, literal, length) != 0) {
+    return false;
+  }
+  c.p += length;
+  return true;
+}
+
+static bool isDigit(char ch) {
+  return ch >= '0' && ch <= '9';
+}
+
+static bool isHexDigit(char ch) {
+  return isDigit(ch) || (ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F');
+}
+
+/**
+ * Scan a string token
+ * @param text Output parameter for the raw contents (escapes not decoded)
+ * @param length Output parameter for the raw length
+ */
+static bool scanString(Cursor& c, const char*& text, size_t& length) {
+  if (!consume(c, '"')) {
+    return false;
+  }
+  text = c.p;
+  while (c.p < c.end) {
+    char ch = *c.p;
+    if (ch == '"') {
+      length = (size_t)(c.p - text);
+      c.p++;
+      return true;
+    }
+    if ((unsigned char)ch < 0x20) {
+      return false;
+    }
+    c.p++;
+    if (ch == '\\') {
+      if (c.p >= c.end) {
+        return false;
+      }
+      char escape = *c.p++;
+      if (escape == 'u') {
+        for (int i = 0; i < 4; i++) {
+          if (c.p >= c.end || !isHexDigit(*c.p)) {
+            return false;
+          }
+          c.p++;
+        }
+      } else if (strchr("\"\\/bfnrt", escape) == nullptr || escape == '\0') {
+        return false;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * Scan a number token (JSON grammar)
+ */
+static bool scanNumber(Cursor& c) {
+  consume(c, '-');
+  if (consume(c, '0')) {
+    // No leading zeros
+  } else if (c.p < c.end && isDigit(*c.p)) {
+    while (c.p < c.end && isDigit(*c.p)) c.p++;
+  } else {
+    return false;
+  }
+  if (consume(c, '.')) {
+    if (c.p >= c.end || !isDigit(*c.p)) return false;
+    while (c.p < c.end && isDigit(*c.p)) c.p++;
+  }
+  if (consume(c, 'e') || consume(c, 'E')) {
+    if (!consume(c, '+')) consume(c, '-');
+    if (c.p >= c.end || !isDigit(*c.p)) return false;
+    while (c.p < c.end && isDigit(*c.p)) c.p++;
+  }
+  return true;
+}
+
+/**
+ * Skip any JSON value (nesting limited to SETPOINT_MAX_NESTING)
+ */
+static bool skipValue(Cursor& c, int depth) {
+  if (c.p >= c.end) {
+    return false;
+  }
+  const char* text;
+  size_t length;
+  switch (*c.p) {
+    case '"':
+      return scanString(c, text, length);
+    case 't':
+      return consumeLiteral(c, "true");
+    case 'f':
+      return consumeLiteral(c, "false");
+    case 'n':
+      return consumeLiteral(c, "null");
+    case '{':
+    case '[': {
+      if (depth >= SETPOINT_MAX_NESTING) {
+        return false;
+      }
+      bool object = *c.p++ == '{';
+      char close = object ? '}' : ']';
+      skipWhitespace(c);
+      if (consume(c, close)) {
+        return true;
+      }
+      for (;;) {
+        if (object) {
+          if (!scanString(c, text, length)) return false;
+          skipWhitespace(c);
+          if (!consume(c, ':')) return false;
+          skipWhitespace(c);
+        }
+        if (!skipValue(c, depth + 1)) return false;
+        skipWhitespace(c);
+        if (consume(c, close)) return true;
+        if (!consume(c, ',')) return false;
+        skipWhitespace(c);
+      }
+    }
+    default:
+      return scanNumber(c);
+  }
+}
+
+/**
+ * Convert a scanned number token
+ * @return false if the token is not a number or too long
+ */
+static bool toNumber(const char* text, size_t length, double& number) {
+  if (length == 0 || length > SETPOINT_NUMBER_MAX_LENGTH || (*text != '-' && !isDigit(*text))) {
+    return false;
+  }
+  char digits[SETPOINT_NUMBER_MAX_LENGTH + 1];
+  memcpy(digits, text, length);
+  digits[length] = '\0';
+  number = strtod(digits, nullptr);
+  return isfinite(number);
+}
+
+static bool inRange(double number, double minValue, double maxValue) {
+  return number >= minValue && number <= maxValue;
+}
+
+/**
+ * Validate one field value and store it in the command
+ * @return true if the value was accepted
+ */
+static bool storeField(SetpointCommand& command, uint8_t field, const char* text, size_t length) {
+  if (field == SETPOINT_TELEMETRY_ENCODING) {
+    if (length == 8 && memcmp(text, "\"binary\"", 8) == 0) {
+      command.telemetryEncoding = TELEMETRY_ENCODING_BINARY;
+      return true;
+    }
+    if (length == 6 && memcmp(text, "\"json\"", 6) == 0) {
+      command.telemetryEncoding = TELEMETRY_ENCODING_JSON;
+      return true;
+    }
+    return false;
+  }
+  
+  double number;
+  if (!toNumber(text, length, number)) {
+    return false;
+  }
+  
+  switch (field) {
+    case SETPOINT_TEMP_MIN:
+    case SETPOINT_TEMP_MAX:
+      if (!inRange(number, SETPOINT_TEMP_LIMIT_MIN, SETPOINT_TEMP_LIMIT_MAX)) return false;
+      (field == SETPOINT_TEMP_MIN ? command.tempMin : command.tempMax) = (float)number;
+      return true;
+    case SETPOINT_HUM_AIR_MAX:
+      if (!inRange(number, SETPOINT_HUM_LIMIT_MIN, SETPOINT_HUM_LIMIT_MAX)) return false;
+      command.humAirMax = (float)number;
+      return true;
+    case SETPOINT_LIGHT_INTENSITY:
+      if (!inRange(number, SETPOINT_LIGHT_LIMIT_MIN, SETPOINT_LIGHT_LIMIT_MAX)) return false;
+      command.lightIntensity = (float)number;
+      return true;
+    case SETPOINT_IRRIGATION_INTERVAL:
+      if (number != floor(number) ||
+          !inRange(number, SETPOINT_IRRIGATION_INTERVAL_LIMIT_MIN, SETPOINT_IRRIGATION_INTERVAL_LIMIT_MAX)) {
+        return false;
+      }
+      command.irrigationIntervalMinutes = (unsigned long)number;
+      return true;
+    case SETPOINT_IRRIGATION_DURATION:
+      if (number != floor(number) ||
+          !inRange(number, SETPOINT_IRRIGATION_DURATION_LIMIT_MIN, SETPOINT_IRRIGATION_DURATION_LIMIT_MAX)) {
+        return false;
+      }
+      command.irrigationDurationSeconds = (unsigned long)number;
+      return true;
+    case SETPOINT_HEATING_KP:
+      if (!inRange(number, 0.0, SETPOINT_HEATING_KP_LIMIT_MAX)) return false;
+      command.heatingKp = (float)number;
+      return true;
+    case SETPOINT_HEATING_KI:
+      if (!inRange(number, 0.0, SETPOINT_HEATING_KI_LIMIT_MAX)) return false;
+      command.heatingKi = (float)number;
+      return true;
+    case SETPOINT_HEATING_KD:
+      if (!inRange(number, 0.0, SETPOINT_HEATING_KD_LIMIT_MAX)) return false;
+      command.heatingKd = (float)number;
+      return true;
+    default:
+      return false;
+  }
+}
+
+static int findField(const char* key, size_t length) {
+  for (uint8_t field = 0; field < SETPOINT_FIELD_COUNT; field++) {
+    if (strlen(FIELD_NAMES[field]) == length && memcmp(FIELD_NAMES[field], key, length) == 0) {
+      return field;
+    }
+  }
+  return -1;
+}
+
+static SetpointParseResult parseObject(Cursor& c, SetpointCommand& command) {
+  skipWhitespace(c);
+  if (!consume(c, '{')) {
+    return SETPOINT_PARSE_MALFORMED;
+  }
+  skipWhitespace(c);
+  if (!consume(c, '}')) {
+    for (;;) {
+      const char* key;
+      size_t keyLength;
+      if (!scanString(c, key, keyLength)) return SETPOINT_PARSE_MALFORMED;
+      skipWhitespace(c);
+      if (!consume(c, ':')) return SETPOINT_PARSE_MALFORMED;
+      skipWhitespace(c);
+      
+      const char* value = c.p;
+      if (!skipValue(c, 1)) return SETPOINT_PARSE_MALFORMED;
+      
+      // Later duplicates override earlier ones
+      int field = findField(key, keyLength);
+      if (field >= 0) {
+        uint16_t bit = SETPOINT_FIELD_BIT(field);
+        if (storeField(command, (uint8_t)field, value, (size_t)(c.p - value))) {
+          command.present |= bit;
+          command.rejected &= (uint16_t)~bit;
+        } else {
+          command.present &= (uint16_t)~bit;
+          command.rejected |= bit;
+        }
+      }
+      
+      skipWhitespace(c);
+      if (consume(c, '}')) break;
+      if (!consume(c, ',')) return SETPOINT_PARSE_MALFORMED;
+      skipWhitespace(c);
+    }
+  }
+  skipWhitespace(c);
+  return c.p == c.end ? SETPOINT_PARSE_OK : SETPOINT_PARSE_MALFORMED;
+}
+
+/**
+ * Parse a setpoint message
+ */
+SetpointParseResult parseSetpointCommand(const char* payload, size_t length, SetpointCommand& command) {
+  memset(&command, 0, sizeof(command));
+  if (length > MQTT_INBOUND_PAYLOAD_SIZE) {
+    return SETPOINT_PARSE_TOO_LARGE;
+  }
+  
+  Cursor c = { payload, payload + length };
+  SetpointParseResult result = parseObject(c, command);
+  if (result != SETPOINT_PARSE_OK) {
+    command.present = 0;
+    command.rejected = 0;
+  }
+  return result;
+}
+
+/**
+ * Get the JSON member name of a field
+ */
+const char* getSetpointFieldName(uint8_t field) {
+  return field < SETPOINT_FIELD_COUNT ? FIELD_NAMES[field] : "unknown";
+}
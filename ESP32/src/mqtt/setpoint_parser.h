@@ -0,0 +1,71 @@
+/**
+ * @file setpoint_parser.h
+ * @brief Bounded, allocation-free parser for setpoint messages
+ *
+ * Scans the JSON payload in place (no copy, no heap) and extracts only the
+ * known setpoint fields. Unknown members such as "changed_at" are skipped.
+ * Each field is range-checked on its own: a missing or invalid field is
+ * simply not reported, so the caller keeps its current value.
+ */
+
+#ifndef SETPOINT_PARSER_H
+#define SETPOINT_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "mqtt.h"
+
+// Fields of a setpoint message (bit positions in the masks below)
+enum SetpointField : uint8_t {
+  SETPOINT_TEMP_MIN,              // target_temp_min
+  SETPOINT_TEMP_MAX,              // target_temp_max
+  SETPOINT_HUM_AIR_MAX,           // target_hum_air_max
+  SETPOINT_LIGHT_INTENSITY,       // target_light_intensity
+  SETPOINT_IRRIGATION_INTERVAL,   // irrigation_interval_minutes
+  SETPOINT_IRRIGATION_DURATION,   // irrigation_duration_seconds
+  SETPOINT_TELEMETRY_ENCODING,    // telemetry_encoding ("json" | "binary")
+  SETPOINT_HEATING_KP,            // heating_kp
+  SETPOINT_HEATING_KI,            // heating_ki
+  SETPOINT_HEATING_KD,            // heating_kd
+  SETPOINT_FIELD_COUNT
+};
+
+#define SETPOINT_FIELD_BIT(field) ((uint16_t)(1u << (field)))
+
+// Parsed setpoint message (values are valid only where `present` is set)
+struct SetpointCommand {
+  uint16_t present;                     // Valid fields (SETPOINT_FIELD_BIT mask)
+  uint16_t rejected;                    // Fields with a wrong type or out of range
+  float tempMin;
+  float tempMax;
+  float humAirMax;
+  float lightIntensity;
+  unsigned long irrigationIntervalMinutes;
+  unsigned long irrigationDurationSeconds;
+  TelemetryEncoding telemetryEncoding;
+  float heatingKp;
+  float heatingKi;
+  float heatingKd;
+};
+
+enum SetpointParseResult {
+  SETPOINT_PARSE_OK,
+  SETPOINT_PARSE_TOO_LARGE,       // Longer than MQTT_INBOUND_PAYLOAD_SIZE
+  SETPOINT_PARSE_MALFORMED        // Not a JSON object
+};
+
+/**
+ * Parse a setpoint message
+ * @param payload Message bytes (need not be NUL-terminated)
+ * @param length Message length
+ * @param command Output parameter (masks are cleared unless the result is OK)
+ * @return Parse result
+ */
+SetpointParseResult parseSetpointCommand(const char* payload, size_t length, SetpointCommand& command);
+
+/**
+ * Get the JSON member name of a field (for logging)
+ */
+const char* getSetpointFieldName(uint8_t field);
+
+#endif // SETPOINT_PARSER_H
@@ -0,0 +1,145 @@
+/**
+ * @file spsc_queue.h
+ * @brief Bounded lock-free single-producer/single-consumer queue
+ *
+ * Connects the control loop (core 1) and the network task (core 0).
+ * Exactly one task may push and exactly one task may pop; no locks or
+ * heap allocation are used, so neither side can block the other.
+ *
+ * Header-only with no Arduino dependencies, so it can be exercised on the
+ * host with two std::threads.
+ *
+ * Large elements can be filled and consumed in place:
+ *   producer: slot = beginPush(); ...fill slot...; commitPush();
+ *   consumer: item = front(); ...use item...; pop();
+ *
+ * The consumer may also look past the front with peek(), e.g. to keep
+ * several elements in flight before popping them in order.
+ */
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stddef.h>
+#include <atomic>
+
+template <typename T, size_t N>
+class SpscQueue {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+  SpscQueue() : head_(0), tail_(0) {}
+
+  static constexpr size_t capacity() { return N; }
+
+  // ---------- Producer side ----------
+
+  /**
+   * Reserve the next free slot
+   * @return Slot to fill, or nullptr if the queue is full
+   */
+  T* beginPush() {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == N) {
+      return nullptr;
+    }
+    return &items_[tail & (N - 1)];
+  }
+
+  /**
+   * Publish the slot returned by beginPush() to the consumer
+   */
+  void commitPush() {
+    tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  /**
+   * Copy an element into the queue
+   * @return false if the queue is full
+   */
+  bool push(const T& item) {
+    T* slot = beginPush();
+    if (slot == nullptr) {
+      return false;
+    }
+    *slot = item;
+    commitPush();
+    return true;
+  }
+
+  /**
+   * Check for free space (exact from the producer side)
+   */
+  bool full() const {
+    return tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_acquire) == N;
+  }
+
+  // ---------- Consumer side ----------
+
+  /**
+   * Access the oldest element without removing it
+   * @return Element, or nullptr if the queue is empty
+   */
+  T* front() {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    return &items_[head & (N - 1)];
+  }
+
+  /**
+   * Access a queued element without removing it
+   * @param offset Position from the oldest element (0 = front())
+   * @return Element, or nullptr if fewer than offset + 1 are queued
+   */
+  T* peek(size_t offset) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (tail_.load(std::memory_order_acquire) - head <= offset) {
+      return nullptr;
+    }
+    return &items_[(head + offset) & (N - 1)];
+  }
+
+  /**
+   * Release the element returned by front() back to the producer
+   */
+  void pop() {
+    head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  /**
+   * Copy and remove the oldest element
+   * @return false if the queue is empty
+   */
+  bool pop(T& out) {
+    T* item = front();
+    if (item == nullptr) {
+      return false;
+    }
+    out = *item;
+    pop();
+    return true;
+  }
+
+  /**
+   * Check for pending elements (exact from the consumer side)
+   */
+  bool empty() const {
+    return head_.load(std::memory_order_relaxed) == tail_.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Number of queued elements (a snapshot when called from a third task)
+   */
+  size_t size() const {
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+  }
+
+private:
+  T items_[N];
+  std::atomic<size_t> head_;  // Next element to pop (written by consumer only)
+  std::atomic<size_t> tail_;  // Next slot to fill (written by producer only)
+};
+
+#endif // SPSC_QUEUE_H
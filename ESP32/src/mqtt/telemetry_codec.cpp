@@ -0,0 +1,176 @@
+/**
+ * @file telemetry_codec.cpp
+ * @brief Compact binary telemetry encoding
+ */
+
+#include <string.h>
+#include "telemetry_codec.h"
+
+// Stats mask bits (aggregate block)
+#define BINARY_STATS_TEMPERATURE 0x01
+#define BINARY_STATS_HUMIDITY    0x02
+#define BINARY_STATS_LIGHT       0x04
+
+/**
+ * Append an unsigned LEB128 varint
+ * @return Bytes written
+ */
+static size_t putVarint(uint8_t* out, uint32_t value) {
+  size_t n = 0;
+  while (value >= 0x80) {
+    out[n++] = (uint8_t)(value | 0x80);
+    value >>= 7;
+  }
+  out[n++] = (uint8_t)value;
+  return n;
+}
+
+/**
+ * Append a 16-bit little-endian value
+ * @return Bytes written
+ */
+static size_t putU16(uint8_t* out, uint16_t value) {
+  out[0] = (uint8_t)value;
+  out[1] = (uint8_t)(value >> 8);
+  return 2;
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+/**
+ * Parse a textual UUID into 16 bytes
+ */
+bool parseUuid(const char* text, uint8_t uuid[16]) {
+  int digits = 0;
+  for (const char* p = text; *p != '\0'; p++) {
+    if (*p == '-') {
+      continue;
+    }
+    int value = hexValue(*p);
+    if (value < 0 || digits >= 32) {
+      return false;
+    }
+    if (digits % 2 == 0) {
+      uuid[digits / 2] = (uint8_t)(value << 4);
+    } else {
+      uuid[digits / 2] |= (uint8_t)value;
+    }
+    digits++;
+  }
+  return digits == 32;
+}
+
+BinaryTelemetryWriter::BinaryTelemetryWriter(uint8_t* buffer, size_t capacity, const uint8_t deviceUuid[16])
+  : buffer_(buffer), capacity_(capacity), size_(TELEMETRY_BINARY_HEADER_SIZE), count_(0) {
+  buffer_[0] = TELEMETRY_BINARY_VERSION;
+  memcpy(buffer_ + 1, deviceUuid, 16);
+  buffer_[17] = 0;
+}
+
+/**
+ * Add the suppressed-reading count to the header
+ */
+bool BinaryTelemetryWriter::setSuppressed(uint32_t suppressed) {
+  if (count_ > 0 || (buffer_[0] & BINARY_HEADER_SUPPRESSED) || size_ + 5 > capacity_) {
+    return false;
+  }
+  buffer_[0] |= BINARY_HEADER_SUPPRESSED;
+  size_ += putVarint(buffer_ + size_, suppressed);
+  return true;
+}
+
+/**
+ * Append one raw reading
+ */
+bool BinaryTelemetryWriter::add(const PackedReading& record, uint32_t sequence) {
+  return addRecord(record, nullptr, sequence);
+}
+
+/**
+ * Append one aggregate
+ */
+bool BinaryTelemetryWriter::add(const PackedAggregate& record, uint32_t sequence) {
+  return addRecord(record.mean, record.samples > 1 ? &record : nullptr, sequence);
+}
+
+/**
+ * Append one record (encoded into a scratch record first so a record
+ * that does not fit leaves the message untouched)
+ * @param mean Means, flags and timestamp
+ * @param aggregate Statistics block, or nullptr for a raw reading
+ */
+bool BinaryTelemetryWriter::addRecord(const PackedReading& mean, const PackedAggregate* aggregate,
+                                      uint32_t sequence) {
+  if (count_ == 255) {
+    return false;
+  }
+  
+  uint8_t scratch[TELEMETRY_BINARY_MAX_RECORD_SIZE];
+  size_t n = 0;
+  
+  n += putVarint(scratch + n, mean.epoch);
+  n += putVarint(scratch + n, sequence);
+  
+  uint8_t flags = 0;
+  if (mean.flags & PACKED_FLAG_TANK_LEVEL) flags |= BINARY_FLAG_TANK_LEVEL;
+  if (mean.flags & PACKED_FLAG_PUMP_ON) flags |= BINARY_FLAG_PUMP_ON;
+  if (mean.flags & PACKED_FLAG_LIGHTS_ON) flags |= BINARY_FLAG_LIGHTS_ON;
+  if (mean.flags & PACKED_FLAG_IRRIGATED) flags |= BINARY_FLAG_IRRIGATED;
+  if (mean.flags & PACKED_FLAG_TEMP_OK) flags |= BINARY_FLAG_TEMPERATURE;
+  if (mean.flags & PACKED_FLAG_HUM_OK) flags |= BINARY_FLAG_HUMIDITY;
+  if (mean.flags & PACKED_FLAG_LIGHT_OK) flags |= BINARY_FLAG_LIGHT;
+  if (aggregate != nullptr) flags |= BINARY_FLAG_AGGREGATE;
+  scratch[n++] = flags;
+  
+  if (flags & BINARY_FLAG_TEMPERATURE) {
+    n += putU16(scratch + n, (uint16_t)mean.temperature);
+  }
+  if (flags & BINARY_FLAG_HUMIDITY) {
+    n += putU16(scratch + n, mean.humidity);
+  }
+  if (flags & BINARY_FLAG_LIGHT) {
+    n += putVarint(scratch + n, mean.light);
+  }
+  
+  if (aggregate != nullptr) {
+    const PackedAggregate& record = *aggregate;
+    n += putVarint(scratch + n, record.samples);
+    scratch[n++] = record.events;
+    
+    uint8_t statsMask = 0;
+    if (record.temperatureCount > 0) statsMask |= BINARY_STATS_TEMPERATURE;
+    if (record.humidityCount > 0) statsMask |= BINARY_STATS_HUMIDITY;
+    if (record.lightCount > 0) statsMask |= BINARY_STATS_LIGHT;
+    scratch[n++] = statsMask;
+    
+    if (statsMask & BINARY_STATS_TEMPERATURE) {
+      n += putU16(scratch + n, (uint16_t)record.temperatureMin);
+      n += putU16(scratch + n, (uint16_t)record.temperatureMax);
+      n += putVarint(scratch + n, record.temperatureStdDev);
+    }
+    if (statsMask & BINARY_STATS_HUMIDITY) {
+      n += putU16(scratch + n, record.humidityMin);
+      n += putU16(scratch + n, record.humidityMax);
+      n += putVarint(scratch + n, record.humidityStdDev);
+    }
+    if (statsMask & BINARY_STATS_LIGHT) {
+      n += putVarint(scratch + n, record.lightMin);
+      n += putVarint(scratch + n, record.lightMax);
+      n += putVarint(scratch + n, record.lightStdDev);
+    }
+  }
+  
+  if (size_ + n > capacity_) {
+    return false;
+  }
+  
+  memcpy(buffer_ + size_, scratch, n);
+  size_ += n;
+  buffer_[17] = ++count_;
+  return true;
+}
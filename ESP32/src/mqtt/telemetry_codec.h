@@ -0,0 +1,114 @@
+/**
+ * @file telemetry_codec.h
+ * @brief Compact binary telemetry encoding (alternative to JSON)
+ *
+ * Same fields as the JSON telemetry message, published on
+ * greenhouse/{id}/telemetry/bin. A live reading is ~30 bytes instead of
+ * ~250. All multi-byte integers are little-endian; varints are unsigned
+ * LEB128.
+ *
+ * Message (version 1):
+ *   u8      version (TELEMETRY_BINARY_VERSION) | BINARY_HEADER_SUPPRESSED
+ *   u8[16]  device UUID (binary form of DEVICE_ID)
+ *   u8      record count
+ *   varint  readings suppressed before this one   if BINARY_HEADER_SUPPRESSED
+ *   record  x count (oldest first)
+ *
+ * Record:
+ *   varint  timestamp (Unix seconds)
+ *   varint  sequence
+ *   u8      flags (BINARY_FLAG_*)
+ *   i16     temperature, °C x100             if BINARY_FLAG_TEMPERATURE
+ *   u16     humidity, % x100                 if BINARY_FLAG_HUMIDITY
+ *   varint  light, lux x100                  if BINARY_FLAG_LIGHT
+ *   aggregate block                          if BINARY_FLAG_AGGREGATE:
+ *     varint  samples
+ *     u8      events (READING_EVENT_*)
+ *     u8      stats mask (bit 0 temperature, 1 humidity, 2 light)
+ *     i16 min, i16 max, varint stddev        temperature, °C x100
+ *     u16 min, u16 max, varint stddev        humidity, % x100
+ *     varint min, varint max, varint stddev  light, whole lux
+ */
+
+#ifndef TELEMETRY_CODEC_H
+#define TELEMETRY_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../buffer/buffer.h"
+
+#define TELEMETRY_BINARY_VERSION 1
+#define TELEMETRY_BINARY_HEADER_SIZE 18      // version + UUID + record count
+#define TELEMETRY_BINARY_MAX_RECORD_SIZE 64  // Worst case for one record (bytes)
+
+// Version byte flag: suppressed-reading count follows the record count
+#define BINARY_HEADER_SUPPRESSED 0x80
+
+// Record flags
+#define BINARY_FLAG_TANK_LEVEL   0x01  // Water tank OK
+#define BINARY_FLAG_PUMP_ON      0x02  // Pump state
+#define BINARY_FLAG_LIGHTS_ON    0x04  // LED state
+#define BINARY_FLAG_IRRIGATED    0x08  // Irrigation occurred since last transmission
+#define BINARY_FLAG_TEMPERATURE  0x10  // Temperature field present
+#define BINARY_FLAG_HUMIDITY     0x20  // Humidity field present
+#define BINARY_FLAG_LIGHT        0x40  // Light field present
+#define BINARY_FLAG_AGGREGATE    0x80  // Aggregate block present
+
+/**
+ * Parse a textual UUID ("8ce70399-99f9-46dd-...") into 16 bytes
+ * @param text UUID string (hyphens optional)
+ * @param uuid Output parameter for the binary UUID
+ * @return true if text held exactly 32 hex digits
+ */
+bool parseUuid(const char* text, uint8_t uuid[16]);
+
+/**
+ * Builds one binary telemetry message in a caller-provided buffer
+ */
+class BinaryTelemetryWriter {
+public:
+  /**
+   * Write the message header
+   * @param buffer Destination (at least TELEMETRY_BINARY_HEADER_SIZE bytes)
+   * @param capacity Size of the destination
+   * @param deviceUuid Binary device UUID
+   */
+  BinaryTelemetryWriter(uint8_t* buffer, size_t capacity, const uint8_t deviceUuid[16]);
+
+  /**
+   * Add the count of readings held back by report-by-exception
+   * (live messages only; must be called before the first add())
+   * @param suppressed Readings not published since the previous message
+   * @return false if records were already added or it does not fit
+   */
+  bool setSuppressed(uint32_t suppressed);
+
+  /**
+   * Append one raw reading
+   * @param record Reading in packed fixed-point form
+   * @param sequence Message sequence number
+   * @return false if the record does not fit (message left unchanged)
+   */
+  bool add(const PackedReading& record, uint32_t sequence);
+
+  /**
+   * Append one aggregate (written as a raw reading if samples <= 1)
+   * @param record Aggregate in packed fixed-point form
+   * @param sequence Message sequence number
+   * @return false if the record does not fit (message left unchanged)
+   */
+  bool add(const PackedAggregate& record, uint32_t sequence);
+
+  uint8_t count() const { return count_; }
+  size_t size() const { return size_; }
+
+private:
+  bool addRecord(const PackedReading& mean, const PackedAggregate* aggregate, uint32_t sequence);
+
+  uint8_t* buffer_;
+  size_t capacity_;
+  size_t size_;
+  uint8_t count_;
+};
+
+#endif // TELEMETRY_CODEC_H
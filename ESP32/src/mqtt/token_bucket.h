@@ -0,0 +1,83 @@
+/**
+ * @file token_bucket.h
+ * @brief Token bucket rate limiter used to pace the buffer flush
+ *
+ * Header-only with no Arduino dependencies: the caller passes the current
+ * time in milliseconds, so the limiter can be driven by millis() on the
+ * ESP32 or by a fake clock on the host. Tokens are stored in thousandths
+ * to keep the arithmetic integer-only.
+ */
+
+#ifndef TOKEN_BUCKET_H
+#define TOKEN_BUCKET_H
+
+#include <stdint.h>
+
+class TokenBucket {
+public:
+  /**
+   * @param capacity Maximum burst (whole tokens)
+   * @param ratePerSecond Refill rate (tokens per second, > 0)
+   */
+  TokenBucket(uint32_t capacity, uint32_t ratePerSecond)
+    : capacity_(capacity * 1000UL), rate_(ratePerSecond), tokens_(capacity * 1000UL), last_(0) {}
+
+  /**
+   * Refill the bucket completely
+   * @param nowMs Current time (ms)
+   */
+  void reset(unsigned long nowMs) {
+    tokens_ = capacity_;
+    last_ = nowMs;
+  }
+
+  /**
+   * Take one token if available
+   * @param nowMs Current time (ms)
+   * @return true if a token was taken, false if the caller must wait
+   */
+  bool tryConsume(unsigned long nowMs) {
+    refill(nowMs);
+    if (tokens_ < 1000UL) {
+      return false;
+    }
+    tokens_ -= 1000UL;
+    return true;
+  }
+
+  /**
+   * Milliseconds until the next token is available (0 if one is ready)
+   * @param nowMs Current time (ms)
+   */
+  unsigned long msUntilAvailable(unsigned long nowMs) {
+    refill(nowMs);
+    if (tokens_ >= 1000UL) {
+      return 0;
+    }
+    // rate_ tokens/s == rate_ milli-tokens/ms
+    return (1000UL - tokens_ + rate_ - 1) / rate_;
+  }
+
+private:
+  void refill(unsigned long nowMs) {
+    unsigned long elapsed = nowMs - last_;  // Wrap-safe
+    last_ = nowMs;
+    // Bound elapsed before multiplying so long idle periods cannot overflow
+    unsigned long fillMs = (capacity_ - tokens_) / rate_ + 1;
+    if (elapsed >= fillMs) {
+      tokens_ = capacity_;
+      return;
+    }
+    tokens_ += elapsed * rate_;
+    if (tokens_ > capacity_) {
+      tokens_ = capacity_;
+    }
+  }
+
+  uint32_t capacity_;  // Milli-tokens
+  uint32_t rate_;      // Milli-tokens per ms (== tokens per second)
+  uint32_t tokens_;    // Milli-tokens available
+  unsigned long last_; // Time of last refill (ms)
+};
+
+#endif // TOKEN_BUCKET_H
@@ -0,0 +1,316 @@
+/**
+ * @file task_scheduler.h
+ * @brief Cooperative scheduler for the work done in loop()
+ *
+ * Periodic and one-shot tasks are kept in a fixed-capacity min-heap
+ * ordered by deadline (ties run in registration order). tick() runs every
+ * due task, then hands the time until the next deadline to an idle hook,
+ * which can block (vTaskDelay on the ESP32) instead of busy-waiting.
+ *
+ * Deadlines are compared as signed differences, so they stay correct when
+ * millis() wraps. Periodic tasks run at a fixed rate: a late run does not
+ * shift later ones, and ticks that could not run at all are counted as
+ * missed rather than run back-to-back. A run longer than the task's budget
+ * (its period by default) counts as an overrun and is reported to the
+ * overrun hook.
+ *
+ * Header-only with no Arduino dependencies. The clock is injected as a
+ * function pointer (millis() on the ESP32, a simulated clock on the host).
+ */
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned long (*SchedulerClock)();
+typedef void (*TaskCallback)();
+typedef void (*IdleHook)(unsigned long idleMs);
+typedef void (*OverrunHook)(const char* name, unsigned long runMs, unsigned long budgetMs);
+
+// Per-task counters (since registration)
+struct TaskStats {
+  const char* name;
+  unsigned long periodMs;     // 0 for one-shot tasks
+  uint32_t runs;
+  uint32_t overruns;          // Runs longer than the budget
+  uint32_t missed;            // Periodic ticks skipped because the task was late
+  unsigned long maxRunMs;     // Longest run
+};
+
+template <size_t Capacity>
+class TaskScheduler {
+  static_assert(Capacity > 0 && Capacity < 255, "Scheduler capacity must fit a task id");
+
+public:
+  explicit TaskScheduler(SchedulerClock clock)
+    : clock_(clock), idleHook_(nullptr), overrunHook_(nullptr), heapSize_(0),
+      running_(-1), nextOrder_(0) {
+    for (size_t i = 0; i < Capacity; i++) {
+      tasks_[i].used = false;
+    }
+  }
+
+  /**
+   * Register a periodic task
+   * @param name Task name (for stats and overrun reports)
+   * @param callback Work to run
+   * @param periodMs Period (ms, > 0)
+   * @param firstDelayMs Delay before the first run (ms)
+   * @param budgetMs Longest expected run (ms, 0 = the period)
+   * @return Task id, or -1 if no slot is free or the period is 0
+   */
+  int every(const char* name, TaskCallback callback, unsigned long periodMs,
+            unsigned long firstDelayMs = 0, unsigned long budgetMs = 0) {
+    if (periodMs == 0) {
+      return -1;
+    }
+    return add(name, callback, periodMs, firstDelayMs, budgetMs > 0 ? budgetMs : periodMs);
+  }
+
+  /**
+   * Register a one-shot task (its slot is freed after it runs)
+   * @param name Task name
+   * @param callback Work to run
+   * @param delayMs Delay before the run (ms)
+   * @param budgetMs Longest expected run (ms, 0 = not checked)
+   * @return Task id, or -1 if no slot is free
+   */
+  int after(const char* name, TaskCallback callback, unsigned long delayMs,
+            unsigned long budgetMs = 0) {
+    return add(name, callback, 0, delayMs, budgetMs);
+  }
+
+  /**
+   * Remove a task (a task may cancel itself while running)
+   * @return true if the task existed
+   */
+  bool cancel(int id) {
+    if (!valid(id)) {
+      return false;
+    }
+    Task& task = tasks_[id];
+    if (task.heapIndex >= 0) {
+      removeAt((size_t)task.heapIndex);
+    }
+    if (id == running_) {
+      running_ = -1; // runDue() must not reschedule it
+    }
+    task.used = false;
+    return true;
+  }
+
+  /**
+   * Run every task whose deadline has passed
+   * Bounded to Capacity runs per call so a task that is always late cannot
+   * starve the caller
+   * @return Milliseconds until the next deadline (0 if a task is still due)
+   */
+  unsigned long runDue() {
+    for (size_t runs = 0; runs < Capacity && heapSize_ > 0; runs++) {
+      int id = heap_[0];
+      Task& task = tasks_[id];
+      unsigned long start = clock_();
+      if ((long)(start - task.deadline) < 0) {
+        break;
+      }
+
+      removeAt(0);
+      running_ = id;
+      task.callback();
+      bool cancelled = running_ != id;
+      running_ = -1;
+      if (cancelled) {
+        continue; // Slot may already hold a task registered by the callback
+      }
+
+      unsigned long runMs = clock_() - start;
+      task.stats.runs++;
+      if (runMs > task.stats.maxRunMs) {
+        task.stats.maxRunMs = runMs;
+      }
+      if (task.budgetMs > 0 && runMs > task.budgetMs) {
+        task.stats.overruns++;
+        if (overrunHook_ != nullptr) {
+          overrunHook_(task.name, runMs, task.budgetMs);
+        }
+      }
+
+      if (task.stats.periodMs == 0) {
+        task.used = false;
+        continue;
+      }
+      reschedule(task);
+      push(id);
+    }
+    return msUntilNext();
+  }
+
+  /**
+   * Run due tasks, then idle until the next deadline
+   */
+  void tick() {
+    unsigned long idleMs = runDue();
+    if (idleHook_ != nullptr) {
+      idleHook_(idleMs);
+    }
+  }
+
+  /**
+   * Milliseconds until the next deadline (0 if a task is due,
+   * (unsigned long)-1 if nothing is scheduled)
+   */
+  unsigned long msUntilNext() const {
+    if (heapSize_ == 0) {
+      return (unsigned long)-1;
+    }
+    long remaining = (long)(tasks_[heap_[0]].deadline - clock_());
+    return remaining > 0 ? (unsigned long)remaining : 0;
+  }
+
+  void setIdleHook(IdleHook hook) { idleHook_ = hook; }
+  void setOverrunHook(OverrunHook hook) { overrunHook_ = hook; }
+
+  /**
+   * Copy the counters of one task
+   * @return true if the task exists
+   */
+  bool stats(int id, TaskStats& out) const {
+    if (!valid(id)) {
+      return false;
+    }
+    out = tasks_[id].stats;
+    return true;
+  }
+
+  /**
+   * Id of the task currently running (-1 outside a callback)
+   */
+  int current() const { return running_; }
+
+  size_t taskCount() const {
+    size_t count = 0;
+    for (size_t i = 0; i < Capacity; i++) {
+      if (tasks_[i].used) count++;
+    }
+    return count;
+  }
+
+private:
+  struct Task {
+    bool used;
+    TaskCallback callback;
+    const char* name;
+    unsigned long deadline;
+    unsigned long budgetMs;
+    uint32_t order;           // Registration order - breaks deadline ties
+    int heapIndex;            // Position in heap_, -1 while running or idle
+    TaskStats stats;
+  };
+
+  bool valid(int id) const { return id >= 0 && id < (int)Capacity && tasks_[id].used; }
+
+  int add(const char* name, TaskCallback callback, unsigned long periodMs,
+          unsigned long delayMs, unsigned long budgetMs) {
+    for (size_t i = 0; i < Capacity; i++) {
+      if (tasks_[i].used) {
+        continue;
+      }
+      Task& task = tasks_[i];
+      task.used = true;
+      task.callback = callback;
+      task.name = name;
+      task.deadline = clock_() + delayMs;
+      task.budgetMs = budgetMs;
+      task.order = nextOrder_++;
+      task.heapIndex = -1;
+      task.stats = TaskStats();
+      task.stats.name = name;
+      task.stats.periodMs = periodMs;
+      push((int)i);
+      return (int)i;
+    }
+    return -1;
+  }
+
+  /**
+   * Advance a periodic task to its first deadline after now (fixed rate)
+   */
+  void reschedule(Task& task) {
+    unsigned long period = task.stats.periodMs;
+    unsigned long late = clock_() - task.deadline;
+    unsigned long skipped = late / period;
+    task.stats.missed += (uint32_t)skipped;
+    task.deadline += (skipped + 1) * period;
+  }
+
+  // true if task a runs before task b
+  bool before(int a, int b) const {
+    long diff = (long)(tasks_[a].deadline - tasks_[b].deadline);
+    return diff < 0 || (diff == 0 && tasks_[a].order < tasks_[b].order);
+  }
+
+  void place(size_t index, int id) {
+    heap_[index] = id;
+    tasks_[id].heapIndex = (int)index;
+  }
+
+  void push(int id) {
+    size_t index = heapSize_++;
+    place(index, id);
+    siftUp(index);
+  }
+
+  void removeAt(size_t index) {
+    tasks_[heap_[index]].heapIndex = -1;
+    heapSize_--;
+    if (index == heapSize_) {
+      return;
+    }
+    place(index, heap_[heapSize_]);
+    siftDown(index);
+    siftUp(index);
+  }
+
+  void siftUp(size_t index) {
+    while (index > 0) {
+      size_t parent = (index - 1) / 2;
+      if (!before(heap_[index], heap_[parent])) {
+        break;
+      }
+      int id = heap_[index];
+      place(index, heap_[parent]);
+      place(parent, id);
+      index = parent;
+    }
+  }
+
+  void siftDown(size_t index) {
+    for (;;) {
+      size_t smallest = index;
+      size_t left = 2 * index + 1;
+      size_t right = left + 1;
+      if (left < heapSize_ && before(heap_[left], heap_[smallest])) smallest = left;
+      if (right < heapSize_ && before(heap_[right], heap_[smallest])) smallest = right;
+      if (smallest == index) {
+        break;
+      }
+      int id = heap_[index];
+      place(index, heap_[smallest]);
+      place(smallest, id);
+      index = smallest;
+    }
+  }
+
+  SchedulerClock clock_;
+  IdleHook idleHook_;
+  OverrunHook overrunHook_;
+  Task tasks_[Capacity];
+  int heap_[Capacity];        // Task ids, earliest deadline first
+  size_t heapSize_;
+  int running_;
+  uint32_t nextOrder_;
+};
+
+#endif // TASK_SCHEDULER_H
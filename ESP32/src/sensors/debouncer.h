@@ -0,0 +1,115 @@
+/**
+ * @file debouncer.h
+ * @brief Edge-driven debouncer for a two-state input (float switch)
+ *
+ * The input's edges are fed in as they happen (from a GPIO interrupt on the
+ * ESP32); the stable state only changes once the input has held a new level
+ * for settleMs with no further edge. A float switch chatters while the water
+ * surface ripples around it, so every edge restarts the quiet period, and a
+ * glitch that returns to the stable level before settling is discarded.
+ *
+ * The time of a change is that of the last edge (when the level actually
+ * became what it is), not the time the debounce finished.
+ *
+ * Header-only with no Arduino dependencies: the caller passes edge and
+ * current times in milliseconds, so a host test can replay synthetic edge
+ * sequences.
+ */
+
+#ifndef DEBOUNCER_H
+#define DEBOUNCER_H
+
+#include <stdint.h>
+
+class Debouncer {
+public:
+  /**
+   * @param settleMs Time the input must stay at a new level (ms)
+   * @param level Initial stable level
+   */
+  Debouncer(unsigned long settleMs, bool level)
+    : settleMs_(settleMs), stable_(level), pending_(level), lastEdge_(0),
+      changedAt_(0), edges_(0), glitches_(0) {}
+
+  /**
+   * Restart from a known level (e.g. read at startup)
+   * @param level Current level
+   * @param nowMs Current time (ms)
+   */
+  void reset(bool level, unsigned long nowMs) {
+    stable_ = level;
+    pending_ = level;
+    lastEdge_ = nowMs;
+    changedAt_ = nowMs;
+  }
+
+  /**
+   * Record an edge of the input
+   * @param level Level after the edge (may equal the previous one when
+   *              interrupts were coalesced - the quiet period still restarts)
+   * @param atMs When the edge happened (ms)
+   */
+  void edge(bool level, unsigned long atMs) {
+    if (pending_ != stable_ && level == stable_) {
+      glitches_++;
+    }
+    pending_ = level;
+    lastEdge_ = atMs;
+    edges_++;
+  }
+
+  /**
+   * Take a settled change
+   * @param nowMs Current time (ms)
+   * @return true if the stable state changed with this call
+   */
+  bool update(unsigned long nowMs) {
+    if (pending_ == stable_ || nowMs - lastEdge_ < settleMs_) {
+      return false;
+    }
+    stable_ = pending_;
+    changedAt_ = lastEdge_;
+    return true;
+  }
+
+  /**
+   * Time until a pending level can settle
+   * @param nowMs Current time (ms)
+   * @return ms to wait before calling update() (0 = due now), or
+   *         DEBOUNCER_IDLE if the input is at its stable level
+   */
+  unsigned long msUntilSettled(unsigned long nowMs) const {
+    if (pending_ == stable_) {
+      return DEBOUNCER_IDLE;
+    }
+    unsigned long quiet = nowMs - lastEdge_;
+    return quiet >= settleMs_ ? 0 : settleMs_ - quiet;
+  }
+
+  static const unsigned long DEBOUNCER_IDLE = (unsigned long)-1;
+
+  bool state() const { return stable_; }
+
+  // Level after the most recent edge (may not have settled yet)
+  bool pending() const { return pending_; }
+
+  // Time of the last stable change (ms)
+  unsigned long changedAt() const { return changedAt_; }
+
+  // Edges seen since construction
+  uint32_t edges() const { return edges_; }
+
+  // Excursions that returned to the stable level before settling
+  uint32_t glitches() const { return glitches_; }
+
+private:
+  unsigned long settleMs_;
+  bool stable_;
+  bool pending_;
+  unsigned long lastEdge_;
+  unsigned long changedAt_;
+  uint32_t edges_;
+  uint32_t glitches_;
+};
+
+#endif // DEBOUNCER_H
@@ -0,0 +1,113 @@
+/**
+ * @file dht_sampler.cpp
+ * @brief Background DHT11 sampling task with median filtering
+ */
+
+#include <Arduino.h>
+#include "dht_sampler.h"
+#include "../config.h"
+
+// TEST MODE has no sensor to sample (see the mocks in temperature.cpp / humidity.cpp)
+#ifndef TEST_MODE
+
+#include <DHT.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "median_filter.h"
+#include "../constants.h"
+
+// DHT sensor instance (temperature.cpp)
+extern DHT dht;
+
+// Filtered value handed from the sampler task to its readers
+struct DhtSnapshot {
+  float value;
+  bool valid;
+  uint8_t validSamples;
+  uint8_t rejected;
+  uint32_t failures;
+  unsigned long lastValidMs;
+};
+
+// Sampler task only
+static MedianFilter<DHT_FILTER_WINDOW> dhtFilters[DHT_CHANNEL_COUNT] = {
+  MedianFilter<DHT_FILTER_WINDOW>(DHT_TEMP_OUTLIER_BAND),
+  MedianFilter<DHT_FILTER_WINDOW>(DHT_HUM_OUTLIER_BAND)
+};
+
+// Latest filtered values (guarded by dhtMux)
+static DhtSnapshot dhtSnapshots[DHT_CHANNEL_COUNT] = {};
+static portMUX_TYPE dhtMux = portMUX_INITIALIZER_UNLOCKED;
+
+static TaskHandle_t dhtTaskHandle = nullptr;
+
+/**
+ * Sampler task: read the sensor at its fastest safe rate and refilter
+ */
+static void dhtSamplerTask(void* parameter) {
+  vTaskDelay(pdMS_TO_TICKS(DHT_STABILIZATION_DELAY_MS));
+  
+  TickType_t lastWake = xTaskGetTickCount();
+  for (;;) {
+    // One bus transaction gives both values (forced: the task keeps the
+    // 2 s spacing itself); the two getters return the cached reading
+    bool ok = dht.read(true);
+    unsigned long now = millis();
+    dhtFilters[DHT_CHANNEL_TEMPERATURE].add(ok ? dht.readTemperature() : NAN, now);
+    dhtFilters[DHT_CHANNEL_HUMIDITY].add(ok ? dht.readHumidity() : NAN, now);
+    
+    DhtSnapshot snapshots[DHT_CHANNEL_COUNT];
+    for (int channel = 0; channel < DHT_CHANNEL_COUNT; channel++) {
+      const MedianFilter<DHT_FILTER_WINDOW>& filter = dhtFilters[channel];
+      snapshots[channel].value = filter.value();
+      snapshots[channel].valid = filter.valid();
+      snapshots[channel].validSamples = filter.validSamples();
+      snapshots[channel].rejected = filter.rejected();
+      snapshots[channel].failures = filter.failures();
+      snapshots[channel].lastValidMs = filter.lastValidMs();
+    }
+    portENTER_CRITICAL(&dhtMux);
+    for (int channel = 0; channel < DHT_CHANNEL_COUNT; channel++) {
+      dhtSnapshots[channel] = snapshots[channel];
+    }
+    portEXIT_CRITICAL(&dhtMux);
+    
+    vTaskDelayUntil(&lastWake, pdMS_TO_TICKS(DHT_MIN_SAMPLE_INTERVAL_MS));
+  }
+}
+
+/**
+ * Start the sampler task
+ * @return false if the task could not be created
+ */
+bool startDhtSampler() {
+  BaseType_t created = xTaskCreatePinnedToCore(dhtSamplerTask, "dht_sampler", DHT_TASK_STACK_SIZE,
+                                               nullptr, DHT_TASK_PRIORITY,
+                                               &dhtTaskHandle, DHT_TASK_CORE);
+  return created == pdPASS;
+}
+
+/**
+ * Get the latest filtered value of a DHT11 quantity (never blocks on the bus)
+ * @param channel Temperature or humidity
+ * @param value Filtered value (only meaningful when true is returned)
+ * @param quality Valid and rejected reads in the window, failures since
+ *                boot, age of the newest valid read
+ * @return false if there is no valid read within DHT_MAX_SAMPLE_AGE_MS
+ */
+bool getDhtValue(DhtChannel channel, float& value, SensorQuality& quality) {
+  portENTER_CRITICAL(&dhtMux);
+  DhtSnapshot snapshot = dhtSnapshots[channel];
+  portEXIT_CRITICAL(&dhtMux);
+  
+  quality.validSamples = snapshot.validSamples;
+  quality.windowSize = DHT_FILTER_WINDOW;
+  quality.rejected = snapshot.rejected;
+  quality.failures = snapshot.failures;
+  quality.ageMs = millis() - snapshot.lastValidMs;  // Since boot if there was none
+  
+  value = snapshot.value;
+  return snapshot.valid && quality.ageMs <= DHT_MAX_SAMPLE_AGE_MS;
+}
+
+#endif // TEST_MODE
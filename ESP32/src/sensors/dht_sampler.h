@@ -0,0 +1,31 @@
+/**
+ * @file dht_sampler.h
+ * @brief Background DHT11 sampler (production mode)
+ *
+ * A FreeRTOS task reads the DHT11 every DHT_MIN_SAMPLE_INTERVAL_MS and runs
+ * each quantity through a MedianFilter (median_filter.h). The driver masks
+ * interrupts for a few milliseconds per read; that now happens on the
+ * sampler task, not inside the control cycle. readTemperature() and
+ * readHumidity() return the latest filtered value without touching the bus.
+ */
+
+#ifndef DHT_SAMPLER_H
+#define DHT_SAMPLER_H
+
+#include <stdint.h>
+#include "sensors.h"
+
+enum DhtChannel : uint8_t {
+  DHT_CHANNEL_TEMPERATURE,
+  DHT_CHANNEL_HUMIDITY,
+  DHT_CHANNEL_COUNT
+};
+
+// Start the sampler task (after dht.begin())
+bool startDhtSampler();
+
+// Latest filtered value; false if none is valid or the newest valid read is
+// older than DHT_MAX_SAMPLE_AGE_MS (quality is filled in either way)
+bool getDhtValue(DhtChannel channel, float& value, SensorQuality& quality);
+
+#endif // DHT_SAMPLER_H
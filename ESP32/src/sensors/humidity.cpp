@@ -32,12 +32,20 @@
     return mockHumidity;
   }
 
+  /**
+   * Get humidity filter quality (TEST MODE - always a full window)
+   */
+  void getHumidityQuality(SensorQuality& quality) {
+    quality = { DHT_FILTER_WINDOW, DHT_FILTER_WINDOW, 0, 0, 0 };
+  }
+
 #else
   // ============================================
   // PRODUCTION MODE - Real Hardware
   // ============================================
   
   #include <DHT.h>
+  #include "dht_sampler.h"
   
   // Pin configuration (shared with temperature)
   const int HUMIDITY_SENSOR_PIN = 5; // GPIO5
@@ -50,23 +58,33 @@
    * Initialize humidity sensor
    */
   void initHumiditySensor() {
-    // DHT already initialized in temperature.cpp
+    // DHT already initialized and sampled from temperature.cpp
     Serial.println("✅ Humidity sensor (DHT11) ready");
   }
 
   /**
-   * Read current humidity
+   * Read current humidity (latest filtered value, no bus access)
    * @return Humidity percentage (0-100%, returns -999.0 on error)
    */
   float readHumidity() {
-    float humidity = dht.readHumidity();
-    
-    if (isnan(humidity)) {
-      Serial.println("❌ Failed to read humidity from DHT11!");
+    float humidity;
+    SensorQuality quality;
+    if (!getDhtValue(DHT_CHANNEL_HUMIDITY, humidity, quality)) {
+      Serial.printf("❌ No valid humidity from DHT11 (%lu failed reads)\n",
+                    (unsigned long)quality.failures);
       return -999.0; // Error value
     }
     
     return humidity;
   }
 
+  /**
+   * Get humidity filter quality
+   * @param quality Valid and rejected reads in the window, failures, age
+   */
+  void getHumidityQuality(SensorQuality& quality) {
+    float humidity;
+    getDhtValue(DHT_CHANNEL_HUMIDITY, humidity, quality);
+  }
+
 #endif
@@ -0,0 +1,125 @@
+/**
+ * @file median_filter.h
+ * @brief Median-of-N filter with outlier rejection for a noisy sensor
+ *
+ * Keeps the last N read attempts. A failed read (NaN) takes a slot like any
+ * other, so a run of failures ages the good samples out instead of hiding
+ * behind them. After each attempt the valid samples are filtered:
+ *   1. take their median (the lower middle one for an even count, so it is
+ *      always a real sample),
+ *   2. drop samples further than outlierBand from it (spikes, bit errors),
+ *   3. average the rest - the DHT11 reports whole units, so this also
+ *      smooths the quantization steps.
+ * A single NaN or spike therefore no longer decides the reported value.
+ *
+ * Header-only with no Arduino dependencies: the caller passes the current
+ * time in milliseconds.
+ */
+
+#ifndef MEDIAN_FILTER_H
+#define MEDIAN_FILTER_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+template <size_t N>
+class MedianFilter {
+public:
+  static_assert(N > 0 && N <= 255, "Window size must fit in uint8_t");
+
+  /**
+   * @param outlierBand Largest distance from the median that is kept
+   */
+  explicit MedianFilter(float outlierBand)
+    : outlierBand_(outlierBand), next_(0), count_(0), value_(0.0f),
+      validSamples_(0), rejected_(0), failures_(0), lastValidMs_(0) {}
+
+  /**
+   * Add one read attempt and refilter
+   * @param sample Reading (NaN = failed read)
+   * @param nowMs Time of the read (ms)
+   */
+  void add(float sample, unsigned long nowMs) {
+    bool ok = !isnan(sample);
+    samples_[next_] = sample;
+    valid_[next_] = ok;
+    next_ = (next_ + 1) % N;
+    if (count_ < N) {
+      count_++;
+    }
+
+    if (ok) {
+      lastValidMs_ = nowMs;
+    } else {
+      failures_++;
+    }
+    refilter();
+  }
+
+  // A filtered value is available (at least one valid sample in the window)
+  bool valid() const { return validSamples_ > 0; }
+
+  // Filtered value (meaningful only if valid())
+  float value() const { return value_; }
+
+  // Valid samples in the window (before outlier rejection)
+  uint8_t validSamples() const { return validSamples_; }
+
+  // Valid samples dropped as outliers in the last filtering
+  uint8_t rejected() const { return rejected_; }
+
+  // Failed reads since construction
+  uint32_t failures() const { return failures_; }
+
+  // Time of the newest valid sample (ms, 0 = none yet)
+  unsigned long lastValidMs() const { return lastValidMs_; }
+
+private:
+  void refilter() {
+    float sorted[N];
+    uint8_t n = 0;
+    for (size_t i = 0; i < count_; i++) {
+      if (valid_[i]) {
+        // Insertion sort - N is a handful of samples
+        size_t j = n++;
+        while (j > 0 && sorted[j - 1] > samples_[i]) {
+          sorted[j] = sorted[j - 1];
+          j--;
+        }
+        sorted[j] = samples_[i];
+      }
+    }
+
+    validSamples_ = n;
+    rejected_ = 0;
+    if (n == 0) {
+      return;
+    }
+
+    float median = sorted[(n - 1) / 2];
+    float sum = 0.0f;
+    uint8_t kept = 0;
+    for (uint8_t i = 0; i < n; i++) {
+      if (fabsf(sorted[i] - median) <= outlierBand_) {
+        sum += sorted[i];
+        kept++;
+      }
+    }
+    rejected_ = (uint8_t)(n - kept);
+    value_ = sum / kept;
+  }
+
+  float outlierBand_;
+  float samples_[N];
+  bool valid_[N];
+  size_t next_;                 // Slot for the next attempt
+  size_t count_;                // Attempts in the window (up to N)
+  float value_;
+  uint8_t validSamples_;
+  uint8_t rejected_;
+  uint32_t failures_;
+  unsigned long lastValidMs_;
+};
+
+#endif // MEDIAN_FILTER_H
@@ -6,20 +6,42 @@
 #ifndef SENSORS_H
 #define SENSORS_H
 
-// Temperature sensor functions
+#include <stdint.h>
+
+// Quality of a filtered sensor value (see sensors/median_filter.h)
+struct SensorQuality {
+  uint8_t validSamples;     // Valid reads in the filter window
+  uint8_t windowSize;       // Reads in a full window
+  uint8_t rejected;         // Valid reads dropped as outliers
+  uint32_t failures;        // Failed reads since boot
+  unsigned long ageMs;      // Time since the newest valid read
+};
+
+// Temperature sensor functions (latest filtered value, never blocks)
 void initTemperatureSensor();
 float readTemperature();
+void getTemperatureQuality(SensorQuality& quality);
 
-// Humidity sensor functions
+// Humidity sensor functions (latest filtered value, never blocks)
 void initHumiditySensor();
 float readHumidity();
+void getHumidityQuality(SensorQuality& quality);
 
 // Light sensor functions
 void initLightSensor();
 float readLight();
 
-// Tank level sensor functions
+// Tank level change reported by the float switch (debounced)
+struct TankLevelEvent {
+  bool hasWater;            // Level after the change
+  bool pumpCut;             // The empty handler stopped a running pump
+  unsigned long atMs;       // When the level changed (millis())
+};
+
+// Tank level sensor functions (interrupt-driven, see sensors/tank_level.cpp)
 void initTankLevelSensor();
 bool readTankLevel();
+void setTankEmptyHandler(bool (*handler)());
+bool takeTankLevelEvent(TankLevelEvent& event);
 
 #endif // SENSORS_H
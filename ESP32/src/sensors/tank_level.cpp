@@ -1,6 +1,13 @@
 /**
  * @file tank_level.cpp
  * @brief Tank water level sensor module (VS804-021 Float Switch)
+ *
+ * The float switch is an event source, not a sampled value: a GPIO
+ * interrupt wakes a small task that debounces the edges (see debouncer.h).
+ * When the tank settles empty the task calls the registered empty handler
+ * at once (it cuts the pump), then queues the change for the loop task,
+ * which publishes the alert. readTankLevel() returns the debounced level
+ * without touching the pin.
  */
 
 #include <Arduino.h>
@@ -31,35 +38,176 @@
     return mockLevel;
   }
 
+  /**
+   * Register the tank-empty handler (TEST MODE - the mock never runs empty)
+   */
+  void setTankEmptyHandler(bool (*handler)()) {
+    (void)handler;
+  }
+
+  /**
+   * Take the next tank level change (TEST MODE - there are none)
+   */
+  bool takeTankLevelEvent(TankLevelEvent& event) {
+    (void)event;
+    return false;
+  }
+
 #else
   // ============================================
   // PRODUCTION MODE - Real Hardware
   // ============================================
   
+  #include <atomic>
+  #include <freertos/FreeRTOS.h>
+  #include <freertos/task.h>
+  #include "debouncer.h"
+  #include "../constants.h"
+  #include "../mqtt/spsc_queue.h"
+  
   // Pin configuration
   const int TANK_LEVEL_PIN = 13; // GPIO13
 
+  static TaskHandle_t tankTaskHandle = nullptr;
+  static std::atomic<unsigned long> lastTankEdgeMs(0);      // Written by the ISR
+  static std::atomic<bool> tankHasWater(true);              // Debounced level
+  static std::atomic<bool (*)()> tankEmptyHandler(nullptr);
+
+  // Level changes (tank task -> loop task)
+  static SpscQueue<TankLevelEvent, TANK_EVENT_QUEUE_DEPTH> tankEvents;
+  static uint32_t droppedTankEvents = 0;                    // Tank task only
+
+  /**
+   * Read the float switch
+   * VS804-021: LOW = no liquid, HIGH = liquid detected
+   */
+  static bool readTankPin() {
+    return digitalRead(TANK_LEVEL_PIN) == HIGH;
+  }
+
+  /**
+   * Float switch edge (interrupt context): note the time, wake the task
+   */
+  static void IRAM_ATTR onTankEdge() {
+    lastTankEdgeMs.store(millis());
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(tankTaskHandle, &woken);
+    if (woken) {
+      portYIELD_FROM_ISR();
+    }
+  }
+
+  /**
+   * Publish a settled level change (tank task)
+   * The level is stored before the pump is cut, so a control cycle that
+   * turns the pump on and then re-reads the level cannot miss the cut.
+   * @param hasWater New level
+   * @param atMs When the level changed
+   */
+  static void reportTankLevel(bool hasWater, unsigned long atMs) {
+    tankHasWater.store(hasWater);
+    
+    TankLevelEvent event = { hasWater, false, atMs };
+    if (!hasWater) {
+      bool (*handler)() = tankEmptyHandler.load();
+      if (handler != nullptr) {
+        event.pumpCut = handler();
+      }
+    }
+    
+    if (!tankEvents.push(event)) {
+      droppedTankEvents++;
+      Serial.printf("⚠️  Tank event queue full - %lu level changes dropped\n",
+                    (unsigned long)droppedTankEvents);
+    }
+  }
+
+  /**
+   * Tank level task: debounce the float switch edges
+   * Sleeps until an edge, then until the level has been quiet for
+   * TANK_LEVEL_DEBOUNCE_MS. Re-reads the pin every TANK_LEVEL_RECHECK_MS in
+   * case an edge was missed.
+   */
+  static void tankLevelTask(void* parameter) {
+    Debouncer debouncer(TANK_LEVEL_DEBOUNCE_MS, tankHasWater.load());
+    debouncer.reset(tankHasWater.load(), millis());
+    if (!debouncer.state()) {
+      reportTankLevel(false, millis());  // Empty at boot
+    }
+    
+    for (;;) {
+      unsigned long waitMs = debouncer.msUntilSettled(millis());
+      if (waitMs > TANK_LEVEL_RECHECK_MS) {
+        waitMs = TANK_LEVEL_RECHECK_MS;
+      }
+      // One extra tick so a short wait never rounds down to a busy poll
+      bool notified = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs) + 1) > 0;
+      
+      // Pin before edge time before now: an edge in between only makes the
+      // quiet period restart later, and its notification wakes us again
+      bool level = readTankPin();
+      unsigned long edgeMs = lastTankEdgeMs.load();
+      unsigned long now = millis();
+      if (notified) {
+        debouncer.edge(level, edgeMs);
+      } else if (level != debouncer.pending()) {
+        debouncer.edge(level, now);  // Edge without an interrupt
+      }
+      
+      if (debouncer.update(now)) {
+        reportTankLevel(debouncer.state(), debouncer.changedAt());
+      }
+    }
+  }
+
   /**
    * Initialize tank level sensor
    */
   void initTankLevelSensor() {
     pinMode(TANK_LEVEL_PIN, INPUT_PULLUP);  // Use internal pull-up resistor
-    Serial.println("✅ Tank level sensor (VS804-021) initialized");
+    tankHasWater.store(readTankPin());
+    
+    BaseType_t created = xTaskCreatePinnedToCore(tankLevelTask, "tank_level", TANK_TASK_STACK_SIZE,
+                                                 nullptr, TANK_TASK_PRIORITY,
+                                                 &tankTaskHandle, TANK_TASK_CORE);
+    if (created != pdPASS) {
+      tankTaskHandle = nullptr;
+      Serial.println("❌ Tank level task not started - float switch polled by the control cycle");
+      return;
+    }
+    
+    attachInterrupt(digitalPinToInterrupt(TANK_LEVEL_PIN), onTankEdge, CHANGE);
+    Serial.printf("✅ Tank level sensor (VS804-021) initialized (interrupt, %lu ms debounce)\n",
+                  (unsigned long)TANK_LEVEL_DEBOUNCE_MS);
   }
 
   /**
-   * Read tank level status
+   * Read tank level status (debounced, no GPIO read)
    * @return true if tank has water (liquid detected), false if empty
    */
   bool readTankLevel() {
-    int sensorState = digitalRead(TANK_LEVEL_PIN);
-    
-    // VS804-021: LOW = no liquid, HIGH = liquid detected
-    if (sensorState == LOW) {
-      return false; // No liquid
-    } else {
-      return true; // Liquid detected
+    if (tankTaskHandle == nullptr) {
+      return readTankPin();
     }
+    return tankHasWater.load();
+  }
+
+  /**
+   * Register the function that stops the pump when the tank runs empty
+   * It runs on the tank level task as soon as the empty level settles.
+   * @param handler Returns true if it stopped a running pump
+   */
+  void setTankEmptyHandler(bool (*handler)()) {
+    tankEmptyHandler.store(handler);
+  }
+
+  /**
+   * Take the next tank level change (loop task)
+   * @param event Destination
+   * @return false if no change is waiting
+   */
+  bool takeTankLevelEvent(TankLevelEvent& event) {
+    return tankEvents.pop(event);
   }
 
 #endif
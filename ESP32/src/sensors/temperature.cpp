@@ -32,41 +32,63 @@
     return mockTemp;
   }
 
+  /**
+   * Get temperature filter quality (TEST MODE - always a full window)
+   */
+  void getTemperatureQuality(SensorQuality& quality) {
+    quality = { DHT_FILTER_WINDOW, DHT_FILTER_WINDOW, 0, 0, 0 };
+  }
+
 #else
   // ============================================
   // PRODUCTION MODE - Real Hardware
   // ============================================
   
   #include <DHT.h>
+  #include "dht_sampler.h"
   
   // Pin configuration
   const int TEMP_SENSOR_PIN = 5; // GPIO5
   #define DHTTYPE DHT11
 
-  // DHT sensor instance (shared with humidity)
+  // DHT sensor instance (shared with humidity, read by the sampler task)
   DHT dht(TEMP_SENSOR_PIN, DHTTYPE);
 
   /**
-   * Initialize temperature sensor
+   * Initialize temperature sensor and start background sampling
    */
   void initTemperatureSensor() {
     dht.begin();
-    Serial.println("✅ Temperature sensor (DHT11) initialized");
+    if (!startDhtSampler()) {
+      Serial.println("❌ DHT11 sampler task not started - no temperature/humidity");
+      return;
+    }
+    Serial.printf("✅ Temperature sensor (DHT11) initialized (median of %d reads)\n", DHT_FILTER_WINDOW);
   }
 
   /**
-   * Read current temperature
+   * Read current temperature (latest filtered value, no bus access)
    * @return Temperature in Celsius (returns -999.0 on error)
    */
   float readTemperature() {
-    float temp = dht.readTemperature();
-    
-    if (isnan(temp)) {
-      Serial.println("❌ Failed to read temperature from DHT11!");
+    float temp;
+    SensorQuality quality;
+    if (!getDhtValue(DHT_CHANNEL_TEMPERATURE, temp, quality)) {
+      Serial.printf("❌ No valid temperature from DHT11 (%lu failed reads)\n",
+                    (unsigned long)quality.failures);
       return -999.0; // Error value
     }
     
     return temp;
   }
 
+  /**
+   * Get temperature filter quality
+   * @param quality Valid and rejected reads in the window, failures, age
+   */
+  void getTemperatureQuality(SensorQuality& quality) {
+    float temp;
+    getDhtValue(DHT_CHANNEL_TEMPERATURE, temp, quality);
+  }
+
 #endif
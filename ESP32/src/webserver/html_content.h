@@ -232,6 +232,14 @@ const char* HTML_CONTENT = R"rawliteral(
                         <span>🌬️ Fan</span>
                         <span id="fan-status">--</span>
                     </div>
+                    <div class="actuator-item">
+                        <span>⚡ Energy</span>
+                        <span id="energy">--</span>
+                    </div>
+                    <div class="actuator-item">
+                        <span>🚰 Water</span>
+                        <span id="water">--</span>
+                    </div>
                 </div>
             </div>
             
@@ -272,6 +280,28 @@ const char* HTML_CONTENT = R"rawliteral(
                     <button type="submit" class="btn">💾 Save Setpoints</button>
                 </form>
             </div>
+            
+            <div class="card">
+                <h2 style="margin-bottom: 15px;">🔥 Heating PID</h2>
+                <form id="heating-form" class="setpoint-form">
+                    <div class="form-group">
+                        <label>Kp (duty per °C):</label>
+                        <input type="number" step="any" min="0" id="kp" name="kp" required>
+                    </div>
+                    <div class="form-group">
+                        <label>Ki (duty per °C·s):</label>
+                        <input type="number" step="any" min="0" id="ki" name="ki" required>
+                    </div>
+                    <div class="form-group">
+                        <label>Kd (duty per °C/s):</label>
+                        <input type="number" step="any" min="0" id="kd" name="kd" required>
+                    </div>
+                    <div style="padding: 10px; background: rgba(255, 255, 255, 0.05); border-radius: 8px; font-size: 0.85em; margin: 10px 0; opacity: 0.9;">
+                        ℹ️ Heating holds the middle of the temperature band. Current output: <span id="heating-duty">--</span>
+                    </div>
+                    <button type="submit" class="btn">💾 Save Gains</button>
+                </form>
+            </div>
         </div>
     </div>
     
@@ -287,6 +317,7 @@ const char* HTML_CONTENT = R"rawliteral(
             
             if (tabName === 'setpoints') {
                 loadSetpoints();
+                loadHeating();
             }
         }
         
@@ -301,8 +332,12 @@ const char* HTML_CONTENT = R"rawliteral(
                     
                     updateActuatorStatus('pump-status', data.pump);
                     updateActuatorStatus('heating-status', data.heating);
+                    document.getElementById('heating-status').textContent +=
+                        ' (' + Math.round(data.heating_duty * 100) + '%)';
                     updateActuatorStatus('led-status', data.led);
                     updateActuatorStatus('fan-status', data.fan);
+                    document.getElementById('energy').textContent = data.energy_wh.toFixed(1) + ' Wh';
+                    document.getElementById('water').textContent = data.water_l.toFixed(1) + ' L';
                     
                     const date = new Date(data.last_update);
                     document.getElementById('timestamp').textContent = 
@@ -331,6 +366,18 @@ const char* HTML_CONTENT = R"rawliteral(
                 .catch(err => console.error('Error loading setpoints:', err));
         }
         
+        function loadHeating() {
+            fetch('/heating')
+                .then(response => response.json())
+                .then(data => {
+                    document.getElementById('kp').value = data.kp;
+                    document.getElementById('ki').value = data.ki;
+                    document.getElementById('kd').value = data.kd;
+                    document.getElementById('heating-duty').textContent = Math.round(data.duty * 100) + '%';
+                })
+                .catch(err => console.error('Error loading heating gains:', err));
+        }
+        
         function showNotification(message, isError = false) {
             const notif = document.getElementById('notification');
             notif.textContent = message;
@@ -363,6 +410,27 @@ const char* HTML_CONTENT = R"rawliteral(
             });
         });
         
+        document.getElementById('heating-form').addEventListener('submit', function(e) {
+            e.preventDefault();
+            
+            fetch('/heating', {
+                method: 'POST',
+                body: new URLSearchParams(new FormData(this))
+            })
+            .then(response => {
+                if (!response.ok) {
+                    return response.text().then(text => { throw new Error(text); });
+                }
+                return response.json();
+            })
+            .then(data => {
+                showNotification('✅ Heating gains updated!');
+            })
+            .catch(err => {
+                showNotification('❌ Error: ' + err.message, true);
+            });
+        });
+        
         // Update sensor data every 5 seconds
         updateData();
         setInterval(updateData, 5000);
@@ -8,7 +8,13 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <WebServer.h>
+#include "../constants.h"
 #include "../control/control.h"
+#include "../actuators/actuators.h"
+#include "../buffer/buffer.h"
+#include "../clock/clock.h"
+#include "../mqtt/mqtt.h"
+#include "../mqtt/reconnect_policy.h"
 
 // External HTML content
 extern const char* HTML_CONTENT;
@@ -39,8 +45,8 @@ void handleRoot() {
  * Handle API endpoint for current data (JSON)
  */
 void handleData() {
-  char json[512];
-  snprintf(json, sizeof(json),
+  char json[1024];
+  int len = snprintf(json, sizeof(json),
     "{"
     "\"temperature\":%.1f,"
     "\"humidity\":%.1f,"
@@ -50,8 +56,9 @@ void handleData() {
     "\"heating\":%s,"
     "\"led\":%s,"
     "\"fan\":%s,"
-    "\"last_update\":%lu"
-    "}",
+    "\"heating_duty\":%.2f,"
+    "\"last_update\":%lu,"
+    "\"actuators\":{",
     currentReadings.temperature,
     currentReadings.humidity,
     currentReadings.light,
@@ -60,9 +67,130 @@ void handleData() {
     currentReadings.heatingOn ? "true" : "false",
     currentReadings.ledOn ? "true" : "false",
     currentReadings.fanOn ? "true" : "false",
+    getHeatingDuty(),
     currentReadings.lastUpdate
   );
   
+  // Usage since boot (see actuators/registry.cpp)
+  double energyWh = 0;
+  for (uint8_t actuator = 0; actuator < ACTUATOR_COUNT; actuator++) {
+    ActuatorUsage usage;
+    getActuatorUsage((ActuatorId)actuator, usage);
+    energyWh += usage.energyWh;
+    len += snprintf(json + len, sizeof(json) - len,
+      "%s\"%s\":{"
+      "\"on_time_s\":%llu,"
+      "\"switches\":%lu,"
+      "\"last_change\":%lu,"
+      "\"duty\":%.3f,"
+      "\"energy_wh\":%.2f"
+      "}",
+      actuator > 0 ? "," : "",
+      getActuatorName((ActuatorId)actuator),
+      (unsigned long long)(usage.onTimeMs / 1000),
+      (unsigned long)usage.switches,
+      usage.lastChangeMs,
+      usage.duty,
+      usage.energyWh
+    );
+  }
+  snprintf(json + len, sizeof(json) - len, "},\"energy_wh\":%.2f,\"water_l\":%.2f}",
+           energyWh, getPumpedLitres());
+  
+  server.send(200, "application/json", json);
+}
+
+/**
+ * Handle API endpoint for offline buffer statistics (JSON)
+ */
+void handleBufferStats() {
+  char json[BUFFER_STATS_JSON_SIZE];
+  int len = snprintf(json, sizeof(json), "{\"uptime_ms\":%llu,\"tiers\":[",
+                     (unsigned long long)uptimeMs());
+  
+  for (int tier = 0; tier < getBufferTierCount(); tier++) {
+    BufferTierStats stats;
+    getBufferTierStats(tier, stats);
+    len += snprintf(json + len, sizeof(json) - len,
+      "%s{"
+      "\"name\":\"%s\","
+      "\"depth\":%u,"
+      "\"capacity\":%u,"
+      "\"high_water\":%u,"
+      "\"enqueued\":%lu,"
+      "\"aggregated\":%lu,"
+      "\"dropped\":%lu,"
+      "\"dropped_samples\":%lu,"
+      "\"flushed\":%lu,"
+      "\"oldest_timestamp\":%lu"
+      "}",
+      tier > 0 ? "," : "",
+      getBufferTierName(tier),
+      stats.depth, stats.capacity, stats.highWater,
+      (unsigned long)stats.enqueued,
+      (unsigned long)stats.aggregated,
+      (unsigned long)stats.dropped,
+      (unsigned long)stats.droppedSamples,
+      (unsigned long)stats.flushed,
+      (unsigned long)stats.oldestTimestamp
+    );
+    if (len >= (int)sizeof(json)) {
+      server.send(500, "text/plain", "Buffer stats too large");
+      return;
+    }
+  }
+  
+  const BufferFlushStats& flush = getBufferFlushStats();
+  len += snprintf(json + len, sizeof(json) - len,
+    "],\"flush\":{"
+    "\"count\":%lu,"
+    "\"last_records\":%lu,"
+    "\"last_duration_ms\":%lu,"
+    "\"records_per_sec\":%.1f"
+    "}}",
+    (unsigned long)flush.flushes,
+    (unsigned long)flush.lastRecords,
+    (unsigned long)flush.lastDurationMs,
+    flush.recordsPerSecond
+  );
+  if (len >= (int)sizeof(json)) {
+    server.send(500, "text/plain", "Buffer stats too large");
+    return;
+  }
+  
+  server.send(200, "application/json", json);
+}
+
+/**
+ * Handle API endpoint for MQTT connection quality (JSON)
+ */
+void handleConnectionStats() {
+  ConnectionStats stats;
+  unsigned long nextAttemptMs;
+  getMQTTConnectionStats(stats, nextAttemptMs);
+  
+  char json[256];
+  snprintf(json, sizeof(json),
+    "{"
+    "\"connected\":%s,"
+    "\"attempts\":%lu,"
+    "\"successes\":%lu,"
+    "\"disconnects\":%lu,"
+    "\"success_rate\":%.3f,"
+    "\"mean_connect_ms\":%lu,"
+    "\"offline_ms\":%lu,"
+    "\"next_attempt_ms\":%lu"
+    "}",
+    stats.connected ? "true" : "false",
+    (unsigned long)stats.attempts,
+    (unsigned long)stats.successes,
+    (unsigned long)stats.disconnects,
+    stats.successRate,
+    (unsigned long)stats.meanConnectMs,
+    (unsigned long)stats.offlineMs,
+    nextAttemptMs
+  );
+  
   server.send(200, "application/json", json);
 }
 
@@ -138,14 +266,66 @@ void handleUpdateSetpoints() {
   server.send(200, "application/json", "{\"status\":\"ok\",\"message\":\"Setpoints updated\"}");
 }
 
+/**
+ * Handle API endpoint for getting the heating PID gains and output (JSON)
+ */
+void handleGetHeating() {
+  float kp, ki, kd;
+  getHeatingGains(kp, ki, kd);
+  
+  char json[192];
+  snprintf(json, sizeof(json),
+    "{"
+    "\"kp\":%.4f,"
+    "\"ki\":%.6f,"
+    "\"kd\":%.2f,"
+    "\"duty\":%.2f,"
+    "\"on\":%s"
+    "}",
+    kp, ki, kd, getHeatingDuty(), isActuatorOn(ACTUATOR_HEATING) ? "true" : "false"
+  );
+  
+  server.send(200, "application/json", json);
+}
+
+/**
+ * Handle API endpoint for updating the heating PID gains (POST)
+ */
+void handleUpdateHeating() {
+  if (!server.hasArg("kp") || !server.hasArg("ki") || !server.hasArg("kd")) {
+    server.send(400, "text/plain", "Missing gains (kp, ki, kd)");
+    return;
+  }
+  
+  float kp = server.arg("kp").toFloat();
+  float ki = server.arg("ki").toFloat();
+  float kd = server.arg("kd").toFloat();
+  
+  // Same limits as the MQTT setpoint message
+  if (kp < 0 || kp > SETPOINT_HEATING_KP_LIMIT_MAX ||
+      ki < 0 || ki > SETPOINT_HEATING_KI_LIMIT_MAX ||
+      kd < 0 || kd > SETPOINT_HEATING_KD_LIMIT_MAX) {
+    server.send(400, "text/plain", "Gains out of range");
+    return;
+  }
+  
+  setHeatingGains(kp, ki, kd);
+  
+  server.send(200, "application/json", "{\"status\":\"ok\",\"message\":\"Heating gains updated\"}");
+}
+
 /**
  * Initialize web server
  */
 void initWebServer() {
   server.on("/", handleRoot);
   server.on("/data", handleData);
+  server.on("/buffer", handleBufferStats);
+  server.on("/connection", handleConnectionStats);
   server.on("/setpoints", HTTP_GET, handleGetSetpoints);
   server.on("/setpoints", HTTP_POST, handleUpdateSetpoints);
+  server.on("/heating", HTTP_GET, handleGetHeating);
+  server.on("/heating", HTTP_POST, handleUpdateHeating);
   
   server.begin();
   Serial.println("Web server started on http://192.168.4.1");
@@ -0,0 +1,25 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the Arduino core, for native tests of modules
+ *        whose only Arduino dependency is logging
+ *
+ * Serial output is discarded.
+ */
+
+#ifndef ARDUINO_STUB_H
+#define ARDUINO_STUB_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+class HostSerial {
+public:
+  int printf(const char*, ...) { return 0; }
+  size_t print(const char*) { return 0; }
+  size_t println(const char* = "") { return 0; }
+};
+
+static HostSerial Serial;
+
+#endif // ARDUINO_STUB_H
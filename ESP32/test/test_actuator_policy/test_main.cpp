@@ -0,0 +1,106 @@
+/**
+ * @file test_main.cpp
+ * @brief Anti-short-cycle policy and hysteresis helpers
+ */
+
+#include <unity.h>
+#include "actuators/actuator_policy.h"
+
+static const unsigned long MINUTE_MS = 60000UL;
+
+void setUp() {}
+void tearDown() {}
+
+void test_hysteresis_helpers() {
+  TEST_ASSERT_FALSE(hysteresisAbove(80.0f, 80.0f, 5.0f, false));
+  TEST_ASSERT_TRUE(hysteresisAbove(80.1f, 80.0f, 5.0f, false));
+  TEST_ASSERT_TRUE(hysteresisAbove(75.1f, 80.0f, 5.0f, true));
+  TEST_ASSERT_FALSE(hysteresisAbove(75.0f, 80.0f, 5.0f, true));
+
+  TEST_ASSERT_FALSE(hysteresisBelow(18.0f, 18.0f, 1.0f, false));
+  TEST_ASSERT_TRUE(hysteresisBelow(17.9f, 18.0f, 1.0f, false));
+  TEST_ASSERT_TRUE(hysteresisBelow(18.9f, 18.0f, 1.0f, true));
+  TEST_ASSERT_FALSE(hysteresisBelow(19.0f, 18.0f, 1.0f, true));
+}
+
+void test_first_request_switches_at_once() {
+  ActuatorPolicy policy(MINUTE_MS, 2 * MINUTE_MS, 0);
+  TEST_ASSERT_TRUE(policy.request(true, 1000));
+  TEST_ASSERT_EQUAL_UINT32(1, policy.switches());
+}
+
+void test_minimum_on_and_off_times() {
+  ActuatorPolicy policy(MINUTE_MS, 2 * MINUTE_MS, 0);
+  policy.request(true, 0);
+
+  TEST_ASSERT_TRUE(policy.request(false, MINUTE_MS - 1));    // Held on
+  TEST_ASSERT_FALSE(policy.request(false, MINUTE_MS));
+  TEST_ASSERT_FALSE(policy.request(true, 3 * MINUTE_MS - 1)); // Held off
+  TEST_ASSERT_TRUE(policy.request(true, 3 * MINUTE_MS));
+
+  TEST_ASSERT_EQUAL_UINT32(3, policy.switches());
+  TEST_ASSERT_EQUAL_UINT32(2, policy.held());
+}
+
+void test_repeated_request_is_not_held() {
+  ActuatorPolicy policy(MINUTE_MS, MINUTE_MS, 0);
+  policy.request(true, 0);
+  for (unsigned long t = 0; t < MINUTE_MS; t += 1000) {
+    TEST_ASSERT_TRUE(policy.request(true, t));
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, policy.held());
+}
+
+void test_switch_rate_limit() {
+  ActuatorPolicy policy(0, 0, 4);
+  unsigned long t = 0;
+  for (int i = 0; i < 4; i++) {
+    TEST_ASSERT_EQUAL(i % 2 == 0, policy.request(i % 2 == 0, t));
+    t += MINUTE_MS;
+  }
+  // Fifth switch within the hour is held until the first ages out
+  TEST_ASSERT_FALSE(policy.request(true, t));
+  TEST_ASSERT_FALSE(policy.request(true, 60 * MINUTE_MS - 1));
+  TEST_ASSERT_TRUE(policy.request(true, 60 * MINUTE_MS));
+  TEST_ASSERT_EQUAL_UINT32(5, policy.switches());
+}
+
+void test_rate_is_capped() {
+  ActuatorPolicy policy(0, 0, 255);
+  unsigned long t = 0;
+  bool state = false;
+  for (int i = 0; i < ACTUATOR_POLICY_MAX_RATE + 5; i++) {
+    state = !state;
+    policy.request(state, t++);
+  }
+  TEST_ASSERT_EQUAL_UINT32(ACTUATOR_POLICY_MAX_RATE, policy.switches());
+}
+
+void test_force_skips_dwell_and_rate() {
+  ActuatorPolicy policy(10 * MINUTE_MS, 10 * MINUTE_MS, 1);
+  policy.request(true, 0);
+  TEST_ASSERT_FALSE(policy.request(false, 1000, true));   // Tank empty
+  TEST_ASSERT_EQUAL_UINT32(0, policy.held());
+  TEST_ASSERT_TRUE(policy.request(true, 2000, true));
+}
+
+void test_times_survive_millis_wrap() {
+  ActuatorPolicy policy(MINUTE_MS, MINUTE_MS, 0);
+  unsigned long start = (unsigned long)-30000;
+  policy.request(true, start);
+  TEST_ASSERT_TRUE(policy.request(false, start + MINUTE_MS - 1));
+  TEST_ASSERT_FALSE(policy.request(false, start + MINUTE_MS));   // Wrapped past zero
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_hysteresis_helpers);
+  RUN_TEST(test_first_request_switches_at_once);
+  RUN_TEST(test_minimum_on_and_off_times);
+  RUN_TEST(test_repeated_request_is_not_held);
+  RUN_TEST(test_switch_rate_limit);
+  RUN_TEST(test_rate_is_capped);
+  RUN_TEST(test_force_skips_dwell_and_rate);
+  RUN_TEST(test_times_survive_millis_wrap);
+  return UNITY_END();
+}
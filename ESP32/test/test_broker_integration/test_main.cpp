@@ -0,0 +1,208 @@
+/**
+ * @file test_main.cpp
+ * @brief QoS 1 delivery against a real MQTT broker
+ *
+ * Connects to a local broker (mosquitto on 127.0.0.1:1883 by default;
+ * override with -D TEST_BROKER_HOST / TEST_BROKER_PORT), pipelines QoS 1
+ * PUBLISHes built by encodeQos1PublishHeader() and collects the PUBACKs
+ * with PubAckScanner, as AckTrackingClient does on the device. Every test
+ * is ignored if no broker is reachable.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <unity.h>
+#include "mqtt/mqtt_packet.h"
+
+#ifndef TEST_BROKER_HOST
+#define TEST_BROKER_HOST "127.0.0.1"
+#endif
+
+#ifndef TEST_BROKER_PORT
+#define TEST_BROKER_PORT 1883
+#endif
+
+#define TEST_TOPIC "greenhouse/native-test/telemetry"
+#define ACK_WAIT_MS 5000
+
+static bool acked[256];
+static uint32_t ackCount;
+static uint32_t duplicateAcks;
+
+static void onAck(uint16_t packetId) {
+  if (packetId < 256) {
+    if (acked[packetId]) {
+      duplicateAcks++;
+    }
+    acked[packetId] = true;
+  }
+  ackCount++;
+}
+
+static PubAckScanner scanner(onAck);
+
+static bool sendAll(int fd, const uint8_t* data, size_t length) {
+  while (length > 0) {
+    ssize_t n = send(fd, data, length, 0);
+    if (n <= 0) {
+      return false;
+    }
+    data += n;
+    length -= (size_t)n;
+  }
+  return true;
+}
+
+/**
+ * Open a TCP connection and complete the MQTT CONNECT handshake
+ * @return Socket, or -1 if the broker is unreachable or refused
+ */
+static int connectBroker(const char* clientId) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  struct timeval timeout = {ACK_WAIT_MS / 1000, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_port = htons(TEST_BROKER_PORT);
+  inet_pton(AF_INET, TEST_BROKER_HOST, &address.sin_addr);
+  if (connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+    close(fd);
+    return -1;
+  }
+
+  // CONNECT: protocol "MQTT" level 4, clean session, keepalive 30 s
+  size_t idLength = strlen(clientId);
+  uint8_t packet[64];
+  size_t n = 0;
+  packet[n++] = 0x10;
+  packet[n++] = (uint8_t)(10 + 2 + idLength);
+  const uint8_t header[] = {0x00, 0x04, 'M', 'Q', 'T', 'T', 0x04, 0x02, 0x00, 0x1E};
+  memcpy(packet + n, header, sizeof(header));
+  n += sizeof(header);
+  packet[n++] = 0x00;
+  packet[n++] = (uint8_t)idLength;
+  memcpy(packet + n, clientId, idLength);
+  n += idLength;
+
+  uint8_t connack[4];
+  if (!sendAll(fd, packet, n) || recv(fd, connack, sizeof(connack), MSG_WAITALL) != 4 ||
+      connack[0] != 0x20 || connack[3] != 0x00) {
+    close(fd);
+    return -1;
+  }
+  scanner.reset();
+  return fd;
+}
+
+/**
+ * Publish one QoS 1 message without waiting for its PUBACK
+ */
+static bool publish(int fd, uint16_t packetId, const char* payload, bool dup) {
+  uint8_t header[MQTT_PUBLISH_HEADER_SIZE(sizeof(TEST_TOPIC) - 1)];
+  size_t length = strlen(payload);
+  size_t n = encodeQos1PublishHeader(header, TEST_TOPIC, packetId, length, dup);
+  return sendAll(fd, header, n) && sendAll(fd, (const uint8_t*)payload, length);
+}
+
+/**
+ * Feed inbound bytes to the scanner until `count` PUBACKs have arrived
+ * or the receive timeout expires
+ */
+static void waitForAcks(int fd, uint32_t count) {
+  uint8_t data[256];
+  while (ackCount < count) {
+    ssize_t n = recv(fd, data, sizeof(data), 0);
+    if (n <= 0) {
+      return;
+    }
+    scanner.feed(data, (size_t)n);
+  }
+}
+
+static int connectOrIgnore(const char* clientId) {
+  int fd = connectBroker(clientId);
+  if (fd < 0) {
+    TEST_IGNORE_MESSAGE("No MQTT broker at " TEST_BROKER_HOST);
+  }
+  return fd;
+}
+
+void setUp() {
+  memset(acked, 0, sizeof(acked));
+  ackCount = 0;
+  duplicateAcks = 0;
+}
+
+void tearDown() {}
+
+void test_pipelined_publishes_are_all_acknowledged() {
+  int fd = connectOrIgnore("greenhouse-native-pipeline");
+
+  for (uint16_t id = 1; id <= 40; id++) {
+    char payload[48];
+    snprintf(payload, sizeof(payload), "{\"seq\":%u}", id);
+    TEST_ASSERT_TRUE(publish(fd, id, payload, false));
+  }
+  waitForAcks(fd, 40);
+  close(fd);
+
+  TEST_ASSERT_EQUAL_UINT32(40, ackCount);
+  TEST_ASSERT_EQUAL_UINT32(0, duplicateAcks);
+  for (uint16_t id = 1; id <= 40; id++) {
+    TEST_ASSERT_TRUE(acked[id]);
+  }
+}
+
+void test_large_publish_is_acknowledged() {
+  int fd = connectOrIgnore("greenhouse-native-large");
+
+  // Three-byte remaining length
+  static char payload[20001];
+  memset(payload, 'x', sizeof(payload) - 1);
+  payload[sizeof(payload) - 1] = '\0';
+  TEST_ASSERT_TRUE(publish(fd, 200, payload, false));
+  waitForAcks(fd, 1);
+  close(fd);
+
+  TEST_ASSERT_TRUE(acked[200]);
+}
+
+void test_unacknowledged_publishes_are_resent_with_dup_after_reconnect() {
+  int fd = connectOrIgnore("greenhouse-native-dup");
+
+  // Drop the connection straight after sending, before any PUBACK is read
+  for (uint16_t id = 100; id < 110; id++) {
+    TEST_ASSERT_TRUE(publish(fd, id, "{\"resend\":true}", false));
+  }
+  close(fd);
+
+  fd = connectOrIgnore("greenhouse-native-dup");
+  for (uint16_t id = 100; id < 110; id++) {
+    TEST_ASSERT_TRUE(publish(fd, id, "{\"resend\":true}", true));
+  }
+  waitForAcks(fd, 10);
+  close(fd);
+
+  TEST_ASSERT_EQUAL_UINT32(10, ackCount);
+  for (uint16_t id = 100; id < 110; id++) {
+    TEST_ASSERT_TRUE(acked[id]);
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_pipelined_publishes_are_all_acknowledged);
+  RUN_TEST(test_large_publish_is_acknowledged);
+  RUN_TEST(test_unacknowledged_publishes_are_resent_with_dup_after_reconnect);
+  return UNITY_END();
+}
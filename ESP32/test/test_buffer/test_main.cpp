@@ -0,0 +1,140 @@
+/**
+ * @file test_main.cpp
+ * @brief Tiered buffer roll-up: streamed and rebuilt windows agree
+ *
+ * buffer.cpp is compiled into this test with the journal hooks stubbed out
+ * (the firmware implements them in persistence.cpp on top of LittleFS).
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+#include "buffer/buffer.cpp"
+
+void journalBufferPush(int) {}
+void journalBufferPop(int) {}
+void journalBufferRewrite() {}
+
+// One 1-minute telemetry window (30 control-cycle samples)
+static TelemetryReading window(uint32_t epoch, float temperature) {
+  TelemetryReading reading;
+  memset(&reading, 0, sizeof(reading));
+  snprintf(reading.timestamp, sizeof(reading.timestamp), "%lu", (unsigned long)epoch);
+  reading.temperature = temperature;
+  reading.humidity = 60.0f + temperature / 10.0f;
+  reading.light = 200.0f + temperature;
+  reading.tankLevel = true;
+  reading.valid = true;
+  reading.samples = 30;
+  reading.temperatureStats = { temperature - 0.5f, temperature + 0.5f, 0.3f, 30 };
+  reading.humidityStats = { reading.humidity - 2.0f, reading.humidity + 2.0f, 1.0f, 30 };
+  reading.lightStats = { reading.light - 10.0f, reading.light + 10.0f, 4.0f, 30 };
+  reading.events = (epoch == 1700000300) ? READING_EVENT_IRRIGATED : 0;
+  return reading;
+}
+
+static const uint32_t START = 1700000000;
+
+// Fill tier 0 once and roll it up; skip is entered via insertIntoBuffer()
+static void fillAndRollUp(int skip) {
+  initBuffers();
+  for (int i = 0; i < BUFFER_TIER0_SIZE; i++) {
+    if (i != skip) {
+      addToBuffer(window(START + i * 60, 20.0f + i * 0.25f));
+    }
+  }
+  if (skip >= 0) {
+    insertIntoBuffer(window(START + skip * 60, 20.0f + skip * 0.25f));
+  }
+  addToBuffer(window(START + BUFFER_TIER0_SIZE * 60, 25.0f));   // Triggers the roll-up
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_tier0_keeps_window_statistics() {
+  initBuffers();
+  addToBuffer(window(START, 21.0f));
+  TelemetryReading stored;
+  TEST_ASSERT_TRUE(getOldestFromBuffer(0, stored));
+  TEST_ASSERT_EQUAL_UINT16(30, stored.samples);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 20.5f, stored.temperatureStats.min);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 21.5f, stored.temperatureStats.max);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.3f, stored.temperatureStats.stdDev);
+  TEST_ASSERT_EQUAL_UINT16(30, stored.humidityStats.count);
+}
+
+void test_streamed_and_rebuilt_rollups_match() {
+  fillAndRollUp(-1);    // Streamed window
+  TEST_ASSERT_EQUAL_INT(1, getBufferCount(0));
+  TEST_ASSERT_EQUAL_INT(1, getBufferCount(1));
+  PackedAggregate streamed;
+  memcpy(&streamed, bufferTiers[1]->record(0), sizeof(streamed));
+
+  fillAndRollUp(4);     // Window rebuilt from the stored entries
+  PackedAggregate rebuilt;
+  memcpy(&rebuilt, bufferTiers[1]->record(0), sizeof(rebuilt));
+
+  TEST_ASSERT_EQUAL_MEMORY(&streamed, &rebuilt, sizeof(streamed));
+}
+
+void test_rollup_merges_window_statistics() {
+  fillAndRollUp(-1);
+  TelemetryReading aggregate;
+  TEST_ASSERT_TRUE(getOldestFromBuffer(1, aggregate));
+  TEST_ASSERT_EQUAL_UINT16(10 * 30, aggregate.samples);
+  TEST_ASSERT_EQUAL_UINT16(10 * 30, aggregate.temperatureStats.count);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 21.125f, aggregate.temperature);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 20.0f - 0.5f, aggregate.temperatureStats.min);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 22.25f + 0.5f, aggregate.temperatureStats.max);
+  // Spread within the windows (0.3) plus that of the means (~0.72)
+  TEST_ASSERT_TRUE(aggregate.temperatureStats.stdDev > 0.75f);
+  TEST_ASSERT_TRUE(aggregate.events & READING_EVENT_IRRIGATED);
+  TEST_ASSERT_EQUAL_STRING("1700000540", aggregate.timestamp);
+}
+
+void test_dropped_samples_count_window_samples() {
+  initBuffers();
+  long perEntry[8];           // Windows represented by one entry of each tier
+  long total = 0;             // Windows the whole cascade holds
+  for (int tier = 0; tier < bufferTierCount; tier++) {
+    perEntry[tier] = (tier == 0 ? 1 : perEntry[tier - 1]) * (long)bufferTiers[tier]->fanIn();
+    total += perEntry[tier] * (long)bufferTiers[tier]->capacity();
+  }
+
+  int last = bufferTierCount - 1;
+  BufferTierStats stats;
+  for (long i = 0; i < total; i++) {
+    addToBuffer(window(START + (uint32_t)i * 60, 20.0f));
+  }
+  getBufferTierStats(last, stats);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.dropped);
+
+  addToBuffer(window(START + (uint32_t)total * 60, 20.0f));
+  getBufferTierStats(last, stats);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.dropped);
+  TEST_ASSERT_EQUAL_UINT32(30 * perEntry[last], stats.droppedSamples);
+}
+
+void test_cascade_covers_multi_day_outage() {
+  long minutes = 0;
+  long perEntry = 1;
+  size_t bytes = 0;
+  for (int tier = 0; tier < bufferTierCount; tier++) {
+    perEntry *= (long)bufferTiers[tier]->fanIn();
+    minutes += perEntry * (long)bufferTiers[tier]->capacity();
+    bytes += bufferTiers[tier]->capacity() * bufferTiers[tier]->recordSize();
+  }
+  TEST_ASSERT_TRUE(minutes >= 5L * 24 * 60);
+  TEST_ASSERT_TRUE(bytes <= 1400);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_tier0_keeps_window_statistics);
+  RUN_TEST(test_streamed_and_rebuilt_rollups_match);
+  RUN_TEST(test_rollup_merges_window_statistics);
+  RUN_TEST(test_dropped_samples_count_window_samples);
+  RUN_TEST(test_cascade_covers_multi_day_outage);
+  return UNITY_END();
+}
@@ -0,0 +1,118 @@
+/**
+ * @file test_main.cpp
+ * @brief Edge-driven debouncer for the float switch
+ */
+
+#include <unity.h>
+#include "sensors/debouncer.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_clean_edge_settles_after_quiet_period() {
+  Debouncer debouncer(50, false);
+  debouncer.reset(false, 1000);
+  debouncer.edge(true, 1010);
+  TEST_ASSERT_TRUE(debouncer.pending());
+  TEST_ASSERT_FALSE(debouncer.update(1059));
+  TEST_ASSERT_FALSE(debouncer.state());
+  TEST_ASSERT_TRUE(debouncer.update(1060));
+  TEST_ASSERT_TRUE(debouncer.state());
+  TEST_ASSERT_FALSE(debouncer.update(1100));   // Reported once
+}
+
+void test_change_time_is_last_edge() {
+  Debouncer debouncer(50, false);
+  debouncer.reset(false, 0);
+  debouncer.edge(true, 100);
+  debouncer.edge(false, 105);
+  debouncer.edge(true, 112);
+  debouncer.update(500);   // Loop was late
+  TEST_ASSERT_EQUAL_UINT32(112, debouncer.changedAt());
+}
+
+void test_chatter_restarts_quiet_period() {
+  Debouncer debouncer(50, true);
+  debouncer.reset(true, 0);
+  unsigned long t = 1000;
+  bool level = true;
+  for (int i = 0; i < 20; i++) {   // Ripple: edges every 30 ms
+    level = !level;
+    debouncer.edge(level, t);
+    TEST_ASSERT_FALSE(debouncer.update(t + 29));
+    t += 30;
+  }
+  // Ended on the stable level: no change ever reported
+  TEST_ASSERT_FALSE(debouncer.update(t + 1000));
+  TEST_ASSERT_TRUE(debouncer.state());
+  TEST_ASSERT_EQUAL_UINT32(20, debouncer.edges());
+  TEST_ASSERT_EQUAL_UINT32(10, debouncer.glitches());
+}
+
+void test_glitch_is_discarded() {
+  Debouncer debouncer(50, false);
+  debouncer.reset(false, 0);
+  debouncer.edge(true, 100);
+  debouncer.edge(false, 120);
+  TEST_ASSERT_FALSE(debouncer.update(500));
+  TEST_ASSERT_FALSE(debouncer.state());
+  TEST_ASSERT_EQUAL_UINT32(1, debouncer.glitches());
+}
+
+void test_coalesced_edge_restarts_quiet_period() {
+  // Two interrupts merged: the level is unchanged but time restarts
+  Debouncer debouncer(50, false);
+  debouncer.reset(false, 0);
+  debouncer.edge(true, 100);
+  debouncer.edge(true, 140);
+  TEST_ASSERT_FALSE(debouncer.update(150));
+  TEST_ASSERT_EQUAL_UINT32(40, debouncer.msUntilSettled(150));
+  TEST_ASSERT_TRUE(debouncer.update(190));
+  TEST_ASSERT_EQUAL_UINT32(0, debouncer.glitches());
+}
+
+void test_ms_until_settled() {
+  Debouncer debouncer(50, false);
+  debouncer.reset(false, 0);
+  TEST_ASSERT_TRUE(debouncer.msUntilSettled(10) == Debouncer::DEBOUNCER_IDLE);
+  debouncer.edge(true, 100);
+  TEST_ASSERT_EQUAL_UINT32(50, debouncer.msUntilSettled(100));
+  TEST_ASSERT_EQUAL_UINT32(20, debouncer.msUntilSettled(130));
+  TEST_ASSERT_EQUAL_UINT32(0, debouncer.msUntilSettled(400));
+  debouncer.update(400);
+  TEST_ASSERT_TRUE(debouncer.msUntilSettled(400) == Debouncer::DEBOUNCER_IDLE);
+}
+
+void test_reset_drops_pending_edge() {
+  Debouncer debouncer(50, false);
+  debouncer.reset(false, 0);
+  debouncer.edge(true, 100);
+  debouncer.reset(true, 120);
+  TEST_ASSERT_TRUE(debouncer.state());
+  TEST_ASSERT_FALSE(debouncer.update(500));
+  TEST_ASSERT_EQUAL_UINT32(120, debouncer.changedAt());
+}
+
+void test_settles_across_millis_wrap() {
+  Debouncer debouncer(50, false);
+  unsigned long start = (unsigned long)-20;
+  debouncer.reset(false, start - 100);
+  debouncer.edge(true, start);
+  TEST_ASSERT_FALSE(debouncer.update(start + 49));
+  TEST_ASSERT_EQUAL_UINT32(1, debouncer.msUntilSettled(start + 49));
+  TEST_ASSERT_TRUE(debouncer.update(start + 50));
+  TEST_ASSERT_TRUE(debouncer.changedAt() == start);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_clean_edge_settles_after_quiet_period);
+  RUN_TEST(test_change_time_is_last_edge);
+  RUN_TEST(test_chatter_restarts_quiet_period);
+  RUN_TEST(test_glitch_is_discarded);
+  RUN_TEST(test_coalesced_edge_restarts_quiet_period);
+  RUN_TEST(test_ms_until_settled);
+  RUN_TEST(test_reset_drops_pending_edge);
+  RUN_TEST(test_settles_across_millis_wrap);
+  return UNITY_END();
+}
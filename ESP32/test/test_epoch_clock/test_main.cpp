@@ -0,0 +1,158 @@
+/**
+ * @file test_main.cpp
+ * @brief Monotonic time base, NTP anchoring, drift correction and
+ *        provisional timestamps
+ *
+ * The monotonic counter is a virtual clock advanced by the tests.
+ */
+
+#include <stdint.h>
+#include <unity.h>
+#include "clock/epoch_clock.h"
+#include "constants.h"
+
+static const int64_t SECOND_US = 1000000;
+static const int64_t HOUR_US = 3600 * SECOND_US;
+static const int64_t EPOCH_US = 1700000000LL * SECOND_US;
+
+static int64_t virtualUs;
+
+static int64_t virtualClock() { return virtualUs; }
+
+static EpochClock makeClock() {
+  return EpochClock(virtualClock, CLOCK_STEP_THRESHOLD_MS, CLOCK_DRIFT_MIN_INTERVAL_MS,
+                    CLOCK_MAX_DRIFT_PPM);
+}
+
+/**
+ * Advance the counter and sync against a server whose clock runs
+ * `ppm` faster than the counter (real elapsed = counter elapsed x (1 + ppm/1e6))
+ */
+static void advanceAndSync(EpochClock& clock, int64_t& serverUs, int64_t counterUs, int64_t ppm) {
+  virtualUs += counterUs;
+  serverUs += counterUs + counterUs / 1000000 * ppm;
+  clock.onSync(serverUs, virtualUs);
+}
+
+void setUp() {
+  virtualUs = 5 * SECOND_US;
+}
+
+void tearDown() {}
+
+void test_unsynced_clock_hands_out_provisional_timestamps() {
+  EpochClock clock = makeClock();
+  TEST_ASSERT_FALSE(clock.synced());
+  TEST_ASSERT_EQUAL_INT64(0, clock.nowEpochUs());
+  TEST_ASSERT_EQUAL_UINT32(CLOCK_PROVISIONAL_BASE + 5, clock.timestamp());
+  TEST_ASSERT_EQUAL_UINT32(CLOCK_PROVISIONAL_BASE + 5, clock.resolve(CLOCK_PROVISIONAL_BASE + 5));
+  TEST_ASSERT_EQUAL_UINT64(5000, clock.uptimeMs());
+}
+
+void test_first_sync_anchors_epoch() {
+  EpochClock clock = makeClock();
+  clock.onSync(EPOCH_US, virtualUs);
+  TEST_ASSERT_TRUE(clock.synced());
+  TEST_ASSERT_EQUAL_UINT32(1, clock.syncs());
+
+  virtualUs += 2500000;
+  TEST_ASSERT_EQUAL_INT64(EPOCH_US + 2500000, clock.nowEpochUs());
+  TEST_ASSERT_EQUAL_UINT32(1700000002, clock.timestamp());
+}
+
+void test_resolve_maps_provisional_timestamps_to_unix_time() {
+  EpochClock clock = makeClock();
+  uint32_t provisional = clock.timestamp();   // Uptime 5 s
+  virtualUs = 100 * SECOND_US;
+  clock.onSync(EPOCH_US, virtualUs);
+
+  TEST_ASSERT_EQUAL_UINT32(1700000000 - 95, clock.resolve(provisional));
+  // A reading from an earlier boot lands before this boot
+  TEST_ASSERT_LESS_THAN(1700000000 - 100, clock.resolve(CLOCK_PROVISIONAL_BASE - 60));
+}
+
+void test_drift_is_learned_and_corrected() {
+  EpochClock clock = makeClock();
+  int64_t serverUs = EPOCH_US;
+  clock.onSync(serverUs, virtualUs);
+
+  advanceAndSync(clock, serverUs, HOUR_US, 100);
+  TEST_ASSERT_EQUAL_INT32(360, clock.lastOffsetMs());
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 100.0f, clock.driftPpm());
+
+  // With the drift modelled, the next hour predicts the server closely
+  advanceAndSync(clock, serverUs, HOUR_US, 100);
+  TEST_ASSERT_INT_WITHIN(2, 0, clock.lastOffsetMs());
+  TEST_ASSERT_FLOAT_WITHIN(0.5f, 100.0f, clock.driftPpm());
+
+  virtualUs += HOUR_US;
+  int64_t expected = serverUs + HOUR_US + HOUR_US / 1000000 * 100;
+  TEST_ASSERT_INT64_WITHIN(2000, expected, clock.nowEpochUs());
+}
+
+void test_drift_is_clamped() {
+  EpochClock clock = makeClock();
+  int64_t serverUs = EPOCH_US;
+  clock.onSync(serverUs, virtualUs);
+  advanceAndSync(clock, serverUs, 2 * 600 * SECOND_US, 1500);   // 1.8 s offset, under the step threshold
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, (float)CLOCK_MAX_DRIFT_PPM, clock.driftPpm());
+}
+
+void test_sync_too_soon_keeps_anchor() {
+  EpochClock clock = makeClock();
+  int64_t serverUs = EPOCH_US;
+  clock.onSync(serverUs, virtualUs);
+  advanceAndSync(clock, serverUs, 60 * SECOND_US, 100);
+  TEST_ASSERT_EQUAL_UINT32(1, clock.syncs());
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, clock.driftPpm());
+}
+
+void test_small_backward_correction_does_not_go_backward() {
+  EpochClock clock = makeClock();
+  int64_t serverUs = EPOCH_US;
+  clock.onSync(serverUs, virtualUs);
+
+  virtualUs += HOUR_US;
+  int64_t before = clock.nowEpochUs();
+  serverUs += HOUR_US - 500000;   // Counter ran 500 ms fast
+  clock.onSync(serverUs, virtualUs);
+  TEST_ASSERT_EQUAL_INT32(-500, clock.lastOffsetMs());
+
+  int64_t previous = before;
+  for (int i = 0; i < 100; i++) {
+    virtualUs += 10000;
+    int64_t now = clock.nowEpochUs();
+    TEST_ASSERT_TRUE(now >= previous);
+    previous = now;
+  }
+  virtualUs += SECOND_US;
+  TEST_ASSERT_TRUE(clock.nowEpochUs() > before);
+}
+
+void test_large_offset_is_a_step() {
+  EpochClock clock = makeClock();
+  int64_t serverUs = EPOCH_US;
+  clock.onSync(serverUs, virtualUs);
+  advanceAndSync(clock, serverUs, HOUR_US, 100);
+
+  virtualUs += HOUR_US;
+  clock.nowEpochUs();
+  serverUs += HOUR_US - 30 * SECOND_US;   // Server stepped back 30 s
+  clock.onSync(serverUs, virtualUs);
+  TEST_ASSERT_EQUAL_UINT32(3, clock.syncs());
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, clock.driftPpm());
+  TEST_ASSERT_EQUAL_INT64(serverUs, clock.nowEpochUs());   // Taken as is
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_unsynced_clock_hands_out_provisional_timestamps);
+  RUN_TEST(test_first_sync_anchors_epoch);
+  RUN_TEST(test_resolve_maps_provisional_timestamps_to_unix_time);
+  RUN_TEST(test_drift_is_learned_and_corrected);
+  RUN_TEST(test_drift_is_clamped);
+  RUN_TEST(test_sync_too_soon_keeps_anchor);
+  RUN_TEST(test_small_backward_correction_does_not_go_backward);
+  RUN_TEST(test_large_offset_is_a_step);
+  return UNITY_END();
+}
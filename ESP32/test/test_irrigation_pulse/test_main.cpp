@@ -0,0 +1,230 @@
+/**
+ * @file test_main.cpp
+ * @brief Timed irrigation pulse ended by a one-shot timer
+ *
+ * A fake timer keeps a simulated µs clock and fires the callback when the
+ * test advances past the armed expiry. The last test races abort() against
+ * the timer callback on two threads.
+ */
+
+#include <atomic>
+#include <thread>
+#include <unity.h>
+#include "control/irrigation_pulse.h"
+
+class FakeTimer : public OneShotTimer {
+public:
+  FakeTimer() : callback_(nullptr), context_(nullptr), now_(0), expiry_(0), armed_(false),
+                refuseArm_(false), arms_(0) {}
+
+  bool setCallback(Callback callback, void* context) override {
+    callback_ = callback;
+    context_ = context;
+    return true;
+  }
+
+  bool arm(uint64_t delayUs) override {
+    if (refuseArm_) {
+      return false;
+    }
+    expiry_ = now_ + delayUs;
+    armed_ = true;
+    arms_++;
+    return true;
+  }
+
+  void disarm() override { armed_ = false; }
+  uint64_t nowUs() override { return now_; }
+
+  // Move the clock, firing a pending expiry on the way
+  void advance(uint64_t us) {
+    uint64_t target = now_ + us;
+    if (armed_ && expiry_ <= target) {
+      now_ = expiry_;
+      fire();
+    }
+    now_ = target;
+  }
+
+  // Run the callback now, as a late or stale expiry would
+  void fire() {
+    armed_ = false;
+    callback_(context_);
+  }
+
+  Callback callback_;
+  void* context_;
+  uint64_t now_;
+  uint64_t expiry_;
+  bool armed_;
+  bool refuseArm_;
+  int arms_;
+};
+
+static std::atomic<int> cutOffs;
+static void cutOff() { cutOffs++; }
+
+void setUp() { cutOffs = 0; }
+void tearDown() {}
+
+void test_timer_ends_pulse_at_deadline() {
+  FakeTimer timer;
+  IrrigationPulse pulse(timer, cutOff);
+  TEST_ASSERT_TRUE(pulse.begin());
+  timer.now_ = 5000;
+  TEST_ASSERT_TRUE(pulse.start(2000000));
+  TEST_ASSERT_TRUE(pulse.timerArmed());
+  TEST_ASSERT_TRUE(pulse.running());
+
+  timer.advance(1999999);
+  TEST_ASSERT_EQUAL_INT(0, cutOffs.load());
+  TEST_ASSERT_EQUAL_UINT32(1, (uint32_t)pulse.remainingUs());
+  timer.advance(1);
+  TEST_ASSERT_EQUAL_INT(1, cutOffs.load());
+  TEST_ASSERT_FALSE(pulse.running());
+
+  PulseEnd reason;
+  uint64_t endUs, ranUs;
+  TEST_ASSERT_TRUE(pulse.takeEnded(reason, endUs, ranUs));
+  TEST_ASSERT_EQUAL(PULSE_COMPLETED, reason);
+  TEST_ASSERT_TRUE(endUs == 2005000);
+  TEST_ASSERT_TRUE(ranUs == 2000000);
+  TEST_ASSERT_FALSE(pulse.takeEnded(reason, endUs, ranUs));
+}
+
+void test_start_refused_until_end_is_taken() {
+  FakeTimer timer;
+  IrrigationPulse pulse(timer, cutOff);
+  pulse.begin();
+  TEST_ASSERT_TRUE(pulse.start(1000));
+  TEST_ASSERT_FALSE(pulse.start(1000));   // Running
+  timer.advance(1000);
+  TEST_ASSERT_FALSE(pulse.start(1000));   // Ended, not taken
+
+  PulseEnd reason;
+  uint64_t endUs, ranUs;
+  pulse.takeEnded(reason, endUs, ranUs);
+  TEST_ASSERT_TRUE(pulse.start(1000));
+}
+
+void test_abort_cuts_early_once() {
+  FakeTimer timer;
+  IrrigationPulse pulse(timer, cutOff);
+  pulse.begin();
+  pulse.start(10000000);
+  timer.advance(3000000);
+  TEST_ASSERT_TRUE(pulse.abort(PULSE_TANK_EMPTY));
+  TEST_ASSERT_FALSE(pulse.abort(PULSE_CANCELLED));
+  TEST_ASSERT_EQUAL_UINT32(0, (uint32_t)pulse.remainingUs());
+
+  timer.advance(7000000);   // Timer still expires; finds the pulse over
+  TEST_ASSERT_EQUAL_INT(1, cutOffs.load());
+
+  PulseEnd reason;
+  uint64_t endUs, ranUs;
+  TEST_ASSERT_TRUE(pulse.takeEnded(reason, endUs, ranUs));
+  TEST_ASSERT_EQUAL(PULSE_TANK_EMPTY, reason);
+  TEST_ASSERT_TRUE(ranUs == 3000000);
+}
+
+void test_stale_expiry_does_not_cut_newer_pulse() {
+  FakeTimer timer;
+  IrrigationPulse pulse(timer, cutOff);
+  pulse.begin();
+  pulse.start(5000000);
+  timer.advance(1000000);
+  pulse.abort(PULSE_CANCELLED);
+
+  PulseEnd reason;
+  uint64_t endUs, ranUs;
+  pulse.takeEnded(reason, endUs, ranUs);
+  pulse.start(5000000);             // Deadline at 6 s
+  timer.advance(4000000);
+  timer.fire();                     // Old pulse's expiry arriving late, at 5 s
+  TEST_ASSERT_TRUE(pulse.running());
+  TEST_ASSERT_EQUAL_INT(1, cutOffs.load());
+}
+
+void test_expiry_within_slack_counts() {
+  FakeTimer timer;
+  IrrigationPulse pulse(timer, cutOff);
+  pulse.begin();
+  pulse.start(100000);
+  timer.now_ = 100000 - PULSE_TIMER_SLACK_US;
+  timer.fire();                     // Timer ran slightly early
+  TEST_ASSERT_FALSE(pulse.running());
+  TEST_ASSERT_EQUAL_INT(1, cutOffs.load());
+}
+
+void test_poll_backstop_when_timer_not_armed() {
+  FakeTimer timer;
+  timer.refuseArm_ = true;
+  IrrigationPulse pulse(timer, cutOff);
+  pulse.begin();
+  TEST_ASSERT_TRUE(pulse.start(50000));
+  TEST_ASSERT_FALSE(pulse.timerArmed());
+
+  timer.advance(49999);
+  TEST_ASSERT_FALSE(pulse.poll());
+  timer.advance(5000);              // Loop was busy
+  TEST_ASSERT_TRUE(pulse.poll());
+  TEST_ASSERT_FALSE(pulse.poll());
+
+  PulseEnd reason;
+  uint64_t endUs, ranUs;
+  pulse.takeEnded(reason, endUs, ranUs);
+  TEST_ASSERT_EQUAL(PULSE_COMPLETED, reason);
+  TEST_ASSERT_TRUE(ranUs == 54999);
+}
+
+void test_start_replaces_pending_expiry() {
+  FakeTimer timer;
+  IrrigationPulse pulse(timer, cutOff);
+  pulse.begin();
+  pulse.start(1000);
+  TEST_ASSERT_TRUE(pulse.abort(PULSE_CANCELLED));
+  PulseEnd reason;
+  uint64_t endUs, ranUs;
+  pulse.takeEnded(reason, endUs, ranUs);
+
+  pulse.start(5000);
+  TEST_ASSERT_TRUE(timer.expiry_ == 5000);
+  TEST_ASSERT_EQUAL_INT(2, timer.arms_);
+}
+
+void test_abort_races_timer_callback() {
+  // Exactly one side ends each pulse, and the pump is cut exactly once
+  FakeTimer timer;
+  IrrigationPulse pulse(timer, cutOff);
+  pulse.begin();
+  for (int i = 0; i < 2000; i++) {
+    pulse.start(0);
+    std::atomic<bool> go(false);
+    std::thread expiry([&] {
+      while (!go.load()) {}
+      timer.fire();
+    });
+    go.store(true);
+    pulse.abort(PULSE_TANK_EMPTY);
+    expiry.join();
+
+    PulseEnd reason;
+    uint64_t endUs, ranUs;
+    TEST_ASSERT_TRUE(pulse.takeEnded(reason, endUs, ranUs));
+    TEST_ASSERT_TRUE(reason == PULSE_COMPLETED || reason == PULSE_TANK_EMPTY);
+    TEST_ASSERT_EQUAL_INT(i + 1, cutOffs.load());
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_timer_ends_pulse_at_deadline);
+  RUN_TEST(test_start_refused_until_end_is_taken);
+  RUN_TEST(test_abort_cuts_early_once);
+  RUN_TEST(test_stale_expiry_does_not_cut_newer_pulse);
+  RUN_TEST(test_expiry_within_slack_counts);
+  RUN_TEST(test_poll_backstop_when_timer_not_armed);
+  RUN_TEST(test_start_replaces_pending_expiry);
+  RUN_TEST(test_abort_races_timer_callback);
+  return UNITY_END();
+}
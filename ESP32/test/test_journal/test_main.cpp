@@ -0,0 +1,283 @@
+/**
+ * @file test_main.cpp
+ * @brief Telemetry journal: record CRC, replay, torn writes and rotation
+ *
+ * Runs against an in-memory JournalStorage that can cut the power after a
+ * given number of bytes, so every write offset can be tried.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+#include "buffer/buffer_tier.h"
+#include "buffer/journal.h"
+#include "crc32.h"
+
+// Two slots in RAM; once the byte budget runs out, writes stop mid-record
+class MemoryJournalStorage : public JournalStorage {
+public:
+  MemoryJournalStorage() : budget(-1) { erase(0); erase(1); }
+
+  size_t read(uint8_t slot, size_t offset, void* data, size_t length) override {
+    if (offset >= sizes[slot]) {
+      return 0;
+    }
+    size_t n = sizes[slot] - offset < length ? sizes[slot] - offset : length;
+    memcpy(data, bytes[slot] + offset, n);
+    return n;
+  }
+
+  bool append(uint8_t slot, const void* data, size_t length) override {
+    const uint8_t* source = (const uint8_t*)data;
+    for (size_t i = 0; i < length; i++) {
+      if (budget == 0 || sizes[slot] == SLOT_BYTES) {
+        return false;
+      }
+      if (budget > 0) {
+        budget--;
+      }
+      bytes[slot][sizes[slot]++] = source[i];
+    }
+    return true;
+  }
+
+  void erase(uint8_t slot) override {
+    if (budget != 0) {
+      sizes[slot] = 0;
+    }
+  }
+
+  size_t size(uint8_t slot) override { return sizes[slot]; }
+
+  static const size_t SLOT_BYTES = 16384;
+
+  uint8_t bytes[2][SLOT_BYTES];
+  size_t sizes[2];
+  long budget;              // Bytes left before the power cut (-1 = unlimited)
+};
+
+typedef RingBufferTier<PackedReading, 8, 1> RawTier;
+typedef RingBufferTier<PackedAggregate, 4, 4> AggregateTier;
+
+// Tiers as they would be after a reboot
+struct TierSet {
+  RawTier raw;
+  AggregateTier aggregate;
+  BufferTier* tiers[2];
+
+  TierSet() : raw("raw"), aggregate("aggregate") {
+    tiers[0] = &raw;
+    tiers[1] = &aggregate;
+  }
+};
+
+static MemoryJournalStorage* storage;
+
+static TelemetryReading makeReading(uint32_t epoch, uint16_t samples) {
+  TelemetryReading reading;
+  memset(&reading, 0, sizeof(reading));
+  snprintf(reading.timestamp, sizeof(reading.timestamp), "%lu", (unsigned long)epoch);
+  reading.temperature = 20.0f + (epoch % 10) * 0.25f;
+  reading.humidity = 55.0f;
+  reading.light = 120.5f;
+  reading.tankLevel = true;
+  reading.valid = true;
+  reading.samples = samples;
+  if (samples > 1) {
+    reading.temperatureStats.min = 19.0f;
+    reading.temperatureStats.max = 23.5f;
+    reading.temperatureStats.stdDev = 1.25f;
+    reading.temperatureStats.count = samples;
+  }
+  return reading;
+}
+
+static void pushAndLog(TelemetryJournal& journal, BufferTier& tier, uint8_t index, uint32_t epoch) {
+  tier.push(makeReading(epoch, index == 0 ? 1 : 4));
+  journal.recordPush(index);
+}
+
+static void assertSameTier(const BufferTier& expected, const BufferTier& actual) {
+  TEST_ASSERT_EQUAL_UINT32(expected.size(), actual.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    TEST_ASSERT_EQUAL_MEMORY(expected.record(i), actual.record(i), expected.recordSize());
+  }
+}
+
+void setUp() {
+  storage = new MemoryJournalStorage();
+}
+
+void tearDown() {
+  delete storage;
+}
+
+void test_crc32_check_value() {
+  const char* check = "123456789";
+  TEST_ASSERT_EQUAL_HEX32(0xCBF43926, crc32((const uint8_t*)check, strlen(check)));
+  TEST_ASSERT_EQUAL_HEX32(0x00000000, crc32(nullptr, 0));
+}
+
+void test_replay_restores_raw_and_aggregate_tiers() {
+  TierSet live;
+  TelemetryJournal journal(*storage, live.tiers, 2);
+  TEST_ASSERT_EQUAL_INT(0, journal.replay());
+
+  for (uint32_t epoch = 1000; epoch < 1006; epoch++) {
+    pushAndLog(journal, live.raw, 0, epoch);
+  }
+  pushAndLog(journal, live.aggregate, 1, 900);
+  pushAndLog(journal, live.aggregate, 1, 960);
+  live.raw.pop();
+  journal.recordPop(0);
+  live.raw.pop();
+  journal.recordPop(0);
+  TEST_ASSERT_TRUE(journal.sync());
+
+  TierSet rebooted;
+  TelemetryJournal replayed(*storage, rebooted.tiers, 2);
+  TEST_ASSERT_EQUAL_INT(6, replayed.replay());
+  assertSameTier(live.raw, rebooted.raw);
+  assertSameTier(live.aggregate, rebooted.aggregate);
+
+  TelemetryReading reading;
+  rebooted.aggregate.read(1, reading);
+  TEST_ASSERT_EQUAL_STRING("960", reading.timestamp);
+  TEST_ASSERT_EQUAL_UINT16(4, reading.samples);
+  TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.25f, reading.temperatureStats.stdDev);
+}
+
+void test_pending_records_are_lost_without_sync() {
+  TierSet live;
+  TelemetryJournal journal(*storage, live.tiers, 2);
+  journal.replay();
+  pushAndLog(journal, live.raw, 0, 1000);
+  TEST_ASSERT_TRUE(journal.sync());
+  pushAndLog(journal, live.raw, 0, 1001);
+  TEST_ASSERT_EQUAL_INT(1, journal.pendingCount());
+
+  TierSet rebooted;
+  TelemetryJournal replayed(*storage, rebooted.tiers, 2);
+  TEST_ASSERT_EQUAL_INT(1, replayed.replay());
+}
+
+void test_consecutive_pops_are_coalesced() {
+  TierSet live;
+  TelemetryJournal journal(*storage, live.tiers, 2);
+  journal.replay();
+  for (uint32_t epoch = 1000; epoch < 1005; epoch++) {
+    pushAndLog(journal, live.raw, 0, epoch);
+  }
+  TEST_ASSERT_TRUE(journal.sync());
+
+  for (int i = 0; i < 4; i++) {
+    live.raw.pop();
+    journal.recordPop(0);
+  }
+  TEST_ASSERT_EQUAL_INT(1, journal.pendingCount());
+  TEST_ASSERT_TRUE(journal.sync());
+
+  TierSet rebooted;
+  TelemetryJournal replayed(*storage, rebooted.tiers, 2);
+  TEST_ASSERT_EQUAL_INT(1, replayed.replay());
+  assertSameTier(live.raw, rebooted.raw);
+}
+
+void test_corrupt_record_ends_replay() {
+  TierSet live;
+  TelemetryJournal journal(*storage, live.tiers, 2);
+  journal.replay();
+  for (uint32_t epoch = 1000; epoch < 1004; epoch++) {
+    pushAndLog(journal, live.raw, 0, epoch);
+  }
+  TEST_ASSERT_TRUE(journal.sync());
+
+  // Flip one payload bit of the third incremental record
+  uint8_t slot = storage->sizes[0] > 0 ? 0 : 1;
+  size_t snapshot = 2 * sizeof(JournalRecord);   // HEADER + COMMIT of an empty snapshot
+  storage->bytes[slot][snapshot + 2 * sizeof(JournalRecord) + 10] ^= 0x01;
+
+  TierSet rebooted;
+  TelemetryJournal replayed(*storage, rebooted.tiers, 2);
+  TEST_ASSERT_EQUAL_INT(2, replayed.replay());
+  TelemetryReading reading;
+  rebooted.raw.read(1, reading);
+  TEST_ASSERT_EQUAL_STRING("1001", reading.timestamp);
+}
+
+void test_power_cut_at_any_offset_restores_a_prefix() {
+  for (long cut = 0; cut < 6000; cut += 13) {
+    MemoryJournalStorage* flash = new MemoryJournalStorage();
+    TierSet live;
+    TelemetryJournal journal(*flash, live.tiers, 2);
+    journal.replay();
+    flash->budget = cut;
+
+    uint32_t synced = 0;
+    for (uint32_t epoch = 1; epoch <= 60; epoch++) {
+      pushAndLog(journal, live.raw, 0, epoch);
+      if (epoch % 5 == 0) {
+        if (journal.sync() && flash->budget != 0) {
+          synced = epoch;
+        }
+      }
+    }
+
+    flash->budget = -1;
+    TierSet rebooted;
+    TelemetryJournal replayed(*flash, rebooted.tiers, 2);
+    replayed.replay();
+
+    // Entries are a run of consecutive readings ending no earlier than the last sync
+    TelemetryReading reading;
+    uint32_t previous = 0;
+    for (size_t i = 0; i < rebooted.raw.size(); i++) {
+      rebooted.raw.read(i, reading);
+      uint32_t epoch = (uint32_t)strtoul(reading.timestamp, NULL, 10);
+      if (previous != 0) {
+        TEST_ASSERT_EQUAL_UINT32(previous + 1, epoch);
+      }
+      previous = epoch;
+    }
+    if (synced > 0) {
+      TEST_ASSERT_GREATER_OR_EQUAL(synced, previous);
+    }
+    delete flash;
+  }
+}
+
+void test_rotation_keeps_contents() {
+  TierSet live;
+  TelemetryJournal journal(*storage, live.tiers, 2);
+  journal.replay();
+
+  // Far more than JOURNAL_SEGMENT_MAX_BYTES of records
+  for (uint32_t epoch = 1; epoch <= 2000; epoch++) {
+    pushAndLog(journal, live.raw, 0, epoch);
+    if (epoch % 16 == 0) {
+      pushAndLog(journal, live.aggregate, 1, epoch);
+    }
+    TEST_ASSERT_TRUE(journal.sync());
+  }
+  TEST_ASSERT_TRUE(storage->sizes[0] == 0 || storage->sizes[1] == 0);
+  TEST_ASSERT_LESS_OR_EQUAL(JOURNAL_SEGMENT_MAX_BYTES, storage->sizes[0] + storage->sizes[1]);
+
+  TierSet rebooted;
+  TelemetryJournal replayed(*storage, rebooted.tiers, 2);
+  replayed.replay();
+  assertSameTier(live.raw, rebooted.raw);
+  assertSameTier(live.aggregate, rebooted.aggregate);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_crc32_check_value);
+  RUN_TEST(test_replay_restores_raw_and_aggregate_tiers);
+  RUN_TEST(test_pending_records_are_lost_without_sync);
+  RUN_TEST(test_consecutive_pops_are_coalesced);
+  RUN_TEST(test_corrupt_record_ends_replay);
+  RUN_TEST(test_power_cut_at_any_offset_restores_a_prefix);
+  RUN_TEST(test_rotation_keeps_contents);
+  return UNITY_END();
+}
@@ -0,0 +1,140 @@
+/**
+ * @file test_main.cpp
+ * @brief Allocation-free JSON writer
+ *
+ * Expected strings are what ArduinoJson's serializeJson() produces for the
+ * same documents.
+ */
+
+#include <math.h>
+#include <string.h>
+#include <unity.h>
+#include "mqtt/json_writer.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_nested_containers_and_separators() {
+  char buffer[128];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginObject();
+  json.member("deviceId", "abc");
+  json.member("count", 3);
+  json.key("readings");
+  json.beginArray();
+  json.beginObject();
+  json.member("ok", true);
+  json.endObject();
+  json.beginObject();
+  json.member("ok", false);
+  json.endObject();
+  json.value(-42L);
+  json.endArray();
+  json.endObject();
+
+  TEST_ASSERT_FALSE(json.overflowed());
+  TEST_ASSERT_EQUAL_STRING("{\"deviceId\":\"abc\",\"count\":3,\"readings\":"
+                           "[{\"ok\":true},{\"ok\":false},-42]}", buffer);
+  TEST_ASSERT_EQUAL_UINT32(strlen(buffer), json.length());
+}
+
+void test_integer_limits() {
+  char buffer[64];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginArray();
+  json.value(0);
+  json.value((long long)(-9223372036854775807LL - 1));
+  json.value(18446744073709551615ULL);
+  json.endArray();
+  TEST_ASSERT_EQUAL_STRING("[0,-9223372036854775808,18446744073709551615]", buffer);
+}
+
+void test_string_escaping() {
+  char buffer[64];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.value("a\"b\\c\n\t\x01");
+  TEST_ASSERT_EQUAL_STRING("\"a\\\"b\\\\c\\n\\t\\u0001\"", buffer);
+}
+
+void test_float_formatting() {
+  struct {
+    float value;
+    const char* expected;
+  } cases[] = {
+    {21.5f, "21.5"},
+    {0.0f, "0"},
+    {-3.25f, "-3.25"},
+    {0.1f, "0.1"},
+    {64.0f, "64"},
+    {1234.56f, "1234.56"},
+    {12345678.0f, "1.234568e7"},
+    {NAN, "null"},
+    {INFINITY, "null"},
+  };
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    char buffer[32];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.value(cases[i].value);
+    TEST_ASSERT_EQUAL_STRING(cases[i].expected, buffer);
+  }
+}
+
+void test_double_keeps_nine_places() {
+  char buffer[32];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.value(0.123456789);
+  TEST_ASSERT_EQUAL_STRING("0.123456789", buffer);
+}
+
+void test_overflow_stays_terminated() {
+  char buffer[8];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginObject();
+  json.member("key", "value");
+  TEST_ASSERT_TRUE(json.overflowed());
+  TEST_ASSERT_EQUAL_UINT32(7, json.length());
+  TEST_ASSERT_EQUAL_STRING("{\"key\":", buffer);
+
+  // Rewinding to before the member clears the overflow
+  json.rewind(1);
+  TEST_ASSERT_FALSE(json.overflowed());
+  json.endObject();
+  TEST_ASSERT_EQUAL_STRING("{}", buffer);
+}
+
+void test_rewind_drops_last_record() {
+  char buffer[32];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginArray();
+  json.value(1);
+  size_t mark = json.length();
+  json.value("a long string that does not fit");
+  TEST_ASSERT_TRUE(json.overflowed());
+
+  json.rewind(mark);
+  json.endArray();
+  TEST_ASSERT_FALSE(json.overflowed());
+  TEST_ASSERT_EQUAL_STRING("[1]", buffer);
+}
+
+void test_zero_capacity() {
+  char buffer[1] = {'x'};
+  JsonWriter json(buffer, 0);
+  json.value(1);
+  TEST_ASSERT_TRUE(json.overflowed());
+  TEST_ASSERT_EQUAL_UINT32(0, json.length());
+  TEST_ASSERT_EQUAL_INT('x', buffer[0]);   // Untouched
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_nested_containers_and_separators);
+  RUN_TEST(test_integer_limits);
+  RUN_TEST(test_string_escaping);
+  RUN_TEST(test_float_formatting);
+  RUN_TEST(test_double_keeps_nine_places);
+  RUN_TEST(test_overflow_stays_terminated);
+  RUN_TEST(test_rewind_drops_last_record);
+  RUN_TEST(test_zero_capacity);
+  return UNITY_END();
+}
@@ -0,0 +1,111 @@
+/**
+ * @file test_main.cpp
+ * @brief Median-of-N filter with outlier rejection
+ */
+
+#include <math.h>
+#include <unity.h>
+#include "sensors/median_filter.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_empty_filter_is_invalid() {
+  MedianFilter<5> filter(2.0f);
+  TEST_ASSERT_FALSE(filter.valid());
+  TEST_ASSERT_EQUAL_UINT8(0, filter.validSamples());
+  TEST_ASSERT_EQUAL_UINT32(0, filter.lastValidMs());
+}
+
+void test_averages_close_samples() {
+  MedianFilter<5> filter(2.0f);
+  filter.add(21.0f, 1000);
+  TEST_ASSERT_TRUE(filter.valid());
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 21.0f, filter.value());
+  filter.add(22.0f, 2000);
+  filter.add(22.0f, 3000);
+  filter.add(21.0f, 4000);
+  // DHT11 whole-unit steps are smoothed
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 21.5f, filter.value());
+  TEST_ASSERT_EQUAL_UINT8(0, filter.rejected());
+}
+
+void test_spike_is_rejected() {
+  MedianFilter<5> filter(2.0f);
+  filter.add(20.0f, 0);
+  filter.add(21.0f, 0);
+  filter.add(85.0f, 0);    // Bit error
+  filter.add(20.0f, 0);
+  filter.add(21.0f, 0);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 20.5f, filter.value());
+  TEST_ASSERT_EQUAL_UINT8(5, filter.validSamples());
+  TEST_ASSERT_EQUAL_UINT8(1, filter.rejected());
+}
+
+void test_lower_median_for_even_count() {
+  MedianFilter<4> filter(0.5f);
+  filter.add(10.0f, 0);
+  filter.add(30.0f, 0);
+  // Median is the lower sample; the other is beyond the band
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 10.0f, filter.value());
+  TEST_ASSERT_EQUAL_UINT8(1, filter.rejected());
+}
+
+void test_failed_read_takes_a_slot() {
+  MedianFilter<3> filter(2.0f);
+  filter.add(20.0f, 1000);
+  filter.add(NAN, 2000);
+  TEST_ASSERT_TRUE(filter.valid());
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 20.0f, filter.value());
+  TEST_ASSERT_EQUAL_UINT8(1, filter.validSamples());
+  TEST_ASSERT_EQUAL_UINT32(1, filter.failures());
+  TEST_ASSERT_EQUAL_UINT32(1000, filter.lastValidMs());
+
+  // A run of failures ages the good sample out
+  filter.add(NAN, 3000);
+  TEST_ASSERT_TRUE(filter.valid());
+  filter.add(NAN, 4000);
+  TEST_ASSERT_FALSE(filter.valid());
+  TEST_ASSERT_EQUAL_UINT32(3, filter.failures());
+  TEST_ASSERT_EQUAL_UINT32(1000, filter.lastValidMs());
+
+  filter.add(24.0f, 5000);
+  TEST_ASSERT_TRUE(filter.valid());
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 24.0f, filter.value());
+  TEST_ASSERT_EQUAL_UINT32(5000, filter.lastValidMs());
+}
+
+void test_window_slides() {
+  MedianFilter<3> filter(1.0f);
+  filter.add(10.0f, 0);
+  filter.add(10.0f, 0);
+  filter.add(10.0f, 0);
+  filter.add(20.0f, 0);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 10.0f, filter.value());   // One step is an outlier
+  filter.add(20.0f, 0);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 20.0f, filter.value());   // Two is the new level
+  TEST_ASSERT_EQUAL_UINT8(1, filter.rejected());
+  TEST_ASSERT_EQUAL_UINT8(3, filter.validSamples());
+}
+
+void test_single_slot_window() {
+  MedianFilter<1> filter(0.0f);
+  filter.add(5.0f, 0);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 5.0f, filter.value());
+  filter.add(NAN, 0);
+  TEST_ASSERT_FALSE(filter.valid());
+  filter.add(7.0f, 0);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 7.0f, filter.value());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_empty_filter_is_invalid);
+  RUN_TEST(test_averages_close_samples);
+  RUN_TEST(test_spike_is_rejected);
+  RUN_TEST(test_lower_median_for_even_count);
+  RUN_TEST(test_failed_read_takes_a_slot);
+  RUN_TEST(test_window_slides);
+  RUN_TEST(test_single_slot_window);
+  return UNITY_END();
+}
@@ -0,0 +1,133 @@
+/**
+ * @file test_main.cpp
+ * @brief QoS 1 PUBLISH header encoding and PUBACK scanning
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <unity.h>
+#include "mqtt/mqtt_packet.h"
+
+static uint16_t acked[16];
+static size_t ackCount;
+
+static void onAck(uint16_t packetId) {
+  if (ackCount < sizeof(acked) / sizeof(acked[0])) {
+    acked[ackCount] = packetId;
+  }
+  ackCount++;
+}
+
+void setUp() {
+  ackCount = 0;
+}
+
+void tearDown() {}
+
+void test_publish_header_single_byte_length() {
+  uint8_t out[MQTT_PUBLISH_HEADER_SIZE(4)];
+  size_t n = encodeQos1PublishHeader(out, "a/bc", 0x1234, 10, false);
+  const uint8_t expected[] = {0x32, 18, 0x00, 0x04, 'a', '/', 'b', 'c', 0x12, 0x34};
+  TEST_ASSERT_EQUAL_UINT32(sizeof(expected), n);
+  TEST_ASSERT_EQUAL_MEMORY(expected, out, n);
+}
+
+void test_publish_header_dup_flag() {
+  uint8_t out[MQTT_PUBLISH_HEADER_SIZE(1)];
+  encodeQos1PublishHeader(out, "t", 1, 0, true);
+  TEST_ASSERT_EQUAL_HEX8(0x3A, out[0]);
+}
+
+void test_publish_header_multi_byte_length() {
+  uint8_t out[MQTT_PUBLISH_HEADER_SIZE(1)];
+
+  // 2 + 1 + 2 + 123 = 128: first two-byte length
+  size_t n = encodeQos1PublishHeader(out, "t", 1, 123, false);
+  TEST_ASSERT_EQUAL_UINT32(8, n);
+  TEST_ASSERT_EQUAL_HEX8(0x80, out[1]);
+  TEST_ASSERT_EQUAL_HEX8(0x01, out[2]);
+
+  // 2 + 1 + 2 + 16379 = 16384: first three-byte length
+  n = encodeQos1PublishHeader(out, "t", 1, 16379, false);
+  TEST_ASSERT_EQUAL_UINT32(9, n);
+  TEST_ASSERT_EQUAL_HEX8(0x80, out[1]);
+  TEST_ASSERT_EQUAL_HEX8(0x80, out[2]);
+  TEST_ASSERT_EQUAL_HEX8(0x01, out[3]);
+
+  // Largest MQTT packet: four length bytes fill MQTT_PUBLISH_HEADER_SIZE exactly
+  n = encodeQos1PublishHeader(out, "t", 1, 268435455 - 5, false);
+  TEST_ASSERT_EQUAL_UINT32(MQTT_PUBLISH_HEADER_SIZE(1), n);
+  TEST_ASSERT_EQUAL_HEX8(0x7F, out[4]);
+}
+
+void test_scanner_reports_puback_ids() {
+  PubAckScanner scanner(onAck);
+  const uint8_t stream[] = {0x40, 0x02, 0x00, 0x01, 0x40, 0x02, 0xAB, 0xCD};
+  scanner.feed(stream, sizeof(stream));
+  TEST_ASSERT_EQUAL_UINT32(2, ackCount);
+  TEST_ASSERT_EQUAL_HEX16(0x0001, acked[0]);
+  TEST_ASSERT_EQUAL_HEX16(0xABCD, acked[1]);
+}
+
+void test_scanner_skips_other_packets() {
+  PubAckScanner scanner(onAck);
+  const uint8_t stream[] = {
+    0x20, 0x02, 0x00, 0x00,                               // CONNACK
+    0x30, 0x07, 0x00, 0x01, 't', 0x40, 0x02, 0x00, 0x09,  // PUBLISH, payload looks like a PUBACK
+    0xD0, 0x00,                                           // PINGRESP (empty body)
+    0x90, 0x03, 0x00, 0x05, 0x01,                         // SUBACK
+    0x40, 0x02, 0x00, 0x07                                // PUBACK 7
+  };
+  scanner.feed(stream, sizeof(stream));
+  TEST_ASSERT_EQUAL_UINT32(1, ackCount);
+  TEST_ASSERT_EQUAL_HEX16(7, acked[0]);
+}
+
+void test_scanner_skips_long_packet() {
+  PubAckScanner scanner(onAck);
+  static uint8_t stream[3 + 200 + 4];
+  memset(stream, 0x40, sizeof(stream));
+  stream[0] = 0x30;
+  stream[1] = 0xC8;   // Remaining length 200 (0xC8 0x01)
+  stream[2] = 0x01;
+  const uint8_t puback[] = {0x40, 0x02, 0x01, 0x00};
+  memcpy(stream + 203, puback, sizeof(puback));
+  scanner.feed(stream, sizeof(stream));
+  TEST_ASSERT_EQUAL_UINT32(1, ackCount);
+  TEST_ASSERT_EQUAL_HEX16(0x0100, acked[0]);
+}
+
+void test_scanner_handles_byte_at_a_time() {
+  PubAckScanner scanner(onAck);
+  const uint8_t stream[] = {0x40, 0x02, 0x12, 0x34};
+  for (size_t i = 0; i < sizeof(stream); i++) {
+    TEST_ASSERT_EQUAL_UINT32(0, ackCount);
+    scanner.feed(stream[i]);
+  }
+  TEST_ASSERT_EQUAL_UINT32(1, ackCount);
+  TEST_ASSERT_EQUAL_HEX16(0x1234, acked[0]);
+}
+
+void test_scanner_reset_drops_partial_packet() {
+  PubAckScanner scanner(onAck);
+  const uint8_t partial[] = {0x30, 0x10, 0x00};
+  scanner.feed(partial, sizeof(partial));
+  scanner.reset();   // New connection
+  const uint8_t puback[] = {0x40, 0x02, 0x00, 0x03};
+  scanner.feed(puback, sizeof(puback));
+  TEST_ASSERT_EQUAL_UINT32(1, ackCount);
+  TEST_ASSERT_EQUAL_HEX16(3, acked[0]);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_publish_header_single_byte_length);
+  RUN_TEST(test_publish_header_dup_flag);
+  RUN_TEST(test_publish_header_multi_byte_length);
+  RUN_TEST(test_scanner_reports_puback_ids);
+  RUN_TEST(test_scanner_skips_other_packets);
+  RUN_TEST(test_scanner_skips_long_packet);
+  RUN_TEST(test_scanner_handles_byte_at_a_time);
+  RUN_TEST(test_scanner_reset_drops_partial_packet);
+  return UNITY_END();
+}
@@ -0,0 +1,219 @@
+/**
+ * @file test_main.cpp
+ * @brief Heating PID controller
+ *
+ * The closed-loop tests run against simulated greenhouses. The last one
+ * compares the shipped heating setup (config.h gains, time-proportional
+ * relay, DHT filter) with the old on/off rule on the same model.
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdint.h>
+#include "config.h"
+#include "constants.h"
+#include "control/pid_controller.h"
+#include "control/time_proportional.h"
+#include "sensors/median_filter.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_proportional_term() {
+  PidController pid({0.1f, 0.0f, 0.0f}, 0.0f, 1.0f, 0.0f);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.3f, pid.update(23.0f, 20.0f, 1.0f));
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, pid.update(18.0f, 20.0f, 1.0f));   // Clamped low
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, pid.update(40.0f, 20.0f, 1.0f));   // Clamped high
+}
+
+void test_integral_accumulates_in_output_units() {
+  PidController pid({0.0f, 0.01f, 0.0f}, 0.0f, 1.0f, 0.0f);
+  pid.update(22.0f, 20.0f, 10.0f);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.2f, pid.integral());
+  pid.update(22.0f, 20.0f, 10.0f);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.4f, pid.output());
+
+  // New gains keep the integral, so the output does not jump
+  pid.setGains({0.0f, 0.05f, 0.0f});
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.4f, pid.update(20.0f, 20.0f, 10.0f));
+}
+
+void test_integral_does_not_wind_up() {
+  PidController pid({0.1f, 0.01f, 0.0f}, 0.0f, 1.0f, 0.0f);
+  for (int i = 0; i < 1000; i++) {
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, pid.update(30.0f, 10.0f, 10.0f));   // Saturated for hours
+  }
+  TEST_ASSERT_TRUE(pid.integral() <= 1.0f);
+
+  // Slightly above the setpoint the output leaves the limit at once
+  float output = pid.update(30.0f, 30.5f, 10.0f);
+  TEST_ASSERT_TRUE(output < 1.0f);
+}
+
+void test_integral_limited_to_output_range() {
+  PidController pid({0.0f, 0.1f, 0.0f}, 0.0f, 1.0f, 0.0f);
+  pid.update(21.0f, 20.0f, 100.0f);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, pid.integral());
+}
+
+void test_derivative_acts_on_measurement_only() {
+  PidController pid({0.0f, 0.0f, 10.0f}, -1.0f, 1.0f, 0.0f);
+  pid.update(20.0f, 20.0f, 1.0f);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, pid.update(25.0f, 20.0f, 1.0f));   // Setpoint step: no kick
+
+  // Rising temperature brakes the output
+  TEST_ASSERT_FLOAT_WITHIN(1e-4f, -0.5f, pid.update(25.0f, 20.05f, 1.0f));
+}
+
+void test_derivative_filter_smooths_steps() {
+  PidController raw({0.0f, 0.0f, 10.0f}, -10.0f, 10.0f, 0.0f);
+  PidController filtered({0.0f, 0.0f, 10.0f}, -10.0f, 10.0f, 9.0f);
+  raw.update(20.0f, 20.0f, 1.0f);
+  filtered.update(20.0f, 20.0f, 1.0f);
+
+  // One DHT11 quantization step
+  float rawKick = raw.update(20.0f, 21.0f, 1.0f);
+  float filteredKick = filtered.update(20.0f, 21.0f, 1.0f);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, -10.0f, rawKick);
+  TEST_ASSERT_FLOAT_WITHIN(1e-5f, -1.0f, filteredKick);   // dt / (tau + dt) of the step
+}
+
+void test_reset_forgets_history() {
+  PidController pid({0.0f, 0.001f, 1.0f}, 0.0f, 1.0f, 0.0f);
+  pid.update(25.0f, 20.0f, 10.0f);
+  pid.update(25.0f, 10.0f, 10.0f);
+  pid.reset();
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, pid.integral());
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, pid.output());
+  // First update after reset has no derivative from the old measurement
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.1f, pid.update(25.0f, 15.0f, 10.0f));
+}
+
+void test_closed_loop_reaches_setpoint() {
+  const float ambient = 10.0f;
+  const float lossPerS = 1.0f / 600.0f;     // Time constant 10 min
+  const float heatPerS = 0.05f;             // °C/s at full output
+  const float dt = 2.0f;
+  const float setpoint = 22.0f;
+
+  PidController pid({0.2f, 0.0005f, 2.0f}, 0.0f, 1.0f, 10.0f);
+  float temperature = ambient;
+  float peak = temperature;
+  for (int step = 0; step < 4 * 3600 / 2; step++) {
+    float output = pid.update(setpoint, temperature, dt);
+    temperature += ((ambient - temperature) * lossPerS + heatPerS * output) * dt;
+    if (temperature > peak) {
+      peak = temperature;
+    }
+  }
+  TEST_ASSERT_FLOAT_WITHIN(0.1f, setpoint, temperature);   // No steady-state offset
+  TEST_ASSERT_TRUE(peak < setpoint + 1.5f);
+  // Steady state holds the heat loss: (22 - 10) / 600 / 0.05 = 0.4
+  TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.4f, pid.output());
+}
+
+/**
+ * Greenhouse on a cold night, for the controller comparison
+ * The air loses heat to a 10 °C ambient with a 30 min time constant; the
+ * heater can hold it 20 °C above ambient and reaches full output through a
+ * 1 min lag. The DHT11 sees the air through a 30 s lag plus 0.1 °C noise and
+ * reports whole degrees every 2 s, filtered as in the firmware.
+ */
+struct HeatingRun {
+  float overshoot;          // First swing above the target after warm-up (°C)
+  float switchesPerHour;
+  float meanError;          // Air minus target after the first 3 h (°C)
+};
+
+static HeatingRun runHeating(bool usePid, unsigned long controlPeriodMs) {
+  const float ambient = 10.0f;
+  const float lossS = 1800.0f;
+  const float heaterRise = 20.0f;
+  const float heaterLagS = 60.0f;
+  const float sensorLagS = 30.0f;
+  const float target = (DEFAULT_TEMP_MIN + DEFAULT_TEMP_MAX) / 2;
+  const unsigned long runMs = 12 * 3600000UL;
+  const unsigned long settledMs = 3 * 3600000UL;
+
+  PidController pid({ DEFAULT_HEATING_KP, DEFAULT_HEATING_KI, DEFAULT_HEATING_KD },
+                    0.0f, 1.0f, HEATING_DERIVATIVE_FILTER_S);
+  TimeProportionalOutput output(HEATING_PWM_WINDOW_MS, HEATING_MIN_ON_MS, HEATING_MIN_OFF_MS);
+  MedianFilter<DHT_FILTER_WINDOW> filter(DHT_TEMP_OUTLIER_BAND);
+
+  float air = 12.0f, heater = 0.0f, sensed = air;
+  float peak = air, errorSum = 0.0f;
+  long errorCount = 0;
+  bool on = false, reached = false, swingDone = false;
+  uint32_t switches = 0, seed = 1;
+
+  for (unsigned long ms = 0; ms < runMs; ms += 1000) {
+    heater += ((on ? 1.0f : 0.0f) - heater) / heaterLagS;
+    air += (ambient - air + heater * heaterRise) / lossS;
+    sensed += (air - sensed) / sensorLagS;
+
+    if (ms % DHT_MIN_SAMPLE_INTERVAL_MS == 0) {
+      seed = seed * 1664525u + 1013904223u;
+      float noise = ((seed >> 8) / 16777216.0f - 0.5f) * 0.2f;
+      filter.add(roundf(sensed + noise), ms);
+      float temperature = filter.value();
+
+      bool wanted = on;
+      if (usePid) {
+        wanted = output.update(pid.update(target, temperature, DHT_MIN_SAMPLE_INTERVAL_MS / 1000.0f), ms);
+      } else if (ms % controlPeriodMs == 0) {
+        if (temperature < DEFAULT_TEMP_MIN) {
+          wanted = true;
+        } else if (temperature >= target) {
+          wanted = false;
+        }
+      }
+      if (wanted != on) {
+        on = wanted;
+        switches++;
+      }
+    }
+
+    if (air >= target) {
+      reached = true;
+    } else if (reached) {
+      swingDone = true;
+    }
+    if (!swingDone && air > peak) {
+      peak = air;
+    }
+    if (ms >= settledMs) {
+      errorSum += air - target;
+      errorCount++;
+    }
+  }
+  return { peak - target, switches / 12.0f, errorSum / errorCount };
+}
+
+void test_default_heating_beats_on_off_rule() {
+  HeatingRun pid = runHeating(true, 0);
+  HeatingRun rule = runHeating(false, DHT_MIN_SAMPLE_INTERVAL_MS);   // Every read, as now
+  HeatingRun slowRule = runHeating(false, 60000);                   // The old 60 s loop
+
+  TEST_ASSERT_TRUE(pid.overshoot < rule.overshoot);
+  TEST_ASSERT_TRUE(pid.overshoot < slowRule.overshoot);
+  TEST_ASSERT_TRUE(pid.switchesPerHour < rule.switchesPerHour);
+  TEST_ASSERT_TRUE(pid.switchesPerHour < slowRule.switchesPerHour);
+
+  // Not by staying cold: the PID holds the target, the rule sits below it
+  TEST_ASSERT_FLOAT_WITHIN(0.2f, 0.0f, pid.meanError);
+  TEST_ASSERT_TRUE(rule.meanError < -0.3f);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_proportional_term);
+  RUN_TEST(test_integral_accumulates_in_output_units);
+  RUN_TEST(test_integral_does_not_wind_up);
+  RUN_TEST(test_integral_limited_to_output_range);
+  RUN_TEST(test_derivative_acts_on_measurement_only);
+  RUN_TEST(test_derivative_filter_smooths_steps);
+  RUN_TEST(test_reset_forgets_history);
+  RUN_TEST(test_closed_loop_reaches_setpoint);
+  RUN_TEST(test_default_heating_beats_on_off_rule);
+  return UNITY_END();
+}
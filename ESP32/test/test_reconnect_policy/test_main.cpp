@@ -0,0 +1,157 @@
+/**
+ * @file test_main.cpp
+ * @brief Reconnect backoff with jitter and the connection-quality model
+ *
+ * The clock and random source are the injected fakes below.
+ */
+
+#include <stdint.h>
+#include <unity.h>
+#include "mqtt/reconnect_policy.h"
+
+static unsigned long fakeNow;
+static uint32_t fakeRandom;
+
+static unsigned long fakeClock() { return fakeNow; }
+static uint32_t fakeRand() { return fakeRandom; }
+
+void setUp() {
+  fakeNow = 1000;
+  fakeRandom = 0xFFFFFFFF;
+}
+
+void tearDown() {}
+
+void test_first_attempt_is_immediate() {
+  ReconnectBackoff backoff(fakeClock, fakeRand, 1000, 60000, 30000);
+  TEST_ASSERT_TRUE(backoff.shouldAttempt());
+  TEST_ASSERT_EQUAL_UINT32(0, backoff.msUntilNextAttempt());
+}
+
+void test_window_doubles_up_to_cap() {
+  // A random value of window gives the longest delay: x % (window + 1) == window
+  ReconnectBackoff backoff(fakeClock, fakeRand, 1000, 16000, 30000);
+  unsigned long expected[] = {2000, 4000, 8000, 16000, 16000, 16000};
+  for (unsigned long window : expected) {
+    fakeRandom = (uint32_t)window;
+    backoff.onAttemptFailed();
+    TEST_ASSERT_EQUAL_UINT32(window, backoff.msUntilNextAttempt());
+    TEST_ASSERT_FALSE(backoff.shouldAttempt());
+    fakeNow += window;
+    TEST_ASSERT_TRUE(backoff.shouldAttempt());
+  }
+}
+
+void test_jitter_stays_inside_window() {
+  ReconnectBackoff backoff(fakeClock, fakeRand, 1000, 60000, 30000);
+  backoff.onAttemptFailed();   // Window 2000 ms
+  for (uint32_t r = 0; r < 10000; r += 7) {
+    fakeRandom = r * 2654435761u;
+    backoff.onAttemptFailed();
+    TEST_ASSERT_LESS_OR_EQUAL(60000, backoff.msUntilNextAttempt());
+  }
+  TEST_ASSERT_EQUAL_UINT8(31, backoff.failures());   // Saturates instead of overflowing
+
+  fakeRandom = 0;
+  backoff.onAttemptFailed();
+  TEST_ASSERT_TRUE(backoff.shouldAttempt());
+}
+
+void test_stable_connection_resets_failures() {
+  ReconnectBackoff backoff(fakeClock, fakeRand, 1000, 60000, 30000);
+  backoff.onAttemptFailed();
+  backoff.onAttemptFailed();
+  backoff.onConnected();
+  TEST_ASSERT_FALSE(backoff.shouldAttempt());
+  TEST_ASSERT_EQUAL_UINT32(0, backoff.msUntilNextAttempt());
+
+  fakeNow += 29999;
+  backoff.update();
+  TEST_ASSERT_EQUAL_UINT8(2, backoff.failures());
+  fakeNow += 1;
+  backoff.update();
+  TEST_ASSERT_EQUAL_UINT8(0, backoff.failures());
+
+  // First reconnect after a long session is jittered over the base window
+  fakeRandom = 1000;
+  backoff.onDisconnected();
+  TEST_ASSERT_EQUAL_UINT32(1000, backoff.msUntilNextAttempt());
+}
+
+void test_flapping_connection_keeps_escalating() {
+  ReconnectBackoff backoff(fakeClock, fakeRand, 1000, 60000, 30000);
+  for (uint8_t i = 1; i <= 4; i++) {
+    backoff.onConnected();
+    fakeNow += 5000;
+    backoff.onDisconnected();
+    TEST_ASSERT_EQUAL_UINT8(i, backoff.failures());
+  }
+  backoff.onDisconnected();   // Already disconnected - ignored
+  TEST_ASSERT_EQUAL_UINT8(4, backoff.failures());
+}
+
+void test_schedule_survives_clock_wrap() {
+  fakeNow = (unsigned long)-500;
+  ReconnectBackoff backoff(fakeClock, fakeRand, 1000, 60000, 30000);
+  fakeRandom = 2000;
+  backoff.onAttemptFailed();
+  TEST_ASSERT_FALSE(backoff.shouldAttempt());
+  fakeNow += 1999;   // Wrapped past zero
+  TEST_ASSERT_EQUAL_UINT32(1, backoff.msUntilNextAttempt());
+  fakeNow += 1;
+  TEST_ASSERT_TRUE(backoff.shouldAttempt());
+}
+
+void test_quality_counts_attempts_and_latency() {
+  fakeNow = 0;
+  ConnectionQuality quality(fakeClock);
+  fakeNow = 3000;
+  quality.onAttempt(false, 1500);
+  quality.onAttempt(false, 1500);
+  quality.onAttempt(true, 200);
+  fakeNow = 10000;
+  quality.onDisconnected();
+  fakeNow = 12000;
+  quality.onAttempt(true, 400);
+
+  ConnectionStats stats;
+  quality.snapshot(stats);
+  TEST_ASSERT_EQUAL_UINT32(4, stats.attempts);
+  TEST_ASSERT_EQUAL_UINT32(2, stats.successes);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.disconnects);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.5f, stats.successRate);
+  TEST_ASSERT_EQUAL_UINT32(300, stats.meanConnectMs);
+  TEST_ASSERT_EQUAL_UINT32(3000 + 2000, stats.offlineMs);   // Boot + outage
+  TEST_ASSERT_TRUE(stats.connected);
+}
+
+void test_quality_includes_current_outage() {
+  fakeNow = 0;
+  ConnectionQuality quality(fakeClock);
+  ConnectionStats stats;
+  quality.snapshot(stats);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.attempts);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, stats.successRate);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.meanConnectMs);
+
+  quality.onAttempt(true, 100);
+  fakeNow = 5000;
+  quality.onDisconnected();
+  fakeNow = 8000;
+  quality.snapshot(stats);
+  TEST_ASSERT_EQUAL_UINT32(3000, stats.offlineMs);
+  TEST_ASSERT_FALSE(stats.connected);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_first_attempt_is_immediate);
+  RUN_TEST(test_window_doubles_up_to_cap);
+  RUN_TEST(test_jitter_stays_inside_window);
+  RUN_TEST(test_stable_connection_resets_failures);
+  RUN_TEST(test_flapping_connection_keeps_escalating);
+  RUN_TEST(test_schedule_survives_clock_wrap);
+  RUN_TEST(test_quality_counts_attempts_and_latency);
+  RUN_TEST(test_quality_includes_current_outage);
+  return UNITY_END();
+}
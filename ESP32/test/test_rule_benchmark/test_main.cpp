@@ -0,0 +1,203 @@
+/**
+ * @file test_main.cpp
+ * @brief Rule table evaluation time vs the hand-written control functions
+ *
+ * The table holds the built-in rules (fan on humidity and temperature, LED,
+ * on/off heating, pump inhibit on an empty tank). Both sides run the same
+ * slowly drifting readings, the way they are called once per control cycle
+ * in rules.cpp, without the actuator switching itself. The timings are
+ * printed as test messages (pio test -e native -v); the assertions only
+ * check that both sides did the work and that a tick stays far below the
+ * 2 s control cycle.
+ */
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+#include "config.h"
+#include "control/rule_engine.h"
+
+static const int READINGS = 4096;
+static const int TICKS = 1000000;
+
+struct Reading {
+  float temperature;
+  float humidity;
+  float light;
+  bool tankLevel;
+};
+
+static Reading readings[READINGS];
+
+static const float tempMin = DEFAULT_TEMP_MIN;
+static const float tempMax = DEFAULT_TEMP_MAX;
+static const float humAirMax = 80.0f;
+static const float lightIntensity = 10000.0f;
+
+// Rule table under construction (as in test_rule_engine)
+struct TableBuilder {
+  uint8_t bytes[RULES_HEADER_SIZE + RULES_MAX_COUNT * RULES_RECORD_SIZE + RULES_CRC_SIZE];
+  size_t length;
+
+  explicit TableBuilder(uint32_t version) : length(RULES_HEADER_SIZE) {
+    memset(bytes, 0, sizeof(bytes));
+    bytes[0] = RULES_MAGIC_0;
+    bytes[1] = RULES_MAGIC_1;
+    bytes[2] = RULES_FORMAT_VERSION;
+    putU32(4, version);
+  }
+
+  void rule(RuleInput input, RuleComparator comparator, RuleReference reference, uint8_t target,
+            int32_t threshold, uint16_t hysteresis) {
+    uint8_t* record = bytes + length;
+    record[0] = input;
+    record[1] = comparator;
+    record[2] = reference;
+    record[3] = target;
+    putU32(length + 4, (uint32_t)threshold);
+    record[8] = (uint8_t)hysteresis;
+    record[9] = (uint8_t)(hysteresis >> 8);
+    length += RULES_RECORD_SIZE;
+    bytes[3]++;
+  }
+
+  size_t finish() {
+    putU32(length, crc32(bytes, length));
+    return length + RULES_CRC_SIZE;
+  }
+
+  void putU32(size_t offset, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+      bytes[offset + i] = (uint8_t)(value >> (8 * i));
+    }
+  }
+};
+
+// State of the hand-written rules (the actuator registry in the firmware)
+struct HandWritten {
+  bool fanOn = false;
+  bool ledOn = false;
+  bool heatingOn = false;
+
+  // controlFan, controlLED, the on/off controlHeating and the pump tank check
+  uint8_t tick(const Reading& r) {
+    bool fan = false;
+    if (r.humidity != SENSOR_ERROR_HUM &&
+        hysteresisAbove(r.humidity, humAirMax, FAN_HUMIDITY_HYSTERESIS, fanOn)) {
+      fan = true;
+    }
+    if (r.temperature != SENSOR_ERROR_TEMP &&
+        hysteresisAbove(r.temperature, tempMax, FAN_TEMP_HYSTERESIS, fanOn)) {
+      fan = true;
+    }
+    fanOn = fan;
+
+    if (r.light >= 0) {
+      ledOn = hysteresisBelow(r.light, lightIntensity, LED_LIGHT_HYSTERESIS, ledOn);
+    }
+
+    if (r.temperature != SENSOR_ERROR_TEMP) {
+      if (r.temperature < tempMin) {
+        heatingOn = true;
+      } else if (r.temperature >= (tempMax + tempMin) / 2) {
+        heatingOn = false;
+      }
+    }
+
+    return (fanOn ? RULE_ACTUATOR_BIT(RULE_ACTUATOR_FAN) : 0) |
+           (ledOn ? RULE_ACTUATOR_BIT(RULE_ACTUATOR_LED) : 0) |
+           (heatingOn ? RULE_ACTUATOR_BIT(RULE_ACTUATOR_HEATING) : 0) |
+           (r.tankLevel ? RULE_ACTUATOR_BIT(RULE_ACTUATOR_PUMP) : 0);
+  }
+};
+
+// evaluateRuleTable in rules.cpp: gather inputs and setpoints, then evaluate
+static uint8_t tableTick(RuleEngine& engine, const Reading& r, unsigned long nowMs) {
+  float inputs[RULE_INPUT_COUNT];
+  inputs[RULE_INPUT_TEMPERATURE] = r.temperature;
+  inputs[RULE_INPUT_HUMIDITY] = r.humidity;
+  inputs[RULE_INPUT_LIGHT] = r.light;
+  inputs[RULE_INPUT_TANK_LEVEL] = r.tankLevel ? 1.0f : 0.0f;
+
+  uint8_t valid = 1u << RULE_INPUT_TANK_LEVEL;
+  if (r.temperature != SENSOR_ERROR_TEMP) valid |= 1u << RULE_INPUT_TEMPERATURE;
+  if (r.humidity != SENSOR_ERROR_HUM) valid |= 1u << RULE_INPUT_HUMIDITY;
+  if (r.light >= 0) valid |= 1u << RULE_INPUT_LIGHT;
+
+  float references[RULE_REF_COUNT];
+  references[RULE_REF_CONSTANT] = 0.0f;
+  references[RULE_REF_TEMP_MIN] = tempMin;
+  references[RULE_REF_TEMP_MAX] = tempMax;
+  references[RULE_REF_HUM_AIR_MAX] = humAirMax;
+  references[RULE_REF_LIGHT_INTENSITY] = lightIntensity;
+
+  return engine.evaluate(inputs, valid, references, nowMs);
+}
+
+static double nsPerTick(std::chrono::steady_clock::time_point start) {
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() / TICKS;
+}
+
+void setUp() {
+  // Random walk around the thresholds, so rules switch now and then
+  uint32_t seed = 12345;
+  Reading r = { 20.5f, 78.0f, 10000.0f, true };
+  for (int i = 0; i < READINGS; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    r.temperature += ((seed >> 8) % 21 - 10) * 0.02f;
+    r.humidity += ((seed >> 13) % 21 - 10) * 0.1f;
+    r.light += ((seed >> 18) % 21 - 10) * 20.0f;
+    r.tankLevel = (seed >> 28) != 0;
+    readings[i] = r;
+  }
+}
+
+void tearDown() {}
+
+void test_rule_table_vs_hand_written() {
+  TableBuilder table(1);
+  table.rule(RULE_INPUT_HUMIDITY, RULE_ABOVE, RULE_REF_HUM_AIR_MAX, RULE_ACTUATOR_FAN,
+             0, (uint16_t)(FAN_HUMIDITY_HYSTERESIS * 100));
+  table.rule(RULE_INPUT_TEMPERATURE, RULE_ABOVE, RULE_REF_TEMP_MAX, RULE_ACTUATOR_FAN,
+             0, (uint16_t)(FAN_TEMP_HYSTERESIS * 100));
+  table.rule(RULE_INPUT_LIGHT, RULE_BELOW, RULE_REF_LIGHT_INTENSITY, RULE_ACTUATOR_LED,
+             0, (uint16_t)(LED_LIGHT_HYSTERESIS * 100));
+  table.rule(RULE_INPUT_TEMPERATURE, RULE_BELOW, RULE_REF_TEMP_MIN, RULE_ACTUATOR_HEATING,
+             0, (uint16_t)((tempMax - tempMin) / 2 * 100));
+  table.rule(RULE_INPUT_TANK_LEVEL, RULE_BELOW, RULE_REF_CONSTANT,
+             RULE_ACTUATOR_PUMP | RULE_TARGET_INHIBIT, 50, 0);
+  RuleEngine engine;
+  TEST_ASSERT_EQUAL(RULES_LOADED, engine.load(table.bytes, table.finish()));
+
+  HandWritten hand;
+  uint32_t tableOn = 0, handOn = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < TICKS; i++) {
+    tableOn += tableTick(engine, readings[i % READINGS], (unsigned long)i * 2000UL);
+  }
+  double tableNs = nsPerTick(start);
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < TICKS; i++) {
+    handOn += hand.tick(readings[i % READINGS]);
+  }
+  double handNs = nsPerTick(start);
+
+  char message[120];
+  snprintf(message, sizeof(message), "%u rules: table %.1f ns/tick, hand-written %.1f ns/tick",
+           (unsigned)engine.ruleCount(), tableNs, handNs);
+  TEST_MESSAGE(message);
+
+  TEST_ASSERT_TRUE(tableOn > 0);      // Rules switched, so the work was not optimized away
+  TEST_ASSERT_TRUE(handOn > 0);
+  TEST_ASSERT_TRUE(tableNs < 100000.0);   // Under 0.01% of a 2 s control cycle
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_rule_table_vs_hand_written);
+  return UNITY_END();
+}
@@ -0,0 +1,239 @@
+/**
+ * @file test_main.cpp
+ * @brief Rule table validation and evaluation
+ *
+ * SERVER_TABLE is the output of api/services/ruleCompiler.js for the
+ * example rule set in its header comment, so a format change on either
+ * side shows up here.
+ */
+
+#include <string.h>
+#include <unity.h>
+#include "control/rule_engine.h"
+
+// { version: 3, rules: [
+//   { actuator: "fan", input: "humidity", op: ">", ref: "hum_air_max", hysteresis: 5, min_dwell_s: 60 },
+//   { actuator: "pump", input: "tank_level", op: "<", value: 0.5, inhibit: true } ] }
+static const uint8_t SERVER_TABLE[] = {
+  0x47, 0x52, 0x01, 0x02, 0x03, 0x00, 0x00, 0x00,
+  0x01, 0x01, 0x03, 0x03, 0x00, 0x00, 0x00, 0x00, 0xf4, 0x01, 0x3c, 0x00,
+  0x03, 0x00, 0x00, 0x80, 0x32, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x7f, 0xf4, 0x83, 0x31
+};
+
+// Rule table under construction
+struct TableBuilder {
+  uint8_t bytes[RULES_HEADER_SIZE + RULES_MAX_COUNT * RULES_RECORD_SIZE + RULES_CRC_SIZE];
+  size_t length;
+
+  explicit TableBuilder(uint32_t version) : length(RULES_HEADER_SIZE) {
+    memset(bytes, 0, sizeof(bytes));
+    bytes[0] = RULES_MAGIC_0;
+    bytes[1] = RULES_MAGIC_1;
+    bytes[2] = RULES_FORMAT_VERSION;
+    putU32(4, version);
+  }
+
+  void rule(RuleInput input, RuleComparator comparator, RuleReference reference, uint8_t target,
+            int32_t threshold, uint16_t hysteresis, uint16_t dwellS) {
+    uint8_t* record = bytes + length;
+    record[0] = input;
+    record[1] = comparator;
+    record[2] = reference;
+    record[3] = target;
+    putU32(length + 4, (uint32_t)threshold);
+    record[8] = (uint8_t)hysteresis;
+    record[9] = (uint8_t)(hysteresis >> 8);
+    record[10] = (uint8_t)dwellS;
+    record[11] = (uint8_t)(dwellS >> 8);
+    length += RULES_RECORD_SIZE;
+    bytes[3]++;
+  }
+
+  // Append the CRC; returns the finished table length
+  size_t finish() {
+    putU32(length, crc32(bytes, length));
+    return length + RULES_CRC_SIZE;
+  }
+
+  void putU32(size_t offset, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+      bytes[offset + i] = (uint8_t)(value >> (8 * i));
+    }
+  }
+};
+
+static float inputs[RULE_INPUT_COUNT];
+static float references[RULE_REF_COUNT];
+static const uint8_t ALL_INPUTS = (1u << RULE_INPUT_COUNT) - 1;
+
+void setUp() {
+  inputs[RULE_INPUT_TEMPERATURE] = 20.0f;
+  inputs[RULE_INPUT_HUMIDITY] = 60.0f;
+  inputs[RULE_INPUT_LIGHT] = 5000.0f;
+  inputs[RULE_INPUT_TANK_LEVEL] = 1.0f;
+  references[RULE_REF_CONSTANT] = 0.0f;
+  references[RULE_REF_TEMP_MIN] = 18.0f;
+  references[RULE_REF_TEMP_MAX] = 28.0f;
+  references[RULE_REF_HUM_AIR_MAX] = 80.0f;
+  references[RULE_REF_LIGHT_INTENSITY] = 10000.0f;
+}
+
+void tearDown() {}
+
+void test_server_compiled_table_loads() {
+  RuleEngine engine;
+  TEST_ASSERT_EQUAL_INT(RULES_LOADED, engine.load(SERVER_TABLE, sizeof(SERVER_TABLE)));
+  TEST_ASSERT_EQUAL_UINT32(3, engine.version());
+  TEST_ASSERT_EQUAL_UINT32(2, engine.ruleCount());
+  TEST_ASSERT_EQUAL_HEX8(RULE_ACTUATOR_BIT(RULE_ACTUATOR_FAN) | RULE_ACTUATOR_BIT(RULE_ACTUATOR_PUMP),
+                         engine.actuators());
+
+  // Retained message delivered again
+  TEST_ASSERT_EQUAL_INT(RULES_UNCHANGED, engine.load(SERVER_TABLE, sizeof(SERVER_TABLE)));
+}
+
+void test_threshold_with_hysteresis_and_dwell() {
+  RuleEngine engine;
+  engine.load(SERVER_TABLE, sizeof(SERVER_TABLE));
+  uint8_t fan = RULE_ACTUATOR_BIT(RULE_ACTUATOR_FAN);
+
+  TEST_ASSERT_EQUAL_HEX8(0, engine.evaluate(inputs, ALL_INPUTS, references, 0));
+
+  // Above hum_air_max, but the 60 s dwell since the first evaluation holds it off
+  inputs[RULE_INPUT_HUMIDITY] = 85.0f;
+  TEST_ASSERT_EQUAL_HEX8(0, engine.evaluate(inputs, ALL_INPUTS, references, 30000));
+  TEST_ASSERT_EQUAL_HEX8(fan, engine.evaluate(inputs, ALL_INPUTS, references, 60000));
+
+  // Inside the hysteresis band (75..80) it stays on
+  inputs[RULE_INPUT_HUMIDITY] = 76.0f;
+  TEST_ASSERT_EQUAL_HEX8(fan, engine.evaluate(inputs, ALL_INPUTS, references, 90000));
+
+  // Released at 75, again only once it has been on for 60 s
+  inputs[RULE_INPUT_HUMIDITY] = 75.0f;
+  TEST_ASSERT_EQUAL_HEX8(fan, engine.evaluate(inputs, ALL_INPUTS, references, 110000));
+  TEST_ASSERT_EQUAL_HEX8(0, engine.evaluate(inputs, ALL_INPUTS, references, 120000));
+}
+
+void test_setpoint_reference_moves_threshold() {
+  RuleEngine engine;
+  engine.load(SERVER_TABLE, sizeof(SERVER_TABLE));
+  engine.evaluate(inputs, ALL_INPUTS, references, 0);
+  references[RULE_REF_HUM_AIR_MAX] = 50.0f;
+  TEST_ASSERT_EQUAL_HEX8(RULE_ACTUATOR_BIT(RULE_ACTUATOR_FAN),
+                         engine.evaluate(inputs, ALL_INPUTS, references, 60000));
+}
+
+void test_inhibit_rule_forces_actuator_off() {
+  TableBuilder table(1);
+  table.rule(RULE_INPUT_TEMPERATURE, RULE_BELOW, RULE_REF_CONSTANT, RULE_ACTUATOR_PUMP, 10000, 0, 0);
+  table.rule(RULE_INPUT_TANK_LEVEL, RULE_BELOW, RULE_REF_CONSTANT,
+             RULE_ACTUATOR_PUMP | RULE_TARGET_INHIBIT, 50, 0, 0);
+  RuleEngine engine;
+  TEST_ASSERT_EQUAL_INT(RULES_LOADED, engine.load(table.bytes, table.finish()));
+
+  uint8_t pump = RULE_ACTUATOR_BIT(RULE_ACTUATOR_PUMP);
+  TEST_ASSERT_EQUAL_HEX8(pump, engine.evaluate(inputs, ALL_INPUTS, references, 0));
+  inputs[RULE_INPUT_TANK_LEVEL] = 0.0f;
+  TEST_ASSERT_EQUAL_HEX8(0, engine.evaluate(inputs, ALL_INPUTS, references, 1000));
+  TEST_ASSERT_EQUAL_HEX8(pump, engine.inhibited());
+  TEST_ASSERT_TRUE(engine.isRuleActive(0));
+}
+
+void test_invalid_input_keeps_rule_state() {
+  TableBuilder table(1);
+  table.rule(RULE_INPUT_TEMPERATURE, RULE_BELOW, RULE_REF_TEMP_MIN, RULE_ACTUATOR_HEATING, -50, 100, 0);
+  RuleEngine engine;
+  engine.load(table.bytes, table.finish());
+
+  uint8_t heating = RULE_ACTUATOR_BIT(RULE_ACTUATOR_HEATING);
+  inputs[RULE_INPUT_TEMPERATURE] = 17.0f;   // Below 18 - 0.5
+  TEST_ASSERT_EQUAL_HEX8(heating, engine.evaluate(inputs, ALL_INPUTS, references, 0));
+
+  // Sensor error: the rule neither releases nor re-evaluates
+  inputs[RULE_INPUT_TEMPERATURE] = SENSOR_ERROR_TEMP;
+  uint8_t valid = ALL_INPUTS & (uint8_t)~(1u << RULE_INPUT_TEMPERATURE);
+  TEST_ASSERT_EQUAL_HEX8(heating, engine.evaluate(inputs, valid, references, 1000));
+}
+
+void test_negative_fixed_point_threshold() {
+  TableBuilder table(1);
+  table.rule(RULE_INPUT_TEMPERATURE, RULE_BELOW, RULE_REF_CONSTANT, RULE_ACTUATOR_HEATING, -250, 0, 0);
+  RuleEngine engine;
+  engine.load(table.bytes, table.finish());
+  inputs[RULE_INPUT_TEMPERATURE] = -2.0f;
+  TEST_ASSERT_EQUAL_HEX8(0, engine.evaluate(inputs, ALL_INPUTS, references, 0));
+  inputs[RULE_INPUT_TEMPERATURE] = -3.0f;
+  TEST_ASSERT_EQUAL_HEX8(RULE_ACTUATOR_BIT(RULE_ACTUATOR_HEATING),
+                         engine.evaluate(inputs, ALL_INPUTS, references, 1000));
+}
+
+void test_malformed_tables_are_rejected() {
+  RuleEngine engine;
+  uint8_t copy[sizeof(SERVER_TABLE)];
+
+  TEST_ASSERT_EQUAL_INT(RULES_BAD_LENGTH, engine.load(SERVER_TABLE, 11));
+  TEST_ASSERT_EQUAL_INT(RULES_BAD_LENGTH, engine.load(SERVER_TABLE, sizeof(SERVER_TABLE) - 1));
+
+  memcpy(copy, SERVER_TABLE, sizeof(copy));
+  copy[1] = 'X';
+  TEST_ASSERT_EQUAL_INT(RULES_BAD_MAGIC, engine.load(copy, sizeof(copy)));
+
+  memcpy(copy, SERVER_TABLE, sizeof(copy));
+  copy[2] = 2;
+  TEST_ASSERT_EQUAL_INT(RULES_BAD_FORMAT, engine.load(copy, sizeof(copy)));
+
+  memcpy(copy, SERVER_TABLE, sizeof(copy));
+  copy[3] = RULES_MAX_COUNT + 1;
+  TEST_ASSERT_EQUAL_INT(RULES_TOO_MANY, engine.load(copy, sizeof(copy)));
+
+  memcpy(copy, SERVER_TABLE, sizeof(copy));
+  copy[16] ^= 0x01;   // Hysteresis bit
+  TEST_ASSERT_EQUAL_INT(RULES_BAD_CRC, engine.load(copy, sizeof(copy)));
+
+  TableBuilder table(1);
+  table.rule(RULE_INPUT_TEMPERATURE, RULE_BELOW, RULE_REF_CONSTANT, RULE_ACTUATOR_COUNT, 0, 0, 0);
+  TEST_ASSERT_EQUAL_INT(RULES_BAD_RULE, engine.load(table.bytes, table.finish()));
+
+  TEST_ASSERT_EQUAL_UINT32(0, engine.version());   // Nothing replaced the empty table
+}
+
+void test_stale_version_keeps_current_table() {
+  RuleEngine engine;
+  engine.load(SERVER_TABLE, sizeof(SERVER_TABLE));
+
+  TableBuilder older(2);
+  older.rule(RULE_INPUT_LIGHT, RULE_BELOW, RULE_REF_LIGHT_INTENSITY, RULE_ACTUATOR_LED, 0, 0, 0);
+  TEST_ASSERT_EQUAL_INT(RULES_STALE_VERSION, engine.load(older.bytes, older.finish()));
+  TEST_ASSERT_EQUAL_UINT32(3, engine.version());
+  TEST_ASSERT_EQUAL_UINT32(2, engine.ruleCount());
+
+  TableBuilder newer(4);
+  newer.rule(RULE_INPUT_LIGHT, RULE_BELOW, RULE_REF_LIGHT_INTENSITY, RULE_ACTUATOR_LED, 0, 0, 0);
+  TEST_ASSERT_EQUAL_INT(RULES_LOADED, engine.load(newer.bytes, newer.finish()));
+  TEST_ASSERT_EQUAL_HEX8(RULE_ACTUATOR_BIT(RULE_ACTUATOR_LED), engine.actuators());
+}
+
+void test_full_table() {
+  TableBuilder table(1);
+  for (int i = 0; i < RULES_MAX_COUNT; i++) {
+    table.rule(RULE_INPUT_LIGHT, RULE_BELOW, RULE_REF_CONSTANT, RULE_ACTUATOR_LED, 100 * i, 0, 0);
+  }
+  RuleEngine engine;
+  TEST_ASSERT_EQUAL_INT(RULES_LOADED, engine.load(table.bytes, table.finish()));
+  TEST_ASSERT_EQUAL_UINT32(RULES_MAX_COUNT, engine.ruleCount());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_server_compiled_table_loads);
+  RUN_TEST(test_threshold_with_hysteresis_and_dwell);
+  RUN_TEST(test_setpoint_reference_moves_threshold);
+  RUN_TEST(test_inhibit_rule_forces_actuator_off);
+  RUN_TEST(test_invalid_input_keeps_rule_state);
+  RUN_TEST(test_negative_fixed_point_threshold);
+  RUN_TEST(test_malformed_tables_are_rejected);
+  RUN_TEST(test_stale_version_keeps_current_table);
+  RUN_TEST(test_full_table);
+  return UNITY_END();
+}
@@ -0,0 +1,139 @@
+/**
+ * @file test_main.cpp
+ * @brief Bounded setpoint message parser
+ */
+
+#include <string.h>
+#include <unity.h>
+#include "constants.h"
+#include "mqtt/setpoint_parser.h"
+
+static SetpointParseResult parse(const char* json, SetpointCommand& command) {
+  return parseSetpointCommand(json, strlen(json), command);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_full_message() {
+  SetpointCommand command;
+  TEST_ASSERT_EQUAL_INT(SETPOINT_PARSE_OK, parse(
+    "{\"target_temp_min\": 18.5, \"target_temp_max\": 26,\n"
+    " \"target_hum_air_max\": 80, \"target_light_intensity\": 12000,\n"
+    " \"irrigation_interval_minutes\": 240, \"irrigation_duration_seconds\": 45,\n"
+    " \"telemetry_encoding\": \"binary\", \"heating_kp\": 0.5,\n"
+    " \"heating_ki\": 1e-3, \"heating_kd\": 0}", command));
+  TEST_ASSERT_EQUAL_HEX16((1u << SETPOINT_FIELD_COUNT) - 1, command.present);
+  TEST_ASSERT_EQUAL_HEX16(0, command.rejected);
+  TEST_ASSERT_EQUAL_FLOAT(18.5f, command.tempMin);
+  TEST_ASSERT_EQUAL_FLOAT(26.0f, command.tempMax);
+  TEST_ASSERT_EQUAL_FLOAT(80.0f, command.humAirMax);
+  TEST_ASSERT_EQUAL_FLOAT(12000.0f, command.lightIntensity);
+  TEST_ASSERT_EQUAL_UINT32(240, command.irrigationIntervalMinutes);
+  TEST_ASSERT_EQUAL_UINT32(45, command.irrigationDurationSeconds);
+  TEST_ASSERT_EQUAL_INT(TELEMETRY_ENCODING_BINARY, command.telemetryEncoding);
+  TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.001f, command.heatingKi);
+}
+
+void test_unknown_members_are_skipped() {
+  SetpointCommand command;
+  TEST_ASSERT_EQUAL_INT(SETPOINT_PARSE_OK, parse(
+    "{\"changed_at\":\"2024-05-01T10:00:00Z\",\"meta\":{\"by\":[1,{\"x\":null},true]},"
+    "\"note\":\"quote \\\" and \\u00e9\",\"target_temp_max\":30}", command));
+  TEST_ASSERT_EQUAL_HEX16(SETPOINT_FIELD_BIT(SETPOINT_TEMP_MAX), command.present);
+  TEST_ASSERT_EQUAL_FLOAT(30.0f, command.tempMax);
+}
+
+void test_out_of_range_and_wrong_type_are_rejected_per_field() {
+  SetpointCommand command;
+  TEST_ASSERT_EQUAL_INT(SETPOINT_PARSE_OK, parse(
+    "{\"target_temp_min\":-5,\"target_temp_max\":\"25\",\"target_hum_air_max\":70,"
+    "\"irrigation_interval_minutes\":1.5,\"irrigation_duration_seconds\":3601,"
+    "\"telemetry_encoding\":\"xml\",\"heating_kp\":-1}", command));
+  TEST_ASSERT_EQUAL_HEX16(SETPOINT_FIELD_BIT(SETPOINT_HUM_AIR_MAX), command.present);
+  TEST_ASSERT_EQUAL_HEX16(SETPOINT_FIELD_BIT(SETPOINT_TEMP_MIN) | SETPOINT_FIELD_BIT(SETPOINT_TEMP_MAX) |
+                          SETPOINT_FIELD_BIT(SETPOINT_IRRIGATION_INTERVAL) |
+                          SETPOINT_FIELD_BIT(SETPOINT_IRRIGATION_DURATION) |
+                          SETPOINT_FIELD_BIT(SETPOINT_TELEMETRY_ENCODING) |
+                          SETPOINT_FIELD_BIT(SETPOINT_HEATING_KP), command.rejected);
+}
+
+void test_range_limits_are_inclusive() {
+  SetpointCommand command;
+  TEST_ASSERT_EQUAL_INT(SETPOINT_PARSE_OK, parse(
+    "{\"target_temp_min\":0,\"target_temp_max\":60,"
+    "\"irrigation_interval_minutes\":10080,\"irrigation_duration_seconds\":1}", command));
+  TEST_ASSERT_EQUAL_HEX16(0, command.rejected);
+  TEST_ASSERT_EQUAL_UINT32(SETPOINT_IRRIGATION_INTERVAL_LIMIT_MAX, command.irrigationIntervalMinutes);
+}
+
+void test_later_duplicate_wins() {
+  SetpointCommand command;
+  parse("{\"target_temp_max\":25,\"target_temp_max\":99}", command);
+  TEST_ASSERT_EQUAL_HEX16(0, command.present);
+  TEST_ASSERT_EQUAL_HEX16(SETPOINT_FIELD_BIT(SETPOINT_TEMP_MAX), command.rejected);
+
+  parse("{\"target_temp_max\":99,\"target_temp_max\":25}", command);
+  TEST_ASSERT_EQUAL_HEX16(SETPOINT_FIELD_BIT(SETPOINT_TEMP_MAX), command.present);
+  TEST_ASSERT_EQUAL_HEX16(0, command.rejected);
+  TEST_ASSERT_EQUAL_FLOAT(25.0f, command.tempMax);
+}
+
+void test_malformed_messages_report_nothing() {
+  const char* malformed[] = {
+    "",
+    "[1,2]",
+    "{\"target_temp_max\":25",
+    "{\"target_temp_max\":25,}",
+    "{\"target_temp_max\" 25}",
+    "{\"target_temp_max\":025}",
+    "{\"target_temp_max\":25.}",
+    "{\"target_temp_max\":tru}",
+    "{\"note\":\"bad \\x escape\",\"target_temp_max\":25}",
+    "{\"target_temp_max\":25} trailing",
+    "{\"a\":[[[[[[[[[1]]]]]]]]],\"target_temp_max\":25}",   // Nested too deep
+  };
+  for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++) {
+    SetpointCommand command;
+    TEST_ASSERT_EQUAL_INT_MESSAGE(SETPOINT_PARSE_MALFORMED, parse(malformed[i], command), malformed[i]);
+    TEST_ASSERT_EQUAL_HEX16(0, command.present);
+    TEST_ASSERT_EQUAL_HEX16(0, command.rejected);
+  }
+}
+
+void test_payload_need_not_be_terminated() {
+  const char payload[] = "{\"target_temp_max\":25}99";
+  SetpointCommand command;
+  TEST_ASSERT_EQUAL_INT(SETPOINT_PARSE_OK, parseSetpointCommand(payload, 22, command));
+  TEST_ASSERT_EQUAL_FLOAT(25.0f, command.tempMax);
+}
+
+void test_oversized_payload() {
+  static char payload[MQTT_INBOUND_PAYLOAD_SIZE + 2];
+  memset(payload, ' ', sizeof(payload));
+  payload[0] = '{';
+  payload[MQTT_INBOUND_PAYLOAD_SIZE - 1] = '}';
+  SetpointCommand command;
+  TEST_ASSERT_EQUAL_INT(SETPOINT_PARSE_OK, parseSetpointCommand(payload, MQTT_INBOUND_PAYLOAD_SIZE, command));
+  TEST_ASSERT_EQUAL_INT(SETPOINT_PARSE_TOO_LARGE,
+                        parseSetpointCommand(payload, MQTT_INBOUND_PAYLOAD_SIZE + 1, command));
+}
+
+void test_field_names() {
+  TEST_ASSERT_EQUAL_STRING("irrigation_duration_seconds", getSetpointFieldName(SETPOINT_IRRIGATION_DURATION));
+  TEST_ASSERT_EQUAL_STRING("unknown", getSetpointFieldName(SETPOINT_FIELD_COUNT));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_full_message);
+  RUN_TEST(test_unknown_members_are_skipped);
+  RUN_TEST(test_out_of_range_and_wrong_type_are_rejected_per_field);
+  RUN_TEST(test_range_limits_are_inclusive);
+  RUN_TEST(test_later_duplicate_wins);
+  RUN_TEST(test_malformed_messages_report_nothing);
+  RUN_TEST(test_payload_need_not_be_terminated);
+  RUN_TEST(test_oversized_payload);
+  RUN_TEST(test_field_names);
+  return UNITY_END();
+}
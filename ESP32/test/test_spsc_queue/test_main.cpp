@@ -0,0 +1,124 @@
+/**
+ * @file test_main.cpp
+ * @brief Lock-free SPSC queue between the control loop and the network task
+ *
+ * The last test runs a producer and a consumer on two std::threads, as the
+ * two cores do on the ESP32.
+ */
+
+#include <stdint.h>
+#include <thread>
+#include <unity.h>
+#include "mqtt/spsc_queue.h"
+
+struct Message {
+  uint32_t sequence;
+  uint32_t check;
+};
+
+void setUp() {}
+void tearDown() {}
+
+void test_fifo_order_and_capacity() {
+  SpscQueue<int, 4> queue;
+  TEST_ASSERT_TRUE(queue.empty());
+  for (int i = 0; i < 4; i++) {
+    TEST_ASSERT_TRUE(queue.push(i));
+  }
+  TEST_ASSERT_TRUE(queue.full());
+  TEST_ASSERT_FALSE(queue.push(99));
+  TEST_ASSERT_EQUAL_UINT32(4, queue.size());
+
+  int value;
+  for (int i = 0; i < 4; i++) {
+    TEST_ASSERT_TRUE(queue.pop(value));
+    TEST_ASSERT_EQUAL_INT(i, value);
+  }
+  TEST_ASSERT_FALSE(queue.pop(value));
+}
+
+void test_in_place_push_and_front() {
+  SpscQueue<Message, 2> queue;
+  Message* slot = queue.beginPush();
+  TEST_ASSERT_NOT_NULL(slot);
+  slot->sequence = 7;
+  TEST_ASSERT_NULL(queue.front());   // Not visible before commit
+  queue.commitPush();
+
+  Message* item = queue.front();
+  TEST_ASSERT_NOT_NULL(item);
+  TEST_ASSERT_EQUAL_UINT32(7, item->sequence);
+  queue.pop();
+  TEST_ASSERT_TRUE(queue.empty());
+}
+
+void test_peek_past_front() {
+  SpscQueue<int, 8> queue;
+  for (int i = 0; i < 5; i++) {
+    queue.push(i * 10);
+  }
+  TEST_ASSERT_EQUAL_INT(0, *queue.peek(0));
+  TEST_ASSERT_EQUAL_INT(40, *queue.peek(4));
+  TEST_ASSERT_NULL(queue.peek(5));
+  queue.pop();
+  TEST_ASSERT_EQUAL_INT(10, *queue.peek(0));
+}
+
+void test_wraps_around_storage() {
+  SpscQueue<int, 4> queue;
+  int value;
+  for (int i = 0; i < 1000; i++) {
+    TEST_ASSERT_TRUE(queue.push(i));
+    TEST_ASSERT_TRUE(queue.push(i + 1));
+    TEST_ASSERT_TRUE(queue.pop(value));
+    TEST_ASSERT_EQUAL_INT(i, value);
+    TEST_ASSERT_TRUE(queue.pop(value));
+    TEST_ASSERT_EQUAL_INT(i + 1, value);
+  }
+}
+
+void test_two_threads_deliver_every_message_in_order() {
+  static SpscQueue<Message, 16> queue;
+  const uint32_t count = 200000;
+
+  std::thread producer([&]() {
+    for (uint32_t i = 0; i < count; i++) {
+      Message* slot;
+      while ((slot = queue.beginPush()) == nullptr) {
+        std::this_thread::yield();
+      }
+      slot->sequence = i;
+      slot->check = i * 2654435761u;
+      queue.commitPush();
+    }
+  });
+
+  uint32_t expected = 0;
+  bool intact = true;
+  while (expected < count) {
+    Message* item = queue.front();
+    if (item == nullptr) {
+      std::this_thread::yield();
+      continue;
+    }
+    if (item->sequence != expected || item->check != expected * 2654435761u) {
+      intact = false;
+    }
+    queue.pop();
+    expected++;
+  }
+  producer.join();
+
+  TEST_ASSERT_TRUE(intact);
+  TEST_ASSERT_TRUE(queue.empty());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_fifo_order_and_capacity);
+  RUN_TEST(test_in_place_push_and_front);
+  RUN_TEST(test_peek_past_front);
+  RUN_TEST(test_wraps_around_storage);
+  RUN_TEST(test_two_threads_deliver_every_message_in_order);
+  return UNITY_END();
+}
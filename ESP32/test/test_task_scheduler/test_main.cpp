@@ -0,0 +1,198 @@
+/**
+ * @file test_main.cpp
+ * @brief Cooperative deadline scheduler for loop()
+ *
+ * Runs on a simulated millisecond clock; callbacks append to a trace and
+ * may advance the clock to model their run time.
+ */
+
+#include <string.h>
+#include <unity.h>
+#include "scheduler/task_scheduler.h"
+
+static unsigned long simulatedMs;
+static char trace[128];
+static size_t traceLength;
+static unsigned long lastIdleMs;
+static const char* lastOverrun;
+static unsigned long lastOverrunMs;
+
+static TaskScheduler<8>* scheduler;
+static int selfId;
+
+static unsigned long simulatedClock() { return simulatedMs; }
+
+static void record(char c) {
+  if (traceLength + 1 < sizeof(trace)) {
+    trace[traceLength++] = c;
+    trace[traceLength] = '\0';
+  }
+}
+
+static void taskA() { record('A'); }
+static void taskB() { record('B'); }
+static void taskC() { record('C'); }
+static void slowTask() { record('S'); simulatedMs += 30; }
+static void cancelSelf() { record('X'); scheduler->cancel(selfId); }
+static void onIdle(unsigned long idleMs) { lastIdleMs = idleMs; }
+
+static void onOverrun(const char* name, unsigned long runMs, unsigned long budgetMs) {
+  (void)budgetMs;
+  lastOverrun = name;
+  lastOverrunMs = runMs;
+}
+
+// Advance the clock one ms at a time, running due tasks as loop() would
+static void runUntil(unsigned long endMs) {
+  while ((long)(simulatedMs - endMs) < 0) {
+    scheduler->runDue();
+    simulatedMs++;
+  }
+  scheduler->runDue();
+}
+
+void setUp() {
+  simulatedMs = 1000;
+  trace[0] = '\0';
+  traceLength = 0;
+  lastIdleMs = 0;
+  lastOverrun = nullptr;
+  lastOverrunMs = 0;
+  scheduler = new TaskScheduler<8>(simulatedClock);
+}
+
+void tearDown() {
+  delete scheduler;
+}
+
+void test_periodic_tasks_interleave_by_deadline() {
+  scheduler->every("a", taskA, 100);
+  scheduler->every("b", taskB, 250, 50);
+  runUntil(1500);
+  // A at 0, 100, ..., 500; B at 50 and 300 (after A, registered first)
+  TEST_ASSERT_EQUAL_STRING("ABAAABAA", trace);
+}
+
+void test_ties_run_in_registration_order() {
+  scheduler->after("c", taskC, 10);
+  scheduler->after("a", taskA, 10);
+  scheduler->after("b", taskB, 10);
+  simulatedMs += 10;
+  scheduler->runDue();
+  TEST_ASSERT_EQUAL_STRING("CAB", trace);
+}
+
+void test_one_shot_frees_its_slot() {
+  int id = scheduler->after("once", taskA, 20);
+  TEST_ASSERT_EQUAL_UINT32(1, scheduler->taskCount());
+  runUntil(1100);
+  TEST_ASSERT_EQUAL_STRING("A", trace);
+  TEST_ASSERT_EQUAL_UINT32(0, scheduler->taskCount());
+  TaskStats stats;
+  TEST_ASSERT_FALSE(scheduler->stats(id, stats));
+  TEST_ASSERT_TRUE(scheduler->msUntilNext() == (unsigned long)-1);
+}
+
+void test_late_run_keeps_fixed_rate_and_counts_missed_ticks() {
+  int id = scheduler->every("a", taskA, 100);
+  scheduler->runDue();                 // t=1000
+  simulatedMs = 1130;                  // Late by 30 ms
+  scheduler->runDue();
+  TEST_ASSERT_EQUAL_UINT32(70, scheduler->msUntilNext());   // Next stays at 1200
+
+  simulatedMs = 1555;                  // 1200 runs late, 1300-1500 cannot run
+  scheduler->runDue();
+  TaskStats stats;
+  scheduler->stats(id, stats);
+  TEST_ASSERT_EQUAL_UINT32(3, stats.runs);
+  TEST_ASSERT_EQUAL_UINT32(3, stats.missed);
+  TEST_ASSERT_EQUAL_UINT32(45, scheduler->msUntilNext());
+}
+
+void test_overrun_is_reported() {
+  scheduler->setOverrunHook(onOverrun);
+  int slow = scheduler->every("slow", slowTask, 100, 0, 20);
+  int fast = scheduler->every("fast", taskA, 100, 0);
+  scheduler->runDue();
+
+  TEST_ASSERT_EQUAL_STRING("slow", lastOverrun);
+  TEST_ASSERT_EQUAL_UINT32(30, lastOverrunMs);
+  TaskStats stats;
+  scheduler->stats(slow, stats);
+  TEST_ASSERT_EQUAL_UINT32(1, stats.overruns);
+  TEST_ASSERT_EQUAL_UINT32(30, stats.maxRunMs);
+  scheduler->stats(fast, stats);
+  TEST_ASSERT_EQUAL_UINT32(0, stats.overruns);
+}
+
+void test_task_can_cancel_itself() {
+  selfId = scheduler->every("x", cancelSelf, 10);
+  scheduler->every("a", taskA, 10);
+  runUntil(1035);
+  TEST_ASSERT_EQUAL_STRING("XAAAA", trace);
+  TEST_ASSERT_EQUAL_UINT32(1, scheduler->taskCount());
+  TEST_ASSERT_FALSE(scheduler->cancel(selfId));
+}
+
+void test_cancel_removes_pending_task() {
+  int a = scheduler->every("a", taskA, 10);
+  scheduler->every("b", taskB, 10, 5);
+  int c = scheduler->after("c", taskC, 7);
+  TEST_ASSERT_TRUE(scheduler->cancel(c));
+  TEST_ASSERT_TRUE(scheduler->cancel(a));
+  runUntil(1020);
+  TEST_ASSERT_EQUAL_STRING("BB", trace);
+}
+
+void test_capacity_and_invalid_period() {
+  TEST_ASSERT_EQUAL_INT(-1, scheduler->every("zero", taskA, 0));
+  for (int i = 0; i < 8; i++) {
+    TEST_ASSERT_EQUAL_INT(i, scheduler->every("a", taskA, 100));
+  }
+  TEST_ASSERT_EQUAL_INT(-1, scheduler->after("full", taskB, 0));
+  TEST_ASSERT_FALSE(scheduler->cancel(8));
+  TEST_ASSERT_FALSE(scheduler->cancel(-1));
+}
+
+void test_idle_hook_gets_time_to_next_deadline() {
+  scheduler->setIdleHook(onIdle);
+  scheduler->every("a", taskA, 100);
+  scheduler->every("b", taskB, 100, 40);
+  scheduler->tick();
+  TEST_ASSERT_EQUAL_STRING("A", trace);
+  TEST_ASSERT_EQUAL_UINT32(40, lastIdleMs);
+}
+
+void test_deadlines_survive_clock_wrap() {
+  simulatedMs = (unsigned long)-150;
+  scheduler->every("a", taskA, 100);
+  scheduler->after("b", taskB, 120);   // Due after the wrap
+  runUntil(simulatedMs + 350);
+  TEST_ASSERT_EQUAL_STRING("AABAA", trace);
+}
+
+void test_run_bound_per_call() {
+  // A task that is always due cannot keep runDue() from returning
+  for (int i = 0; i < 8; i++) {
+    scheduler->every("a", slowTask, 1);
+  }
+  scheduler->runDue();
+  TEST_ASSERT_EQUAL_UINT32(8, traceLength);
+  TEST_ASSERT_EQUAL_UINT32(0, scheduler->msUntilNext());
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_periodic_tasks_interleave_by_deadline);
+  RUN_TEST(test_ties_run_in_registration_order);
+  RUN_TEST(test_one_shot_frees_its_slot);
+  RUN_TEST(test_late_run_keeps_fixed_rate_and_counts_missed_ticks);
+  RUN_TEST(test_overrun_is_reported);
+  RUN_TEST(test_task_can_cancel_itself);
+  RUN_TEST(test_cancel_removes_pending_task);
+  RUN_TEST(test_capacity_and_invalid_period);
+  RUN_TEST(test_idle_hook_gets_time_to_next_deadline);
+  RUN_TEST(test_deadlines_survive_clock_wrap);
+  RUN_TEST(test_run_bound_per_call);
+  return UNITY_END();
+}
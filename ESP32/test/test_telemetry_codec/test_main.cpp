@@ -0,0 +1,266 @@
+/**
+ * @file test_main.cpp
+ * @brief Binary telemetry encoding and the packed buffer records
+ *
+ * Messages are checked byte for byte against the layout documented in
+ * telemetry_codec.h.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+#include "buffer/buffer.h"
+#include "mqtt/telemetry_codec.h"
+
+static const uint8_t UUID[16] = {
+  0x8c, 0xe7, 0x03, 0x99, 0x99, 0xf9, 0x46, 0xdd,
+  0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef
+};
+
+static TelemetryReading makeReading() {
+  TelemetryReading reading;
+  memset(&reading, 0, sizeof(reading));
+  strcpy(reading.timestamp, "1700000000");
+  reading.temperature = 21.37f;
+  reading.humidity = 64.5f;
+  reading.light = 321.25f;
+  reading.tankLevel = true;
+  reading.lightsOn = true;
+  reading.valid = true;
+  reading.samples = 1;
+  return reading;
+}
+
+// Unsigned LEB128 decode
+static uint32_t getVarint(const uint8_t* data, size_t& pos) {
+  uint32_t value = 0;
+  for (int shift = 0; ; shift += 7) {
+    uint8_t byte = data[pos++];
+    value |= (uint32_t)(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+}
+
+static uint16_t getU16(const uint8_t* data, size_t& pos) {
+  uint16_t value = (uint16_t)(data[pos] | (data[pos + 1] << 8));
+  pos += 2;
+  return value;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_parse_uuid() {
+  uint8_t uuid[16];
+  TEST_ASSERT_TRUE(parseUuid("8ce70399-99f9-46dd-0123-456789ABCDEF", uuid));
+  TEST_ASSERT_EQUAL_MEMORY(UUID, uuid, 16);
+  TEST_ASSERT_TRUE(parseUuid("8ce7039999f946dd0123456789abcdef", uuid));
+  TEST_ASSERT_EQUAL_MEMORY(UUID, uuid, 16);
+
+  TEST_ASSERT_FALSE(parseUuid("8ce70399-99f9-46dd-0123-456789abcde", uuid));    // 31 digits
+  TEST_ASSERT_FALSE(parseUuid("8ce70399-99f9-46dd-0123-456789abcdef0", uuid));  // 33 digits
+  TEST_ASSERT_FALSE(parseUuid("8ce70399-99f9-46dd-0123-456789abcdeg", uuid));
+  TEST_ASSERT_FALSE(parseUuid("", uuid));
+}
+
+void test_packed_record_sizes() {
+  TEST_ASSERT_EQUAL_UINT32(16, sizeof(PackedReading));
+  TEST_ASSERT_EQUAL_UINT32(44, sizeof(PackedAggregate));
+}
+
+void test_pack_reading_round_trip() {
+  TelemetryReading reading = makeReading();
+  PackedReading packed;
+  packReading(reading, packed);
+  TEST_ASSERT_EQUAL_UINT32(1700000000, packed.epoch);
+  TEST_ASSERT_EQUAL_INT16(2137, packed.temperature);
+  TEST_ASSERT_EQUAL_UINT16(6450, packed.humidity);
+  TEST_ASSERT_EQUAL_UINT32(32125, packed.light);
+  TEST_ASSERT_EQUAL_HEX8(PACKED_FLAG_TANK_LEVEL | PACKED_FLAG_LIGHTS_ON | PACKED_FLAG_TEMP_OK |
+                         PACKED_FLAG_HUM_OK | PACKED_FLAG_LIGHT_OK, packed.flags);
+
+  TelemetryReading back;
+  unpackReading(packed, back);
+  TEST_ASSERT_EQUAL_STRING("1700000000", back.timestamp);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 21.37f, back.temperature);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 64.5f, back.humidity);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 321.25f, back.light);
+  TEST_ASSERT_TRUE(back.tankLevel);
+  TEST_ASSERT_TRUE(back.lightsOn);
+  TEST_ASSERT_FALSE(back.pumpOn);
+  TEST_ASSERT_FALSE(back.provisional);
+  TEST_ASSERT_EQUAL_UINT16(1, back.samples);
+  TEST_ASSERT_EQUAL_HEX8(READING_EVENT_LIGHTS_RAN, back.events);
+  TEST_ASSERT_EQUAL_UINT16(1, back.temperatureStats.count);
+}
+
+void test_pack_reading_keeps_sensor_errors() {
+  TelemetryReading reading = makeReading();
+  reading.temperature = SENSOR_ERROR_TEMP;
+  reading.humidity = SENSOR_ERROR_HUM;
+  reading.light = SENSOR_ERROR_LIGHT;
+  reading.provisional = true;
+  PackedReading packed;
+  packReading(reading, packed);
+  TEST_ASSERT_EQUAL_HEX8(0, packed.flags & (PACKED_FLAG_TEMP_OK | PACKED_FLAG_HUM_OK | PACKED_FLAG_LIGHT_OK));
+  TEST_ASSERT_TRUE(packed.flags & PACKED_FLAG_PROVISIONAL);
+
+  TelemetryReading back;
+  unpackReading(packed, back);
+  TEST_ASSERT_EQUAL_FLOAT(SENSOR_ERROR_TEMP, back.temperature);
+  TEST_ASSERT_EQUAL_FLOAT(SENSOR_ERROR_HUM, back.humidity);
+  TEST_ASSERT_EQUAL_FLOAT(SENSOR_ERROR_LIGHT, back.light);
+  TEST_ASSERT_TRUE(back.provisional);
+  TEST_ASSERT_EQUAL_UINT16(0, back.temperatureStats.count);
+}
+
+void test_pack_aggregate_round_trip() {
+  TelemetryReading reading = makeReading();
+  reading.samples = 10;
+  reading.events = READING_EVENT_IRRIGATED | READING_EVENT_PUMP_RAN;
+  reading.temperatureStats = {18.5f, 24.25f, 1.75f, 10};
+  reading.humidityStats = {60.0f, 70.0f, 2.5f, 9};
+  reading.lightStats = {100.0f, 90000.0f, 12.0f, 10};
+
+  PackedAggregate packed;
+  packAggregate(reading, packed);
+  TEST_ASSERT_EQUAL_UINT16(10, packed.samples);
+  TEST_ASSERT_EQUAL_INT16(1850, packed.temperatureMin);
+  TEST_ASSERT_EQUAL_UINT16(65535, packed.lightMax);   // Saturates
+
+  TelemetryReading back;
+  unpackAggregate(packed, back);
+  TEST_ASSERT_EQUAL_UINT16(10, back.samples);
+  TEST_ASSERT_EQUAL_HEX8(READING_EVENT_IRRIGATED | READING_EVENT_PUMP_RAN, back.events);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 24.25f, back.temperatureStats.max);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 1.75f, back.temperatureStats.stdDev);
+  TEST_ASSERT_EQUAL_UINT16(9, back.humidityStats.count);
+  TEST_ASSERT_FLOAT_WITHIN(0.001f, 100.0f, back.lightStats.min);
+}
+
+void test_header_and_raw_record_layout() {
+  uint8_t buffer[128];
+  BinaryTelemetryWriter writer(buffer, sizeof(buffer), UUID);
+  TEST_ASSERT_EQUAL_UINT32(TELEMETRY_BINARY_HEADER_SIZE, writer.size());
+
+  PackedReading packed;
+  packReading(makeReading(), packed);
+  TEST_ASSERT_TRUE(writer.add(packed, 300));
+  TEST_ASSERT_EQUAL_UINT8(1, writer.count());
+
+  TEST_ASSERT_EQUAL_HEX8(TELEMETRY_BINARY_VERSION, buffer[0]);
+  TEST_ASSERT_EQUAL_MEMORY(UUID, buffer + 1, 16);
+  TEST_ASSERT_EQUAL_UINT8(1, buffer[17]);
+
+  size_t pos = TELEMETRY_BINARY_HEADER_SIZE;
+  TEST_ASSERT_EQUAL_UINT32(1700000000, getVarint(buffer, pos));
+  TEST_ASSERT_EQUAL_UINT32(300, getVarint(buffer, pos));
+  TEST_ASSERT_EQUAL_HEX8(BINARY_FLAG_TANK_LEVEL | BINARY_FLAG_LIGHTS_ON | BINARY_FLAG_TEMPERATURE |
+                         BINARY_FLAG_HUMIDITY | BINARY_FLAG_LIGHT, buffer[pos++]);
+  TEST_ASSERT_EQUAL_INT16(2137, (int16_t)getU16(buffer, pos));
+  TEST_ASSERT_EQUAL_UINT16(6450, getU16(buffer, pos));
+  TEST_ASSERT_EQUAL_UINT32(32125, getVarint(buffer, pos));
+  TEST_ASSERT_EQUAL_UINT32(pos, writer.size());
+  TEST_ASSERT_EQUAL_UINT32(33, writer.size());    // ~30 bytes for a live reading
+}
+
+void test_aggregate_record_layout() {
+  TelemetryReading reading = makeReading();
+  reading.samples = 6;
+  reading.events = READING_EVENT_TANK_EMPTY;
+  reading.temperatureStats = {-5.5f, 30.0f, 2.0f, 6};
+  reading.humidityStats = {0.0f, 0.0f, 0.0f, 0};   // No valid humidity samples
+  reading.lightStats = {10.0f, 500.0f, 40.0f, 6};
+  PackedAggregate packed;
+  packAggregate(reading, packed);
+
+  uint8_t buffer[128];
+  BinaryTelemetryWriter writer(buffer, sizeof(buffer), UUID);
+  TEST_ASSERT_TRUE(writer.add(packed, 7));
+
+  size_t pos = TELEMETRY_BINARY_HEADER_SIZE;
+  getVarint(buffer, pos);
+  getVarint(buffer, pos);
+  uint8_t flags = buffer[pos++];
+  TEST_ASSERT_TRUE(flags & BINARY_FLAG_AGGREGATE);
+  getU16(buffer, pos);
+  getU16(buffer, pos);
+  getVarint(buffer, pos);
+
+  TEST_ASSERT_EQUAL_UINT32(6, getVarint(buffer, pos));
+  TEST_ASSERT_EQUAL_HEX8(READING_EVENT_TANK_EMPTY, buffer[pos++]);
+  TEST_ASSERT_EQUAL_HEX8(0x05, buffer[pos++]);   // Temperature and light stats
+  TEST_ASSERT_EQUAL_INT16(-550, (int16_t)getU16(buffer, pos));
+  TEST_ASSERT_EQUAL_INT16(3000, (int16_t)getU16(buffer, pos));
+  TEST_ASSERT_EQUAL_UINT32(200, getVarint(buffer, pos));
+  TEST_ASSERT_EQUAL_UINT32(10, getVarint(buffer, pos));
+  TEST_ASSERT_EQUAL_UINT32(500, getVarint(buffer, pos));
+  TEST_ASSERT_EQUAL_UINT32(40, getVarint(buffer, pos));
+  TEST_ASSERT_EQUAL_UINT32(pos, writer.size());
+}
+
+void test_single_sample_aggregate_is_written_raw() {
+  PackedAggregate packed;
+  packAggregate(makeReading(), packed);
+  TEST_ASSERT_EQUAL_UINT16(1, packed.samples);
+
+  uint8_t raw[128];
+  uint8_t viaAggregate[128];
+  BinaryTelemetryWriter rawWriter(raw, sizeof(raw), UUID);
+  BinaryTelemetryWriter aggregateWriter(viaAggregate, sizeof(viaAggregate), UUID);
+  rawWriter.add(packed.mean, 1);
+  aggregateWriter.add(packed, 1);
+  TEST_ASSERT_EQUAL_UINT32(rawWriter.size(), aggregateWriter.size());
+  TEST_ASSERT_EQUAL_MEMORY(raw, viaAggregate, rawWriter.size());
+}
+
+void test_suppressed_count_in_header() {
+  uint8_t buffer[128];
+  BinaryTelemetryWriter writer(buffer, sizeof(buffer), UUID);
+  TEST_ASSERT_TRUE(writer.setSuppressed(200));
+  TEST_ASSERT_FALSE(writer.setSuppressed(1));   // Only once
+  TEST_ASSERT_EQUAL_HEX8(TELEMETRY_BINARY_VERSION | BINARY_HEADER_SUPPRESSED, buffer[0]);
+  size_t pos = TELEMETRY_BINARY_HEADER_SIZE;
+  TEST_ASSERT_EQUAL_UINT32(200, getVarint(buffer, pos));
+
+  PackedReading packed;
+  packReading(makeReading(), packed);
+  writer.add(packed, 1);
+  BinaryTelemetryWriter late(buffer, sizeof(buffer), UUID);
+  late.add(packed, 1);
+  TEST_ASSERT_FALSE(late.setSuppressed(5));     // Must come before the first record
+}
+
+void test_record_that_does_not_fit_leaves_message_unchanged() {
+  PackedReading packed;
+  packReading(makeReading(), packed);
+  uint8_t buffer[56];   // Header + two 15-byte records
+  BinaryTelemetryWriter writer(buffer, sizeof(buffer), UUID);
+  TEST_ASSERT_TRUE(writer.add(packed, 1));
+  TEST_ASSERT_TRUE(writer.add(packed, 2));
+  size_t size = writer.size();
+  uint8_t before[56];
+  memcpy(before, buffer, size);
+
+  TEST_ASSERT_FALSE(writer.add(packed, 3));
+  TEST_ASSERT_EQUAL_UINT8(2, writer.count());
+  TEST_ASSERT_EQUAL_UINT32(size, writer.size());
+  TEST_ASSERT_EQUAL_MEMORY(before, buffer, size);
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_parse_uuid);
+  RUN_TEST(test_packed_record_sizes);
+  RUN_TEST(test_pack_reading_round_trip);
+  RUN_TEST(test_pack_reading_keeps_sensor_errors);
+  RUN_TEST(test_pack_aggregate_round_trip);
+  RUN_TEST(test_header_and_raw_record_layout);
+  RUN_TEST(test_aggregate_record_layout);
+  RUN_TEST(test_single_sample_aggregate_is_written_raw);
+  RUN_TEST(test_suppressed_count_in_header);
+  RUN_TEST(test_record_that_does_not_fit_leaves_message_unchanged);
+  return UNITY_END();
+}
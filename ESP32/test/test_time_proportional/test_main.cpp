@@ -0,0 +1,113 @@
+/**
+ * @file test_main.cpp
+ * @brief Time-proportional relay drive for the heater
+ */
+
+#include <unity.h>
+#include "control/time_proportional.h"
+
+/**
+ * Step the output every ms over [startMs, endMs) at a fixed duty
+ * @return ms spent on
+ */
+static unsigned long runFor(TimeProportionalOutput& output, float duty, unsigned long startMs,
+                            unsigned long endMs) {
+  unsigned long onMs = 0;
+  for (unsigned long now = startMs; now != endMs; now++) {
+    if (output.update(duty, now)) {
+      onMs++;
+    }
+  }
+  return onMs;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_on_time_follows_duty() {
+  TimeProportionalOutput output(1000, 50, 50);
+  TEST_ASSERT_TRUE(output.update(0.25f, 0));
+  TEST_ASSERT_TRUE(output.update(0.25f, 249));
+  TEST_ASSERT_FALSE(output.update(0.25f, 250));
+  TEST_ASSERT_EQUAL_UINT32(250, output.onTimeMs());
+
+  TEST_ASSERT_EQUAL_UINT32(3 * 250, runFor(output, 0.25f, 251, 4000));   // Windows at 1000, 2000, 3000
+}
+
+void test_duty_average_over_windows() {
+  TimeProportionalOutput output(1000, 50, 50);
+  TEST_ASSERT_EQUAL_UINT32(4 * 400, runFor(output, 0.4f, 0, 4000));
+  TEST_ASSERT_EQUAL_UINT32(8, output.switches());   // One pulse per window
+}
+
+void test_short_pulses_and_gaps_are_removed() {
+  TimeProportionalOutput low(1000, 100, 100);
+  TEST_ASSERT_EQUAL_UINT32(0, runFor(low, 0.05f, 0, 3000));    // 50 ms < minimum on
+  TEST_ASSERT_EQUAL_UINT32(0, low.switches());
+
+  TimeProportionalOutput high(1000, 100, 100);
+  TEST_ASSERT_EQUAL_UINT32(3000, runFor(high, 0.95f, 0, 3000));  // 50 ms gap < minimum off
+  TEST_ASSERT_EQUAL_UINT32(1, high.switches());
+}
+
+void test_duty_change_within_window() {
+  TimeProportionalOutput output(1000, 50, 50);
+  runFor(output, 0.2f, 0, 100);
+  TEST_ASSERT_TRUE(output.isOn());
+  // Raised before the pulse ends: the pulse is extended
+  TEST_ASSERT_EQUAL_UINT32(500, runFor(output, 0.6f, 100, 601));
+  TEST_ASSERT_FALSE(output.isOn());
+  // Raised again after the pulse ended: stays off until the next window
+  TEST_ASSERT_EQUAL_UINT32(0, runFor(output, 0.9f, 601, 1000));
+  TEST_ASSERT_TRUE(output.update(0.9f, 1000));
+}
+
+void test_duty_cut_respects_minimum_on_time() {
+  TimeProportionalOutput output(1000, 200, 50);
+  output.update(0.5f, 0);
+  TEST_ASSERT_TRUE(output.update(0.0f, 100));    // Held on until 200 ms
+  TEST_ASSERT_TRUE(output.update(0.0f, 199));
+  TEST_ASSERT_FALSE(output.update(0.0f, 200));
+}
+
+void test_force_off() {
+  TimeProportionalOutput output(1000, 200, 50);
+  output.update(1.0f, 0);
+  TEST_ASSERT_TRUE(output.forceOff(150));
+  TEST_ASSERT_FALSE(output.forceOff(200));
+  TEST_ASSERT_FALSE(output.update(1.0f, 500));   // Pulse ended for this window
+  TEST_ASSERT_TRUE(output.update(1.0f, 1000));
+}
+
+void test_at_most_two_switches_per_window() {
+  TimeProportionalOutput output(1000, 50, 50);
+  uint32_t seed = 12345;
+  for (unsigned long window = 0; window < 50; window++) {
+    uint32_t before = output.switches();
+    for (unsigned long ms = 0; ms < 1000; ms += 10) {
+      seed = seed * 1103515245u + 12345u;
+      float duty = (float)((seed >> 16) % 1001) / 1000.0f;
+      output.update(duty, window * 1000 + ms);
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(2, output.switches() - before);
+  }
+}
+
+void test_window_survives_clock_wrap() {
+  TimeProportionalOutput output(1000, 50, 50);
+  unsigned long start = (unsigned long)-2500;
+  TEST_ASSERT_EQUAL_UINT32(5 * 300, runFor(output, 0.3f, start, start + 5000));
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_on_time_follows_duty);
+  RUN_TEST(test_duty_average_over_windows);
+  RUN_TEST(test_short_pulses_and_gaps_are_removed);
+  RUN_TEST(test_duty_change_within_window);
+  RUN_TEST(test_duty_cut_respects_minimum_on_time);
+  RUN_TEST(test_force_off);
+  RUN_TEST(test_at_most_two_switches_per_window);
+  RUN_TEST(test_window_survives_clock_wrap);
+  return UNITY_END();
+}
@@ -0,0 +1,78 @@
+/**
+ * @file test_main.cpp
+ * @brief Token bucket pacing of the buffer flush
+ */
+
+#include <unity.h>
+#include "mqtt/token_bucket.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_burst_then_empty() {
+  TokenBucket bucket(3, 2);
+  bucket.reset(1000);
+  TEST_ASSERT_TRUE(bucket.tryConsume(1000));
+  TEST_ASSERT_TRUE(bucket.tryConsume(1000));
+  TEST_ASSERT_TRUE(bucket.tryConsume(1000));
+  TEST_ASSERT_FALSE(bucket.tryConsume(1000));
+}
+
+void test_refills_at_rate() {
+  TokenBucket bucket(3, 2);   // One token per 500 ms
+  bucket.reset(0);
+  for (int i = 0; i < 3; i++) {
+    bucket.tryConsume(0);
+  }
+  TEST_ASSERT_EQUAL_UINT32(500, bucket.msUntilAvailable(0));
+  TEST_ASSERT_FALSE(bucket.tryConsume(499));
+  TEST_ASSERT_EQUAL_UINT32(1, bucket.msUntilAvailable(499));
+  TEST_ASSERT_TRUE(bucket.tryConsume(500));
+  TEST_ASSERT_FALSE(bucket.tryConsume(500));
+}
+
+void test_sustained_rate_matches_configuration() {
+  TokenBucket bucket(5, 10);
+  bucket.reset(0);
+  int taken = 0;
+  for (unsigned long now = 0; now <= 10000; now += 7) {
+    while (bucket.tryConsume(now)) {
+      taken++;
+    }
+  }
+  // 5 burst + 10/s for 10 s
+  TEST_ASSERT_INT_WITHIN(1, 105, taken);
+}
+
+void test_long_idle_caps_at_capacity() {
+  TokenBucket bucket(4, 1000);
+  bucket.reset(0);
+  for (int i = 0; i < 4; i++) {
+    bucket.tryConsume(0);
+  }
+  unsigned long later = 3600000UL * 24 * 40;  // 40 days
+  int taken = 0;
+  while (bucket.tryConsume(later)) {
+    taken++;
+  }
+  TEST_ASSERT_EQUAL_INT(4, taken);
+}
+
+void test_time_wraps() {
+  TokenBucket bucket(1, 1);
+  unsigned long start = (unsigned long)-200;
+  bucket.reset(start);
+  TEST_ASSERT_TRUE(bucket.tryConsume(start));
+  TEST_ASSERT_FALSE(bucket.tryConsume(start + 100));
+  TEST_ASSERT_TRUE(bucket.tryConsume(start + 1000));   // Wrapped past zero
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_burst_then_empty);
+  RUN_TEST(test_refills_at_rate);
+  RUN_TEST(test_sustained_rate_matches_configuration);
+  RUN_TEST(test_long_idle_caps_at_capacity);
+  RUN_TEST(test_time_wraps);
+  return UNITY_END();
+}
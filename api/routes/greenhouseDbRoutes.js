@@ -394,6 +394,38 @@ router.patch("/:id/setpoint", authenticateToken, async (req, res) => {
   }
 });
 
+// Push a control rule set to the greenhouse
+router.put("/:id/rules", authenticateToken, async (req, res) => {
+  const { id } = req.params;
+
+  try {
+    // Single statement - query() returns its pooled connection itself
+    const { rows } = await query(
+      `SELECT id FROM greenhouse WHERE id = $1 AND owner_id = $2`,
+      [id, req.user.id]
+    );
+
+    if (rows.length === 0) {
+      return res.status(404).json({ error: "Greenhouse not found" });
+    }
+
+    let published;
+    try {
+      published = mqttService.publishRules(id, req.body);
+    } catch (error) {
+      return res.status(400).json({ error: error.message });
+    }
+
+    if (!published) {
+      return res.status(503).json({ error: "MQTT broker not connected" });
+    }
+    res.json({ version: req.body.version, rules: req.body.rules?.length ?? 0 });
+  } catch (error) {
+    console.error("Error publishing rules:", error);
+    res.status(500).json({ error: "Internal server error" });
+  }
+});
+
 
 router.patch("/:id", authenticateToken, async (req, res) => {
   const { id } = req.params;
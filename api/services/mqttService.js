@@ -1,5 +1,6 @@
 import mqtt from "mqtt";
 import dotenv from "dotenv";
+import { compileRules } from "./ruleCompiler.js";
 
 dotenv.config();
 
@@ -78,6 +79,34 @@ class MqttService {
     return true;
   }
 
+  /**
+   * Compile a rule set and publish it to the greenhouse (retained, so the
+   * ESP32 receives it again after a reboot)
+   * @param {string} greenhouseId - The greenhouse UUID
+   * @param {object} ruleSet - { version, rules } (see ruleCompiler.js)
+   * @throws {Error} If the rule set is invalid
+   */
+  publishRules(greenhouseId, ruleSet) {
+    const table = compileRules(ruleSet);
+
+    if (!this.client || !this.isConnected) {
+      console.error("❌ MQTT client not connected. Cannot publish rules.");
+      return false;
+    }
+
+    const topic = `greenhouse/${greenhouseId}/config/rules`;
+
+    this.client.publish(topic, table, { qos: 1, retain: true }, (error) => {
+      if (error) {
+        console.error(`❌ Error publishing to ${topic}:`, error);
+      } else {
+        console.log(`📤 Published rules v${ruleSet.version} (${table.length} bytes) to ${topic}`);
+      }
+    });
+
+    return true;
+  }
+
   disconnect() {
     if (this.client) {
       this.client.end();
@@ -0,0 +1,130 @@
+/**
+ * Compiles a JSON rule set into the binary rule table the ESP32 evaluates
+ * (see ESP32/src/control/rule_engine.h for the format).
+ *
+ * Rule set:
+ * {
+ *   "version": 3,                       // must increase with every change
+ *   "rules": [
+ *     { "actuator": "fan", "input": "humidity", "op": ">",
+ *       "ref": "hum_air_max", "hysteresis": 5, "min_dwell_s": 60 },
+ *     { "actuator": "pump", "input": "tank_level", "op": "<", "value": 0.5,
+ *       "inhibit": true }
+ *   ]
+ * }
+ *
+ * The threshold is the setpoint named by "ref" plus "offset", or the
+ * constant "value".
+ */
+
+const MAGIC = [0x47, 0x52]; // "GR"
+const FORMAT_VERSION = 1;
+const HEADER_SIZE = 8;
+const RECORD_SIZE = 12;
+const CRC_SIZE = 4;
+const MAX_RULES = 32; // RULES_MAX_COUNT
+const TARGET_INHIBIT = 0x80;
+
+const INPUTS = ["temperature", "humidity", "light", "tank_level"];
+const OPERATORS = ["<", ">"];
+const REFERENCES = ["constant", "temp_min", "temp_max", "hum_air_max", "light_intensity"];
+const ACTUATORS = ["pump", "heating", "led", "fan"];
+
+const CRC_TABLE = (() => {
+  const table = new Uint32Array(256);
+  for (let n = 0; n < 256; n++) {
+    let c = n;
+    for (let bit = 0; bit < 8; bit++) {
+      c = c & 1 ? 0xedb88320 ^ (c >>> 1) : c >>> 1;
+    }
+    table[n] = c >>> 0;
+  }
+  return table;
+})();
+
+/**
+ * CRC-32 (IEEE 802.3), same as the firmware's crc32()
+ * @param {Buffer} data
+ * @returns {number}
+ */
+export function crc32(data) {
+  let crc = 0xffffffff;
+  for (const byte of data) {
+    crc = CRC_TABLE[(crc ^ byte) & 0xff] ^ (crc >>> 8);
+  }
+  return (crc ^ 0xffffffff) >>> 0;
+}
+
+function lookup(list, name, field, index) {
+  const position = list.indexOf(String(name).toLowerCase());
+  if (position < 0) {
+    throw new Error(`Rule ${index}: invalid ${field} '${name}'. Allowed: ${list.join(", ")}`);
+  }
+  return position;
+}
+
+function fixedPoint(value, field, index, min, max) {
+  const number = Number(value ?? 0);
+  const scaled = Math.round(number * 100);
+  if (!Number.isFinite(number) || scaled < min || scaled > max) {
+    throw new Error(`Rule ${index}: ${field} out of range`);
+  }
+  return scaled;
+}
+
+/**
+ * Compile a rule set
+ * @param {object} ruleSet - { version, rules: [...] }
+ * @returns {Buffer} Rule table
+ * @throws {Error} If the rule set is invalid
+ */
+export function compileRules(ruleSet) {
+  const { version, rules = [] } = ruleSet ?? {};
+
+  if (!Number.isInteger(version) || version < 1 || version > 0xffffffff) {
+    throw new Error("version must be an integer from 1 to 4294967295");
+  }
+  if (!Array.isArray(rules) || rules.length > MAX_RULES) {
+    throw new Error(`rules must be an array of at most ${MAX_RULES} rules`);
+  }
+
+  const table = Buffer.alloc(HEADER_SIZE + rules.length * RECORD_SIZE + CRC_SIZE);
+  table[0] = MAGIC[0];
+  table[1] = MAGIC[1];
+  table[2] = FORMAT_VERSION;
+  table[3] = rules.length;
+  table.writeUInt32LE(version, 4);
+
+  rules.forEach((rule, index) => {
+    const offset = HEADER_SIZE + index * RECORD_SIZE;
+    const hasValue = rule.value !== undefined;
+
+    if (hasValue && rule.ref !== undefined) {
+      throw new Error(`Rule ${index}: use either 'value' or 'ref', not both`);
+    }
+    if (!hasValue && rule.ref === undefined) {
+      throw new Error(`Rule ${index}: 'value' or 'ref' is required`);
+    }
+
+    const dwell = Number(rule.min_dwell_s ?? 0);
+    if (!Number.isInteger(dwell) || dwell < 0 || dwell > 0xffff) {
+      throw new Error(`Rule ${index}: min_dwell_s must be an integer from 0 to 65535`);
+    }
+
+    table[offset] = lookup(INPUTS, rule.input, "input", index);
+    table[offset + 1] = lookup(OPERATORS, rule.op, "op", index);
+    table[offset + 2] = hasValue ? 0 : lookup(REFERENCES, rule.ref, "ref", index);
+    table[offset + 3] =
+      lookup(ACTUATORS, rule.actuator, "actuator", index) | (rule.inhibit ? TARGET_INHIBIT : 0);
+    table.writeInt32LE(
+      fixedPoint(hasValue ? rule.value : rule.offset, "threshold", index, -0x80000000, 0x7fffffff),
+      offset + 4
+    );
+    table.writeUInt16LE(fixedPoint(rule.hysteresis, "hysteresis", index, 0, 0xffff), offset + 8);
+    table.writeUInt16LE(dwell, offset + 10);
+  });
+
+  const crcOffset = table.length - CRC_SIZE;
+  table.writeUInt32LE(crc32(table.subarray(0, crcOffset)), crcOffset);
+  return table;
+}
@@ -8,6 +8,8 @@ pub struct Config {
     pub mqtt_host: String,
     pub mqtt_port: u16,
     pub mqtt_telemetry_topic: String,
+    pub mqtt_telemetry_batch_topic: String,
+    pub mqtt_telemetry_binary_topic: String,
 
     // Database Configuration
     pub db_host: String,
@@ -30,6 +32,10 @@ impl Config {
                 .parse()?,
             mqtt_telemetry_topic: env::var("MQTT_TELEMETRY_TOPIC")
                 .unwrap_or_else(|_| "greenhouse/+/telemetry".to_string()),
+            mqtt_telemetry_batch_topic: env::var("MQTT_TELEMETRY_BATCH_TOPIC")
+                .unwrap_or_else(|_| "greenhouse/+/telemetry/batch".to_string()),
+            mqtt_telemetry_binary_topic: env::var("MQTT_TELEMETRY_BINARY_TOPIC")
+                .unwrap_or_else(|_| "greenhouse/+/telemetry/bin".to_string()),
 
             // Database settings
             db_host: env::var("DB_HOST").unwrap_or_else(|_| "localhost".to_string()),
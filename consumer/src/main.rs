@@ -9,7 +9,7 @@ use std::time::Duration;
 
 use config::Config;
 use db::Database;
-use models::TelemetryMessage;
+use models::{parse_binary_telemetry_payload, parse_telemetry_payload, TelemetryMessage};
 
 #[tokio::main]
 async fn main() -> Result<()> {
@@ -24,6 +24,8 @@ async fn main() -> Result<()> {
     info!("Configuration loaded");
     info!("  MQTT: {}:{}", config.mqtt_host, config.mqtt_port);
     info!("  Topic: {}", config.mqtt_telemetry_topic);
+    info!("  Batch topic: {}", config.mqtt_telemetry_batch_topic);
+    info!("  Binary topic: {}", config.mqtt_telemetry_binary_topic);
     info!(
         "  Database: {}@{}/{}",
         config.db_user, config.db_host, config.db_name
@@ -54,6 +56,24 @@ async fn main() -> Result<()> {
         .subscribe(&config.mqtt_telemetry_topic, QoS::AtLeastOnce)
         .await?;
 
+    // Subscribe to batched telemetry topic (buffered readings flushed as JSON arrays)
+    info!(
+        "Subscribing to topic: {}",
+        config.mqtt_telemetry_batch_topic
+    );
+    client
+        .subscribe(&config.mqtt_telemetry_batch_topic, QoS::AtLeastOnce)
+        .await?;
+
+    // Subscribe to binary telemetry topic (compact encoding, see models.rs)
+    info!(
+        "Subscribing to topic: {}",
+        config.mqtt_telemetry_binary_topic
+    );
+    client
+        .subscribe(&config.mqtt_telemetry_binary_topic, QoS::AtLeastOnce)
+        .await?;
+
     info!("Consumer ready - waiting for messages");
 
     // Event loop - process incoming messages
@@ -69,65 +89,34 @@ async fn main() -> Result<()> {
                     let topic = &publish.topic;
                     let payload = &publish.payload;
 
-                    // Parse JSON payload
-                    match serde_json::from_slice::<TelemetryMessage>(payload) {
-                        Ok(telemetry) => {
-                            info!("Received telemetry from: {}", telemetry.greenhouse_id);
-                            info!("  Topic: {}", topic);
-                            info!(
-                                "  Seq: {}, Temp: {}°C, Humidity: {}%, Light: {} lux",
-                                telemetry.sequence,
-                                telemetry.temperature,
-                                telemetry.humidity,
-                                telemetry.light
-                            );
-                            info!(
-                                "  Tank: {}, Pump: {}, Lights: {}",
-                                telemetry.tank_level, telemetry.pump_on, telemetry.lights_are_on
-                            );
-
-                            // Validate message
-                            if let Err(e) = telemetry.validate() {
-                                error!("Invalid telemetry message: {}", e);
-                                continue;
-                            }
-
-                            // Check if greenhouse exists
-                            match db.greenhouse_exists(&telemetry.greenhouse_id).await {
-                                Ok(true) => {
-                                    // Insert into database
-                                    match db.insert_telemetry(&telemetry).await {
-                                        Ok(()) => {
-                                            // Update last_seen timestamp
-                                            if let Err(e) = db
-                                                .update_greenhouse_last_seen(
-                                                    &telemetry.greenhouse_id,
-                                                    &telemetry.timestamp,
-                                                )
-                                                .await
-                                            {
-                                                warn!("Failed to update last_seen: {}", e);
-                                            }
-                                        }
-                                        Err(e) => {
-                                            error!("Database insert failed: {}", e);
-                                        }
+                    // Binary payloads are decoded to the same messages as JSON
+                    let parsed = if topic.ends_with("/bin") {
+                        parse_binary_telemetry_payload(payload)
+                    } else {
+                        // JSON payload (single message or batch array)
+                        parse_telemetry_payload(payload).map_err(|e| e.to_string())
+                    };
+
+                    match parsed {
+                        Ok(messages) => {
+                            for message in messages {
+                                match message {
+                                    Ok(telemetry) => {
+                                        process_telemetry(&db, topic, &telemetry).await;
+                                    }
+                                    Err(e) => {
+                                        error!("Failed to parse telemetry message: {}", e);
+                                        error!("  Topic: {}", topic);
                                     }
-                                }
-                                Ok(false) => {
-                                    warn!(
-                                        "Greenhouse {} not found in database - skipping",
-                                        telemetry.greenhouse_id
-                                    );
-                                }
-                                Err(e) => {
-                                    error!("Database query failed: {}", e);
                                 }
                             }
                         }
                         Err(e) => {
-                            error!("Failed to parse JSON: {}", e);
-                            error!("  Payload: {}", String::from_utf8_lossy(payload));
+                            error!("Failed to parse payload: {}", e);
+                            error!("  Topic: {}", topic);
+                            if !topic.ends_with("/bin") {
+                                error!("  Payload: {}", String::from_utf8_lossy(payload));
+                            }
                         }
                     }
                 }
@@ -140,3 +129,59 @@ async fn main() -> Result<()> {
         }
     }
 }
+
+/// Validate a telemetry message and store it in the database
+async fn process_telemetry(db: &Database, topic: &str, telemetry: &TelemetryMessage) {
+    info!("Received telemetry from: {}", telemetry.greenhouse_id);
+    info!("  Topic: {}", topic);
+    info!(
+        "  Seq: {}, Temp: {}°C, Humidity: {}%, Light: {} lux",
+        telemetry.sequence, telemetry.temperature, telemetry.humidity, telemetry.light
+    );
+    info!(
+        "  Tank: {}, Pump: {}, Lights: {}",
+        telemetry.tank_level, telemetry.pump_on, telemetry.lights_are_on
+    );
+    if telemetry.suppressed > 0 {
+        info!(
+            "  {} unchanged readings held back by the device",
+            telemetry.suppressed
+        );
+    }
+
+    // Validate message
+    if let Err(e) = telemetry.validate() {
+        error!("Invalid telemetry message: {}", e);
+        return;
+    }
+
+    // Check if greenhouse exists
+    match db.greenhouse_exists(&telemetry.greenhouse_id).await {
+        Ok(true) => {
+            // Insert into database
+            match db.insert_telemetry(telemetry).await {
+                Ok(()) => {
+                    // Update last_seen timestamp
+                    if let Err(e) = db
+                        .update_greenhouse_last_seen(&telemetry.greenhouse_id, &telemetry.timestamp)
+                        .await
+                    {
+                        warn!("Failed to update last_seen: {}", e);
+                    }
+                }
+                Err(e) => {
+                    error!("Database insert failed: {}", e);
+                }
+            }
+        }
+        Ok(false) => {
+            warn!(
+                "Greenhouse {} not found in database - skipping",
+                telemetry.greenhouse_id
+            );
+        }
+        Err(e) => {
+            error!("Database query failed: {}", e);
+        }
+    }
+}
@@ -45,6 +45,11 @@ pub struct TelemetryMessage {
     /// Is water pump currently on (defaults to false if missing)
     #[serde(default)]
     pub pump_on: bool,
+
+    /// Live readings the ESP32 held back (no change beyond its deadbands)
+    /// since its previous message
+    #[serde(default)]
+    pub suppressed: u32,
 }
 
 /// Deserialize and validate UUID v4
@@ -159,6 +164,246 @@ impl TelemetryMessage {
     }
 }
 
+/// Parse a telemetry payload into individual messages
+///
+/// A payload is either a single message object or a JSON array of messages
+/// (batched flush of readings buffered on the ESP32 while offline). Each
+/// array element is parsed on its own so one bad reading does not discard
+/// the rest of the batch.
+pub fn parse_telemetry_payload(
+    payload: &[u8],
+) -> Result<Vec<Result<TelemetryMessage, serde_json::Error>>, serde_json::Error> {
+    match serde_json::from_slice::<serde_json::Value>(payload)? {
+        serde_json::Value::Array(items) => Ok(items
+            .into_iter()
+            .map(serde_json::from_value::<TelemetryMessage>)
+            .collect()),
+        item => Ok(vec![serde_json::from_value::<TelemetryMessage>(item)]),
+    }
+}
+
+/// Version of the compact binary telemetry encoding (ESP32 mqtt/telemetry_codec.h)
+pub const BINARY_TELEMETRY_VERSION: u8 = 1;
+
+// Version byte flag: suppressed-reading count follows the record count
+const BINARY_HEADER_SUPPRESSED: u8 = 0x80;
+
+// Binary record flags
+const BINARY_FLAG_TANK_LEVEL: u8 = 0x01;
+const BINARY_FLAG_PUMP_ON: u8 = 0x02;
+const BINARY_FLAG_LIGHTS_ON: u8 = 0x04;
+const BINARY_FLAG_IRRIGATED: u8 = 0x08;
+const BINARY_FLAG_TEMPERATURE: u8 = 0x10;
+const BINARY_FLAG_HUMIDITY: u8 = 0x20;
+const BINARY_FLAG_LIGHT: u8 = 0x40;
+const BINARY_FLAG_AGGREGATE: u8 = 0x80;
+
+// Aggregate stats mask
+const BINARY_STATS_TEMPERATURE: u8 = 0x01;
+const BINARY_STATS_HUMIDITY: u8 = 0x02;
+const BINARY_STATS_LIGHT: u8 = 0x04;
+
+// Aggregate window events (READING_EVENT_* on the ESP32)
+const READING_EVENT_PUMP_RAN: u8 = 0x02;
+const READING_EVENT_LIGHTS_RAN: u8 = 0x04;
+const READING_EVENT_TANK_EMPTY: u8 = 0x08;
+
+/// Cursor over a binary telemetry payload
+struct BinaryReader<'a> {
+    data: &'a [u8],
+    pos: usize,
+}
+
+impl BinaryReader<'_> {
+    fn u8(&mut self) -> Result<u8, String> {
+        let byte = *self
+            .data
+            .get(self.pos)
+            .ok_or_else(|| format!("Truncated payload at byte {}", self.pos))?;
+        self.pos += 1;
+        Ok(byte)
+    }
+
+    fn u16(&mut self) -> Result<u16, String> {
+        Ok(u16::from_le_bytes([self.u8()?, self.u8()?]))
+    }
+
+    fn i16(&mut self) -> Result<i16, String> {
+        Ok(self.u16()? as i16)
+    }
+
+    /// Unsigned LEB128 varint (at most 32 bits)
+    fn varint(&mut self) -> Result<u32, String> {
+        let mut value: u64 = 0;
+        for shift in (0..35).step_by(7) {
+            let byte = self.u8()?;
+            value |= u64::from(byte & 0x7f) << shift;
+            if byte & 0x80 == 0 {
+                return u32::try_from(value).map_err(|_| "Varint overflows 32 bits".to_string());
+            }
+        }
+        Err("Varint longer than 5 bytes".to_string())
+    }
+}
+
+/// Parse a compact binary telemetry payload (greenhouse/{id}/telemetry/bin)
+///
+/// Each record is rebuilt as the equivalent JSON object and deserialized like
+/// a JSON message, so both encodings go through the same validation. A bad
+/// header or truncated record rejects the whole payload, since the records
+/// after it cannot be located.
+pub fn parse_binary_telemetry_payload(
+    payload: &[u8],
+) -> Result<Vec<Result<TelemetryMessage, serde_json::Error>>, String> {
+    Ok(decode_binary_telemetry(payload)?
+        .into_iter()
+        .map(serde_json::from_value::<TelemetryMessage>)
+        .collect())
+}
+
+/// Decode a binary telemetry payload into the equivalent JSON objects
+pub fn decode_binary_telemetry(payload: &[u8]) -> Result<Vec<serde_json::Value>, String> {
+    let mut reader = BinaryReader {
+        data: payload,
+        pos: 0,
+    };
+
+    let header = reader.u8()?;
+    let version = header & !BINARY_HEADER_SUPPRESSED;
+    if version != BINARY_TELEMETRY_VERSION {
+        return Err(format!("Unsupported binary telemetry version {}", version));
+    }
+
+    let mut uuid = [0u8; 16];
+    for byte in uuid.iter_mut() {
+        *byte = reader.u8()?;
+    }
+    let device_id = Uuid::from_bytes(uuid).to_string();
+
+    let count = reader.u8()?;
+    let suppressed = if header & BINARY_HEADER_SUPPRESSED != 0 {
+        Some(reader.varint()?)
+    } else {
+        None
+    };
+
+    let mut records = Vec::with_capacity(usize::from(count));
+    for _ in 0..count {
+        let mut record = decode_binary_record(&mut reader, &device_id)?;
+        if let (Some(suppressed), Some(object)) = (suppressed, record.as_object_mut()) {
+            object.insert("suppressed".into(), serde_json::json!(suppressed));
+        }
+        records.push(record);
+    }
+
+    if reader.pos != payload.len() {
+        return Err(format!(
+            "{} trailing bytes after {} records",
+            payload.len() - reader.pos,
+            count
+        ));
+    }
+
+    Ok(records)
+}
+
+/// Decode one binary record into the JSON object the ESP32 would have sent
+fn decode_binary_record(
+    reader: &mut BinaryReader,
+    device_id: &str,
+) -> Result<serde_json::Value, String> {
+    use serde_json::json;
+
+    let mut record = serde_json::Map::new();
+    record.insert("device_id".into(), json!(device_id));
+    record.insert("timestamp".into(), json!(reader.varint()?));
+    record.insert("sequence".into(), json!(reader.varint()?));
+
+    let flags = reader.u8()?;
+    if flags & BINARY_FLAG_TEMPERATURE != 0 {
+        record.insert(
+            "temperature".into(),
+            json!(f64::from(reader.i16()?) / 100.0),
+        );
+    }
+    if flags & BINARY_FLAG_HUMIDITY != 0 {
+        record.insert("humidity".into(), json!(f64::from(reader.u16()?) / 100.0));
+    }
+    if flags & BINARY_FLAG_LIGHT != 0 {
+        record.insert("light".into(), json!(f64::from(reader.varint()?) / 100.0));
+    }
+
+    record.insert(
+        "tank_level".into(),
+        json!(flags & BINARY_FLAG_TANK_LEVEL != 0),
+    );
+    record.insert(
+        "irrigated_since_last_transmission".into(),
+        json!(flags & BINARY_FLAG_IRRIGATED != 0),
+    );
+    record.insert(
+        "lights_are_on".into(),
+        json!(flags & BINARY_FLAG_LIGHTS_ON != 0),
+    );
+    record.insert("pump_on".into(), json!(flags & BINARY_FLAG_PUMP_ON != 0));
+
+    // Window statistics for aggregated readings
+    if flags & BINARY_FLAG_AGGREGATE != 0 {
+        record.insert("samples".into(), json!(reader.varint()?));
+        let events = reader.u8()?;
+        let stats = reader.u8()?;
+
+        if stats & BINARY_STATS_TEMPERATURE != 0 {
+            record.insert(
+                "temperature_min".into(),
+                json!(f64::from(reader.i16()?) / 100.0),
+            );
+            record.insert(
+                "temperature_max".into(),
+                json!(f64::from(reader.i16()?) / 100.0),
+            );
+            record.insert(
+                "temperature_stddev".into(),
+                json!(f64::from(reader.varint()?) / 100.0),
+            );
+        }
+        if stats & BINARY_STATS_HUMIDITY != 0 {
+            record.insert(
+                "humidity_min".into(),
+                json!(f64::from(reader.u16()?) / 100.0),
+            );
+            record.insert(
+                "humidity_max".into(),
+                json!(f64::from(reader.u16()?) / 100.0),
+            );
+            record.insert(
+                "humidity_stddev".into(),
+                json!(f64::from(reader.varint()?) / 100.0),
+            );
+        }
+        if stats & BINARY_STATS_LIGHT != 0 {
+            record.insert("light_min".into(), json!(f64::from(reader.varint()?)));
+            record.insert("light_max".into(), json!(f64::from(reader.varint()?)));
+            record.insert("light_stddev".into(), json!(f64::from(reader.varint()?)));
+        }
+
+        record.insert(
+            "pump_ran".into(),
+            json!(events & READING_EVENT_PUMP_RAN != 0),
+        );
+        record.insert(
+            "lights_ran".into(),
+            json!(events & READING_EVENT_LIGHTS_RAN != 0),
+        );
+        record.insert(
+            "tank_was_empty".into(),
+            json!(events & READING_EVENT_TANK_EMPTY != 0),
+        );
+    }
+
+    Ok(serde_json::Value::Object(record))
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -206,6 +451,26 @@ mod tests {
         assert_eq!(msg.light_intensity, None);
         assert_eq!(msg.irrigated_since_last_transmission, false);
         assert_eq!(msg.pump_on, false);
+        assert_eq!(msg.suppressed, 0);
+    }
+
+    #[test]
+    fn test_suppressed_count() {
+        let json = r#"{
+            "device_id": "550e8400-e29b-41d4-a716-446655440000",
+            "timestamp": 1699459200,
+            "sequence": 2,
+            "temperature": 22.5,
+            "humidity": 65.0,
+            "light": 350.0,
+            "tank_level": true,
+            "lights_are_on": true,
+            "suppressed": 14
+        }"#;
+
+        let msg: TelemetryMessage = serde_json::from_str(json).unwrap();
+        assert_eq!(msg.suppressed, 14);
+        assert!(msg.validate().is_ok());
     }
 
     // ========== Temperature Validation Tests ==========
@@ -755,4 +1020,240 @@ mod tests {
         let msg: TelemetryMessage = serde_json::from_str(json).unwrap();
         assert!(msg.validate().is_ok());
     }
+
+    // ========== Batch Payload Tests ==========
+
+    #[test]
+    fn test_payload_single_object() {
+        let json = r#"{
+            "device_id": "550e8400-e29b-41d4-a716-446655440000",
+            "timestamp": 1699459200,
+            "sequence": 1,
+            "temperature": 20.0,
+            "humidity": 50.0,
+            "light": 100.0,
+            "tank_level": true,
+            "lights_are_on": false
+        }"#;
+
+        let messages = parse_telemetry_payload(json.as_bytes()).unwrap();
+        assert_eq!(messages.len(), 1);
+        assert_eq!(messages[0].as_ref().unwrap().sequence, 1);
+    }
+
+    #[test]
+    fn test_payload_batch_array() {
+        let json = r#"[
+            {
+                "device_id": "550e8400-e29b-41d4-a716-446655440000",
+                "timestamp": 1699459200,
+                "sequence": 1,
+                "temperature": 20.0,
+                "humidity": 50.0,
+                "light": 100.0,
+                "tank_level": true,
+                "lights_are_on": false
+            },
+            {
+                "device_id": "550e8400-e29b-41d4-a716-446655440000",
+                "timestamp": 1699459800,
+                "sequence": 2,
+                "temperature": 21.5,
+                "humidity": 48.0,
+                "light": 120.0,
+                "tank_level": true,
+                "lights_are_on": true,
+                "samples": 10,
+                "temperature_min": 20.1,
+                "temperature_max": 22.3,
+                "temperature_stddev": 0.6
+            }
+        ]"#;
+
+        let messages = parse_telemetry_payload(json.as_bytes()).unwrap();
+        assert_eq!(messages.len(), 2);
+        assert_eq!(messages[0].as_ref().unwrap().sequence, 1);
+        assert_eq!(messages[1].as_ref().unwrap().sequence, 2);
+        assert_eq!(messages[1].as_ref().unwrap().temperature, 21.5);
+    }
+
+    #[test]
+    fn test_payload_batch_with_invalid_element() {
+        // Second element is missing required sensor fields
+        let json = r#"[
+            {
+                "device_id": "550e8400-e29b-41d4-a716-446655440000",
+                "timestamp": 1699459200,
+                "sequence": 1,
+                "temperature": 20.0,
+                "humidity": 50.0,
+                "light": 100.0,
+                "tank_level": true,
+                "lights_are_on": false
+            },
+            {
+                "device_id": "550e8400-e29b-41d4-a716-446655440000",
+                "timestamp": 1699459800,
+                "sequence": 2,
+                "tank_level": true,
+                "lights_are_on": false
+            }
+        ]"#;
+
+        let messages = parse_telemetry_payload(json.as_bytes()).unwrap();
+        assert_eq!(messages.len(), 2);
+        assert!(messages[0].is_ok());
+        assert!(messages[1].is_err());
+    }
+
+    #[test]
+    fn test_payload_malformed_json() {
+        let json = r#"[{"device_id": "550e8400-e29b-41d4-a716-446655440000""#;
+        assert!(parse_telemetry_payload(json.as_bytes()).is_err());
+    }
+
+    // ========== Binary Payload Tests ==========
+
+    // Encoded by the ESP32 codec (mqtt/telemetry_codec.cpp) from a live
+    // reading (sequence 7) followed by a 10-sample aggregate (sequence 8)
+    const BINARY_LIVE: &str = "01550e8400e29b41d4a7164466554400000180e1aeaa060775ca086419b89102";
+    const BINARY_LIVE_SUPPRESSED: &str =
+        "81550e8400e29b41d4a716446655440000010e80e1aeaa060775ca086419b89102";
+    const BINARY_BATCH: &str = "01550e8400e29b41d4a7164466554400000280e1aeaa060775ca086419b89102\
+                                bce1aeaa0608dabbfec0c4070a0a053efe51ff52b009940a29";
+
+    fn from_hex(hex: &str) -> Vec<u8> {
+        (0..hex.len())
+            .step_by(2)
+            .map(|i| u8::from_str_radix(&hex[i..i + 2], 16).unwrap())
+            .collect()
+    }
+
+    /// Compare a decoded binary record with the JSON form of the same reading
+    /// (fixed-point values are accurate to 0.01)
+    fn assert_matches_json(decoded: &serde_json::Value, json: &str) {
+        let expected: serde_json::Value = serde_json::from_str(json).unwrap();
+        let decoded = decoded.as_object().unwrap();
+        let expected = expected.as_object().unwrap();
+
+        let mut decoded_keys: Vec<_> = decoded.keys().collect();
+        let mut expected_keys: Vec<_> = expected.keys().collect();
+        decoded_keys.sort();
+        expected_keys.sort();
+        assert_eq!(decoded_keys, expected_keys);
+
+        for (key, value) in expected {
+            match (value.as_f64(), decoded[key].as_f64()) {
+                (Some(a), Some(b)) => assert!((a - b).abs() < 0.005, "{}: {} != {}", key, a, b),
+                _ => assert_eq!(&decoded[key], value, "{}", key),
+            }
+        }
+    }
+
+    #[test]
+    fn test_binary_live_reading_matches_json() {
+        let records = decode_binary_telemetry(&from_hex(BINARY_LIVE)).unwrap();
+        assert_eq!(records.len(), 1);
+        assert_matches_json(
+            &records[0],
+            r#"{
+                "device_id": "550e8400-e29b-41d4-a716-446655440000",
+                "timestamp": 1699459200,
+                "sequence": 7,
+                "temperature": 22.5,
+                "humidity": 65.0,
+                "light": 350.0,
+                "tank_level": true,
+                "irrigated_since_last_transmission": false,
+                "lights_are_on": true,
+                "pump_on": false
+            }"#,
+        );
+    }
+
+    #[test]
+    fn test_binary_aggregate_matches_json() {
+        let records = decode_binary_telemetry(&from_hex(BINARY_BATCH)).unwrap();
+        assert_eq!(records.len(), 2);
+        assert_matches_json(
+            &records[1],
+            r#"{
+                "device_id": "550e8400-e29b-41d4-a716-446655440000",
+                "timestamp": 1699459260,
+                "sequence": 8,
+                "temperature": -3.25,
+                "light": 1234.56,
+                "tank_level": false,
+                "irrigated_since_last_transmission": true,
+                "lights_are_on": false,
+                "pump_on": true,
+                "samples": 10,
+                "temperature_min": -4.5,
+                "temperature_max": -1.75,
+                "temperature_stddev": 0.82,
+                "light_min": 1200.0,
+                "light_max": 1300.0,
+                "light_stddev": 41.0,
+                "pump_ran": true,
+                "lights_ran": false,
+                "tank_was_empty": true
+            }"#,
+        );
+    }
+
+    #[test]
+    fn test_binary_payload_validated_like_json() {
+        let messages = parse_binary_telemetry_payload(&from_hex(BINARY_BATCH)).unwrap();
+        assert_eq!(messages.len(), 2);
+
+        let live = messages[0].as_ref().unwrap();
+        assert_eq!(
+            live.greenhouse_id.to_string(),
+            "550e8400-e29b-41d4-a716-446655440000"
+        );
+        assert_eq!(live.sequence, 7);
+        assert_eq!(live.temperature, 22.5);
+        assert!(live.validate().is_ok());
+
+        // No humidity in the aggregate - rejected exactly like the JSON form
+        assert!(messages[1].is_err());
+    }
+
+    #[test]
+    fn test_binary_live_reading_with_suppressed_count() {
+        // Same reading as BINARY_LIVE, sent after 14 held-back readings
+        let payload = from_hex(BINARY_LIVE_SUPPRESSED);
+        let messages = parse_binary_telemetry_payload(&payload).unwrap();
+        assert_eq!(messages.len(), 1);
+
+        let live = messages[0].as_ref().unwrap();
+        assert_eq!(live.sequence, 7);
+        assert_eq!(live.suppressed, 14);
+        assert!(live.validate().is_ok());
+
+        // Count declared but missing
+        assert!(decode_binary_telemetry(&payload[..18]).is_err());
+    }
+
+    #[test]
+    fn test_binary_payload_malformed() {
+        let payload = from_hex(BINARY_BATCH);
+
+        // Truncated record
+        assert!(decode_binary_telemetry(&payload[..payload.len() - 1]).is_err());
+
+        // Trailing bytes
+        let mut trailing = payload.clone();
+        trailing.push(0);
+        assert!(decode_binary_telemetry(&trailing).is_err());
+
+        // Unknown version
+        let mut version = payload.clone();
+        version[0] = 2;
+        assert!(decode_binary_telemetry(&version).is_err());
+        version[0] = 2 | BINARY_HEADER_SUPPRESSED;
+        assert!(decode_binary_telemetry(&version).is_err());
+
+        assert!(decode_binary_telemetry(&[]).is_err());
+    }
 }